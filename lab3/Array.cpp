@@ -1,81 +1,411 @@
 #include "Array.h"
+#include "StringSort.h"
+#include "ThreadPool.h"
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <stdexcept>
 
 using namespace std;
 
+// Сырая память под count строк без конструирования
+static string* allocate_cells(int count) {
+    return static_cast<string*>(::operator new(static_cast<size_t>(count) * sizeof(string)));
+}
+
 Array::Array(int initial_capacity) {
-    data = new string[initial_capacity];
-    capacity = initial_capacity;
+    capacity = initial_capacity > 0 ? initial_capacity : 0;
     size = 0;
+    data = capacity > 0 ? allocate_cells(capacity) : nullptr;
 }
 
 Array::~Array() {
-    delete[] data;
+    release_cells();
 }
 
-Array::Array(const Array& other) {
+Array::Array(const Array& other)
+    : storage(other.storage), arena(other.arena), offsets(other.offsets), chunks(other.chunks),
+      chunk_tree(other.chunk_tree) {
     capacity = other.capacity;
-    size = other.size;
-    data = new string[capacity];
-    for (int i = 0; i < size; ++i) {
-        data[i] = other.data[i];
+    size = 0;
+    data = capacity > 0 ? allocate_cells(capacity) : nullptr;
+    if (storage != ArrayStorage::STRINGS) {
+        size = other.size;
+        return;
+    }
+    for (; size < other.size; ++size) {
+        new (data + size) string(other.data[size]);
     }
 }
 
 Array& Array::operator=(const Array& other) {
     if (this != &other) {
-        delete[] data;
+        Array copy(other);
+        *this = move(copy);
+    }
+    return *this;
+}
+
+Array::Array(Array&& other) noexcept
+    : data(other.data), capacity(other.capacity), size(other.size), storage(other.storage),
+      arena(move(other.arena)), offsets(move(other.offsets)), chunks(move(other.chunks)),
+      chunk_tree(move(other.chunk_tree)) {
+    other.data = nullptr;
+    other.capacity = 0;
+    other.size = 0;
+    other.storage = ArrayStorage::STRINGS;
+    other.clear_arena();
+    other.clear_chunks();
+}
+
+Array& Array::operator=(Array&& other) noexcept {
+    if (this != &other) {
+        release_cells();
+        data = other.data;
         capacity = other.capacity;
         size = other.size;
-        data = new string[capacity];
+        storage = other.storage;
+        arena = move(other.arena);
+        offsets = move(other.offsets);
+        chunks = move(other.chunks);
+        chunk_tree = move(other.chunk_tree);
+        other.data = nullptr;
+        other.capacity = 0;
+        other.size = 0;
+        other.storage = ArrayStorage::STRINGS;
+        other.clear_arena();
+        other.clear_chunks();
+    }
+    return *this;
+}
+
+void Array::destroy_elements() {
+    if (storage == ArrayStorage::ARENA) {
+        clear_arena();
+    } else if (storage == ArrayStorage::CHUNKED) {
+        clear_chunks();
+    } else {
         for (int i = 0; i < size; ++i) {
-            data[i] = other.data[i];
+            data[i].~string();
         }
     }
-    return *this;
+    size = 0;
+}
+
+void Array::release_cells() {
+    destroy_elements();
+    ::operator delete(data);
+    data = nullptr;
+    capacity = 0;
+}
+
+// Пустой offsets равносилен {0}: первая вставка добавит начальное смещение
+void Array::clear_arena() {
+    arena.clear();
+    offsets.clear();
+}
+
+void Array::clear_chunks() noexcept {
+    chunks.clear();
+    chunk_tree.clear();
+}
+
+vector<string> Array::take_values() {
+    vector<string> values;
+    values.reserve(static_cast<size_t>(size));
+    if (storage == ArrayStorage::STRINGS) {
+        for (int i = 0; i < size; ++i) {
+            values.push_back(move(data[i]));
+        }
+    } else if (storage == ArrayStorage::CHUNKED) {
+        for (auto& chunk : chunks) {
+            for (auto& value : chunk) {
+                values.push_back(move(value));
+            }
+        }
+    } else {
+        for (int i = 0; i < size; ++i) {
+            values.emplace_back(view(i));
+        }
+    }
+    destroy_elements();
+    return values;
+}
+
+void Array::set_storage(ArrayStorage mode) {
+    if (mode == storage) {
+        return;
+    }
+
+    vector<string> values = take_values();
+    release_cells();
+    string().swap(arena);
+    vector<size_t>().swap(offsets);
+    vector<vector<string>>().swap(chunks);
+    vector<size_t>().swap(chunk_tree);
+    storage = mode;
+
+    reserve(static_cast<int>(values.size()));
+    if (mode == ArrayStorage::ARENA) {
+        size_t bytes = 0;
+        for (const auto& value : values) {
+            bytes += value.size();
+        }
+        arena.reserve(bytes);
+    }
+    for (auto& value : values) {
+        push_back(move(value));
+    }
+}
+
+void Array::arena_insert(int index, string_view value) {
+    if (offsets.empty()) {
+        offsets.push_back(0);
+    }
+    size_t position = offsets[index];
+    if (index == size) {
+        arena.append(value.data(), value.size());
+    } else {
+        arena.insert(position, value.data(), value.size());
+    }
+    offsets.insert(offsets.begin() + index + 1, position + value.size());
+    for (size_t i = static_cast<size_t>(index) + 2; i < offsets.size(); ++i) {
+        offsets[i] += value.size();
+    }
+    size++;
+}
+
+void Array::arena_replace(int index, string_view value) {
+    size_t position = offsets[index];
+    size_t old_length = offsets[index + 1] - position;
+    arena.replace(position, old_length, value.data(), value.size());
+    for (size_t i = static_cast<size_t>(index) + 1; i < offsets.size(); ++i) {
+        offsets[i] = offsets[i] - old_length + value.size();
+    }
+}
+
+void Array::arena_remove(int index) {
+    size_t position = offsets[index];
+    size_t length = offsets[index + 1] - position;
+    arena.erase(position, length);
+    offsets.erase(offsets.begin() + index + 1);
+    for (size_t i = static_cast<size_t>(index) + 1; i < offsets.size(); ++i) {
+        offsets[i] -= length;
+    }
+    size--;
+}
+
+// Младший единичный бит: узел i дерева Фенвика покрывает lowest_bit(i) блоков
+static size_t lowest_bit(size_t i) {
+    return i & (~i + 1);
+}
+
+void Array::chunk_resized(size_t chunk, ptrdiff_t delta) {
+    for (size_t i = chunk + 1; i < chunk_tree.size(); i += lowest_bit(i)) {
+        chunk_tree[i] = static_cast<size_t>(static_cast<ptrdiff_t>(chunk_tree[i]) + delta);
+    }
+}
+
+void Array::chunk_appended() {
+    if (chunk_tree.empty()) {
+        chunk_tree.push_back(0);
+    }
+    // Узел нового блока — его размер плюс узлы, которые он накрывает
+    size_t node = chunks.size();
+    size_t sum = chunks.back().size();
+    for (size_t i = node - 1; i > node - lowest_bit(node); i -= lowest_bit(i)) {
+        sum += chunk_tree[i];
+    }
+    chunk_tree.push_back(sum);
+}
+
+void Array::chunk_rebuild() {
+    // Каждый узел добавляет свою сумму ближайшему накрывающему его узлу
+    chunk_tree.assign(chunks.size() + 1, 0);
+    for (size_t i = 1; i < chunk_tree.size(); ++i) {
+        chunk_tree[i] += chunks[i - 1].size();
+        size_t parent = i + lowest_bit(i);
+        if (parent < chunk_tree.size()) {
+            chunk_tree[parent] += chunk_tree[i];
+        }
+    }
+}
+
+void Array::chunk_locate(size_t index, size_t& chunk, size_t& offset) const {
+    size_t count = chunk_tree.size() - 1;
+    // Блоки обычно заполнены одинаково, поэтому сначала проверяется блок,
+    // предсказанный по средней заполненности. Его начало — сумма узлов, чьи
+    // номера известны заранее: загрузки идут параллельно, а не цепочкой.
+    size_t guess = min(index * count / static_cast<size_t>(size), count - 1);
+    size_t start = 0;
+    for (size_t i = guess; i > 0; i -= lowest_bit(i)) {
+        start += chunk_tree[i];
+    }
+    if (index >= start && index - start < chunks[guess].size()) {
+        chunk = guess;
+        offset = index - start;
+        return;
+    }
+
+    // Спуск по дереву: самый длинный ряд первых блоков, в котором не больше
+    // index элементов. Блоки непусты, поэтому следующий блок содержит index.
+    size_t step = size_t(1) << (63 - __builtin_clzll(count));
+    size_t position = 0;
+    size_t rest = index;
+    for (; step > 0; step /= 2) {
+        if (position + step <= count && chunk_tree[position + step] <= rest) {
+            position += step;
+            rest -= chunk_tree[position];
+        }
+    }
+    chunk = position;
+    offset = rest;
+}
+
+void Array::chunked_insert(int index, string&& value) {
+    size_t chunk;
+    size_t offset;
+    bool split = false;
+    if (index == size) {
+        if (chunks.empty() || chunks.back().size() == CHUNK_CAPACITY) {
+            chunks.emplace_back();
+            chunk_appended();
+        }
+        chunk = chunks.size() - 1;
+        offset = chunks[chunk].size();
+    } else {
+        chunk_locate(static_cast<size_t>(index), chunk, offset);
+        if (chunks[chunk].size() == CHUNK_CAPACITY) {
+            split = true;
+            // Полный блок делится пополам
+            const size_t half = CHUNK_CAPACITY / 2;
+            vector<string>& full = chunks[chunk];
+            vector<string> tail(make_move_iterator(full.begin() + half), make_move_iterator(full.end()));
+            full.erase(full.begin() + half, full.end());
+            chunks.insert(chunks.begin() + chunk + 1, move(tail));
+            if (offset > half) {
+                ++chunk;
+                offset -= half;
+            }
+        }
+    }
+
+    vector<string>& target = chunks[chunk];
+    target.insert(target.begin() + offset, move(value));
+    size++;
+    if (split) {
+        chunk_rebuild();
+    } else {
+        chunk_resized(chunk, 1);
+    }
+}
+
+void Array::chunked_remove(int index) {
+    size_t chunk;
+    size_t offset;
+    chunk_locate(static_cast<size_t>(index), chunk, offset);
+    chunks[chunk].erase(chunks[chunk].begin() + offset);
+    size--;
+
+    // Пустой блок удаляется, маленький сливается с соседом
+    const size_t half = CHUNK_CAPACITY / 2;
+    if (chunks[chunk].empty()) {
+        chunks.erase(chunks.begin() + chunk);
+    } else if (chunk > 0 && chunks[chunk - 1].size() + chunks[chunk].size() <= half) {
+        --chunk;
+    } else if (chunk + 1 >= chunks.size() || chunks[chunk].size() + chunks[chunk + 1].size() > half) {
+        chunk_resized(chunk, -1);
+        return;
+    }
+    if (chunk + 1 < chunks.size() && chunks[chunk].size() + chunks[chunk + 1].size() <= half) {
+        vector<string>& next = chunks[chunk + 1];
+        chunks[chunk].insert(chunks[chunk].end(), make_move_iterator(next.begin()), make_move_iterator(next.end()));
+        chunks.erase(chunks.begin() + chunk + 1);
+    }
+    chunk_rebuild();
 }
 
 void Array::resize(int new_capacity) {
-    string* new_data = new string[new_capacity];
+    string* new_data = allocate_cells(new_capacity);
     for (int i = 0; i < size; ++i) {
-        new_data[i] = data[i];
+        new (new_data + i) string(move(data[i]));
+        data[i].~string();
     }
-    delete[] data;
+    ::operator delete(data);
     data = new_data;
     capacity = new_capacity;
 }
 
-void Array::push_back(const string& value) {
-    if (size >= capacity) {
-        resize(capacity * 2);
+void Array::reserve(int new_capacity) {
+    if (storage == ArrayStorage::ARENA) {
+        offsets.reserve(static_cast<size_t>(new_capacity) + 1);
+    } else if (storage == ArrayStorage::CHUNKED) {
+        chunks.reserve(static_cast<size_t>(new_capacity) / CHUNK_CAPACITY + 1);
+    } else if (new_capacity > capacity) {
+        resize(new_capacity);
     }
-    data[size] = value;
-    size++;
 }
 
-bool Array::insert(int index, const string& value) {
+bool Array::insert(int index, string_view value) {
+    if (index < 0 || index > size) {
+        return false;
+    }
+    if (storage == ArrayStorage::ARENA) {
+        arena_insert(index, value);
+        return true;
+    }
+    return insert(index, string(value));
+}
+
+bool Array::insert(int index, string&& value) {
     if (index < 0 || index > size) {
         return false;
     }
+    if (storage == ArrayStorage::ARENA) {
+        arena_insert(index, value);
+        return true;
+    }
+    if (storage == ArrayStorage::CHUNKED) {
+        chunked_insert(index, move(value));
+        return true;
+    }
 
-    if (size >= capacity) {
-        resize(capacity * 2);
+    if (size == capacity) {
+        resize(grown_capacity());
     }
 
-    for (int i = size; i > index; --i) {
-        data[i] = data[i - 1];
+    if (index == size) {
+        new (data + size) string(move(value));
+    } else {
+        // Последний элемент переезжает в свободную ячейку, остальные сдвигаются перемещением
+        new (data + size) string(move(data[size - 1]));
+        for (int i = size - 1; i > index; --i) {
+            data[i] = move(data[i - 1]);
+        }
+        data[index] = move(value);
     }
-    data[index] = value;
     size++;
     return true;
 }
 
 string Array::get(int index) const {
+    return string(view(index));
+}
+
+string_view Array::view(int index) const {
     if (index < 0 || index >= size) {
-        return "";
+        return string_view();
+    }
+    if (storage == ArrayStorage::ARENA) {
+        return string_view(arena.data() + offsets[index], offsets[index + 1] - offsets[index]);
+    }
+    if (storage == ArrayStorage::CHUNKED) {
+        size_t chunk;
+        size_t offset;
+        chunk_locate(static_cast<size_t>(index), chunk, offset);
+        return chunks[chunk][offset];
     }
     return data[index];
 }
@@ -84,19 +414,58 @@ bool Array::remove(int index) {
     if (index < 0 || index >= size) {
         return false;
     }
+    if (storage == ArrayStorage::ARENA) {
+        arena_remove(index);
+        return true;
+    }
+    if (storage == ArrayStorage::CHUNKED) {
+        chunked_remove(index);
+        return true;
+    }
 
     for (int i = index; i < size - 1; ++i) {
-        data[i] = data[i + 1];
+        data[i] = move(data[i + 1]);
     }
     size--;
+    data[size].~string();
+    return true;
+}
+
+bool Array::replace(int index, string_view value) {
+    if (index < 0 || index >= size) {
+        return false;
+    }
+    if (storage == ArrayStorage::ARENA) {
+        arena_replace(index, value);
+        return true;
+    }
+    if (storage == ArrayStorage::CHUNKED) {
+        size_t chunk;
+        size_t offset;
+        chunk_locate(static_cast<size_t>(index), chunk, offset);
+        chunks[chunk][offset].assign(value.data(), value.size());
+        return true;
+    }
+    data[index].assign(value.data(), value.size());
     return true;
 }
 
-bool Array::replace(int index, const string& value) {
+bool Array::replace(int index, string&& value) {
     if (index < 0 || index >= size) {
         return false;
     }
-    data[index] = value;
+    if (storage == ArrayStorage::ARENA) {
+        arena_replace(index, value);
+        return true;
+    }
+    if (storage == ArrayStorage::CHUNKED) {
+        size_t chunk;
+        size_t offset;
+        chunk_locate(static_cast<size_t>(index), chunk, offset);
+        chunks[chunk][offset] = move(value);
+        return true;
+    }
+    data[index] = move(value);
     return true;
 }
 
@@ -104,58 +473,128 @@ int Array::length() const {
     return size;
 }
 
+MemoryUsage Array::memory_usage() const {
+    MemoryUsage usage;
+    usage.bytes = sizeof(Array);
+    if (storage == ArrayStorage::ARENA) {
+        usage.addStringBuffer(arena);
+        usage.payload += arena.size();
+        if (offsets.capacity() > 0) {
+            usage.addBlock(offsets.capacity() * sizeof(size_t));
+        }
+        return usage;
+    }
+    if (storage == ArrayStorage::CHUNKED) {
+        if (chunks.capacity() > 0) {
+            usage.addBlock(chunks.capacity() * sizeof(vector<string>));
+        }
+        if (chunk_tree.capacity() > 0) {
+            usage.addBlock(chunk_tree.capacity() * sizeof(size_t));
+        }
+        for (const auto& chunk : chunks) {
+            if (chunk.capacity() > 0) {
+                usage.addBlock(chunk.capacity() * sizeof(string));
+            }
+            for (const auto& value : chunk) {
+                usage.addString(value);
+            }
+        }
+        return usage;
+    }
+    if (capacity > 0) {
+        usage.addBlock(static_cast<size_t>(capacity) * sizeof(string));
+    }
+    for (int i = 0; i < size; ++i) {
+        usage.addString(data[i]);
+    }
+    return usage;
+}
+
 void Array::print() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    print(out);
+}
+
+void Array::print(TextWriter& out) const {
     if (size == 0) {
-        cout << "массив пуст" << endl;
+        out << "массив пуст\n";
         return;
     }
 
-    cout << "массив [" << size << "]: ";
+    out << "массив [" << size << "]: ";
     for (int i = 0; i < size; ++i) {
-        cout << data[i];
+        out << view(i);
         if (i < size - 1) {
-            cout << ", ";
+            out << ", ";
         }
     }
-    cout << endl;
+    out << '\n';
 }
 
 bool Array::serialize_binary(const string& filename) const {
-    ofstream file(filename, ios::binary);
-    if (!file.is_open()) {
-        return false;
+    return writeBinaryFile(filename, *this);
+}
+
+bool Array::deserialize_binary(const string& filename) {
+    return readBinaryFile(filename, *this);
+}
+
+// Формат общий для всех режимов: снимок, сохраненный из одного, читается в другом
+void Array::serialize_binary(ByteWriter& out) const {
+    if (storage == ArrayStorage::ARENA) {
+        out.writeBulkHeader(static_cast<uint32_t>(size), arena.size());
+        for (int i = 0; i < size; ++i) {
+            out.writeString(view(i));
+        }
+        return;
+    }
+    if (storage == ArrayStorage::CHUNKED) {
+        uint64_t bytes = 0;
+        for (const auto& chunk : chunks) {
+            for (const auto& value : chunk) {
+                bytes += value.size();
+            }
+        }
+        out.writeBulkHeader(static_cast<uint32_t>(size), bytes);
+        for (const auto& chunk : chunks) {
+            for (const auto& value : chunk) {
+                out.writeString(value);
+            }
+        }
+        return;
     }
 
-    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    uint64_t bytes = 0;
     for (int i = 0; i < size; ++i) {
-        size_t str_size = data[i].size();
-        file.write(reinterpret_cast<const char*>(&str_size), sizeof(str_size));
-        file.write(data[i].c_str(), str_size);
+        bytes += data[i].size();
     }
 
-    return true;
+    out.writeBulkHeader(static_cast<uint32_t>(size), bytes);
+    for (int i = 0; i < size; ++i) {
+        out.writeString(data[i]);
+    }
 }
 
-bool Array::deserialize_binary(const string& filename) {
-    ifstream file(filename, ios::binary);
-    if (!file.is_open()) {
+bool Array::deserialize_binary(ByteReader& in) {
+    uint32_t new_size;
+    uint64_t bytes;
+    if (!in.readBulkHeader(new_size, bytes, 4)) {
         return false;
     }
 
-    int new_size;
-    file.read(reinterpret_cast<char*>(&new_size), sizeof(new_size));
-
-    if (new_size > capacity) {
-        resize(new_size);
+    destroy_elements();
+    reserve(bulkReserve(new_size));
+    // Заголовок уже сверен с размером источника, если тот известен
+    if (storage == ArrayStorage::ARENA && in.remaining() != ByteSource::UNKNOWN_SIZE) {
+        arena.reserve(bytes);
     }
 
-    size = 0;
-    for (int i = 0; i < new_size; ++i) {
-        size_t str_size;
-        file.read(reinterpret_cast<char*>(&str_size), sizeof(str_size));
-
-        string value(str_size, '\0');
-        file.read(&value[0], str_size);
+    string_view value;
+    for (uint32_t i = 0; i < new_size; ++i) {
+        if (!in.readStringView(value)) {
+            return false;
+        }
         push_back(value);
     }
 
@@ -170,7 +609,7 @@ bool Array::serialize_text(const string& filename) const {
 
     file << size << endl;
     for (int i = 0; i < size; ++i) {
-        file << data[i] << endl;
+        file << view(i) << endl;
     }
 
     return true;
@@ -186,14 +625,14 @@ bool Array::deserialize_text(const string& filename) {
     file >> new_size;
     file.ignore();
 
-    size = 0;
+    destroy_elements();
     for (int i = 0; i < new_size; ++i) {
         string value;
         getline(file, value);
         if (!file.good() && !file.eof()) {
             return false;
         }
-        push_back(value);
+        push_back(move(value));
     }
 
     return true;
@@ -201,8 +640,199 @@ bool Array::deserialize_text(const string& filename) {
 
 vector<string> Array::to_vector() const {
     vector<string> result;
+    result.reserve(static_cast<size_t>(size));
     for (int i = 0; i < size; ++i) {
-        result.push_back(data[i]);
+        result.emplace_back(view(i));
+    }
+    return result;
+}
+
+template <typename Visitor>
+void Array::scan_matches(int begin, int end, string_view pattern, MatchMode mode, Visitor&& visit) const {
+    if (begin >= end) {
+        return;
+    }
+    if (storage == ArrayStorage::ARENA && mode == MatchMode::SUBSTRING && !pattern.empty()) {
+        // Образец ищется сразу во всем буфере; вхождение засчитывается, если
+        // не выходит за конец значения, в котором начинается
+        size_t position = offsets[begin];
+        const size_t limit = offsets[end];
+        int index = begin;
+        while (index < end) {
+            size_t hit = findSubstring(arena.data() + position, limit - position, pattern);
+            if (hit == MATCH_NOT_FOUND) {
+                return;
+            }
+            hit += position;
+            auto next = upper_bound(offsets.begin() + index + 1, offsets.begin() + end + 1, hit);
+            index = static_cast<int>(next - offsets.begin()) - 1;
+            if (hit + pattern.size() <= offsets[index + 1]) {
+                if (!visit(index)) {
+                    return;
+                }
+                position = offsets[index + 1];
+                ++index;
+            } else {
+                position = hit + 1;
+            }
+        }
+        return;
+    }
+
+    if (storage == ArrayStorage::ARENA) {
+        for (int index = begin; index < end; ++index) {
+            string_view value(arena.data() + offsets[index], offsets[index + 1] - offsets[index]);
+            if (matchesPattern(value, pattern, mode) && !visit(index)) {
+                return;
+            }
+        }
+    } else if (storage == ArrayStorage::CHUNKED) {
+        size_t chunk = 0;
+        int first = 0;
+        while (first + static_cast<int>(chunks[chunk].size()) <= begin) {
+            first += static_cast<int>(chunks[chunk].size());
+            ++chunk;
+        }
+        for (int index = begin; index < end; ++chunk) {
+            const vector<string>& values = chunks[chunk];
+            for (size_t offset = static_cast<size_t>(index - first); offset < values.size() && index < end;
+                 ++offset, ++index) {
+                if (matchesPattern(values[offset], pattern, mode) && !visit(index)) {
+                    return;
+                }
+            }
+            first += static_cast<int>(values.size());
+        }
+    } else {
+        for (int index = begin; index < end; ++index) {
+            if (matchesPattern(data[index], pattern, mode) && !visit(index)) {
+                return;
+            }
+        }
+    }
+}
+
+int Array::find(string_view pattern, MatchMode mode, int from) const {
+    int found = -1;
+    scan_matches(from < 0 ? 0 : from, size, pattern, mode, [&found](int index) {
+        found = index;
+        return false;
+    });
+    return found;
+}
+
+// Меньшие массивы быстрее проверить в одном потоке, чем запускать пул
+static constexpr int PARALLEL_MIN_VALUES = 1 << 16;
+
+// Делит [0, count) на равные части и вызывает body(part, begin, end) для
+// каждой; возвращает число частей
+static size_t forEachPart(int count, size_t threads, const function<void(size_t, int, int)>& body) {
+    size_t parts = threads <= 1 || count < PARALLEL_MIN_VALUES ? 1 : threads;
+    auto run = [&](size_t part) {
+        int begin = static_cast<int>(static_cast<int64_t>(count) * part / parts);
+        int end = static_cast<int>(static_cast<int64_t>(count) * (part + 1) / parts);
+        body(part, begin, end);
+    };
+    if (parts == 1) {
+        run(0);
+    } else {
+        ThreadPool pool(parts);
+        pool.parallelFor(parts, run);
+    }
+    return parts;
+}
+
+int Array::count_matches(string_view pattern, MatchMode mode, size_t threads) const {
+    vector<int> counts(threads > 0 ? threads : 1, 0);
+    size_t parts = forEachPart(size, threads, [&](size_t part, int begin, int end) {
+        int found = 0;
+        scan_matches(begin, end, pattern, mode, [&found](int) {
+            ++found;
+            return true;
+        });
+        counts[part] = found;
+    });
+    int total = 0;
+    for (size_t part = 0; part < parts; ++part) {
+        total += counts[part];
+    }
+    return total;
+}
+
+vector<int> Array::filter(string_view pattern, MatchMode mode, size_t limit, size_t threads) const {
+    vector<vector<int>> found(threads > 0 ? threads : 1);
+    size_t parts = forEachPart(size, threads, [&](size_t part, int begin, int end) {
+        vector<int>& indices = found[part];
+        scan_matches(begin, end, pattern, mode, [&indices, limit](int index) {
+            indices.push_back(index);
+            return indices.size() < limit;
+        });
+    });
+    // Части идут по порядку, поэтому первые limit номеров — из начала массива
+    vector<int> result = move(found[0]);
+    for (size_t part = 1; part < parts && result.size() < limit; ++part) {
+        size_t take = min(found[part].size(), limit - result.size());
+        result.insert(result.end(), found[part].begin(), found[part].begin() + static_cast<ptrdiff_t>(take));
+    }
+    if (result.size() > limit) {
+        result.resize(limit);
     }
     return result;
-}
\ No newline at end of file
+}
+
+vector<int> Array::sorted_order(bool stable, size_t threads) const {
+    vector<SortKey> keys;
+    keys.reserve(static_cast<size_t>(size));
+    auto add = [&keys](string_view value) {
+        keys.push_back({value.data(), static_cast<uint32_t>(value.size()), static_cast<uint32_t>(keys.size())});
+    };
+    if (storage == ArrayStorage::CHUNKED) {
+        for (const auto& chunk : chunks) {
+            for (const auto& value : chunk) {
+                add(value);
+            }
+        }
+    } else {
+        for (int i = 0; i < size; ++i) {
+            add(view(i));
+        }
+    }
+
+    sortStrings(keys, stable, threads);
+
+    vector<int> order(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        order[i] = static_cast<int>(keys[i].index);
+    }
+    return order;
+}
+
+void Array::sort(size_t threads) {
+    // Равные значения неразличимы, поэтому устойчивость не нужна
+    vector<int> order = sorted_order(false, threads);
+    if (storage == ArrayStorage::STRINGS) {
+        // Строки переезжают в новые ячейки перемещением, буферы не копируются
+        int count = size;
+        int cells_capacity = capacity;
+        string* cells = cells_capacity > 0 ? allocate_cells(cells_capacity) : nullptr;
+        for (int i = 0; i < count; ++i) {
+            new (cells + i) string(move(data[order[i]]));
+        }
+        release_cells();
+        data = cells;
+        capacity = cells_capacity;
+        size = count;
+        return;
+    }
+
+    Array sorted(0);
+    sorted.set_storage(storage);
+    sorted.reserve(size);
+    if (storage == ArrayStorage::ARENA) {
+        sorted.arena.reserve(arena.size());
+    }
+    for (int index : order) {
+        sorted.push_back(view(index));
+    }
+    *this = move(sorted);
+}
@@ -1,40 +1,184 @@
 #ifndef ARRAY_H
 #define ARRAY_H
 
+#include <cstdint>
 #include <fstream>
+#include <new>
 #include <string>
+#include <string_view>
+#include <utility>
+
+#include "ByteStream.h"
+#include "MemoryUsage.h"
+#include "StringMatch.h"
+#include "TextWriter.h"
 #include <vector>
 
 using namespace std;
 
+// Размещение строк массива
+enum class ArrayStorage : uint8_t {
+    STRINGS,  // объект string на элемент; длинное значение — в своем блоке кучи
+    ARENA,    // байты всех значений подряд в одном буфере плюс смещения
+    CHUNKED   // последовательность блоков до CHUNK_CAPACITY строк
+};
+
+// Динамический массив строк. В режиме STRINGS память под ячейки выделяется
+// без инициализации: строки существуют только в [0, size) и при росте
+// перемещаются. В режиме ARENA значения лежат подряд, как столбец строк в
+// колоночных форматах: полный проход читает память последовательно, а
+// вставка и удаление в середине сдвигают байты всех следующих значений.
+// В режиме CHUNKED вставка и удаление сдвигают строки только внутри одного
+// блока, а блок ищется по дереву Фенвика из размеров блоков за O(log C), где
+// C — число блоков. Дерево меняется только при изменении массива, поэтому
+// константные методы можно вызывать из разных потоков.
 class Array {
 private:
     string* data;
     int capacity;
     int size;
 
+    ArrayStorage storage = ArrayStorage::STRINGS;
+    // ARENA: значение i — arena[offsets[i], offsets[i + 1]); offsets[0] = 0,
+    // у пустого массива offsets может быть пуст
+    string arena;
+    vector<size_t> offsets;
+
+    // CHUNKED: блоки непусты. chunk_tree — дерево Фенвика по размерам блоков:
+    // chunk_tree[i] (i >= 1) — число элементов в блоках с номерами
+    // [i - (i & -i), i); у массива без блоков дерево может быть пустым.
+    static constexpr size_t CHUNK_CAPACITY = 512;
+    vector<vector<string>> chunks;
+    vector<size_t> chunk_tree;
+
     void resize(int new_capacity);
+    // Емкость после роста заполненного массива
+    int grown_capacity() const { return capacity > 0 ? capacity * 2 : 1; }
+    void destroy_elements();
+    void release_cells();
+    void clear_arena();
+    void arena_insert(int index, string_view value);
+    void arena_replace(int index, string_view value);
+    void arena_remove(int index);
+    // Блок и позиция в нем для элемента index < size; ничего не записывает
+    void chunk_locate(size_t index, size_t& chunk, size_t& offset) const;
+    // Размер блока chunk изменился на delta: O(log C)
+    void chunk_resized(size_t chunk, ptrdiff_t delta);
+    // В конец добавлен блок: O(log C)
+    void chunk_appended();
+    // Блоки вставлены или удалены в середине: дерево строится заново за O(C)
+    void chunk_rebuild();
+    void chunked_insert(int index, string&& value);
+    void chunked_remove(int index);
+    void clear_chunks() noexcept;
+    // Забирает все значения, оставляя массив пустым
+    vector<string> take_values();
+    // Вызывает visit(i) для подходящих под образец значений из [begin, end),
+    // пока visit возвращает true. Разные части массива можно проверять
+    // из разных потоков.
+    template <typename Visitor>
+    void scan_matches(int begin, int end, string_view pattern, MatchMode mode, Visitor&& visit) const;
 
 public:
     Array(int initial_capacity = 10);
     ~Array();
     Array(const Array& other);
     Array& operator=(const Array& other);
+    Array(Array&& other) noexcept;
+    Array& operator=(Array&& other) noexcept;
+
+    // Переводит содержимое в другой режим хранения
+    void set_storage(ArrayStorage mode);
+    ArrayStorage get_storage() const { return storage; }
+
+    // Строит строку прямо в ячейке; аргументы могут ссылаться на элемент массива.
+    // size растет только после конструктора: если он бросит исключение,
+    // деструктор не тронет неинициализированную ячейку.
+    template <typename... Args>
+    void emplace_back(Args&&... args) {
+        if (storage != ArrayStorage::STRINGS) {
+            push_back(string(forward<Args>(args)...));
+            return;
+        }
+        if (size == capacity) {
+            string value(forward<Args>(args)...);
+            resize(grown_capacity());
+            new (data + size) string(move(value));
+            ++size;
+            return;
+        }
+        new (data + size) string(forward<Args>(args)...);
+        ++size;
+    }
 
-    void push_back(const string& value);
-    bool insert(int index, const string& value);
+    // Перегрузка для const char* нужна, иначе литерал неоднозначен
+    void push_back(string_view value) {
+        if (storage == ArrayStorage::STRINGS) {
+            emplace_back(value);
+        } else if (storage == ArrayStorage::ARENA) {
+            arena_insert(size, value);
+        } else {
+            chunked_insert(size, string(value));
+        }
+    }
+    void push_back(const string& value) { push_back(string_view(value)); }
+    void push_back(const char* value) { push_back(string_view(value)); }
+    void push_back(string&& value) {
+        if (storage == ArrayStorage::STRINGS) {
+            emplace_back(move(value));
+        } else if (storage == ArrayStorage::ARENA) {
+            arena_insert(size, value);
+        } else {
+            chunked_insert(size, move(value));
+        }
+    }
+
+    bool insert(int index, string&& value);
+    bool insert(int index, string_view value);
+    bool insert(int index, const string& value) { return insert(index, string_view(value)); }
+    bool insert(int index, const char* value) { return insert(index, string_view(value)); }
+
+    // Замена переиспользует буфер строки, если новое значение в него помещается
+    bool replace(int index, string_view value);
+    bool replace(int index, string&& value);
+    bool replace(int index, const string& value) { return replace(index, string_view(value)); }
+    bool replace(int index, const char* value) { return replace(index, string_view(value)); }
+
+    void reserve(int new_capacity);
     string get(int index) const;
+    // Элемент без копирования; пустая строка, если индекса нет. Ссылка
+    // действительна до следующего изменения массива.
+    string_view view(int index) const;
     bool remove(int index);
-    bool replace(int index, const string& value);
     int length() const;
+    // Занятая память: объект, блоки в куче и емкость строк
+    MemoryUsage memory_usage() const;
     void print() const;
+    void print(TextWriter& out) const;
 
     bool serialize_binary(const string& filename) const;
     bool deserialize_binary(const string& filename);
     bool serialize_text(const string& filename) const;
     bool deserialize_text(const string& filename);
 
+    // Сериализация в память (снимки базы данных)
+    void serialize_binary(ByteWriter& out) const;
+    bool deserialize_binary(ByteReader& in);
+
     vector<string> to_vector() const;
+
+    // Номер первого значения начиная с from, подходящего под образец, или -1
+    int find(string_view pattern, MatchMode mode, int from = 0) const;
+    // Число и номера подходящих значений по порядку (не больше limit).
+    // threads > 1 делит большой массив между потоками.
+    int count_matches(string_view pattern, MatchMode mode, size_t threads = 1) const;
+    vector<int> filter(string_view pattern, MatchMode mode, size_t limit = SIZE_MAX, size_t threads = 1) const;
+
+    // Номера значений в порядке возрастания (как string::compare): result[k] —
+    // номер k-го значения. stable — равные значения идут в исходном порядке.
+    vector<int> sorted_order(bool stable = false, size_t threads = 1) const;
+    // Сортирует значения по возрастанию
+    void sort(size_t threads = 1);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,274 @@
+#include "ByteStream.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static constexpr size_t SOURCE_BLOCK_SIZE = 64 * 1024;
+
+// ========== Приемники ==========
+
+bool FileSink::write(const char* data, size_t size) {
+    return fwrite(data, 1, size, file) == size;
+}
+
+bool FileSink::flush() {
+    return fflush(file) == 0;
+}
+
+bool FdSink::write(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// ========== Источники ==========
+
+// Для обычных файлов остаток известен заранее: читатель сможет отбросить
+// испорченные счетчики, не выделяя под них память
+static size_t remainingInFile(int fd, off_t position) {
+    struct stat info;
+    if (fd < 0 || position < 0 || ::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size < position) {
+        return ByteSource::UNKNOWN_SIZE;
+    }
+    return static_cast<size_t>(info.st_size - position);
+}
+
+FileSource::FileSource(FILE* source) : file(source), block(SOURCE_BLOCK_SIZE, '\0') {
+    left = remainingInFile(fileno(file), ftello(file));
+}
+
+string_view FileSource::next() {
+    size_t got = fread(&block[0], 1, block.size(), file);
+    if (left != UNKNOWN_SIZE) {
+        left = got < left ? left - got : 0;
+    }
+    return string_view(block.data(), got);
+}
+
+FdSource::FdSource(int source) : fd(source), block(SOURCE_BLOCK_SIZE, '\0') {
+    left = remainingInFile(fd, ::lseek(fd, 0, SEEK_CUR));
+}
+
+string_view FdSource::next() {
+    while (true) {
+        ssize_t got = ::read(fd, &block[0], block.size());
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            left = 0;
+            return string_view();
+        }
+        size_t size = static_cast<size_t>(got);
+        if (left != UNKNOWN_SIZE) {
+            left = size < left ? left - size : 0;
+        }
+        return string_view(block.data(), size);
+    }
+}
+
+// ========== ByteWriter ==========
+
+bool ByteWriter::drain() {
+    if (used > 0) {
+        valid = sink.write(staging, used) && valid;
+        used = 0;
+    }
+    return valid;
+}
+
+void ByteWriter::writeBytes(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    total += size;
+
+    if (size <= STAGING_SIZE - used) {
+        memcpy(staging + used, bytes, size);
+        used += size;
+        return;
+    }
+
+    // Крупные блоки передаются приемнику напрямую, минуя промежуточный буфер
+    drain();
+    if (size >= STAGING_SIZE) {
+        valid = sink.write(bytes, size) && valid;
+    } else {
+        memcpy(staging, bytes, size);
+        used = size;
+    }
+}
+
+void ByteWriter::writeU8(uint8_t value) {
+    if (used == STAGING_SIZE) {
+        drain();
+    }
+    staging[used++] = static_cast<char>(value);
+    total++;
+}
+
+void ByteWriter::writeU32(uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    writeBytes(bytes, sizeof(bytes));
+}
+
+void ByteWriter::writeU64(uint64_t value) {
+    char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    writeBytes(bytes, sizeof(bytes));
+}
+
+void ByteWriter::writeString(string_view value) {
+    writeU32(static_cast<uint32_t>(value.size()));
+    writeBytes(value.data(), value.size());
+}
+
+bool ByteWriter::flush() {
+    drain();
+    valid = sink.flush() && valid;
+    return valid;
+}
+
+// ========== ByteReader ==========
+
+bool ByteReader::take(size_t size, const char*& start) {
+    if (!valid) {
+        return false;
+    }
+    if (block.size() - pos >= size) {
+        start = block.data() + pos;
+        pos += size;
+        consumed += size;
+        return true;
+    }
+
+    // Данные разбиты между блоками источника: собираем их во временный буфер
+    scratch.assign(block.data() + pos, block.size() - pos);
+    pos = block.size();
+    while (scratch.size() < size) {
+        if (source == nullptr) {
+            valid = false;
+            return false;
+        }
+        block = source->next();
+        pos = 0;
+        if (block.empty()) {
+            valid = false;
+            return false;
+        }
+        size_t needed = min(size - scratch.size(), block.size());
+        scratch.append(block.data(), needed);
+        pos = needed;
+    }
+
+    start = scratch.data();
+    consumed += size;
+    return true;
+}
+
+size_t ByteReader::remaining() const {
+    size_t buffered = block.size() - pos;
+    if (source == nullptr) {
+        return buffered;
+    }
+    size_t rest = source->remaining();
+    return rest == ByteSource::UNKNOWN_SIZE ? rest : buffered + rest;
+}
+
+bool ByteReader::readU8(uint8_t& value) {
+    const char* bytes;
+    if (!take(1, bytes)) {
+        return false;
+    }
+    value = static_cast<uint8_t>(bytes[0]);
+    return true;
+}
+
+bool ByteReader::readU32(uint32_t& value) {
+    const char* bytes;
+    if (!take(4, bytes)) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+    }
+    return true;
+}
+
+bool ByteReader::readU64(uint64_t& value) {
+    const char* bytes;
+    if (!take(8, bytes)) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+    }
+    return true;
+}
+
+bool ByteReader::readI32(int32_t& value) {
+    uint32_t raw;
+    if (!readU32(raw)) {
+        return false;
+    }
+    value = static_cast<int32_t>(raw);
+    return true;
+}
+
+bool ByteReader::readStringView(string_view& value) {
+    uint32_t length;
+    const char* bytes;
+    if (!readU32(length) || !take(length, bytes)) {
+        return false;
+    }
+    value = string_view(bytes, length);
+    return true;
+}
+
+bool ByteReader::readString(string& value) {
+    string_view view;
+    if (!readStringView(view)) {
+        return false;
+    }
+    value.assign(view.data(), view.size());
+    return true;
+}
+
+bool ByteReader::skip(size_t size) {
+    const char* bytes;
+    return take(size, bytes);
+}
+
+bool ByteReader::readBulkHeader(uint32_t& count, uint64_t& bytes, size_t element_overhead) {
+    if (!readU32(count) || !readU64(bytes)) {
+        return false;
+    }
+    size_t left = remaining();
+    if (left == ByteSource::UNKNOWN_SIZE) {
+        return true;
+    }
+    if (bytes > left || static_cast<uint64_t>(count) * element_overhead > left - bytes) {
+        valid = false;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,235 @@
+#ifndef BYTESTREAM_H
+#define BYTESTREAM_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+// ========== Приемники байтов ==========
+
+class ByteSink {
+public:
+    virtual ~ByteSink() = default;
+    virtual bool write(const char* data, size_t size) = 0;
+    virtual bool flush() { return true; }
+};
+
+// Дописывает в растущий буфер
+class BufferSink : public ByteSink {
+private:
+    string& buffer;
+
+public:
+    explicit BufferSink(string& target) : buffer(target) {}
+    bool write(const char* data, size_t size) override {
+        buffer.append(data, size);
+        return true;
+    }
+};
+
+// Пишет в открытый FILE*; файл не закрывает
+class FileSink : public ByteSink {
+private:
+    FILE* file;
+
+public:
+    explicit FileSink(FILE* target) : file(target) {}
+    bool write(const char* data, size_t size) override;
+    bool flush() override;
+};
+
+// Пишет в файловый дескриптор (файл, сокет, канал); дескриптор не закрывает
+class FdSink : public ByteSink {
+private:
+    int fd;
+
+public:
+    explicit FdSink(int target) : fd(target) {}
+    bool write(const char* data, size_t size) override;
+};
+
+// ========== Источники байтов ==========
+
+class ByteSource {
+public:
+    static constexpr size_t UNKNOWN_SIZE = SIZE_MAX;
+
+    virtual ~ByteSource() = default;
+    // Следующий непрерывный блок данных; пустой блок означает конец
+    virtual string_view next() = 0;
+    // Сколько байт еще не выдано через next() (если известно)
+    virtual size_t remaining() const { return UNKNOWN_SIZE; }
+};
+
+// Участок памяти (буфер, отображенный файл): отдается целиком без копирования
+class SpanSource : public ByteSource {
+private:
+    string_view data;
+
+public:
+    SpanSource(const char* bytes, size_t size) : data(bytes, size) {}
+    explicit SpanSource(string_view bytes) : data(bytes) {}
+    string_view next() override {
+        string_view block = data;
+        data = string_view();
+        return block;
+    }
+    size_t remaining() const override { return data.size(); }
+};
+
+// Читает из открытого FILE* блоками; файл не закрывает
+class FileSource : public ByteSource {
+private:
+    FILE* file;
+    string block;
+    size_t left;
+
+public:
+    explicit FileSource(FILE* source);
+    string_view next() override;
+    size_t remaining() const override { return left; }
+};
+
+// Читает из файлового дескриптора блоками; размер известен только для файлов
+class FdSource : public ByteSource {
+private:
+    int fd;
+    string block;
+    size_t left;
+
+public:
+    explicit FdSource(int source);
+    string_view next() override;
+    size_t remaining() const override { return left; }
+};
+
+// ========== Кодирование ==========
+
+// Запись двоичных данных в приемник. Числа хранятся в little-endian, строки —
+// как длина (4 байта) и байты без завершающего нуля. Мелкие записи копятся в
+// промежуточном буфере, поэтому приемник вызывается крупными блоками.
+class ByteWriter {
+private:
+    static constexpr size_t STAGING_SIZE = 4096;
+
+    ByteSink& sink;
+    char staging[STAGING_SIZE];
+    size_t used;
+    uint64_t total;
+    bool valid;
+
+    bool drain();
+
+public:
+    explicit ByteWriter(ByteSink& target) : sink(target), used(0), total(0), valid(true) {}
+    ~ByteWriter() { flush(); }
+
+    ByteWriter(const ByteWriter&) = delete;
+    ByteWriter& operator=(const ByteWriter&) = delete;
+
+    void writeBytes(const void* data, size_t size);
+    void writeU8(uint8_t value);
+    void writeU32(uint32_t value);
+    void writeU64(uint64_t value);
+    void writeI32(int32_t value) { writeU32(static_cast<uint32_t>(value)); }
+    void writeString(string_view value);
+
+    // Заголовок набора элементов: их число и суммарная длина строк, чтобы
+    // читатель мог заранее выделить память
+    void writeBulkHeader(uint32_t count, uint64_t bytes) {
+        writeU32(count);
+        writeU64(bytes);
+    }
+
+    // Передает накопленное в приемник и сбрасывает его
+    bool flush();
+    bool ok() const { return valid; }
+    uint64_t size() const { return total; }
+};
+
+// Чтение из источника. Из непрерывной памяти данные берутся без копирования;
+// строка, пересекающая границу блоков, собирается во внутреннем буфере.
+// readStringView возвращает ссылку, действительную до следующего чтения
+// (для SpanSource — пока жив исходный буфер). При нехватке данных чтение
+// перестает выполняться, а ok() возвращает false.
+class ByteReader {
+private:
+    ByteSource* source;
+    string_view block;
+    size_t pos;
+    uint64_t consumed;
+    string scratch;
+    bool valid;
+
+    bool take(size_t size, const char*& start);
+
+public:
+    explicit ByteReader(ByteSource& input)
+        : source(&input), block(), pos(0), consumed(0), valid(true) {}
+    ByteReader(const char* data, size_t size)
+        : source(nullptr), block(data, size), pos(0), consumed(0), valid(true) {}
+    explicit ByteReader(string_view data) : ByteReader(data.data(), data.size()) {}
+
+    bool readU8(uint8_t& value);
+    bool readU32(uint32_t& value);
+    bool readU64(uint64_t& value);
+    bool readI32(int32_t& value);
+    bool readString(string& value);
+    bool readStringView(string_view& value);
+    bool skip(size_t size);
+
+    // Читает заголовок набора и проверяет, что данные могут в нем поместиться:
+    // каждый элемент занимает не меньше element_overhead байт сверх строк
+    bool readBulkHeader(uint32_t& count, uint64_t& bytes, size_t element_overhead);
+
+    bool ok() const { return valid; }
+    uint64_t offset() const { return consumed; }
+    // Оставшийся объем или ByteSource::UNKNOWN_SIZE
+    size_t remaining() const;
+};
+
+// Сколько элементов резервировать по заголовку набора. Если размер источника
+// неизвестен, испорченный счетчик не должен приводить к огромному выделению.
+constexpr uint32_t MAX_BULK_RESERVE = 1u << 20;
+
+inline int bulkReserve(uint32_t count) {
+    return static_cast<int>(min(count, MAX_BULK_RESERVE));
+}
+
+// Сохранение и загрузка объекта с методами serialize_binary(ByteWriter&) и
+// deserialize_binary(ByteReader&) в отдельный файл
+template <typename T>
+bool writeBinaryFile(const string& filename, const T& object) {
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    FileSink sink(file);
+    bool ok;
+    {
+        ByteWriter out(sink);
+        object.serialize_binary(out);
+        ok = out.flush();
+    }
+    return fclose(file) == 0 && ok;
+}
+
+template <typename T>
+bool readBinaryFile(const string& filename, T& object) {
+    FILE* file = fopen(filename.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    FileSource source(file);
+    ByteReader in(source);
+    bool ok = object.deserialize_binary(in);
+    fclose(file);
+    return ok;
+}
+
+#endif
@@ -0,0 +1,28 @@
+#include "Checksum.h"
+
+#include <array>
+
+using namespace std;
+
+static array<uint32_t, 256> makeCrcTable() {
+    array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t value = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+        }
+        table[i] = value;
+    }
+    return table;
+}
+
+uint32_t crc32(const void* data, size_t size, uint32_t crc) {
+    static const array<uint32_t, 256> table = makeCrcTable();
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
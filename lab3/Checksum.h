@@ -0,0 +1,10 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (IEEE 802.3). Можно считать по частям, передавая предыдущее значение.
+uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+#endif
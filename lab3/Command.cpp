@@ -0,0 +1,51 @@
+#include "Command.h"
+
+#include <charconv>
+
+using namespace std;
+
+static bool isCommandSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+size_t CommandTokens::tokenize(string_view command) {
+    count = 0;
+    size_t pos = 0;
+    const size_t length = command.size();
+
+    while (pos < length) {
+        while (pos < length && isCommandSpace(command[pos])) {
+            ++pos;
+        }
+        if (pos == length) {
+            break;
+        }
+
+        size_t start = pos;
+        while (pos < length && !isCommandSpace(command[pos])) {
+            ++pos;
+        }
+
+        if (count < MAX_TOKENS) {
+            tokens[count] = command.substr(start, pos - start);
+        }
+        ++count;
+    }
+
+    return count;
+}
+
+bool parseInt(string_view token, int& value) {
+    if (!token.empty() && token[0] == '+') {
+        token.remove_prefix(1);
+        if (!token.empty() && token[0] == '-') {
+            return false;
+        }
+    }
+    if (token.empty()) {
+        return false;
+    }
+
+    auto result = from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == errc();
+}
@@ -0,0 +1,300 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+using namespace std;
+
+// Коды команд базы данных
+enum class Opcode : uint8_t {
+    UNKNOWN = 0,
+
+    PRINT,
+    LIST,
+    SAVE,
+    BGSAVE,
+    LOAD,
+    CLEAR,
+    HELP,
+    STATS,
+    INFO,
+    SLOWLOG,
+    MEMORY,
+    TYPE,
+    EXISTS,
+    DEL,
+    RENAME,
+
+    MCREATE,
+    MPUSH,
+    MINSERT,
+    MGET,
+    MDEL,
+    MREPLACE,
+    MSIZE,
+    MFIND,
+    MCOUNT,
+    MFILTER,
+    MSORT,
+    MSORTED,
+
+    FCREATE,
+    FPUSH,
+    FDEL,
+    FGET,
+    FSIZE,
+    FPRINT_BACKWARD,
+    FINDEX,
+
+    LCREATE,
+    LPUSH,
+    LDEL,
+    LGET,
+    LSIZE,
+    LPRINT_BACKWARD,
+    LINDEX,
+
+    SCREATE,
+    SPUSH,
+    SPOP,
+    SPEEK,
+    SSIZE,
+
+    QCREATE,
+    QPUSH,
+    QPOP,
+    QPEEK,
+    QSIZE,
+
+    TCREATE,
+    TINSERT,
+    TSEARCH,
+    TISFULL,
+    THEIGHT,
+    TSIZE,
+    TTRAVERSE,
+
+    HCREATE,
+    HINSERT,
+    HSEARCH,
+    HDELETE,
+    HPRINT,
+    HSIZE,
+
+    COUNT
+};
+
+constexpr size_t OPCODE_COUNT = static_cast<size_t>(Opcode::COUNT);
+
+// Семейство команды: к какому типу контейнера она относится
+enum class CommandFamily : uint8_t {
+    GENERAL,
+    ARRAY,
+    SINGLY_LIST,
+    DOUBLY_LIST,
+    STACK,
+    QUEUE,
+    TREE,
+    HASH_TABLE
+};
+
+struct CommandSpec {
+    string_view name;
+    Opcode opcode;
+    CommandFamily family;
+    bool mutates;  // команда меняет данные и попадает в журнал
+};
+
+// Таблица всех известных команд (имена в верхнем регистре)
+inline constexpr CommandSpec COMMAND_SPECS[] = {
+    {"PRINT", Opcode::PRINT, CommandFamily::GENERAL, false},
+    {"LIST", Opcode::LIST, CommandFamily::GENERAL, false},
+    {"SAVE", Opcode::SAVE, CommandFamily::GENERAL, false},
+    {"BGSAVE", Opcode::BGSAVE, CommandFamily::GENERAL, false},
+    {"LOAD", Opcode::LOAD, CommandFamily::GENERAL, true},  // с открытым журналом отклоняется
+    {"CLEAR", Opcode::CLEAR, CommandFamily::GENERAL, true},
+    {"HELP", Opcode::HELP, CommandFamily::GENERAL, false},
+    {"STATS", Opcode::STATS, CommandFamily::GENERAL, false},
+    {"INFO", Opcode::INFO, CommandFamily::GENERAL, false},
+    {"SLOWLOG", Opcode::SLOWLOG, CommandFamily::GENERAL, false},
+    {"MEMORY", Opcode::MEMORY, CommandFamily::GENERAL, false},
+    {"TYPE", Opcode::TYPE, CommandFamily::GENERAL, false},
+    {"EXISTS", Opcode::EXISTS, CommandFamily::GENERAL, false},
+    {"DEL", Opcode::DEL, CommandFamily::GENERAL, true},
+    {"RENAME", Opcode::RENAME, CommandFamily::GENERAL, true},
+
+    {"MCREATE", Opcode::MCREATE, CommandFamily::ARRAY, true},
+    {"MPUSH", Opcode::MPUSH, CommandFamily::ARRAY, true},
+    {"MINSERT", Opcode::MINSERT, CommandFamily::ARRAY, true},
+    {"MGET", Opcode::MGET, CommandFamily::ARRAY, false},
+    {"MDEL", Opcode::MDEL, CommandFamily::ARRAY, true},
+    {"MREPLACE", Opcode::MREPLACE, CommandFamily::ARRAY, true},
+    {"MSIZE", Opcode::MSIZE, CommandFamily::ARRAY, false},
+    {"MFIND", Opcode::MFIND, CommandFamily::ARRAY, false},
+    {"MCOUNT", Opcode::MCOUNT, CommandFamily::ARRAY, false},
+    {"MFILTER", Opcode::MFILTER, CommandFamily::ARRAY, false},
+    {"MSORT", Opcode::MSORT, CommandFamily::ARRAY, true},
+    {"MSORTED", Opcode::MSORTED, CommandFamily::ARRAY, false},
+
+    {"FCREATE", Opcode::FCREATE, CommandFamily::SINGLY_LIST, true},
+    {"FPUSH", Opcode::FPUSH, CommandFamily::SINGLY_LIST, true},
+    {"FDEL", Opcode::FDEL, CommandFamily::SINGLY_LIST, true},
+    {"FGET", Opcode::FGET, CommandFamily::SINGLY_LIST, false},
+    {"FSIZE", Opcode::FSIZE, CommandFamily::SINGLY_LIST, false},
+    {"FPRINT_BACKWARD", Opcode::FPRINT_BACKWARD, CommandFamily::SINGLY_LIST, false},
+    {"FINDEX", Opcode::FINDEX, CommandFamily::SINGLY_LIST, true},
+
+    {"LCREATE", Opcode::LCREATE, CommandFamily::DOUBLY_LIST, true},
+    {"LPUSH", Opcode::LPUSH, CommandFamily::DOUBLY_LIST, true},
+    {"LDEL", Opcode::LDEL, CommandFamily::DOUBLY_LIST, true},
+    {"LGET", Opcode::LGET, CommandFamily::DOUBLY_LIST, false},
+    {"LSIZE", Opcode::LSIZE, CommandFamily::DOUBLY_LIST, false},
+    {"LPRINT_BACKWARD", Opcode::LPRINT_BACKWARD, CommandFamily::DOUBLY_LIST, false},
+    {"LINDEX", Opcode::LINDEX, CommandFamily::DOUBLY_LIST, true},
+
+    {"SCREATE", Opcode::SCREATE, CommandFamily::STACK, true},
+    {"SPUSH", Opcode::SPUSH, CommandFamily::STACK, true},
+    {"SPOP", Opcode::SPOP, CommandFamily::STACK, true},
+    {"SPEEK", Opcode::SPEEK, CommandFamily::STACK, false},
+    {"SSIZE", Opcode::SSIZE, CommandFamily::STACK, false},
+
+    {"QCREATE", Opcode::QCREATE, CommandFamily::QUEUE, true},
+    {"QPUSH", Opcode::QPUSH, CommandFamily::QUEUE, true},
+    {"QPOP", Opcode::QPOP, CommandFamily::QUEUE, true},
+    {"QPEEK", Opcode::QPEEK, CommandFamily::QUEUE, false},
+    {"QSIZE", Opcode::QSIZE, CommandFamily::QUEUE, false},
+
+    {"TCREATE", Opcode::TCREATE, CommandFamily::TREE, true},
+    {"TINSERT", Opcode::TINSERT, CommandFamily::TREE, true},
+    {"TSEARCH", Opcode::TSEARCH, CommandFamily::TREE, false},
+    {"TISFULL", Opcode::TISFULL, CommandFamily::TREE, false},
+    {"THEIGHT", Opcode::THEIGHT, CommandFamily::TREE, false},
+    {"TSIZE", Opcode::TSIZE, CommandFamily::TREE, false},
+    {"TTRAVERSE", Opcode::TTRAVERSE, CommandFamily::TREE, false},
+
+    {"HCREATE", Opcode::HCREATE, CommandFamily::HASH_TABLE, true},
+    {"HINSERT", Opcode::HINSERT, CommandFamily::HASH_TABLE, true},
+    {"HSEARCH", Opcode::HSEARCH, CommandFamily::HASH_TABLE, false},
+    {"HDELETE", Opcode::HDELETE, CommandFamily::HASH_TABLE, true},
+    {"HPRINT", Opcode::HPRINT, CommandFamily::HASH_TABLE, false},
+    {"HSIZE", Opcode::HSIZE, CommandFamily::HASH_TABLE, false},
+};
+
+constexpr size_t COMMAND_SPEC_COUNT = sizeof(COMMAND_SPECS) / sizeof(COMMAND_SPECS[0]);
+
+// ========== Идеальный хэш имён команд (строится на этапе компиляции) ==========
+
+constexpr size_t OPCODE_TABLE_SIZE = 1024;
+constexpr uint16_t OPCODE_TABLE_EMPTY = 0xFFFF;
+
+constexpr char foldCommandChar(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// FNV-1a без учета регистра с подбираемым зерном
+constexpr uint32_t hashCommandName(string_view name, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (char c : name) {
+        h ^= static_cast<uint8_t>(foldCommandChar(c));
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+constexpr bool hasCollisions(uint32_t seed) {
+    array<bool, OPCODE_TABLE_SIZE> used{};
+    for (size_t i = 0; i < COMMAND_SPEC_COUNT; ++i) {
+        size_t slot = hashCommandName(COMMAND_SPECS[i].name, seed) % OPCODE_TABLE_SIZE;
+        if (used[slot]) {
+            return true;
+        }
+        used[slot] = true;
+    }
+    return false;
+}
+
+constexpr uint32_t findPerfectSeed() {
+    for (uint32_t seed = 0; seed < 100000; ++seed) {
+        if (!hasCollisions(seed)) {
+            return seed;
+        }
+    }
+    return 0xFFFFFFFFu;
+}
+
+constexpr uint32_t COMMAND_HASH_SEED = findPerfectSeed();
+static_assert(COMMAND_HASH_SEED != 0xFFFFFFFFu, "Не удалось подобрать идеальный хэш для команд");
+
+constexpr array<uint16_t, OPCODE_TABLE_SIZE> buildOpcodeTable() {
+    array<uint16_t, OPCODE_TABLE_SIZE> table{};
+    for (auto& slot : table) {
+        slot = OPCODE_TABLE_EMPTY;
+    }
+    for (size_t i = 0; i < COMMAND_SPEC_COUNT; ++i) {
+        table[hashCommandName(COMMAND_SPECS[i].name, COMMAND_HASH_SEED) % OPCODE_TABLE_SIZE] =
+            static_cast<uint16_t>(i);
+    }
+    return table;
+}
+
+inline constexpr array<uint16_t, OPCODE_TABLE_SIZE> OPCODE_TABLE = buildOpcodeTable();
+
+// Имена команд и ключевых слов сравниваются без учета регистра
+constexpr bool matchesCommandName(string_view token, string_view name) {
+    if (token.size() != name.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < name.size(); ++i) {
+        if (foldCommandChar(token[i]) != name[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Поиск описания команды: одно вычисление хэша и одно сравнение
+constexpr const CommandSpec* findCommand(string_view token) {
+    if (token.empty()) {
+        return nullptr;
+    }
+    uint16_t index = OPCODE_TABLE[hashCommandName(token, COMMAND_HASH_SEED) % OPCODE_TABLE_SIZE];
+    if (index == OPCODE_TABLE_EMPTY || !matchesCommandName(token, COMMAND_SPECS[index].name)) {
+        return nullptr;
+    }
+    return &COMMAND_SPECS[index];
+}
+
+// Ключевые слова внутри команды (FRONT, BACK, INORDER...)
+constexpr bool isKeyword(string_view token, string_view keyword) {
+    return matchesCommandName(token, keyword);
+}
+
+// ========== Токенизатор без выделения памяти ==========
+
+class CommandTokens {
+public:
+    static constexpr size_t MAX_TOKENS = 8;
+
+    // Разбивает команду по пробельным символам. Токены ссылаются на исходную
+    // строку, поэтому она должна жить, пока используются токены.
+    size_t tokenize(string_view command);
+
+    // Общее число токенов (может превышать MAX_TOKENS, лишние не сохраняются)
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    string_view operator[](size_t index) const {
+        return index < MAX_TOKENS && index < count ? tokens[index] : string_view();
+    }
+
+private:
+    array<string_view, MAX_TOKENS> tokens{};
+    size_t count = 0;
+};
+
+// Разбор целого числа без выделения памяти (аналог stoi)
+bool parseInt(string_view token, int& value);
+
+#endif
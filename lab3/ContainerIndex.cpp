@@ -0,0 +1,290 @@
+#include "ContainerIndex.h"
+
+#include <functional>
+
+using namespace std;
+
+const char* containerTypeName(ContainerType type) {
+    switch (type) {
+        case ContainerType::ARRAY:
+            return "array";
+        case ContainerType::SINGLY_LIST:
+            return "singly list";
+        case ContainerType::DOUBLY_LIST:
+            return "doubly list";
+        case ContainerType::STACK:
+            return "stack";
+        case ContainerType::QUEUE:
+            return "queue";
+        case ContainerType::TREE:
+            return "tree";
+        case ContainerType::HASH_TABLE:
+            return "double hash table";
+        case ContainerType::NONE:
+            break;
+    }
+    return "none";
+}
+
+// ========== ContainerHandle ==========
+
+void ContainerHandle::destroy() {
+    switch (tag) {
+        case ContainerType::ARRAY:
+            delete static_cast<Array*>(ptr);
+            break;
+        case ContainerType::SINGLY_LIST:
+            delete static_cast<SingleList*>(ptr);
+            break;
+        case ContainerType::DOUBLY_LIST:
+            delete static_cast<DoubleList*>(ptr);
+            break;
+        case ContainerType::STACK:
+            delete static_cast<Stack*>(ptr);
+            break;
+        case ContainerType::QUEUE:
+            delete static_cast<Queue*>(ptr);
+            break;
+        case ContainerType::TREE:
+            delete static_cast<FullBinaryTree*>(ptr);
+            break;
+        case ContainerType::HASH_TABLE:
+            delete static_cast<DoubleHashTable*>(ptr);
+            break;
+        case ContainerType::NONE:
+            break;
+    }
+    tag = ContainerType::NONE;
+    ptr = nullptr;
+}
+
+// ========== ContainerIndex ==========
+
+static constexpr size_t INITIAL_SLOTS = 16;
+
+static size_t hashName(string_view name) {
+    return hash<string_view>()(name);
+}
+
+ContainerIndex::ContainerIndex() : slots(INITIAL_SLOTS), count(0) {}
+
+// Перемещенный индекс остается пустым; таблица слотов создается заново при вставке
+ContainerIndex::ContainerIndex(ContainerIndex&& other) noexcept
+    : slots(move(other.slots)), count(other.count) {
+    other.slots.clear();
+    other.count = 0;
+}
+
+ContainerIndex& ContainerIndex::operator=(ContainerIndex&& other) noexcept {
+    if (this != &other) {
+        slots = move(other.slots);
+        count = other.count;
+        other.slots.clear();
+        other.count = 0;
+    }
+    return *this;
+}
+
+size_t ContainerIndex::findSlot(string_view name, size_t hash) const {
+    const size_t mask = slots.size() - 1;
+    size_t slot = hash & mask;
+
+    while (!slots[slot].handle.empty()) {
+        if (slots[slot].hash == hash && slots[slot].name == name) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void ContainerIndex::grow() {
+    vector<Entry> old_slots(slots.size() * 2);
+    old_slots.swap(slots);
+
+    const size_t mask = slots.size() - 1;
+    for (Entry& entry : old_slots) {
+        if (entry.handle.empty()) {
+            continue;
+        }
+        size_t slot = entry.hash & mask;
+        while (!slots[slot].handle.empty()) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = move(entry);
+    }
+}
+
+ContainerHandle* ContainerIndex::find(string_view name) {
+    if (count == 0) {
+        return nullptr;
+    }
+    Entry& entry = slots[findSlot(name, hashName(name))];
+    return entry.handle.empty() ? nullptr : &entry.handle;
+}
+
+const ContainerHandle* ContainerIndex::find(string_view name) const {
+    if (count == 0) {
+        return nullptr;
+    }
+    const Entry& entry = slots[findSlot(name, hashName(name))];
+    return entry.handle.empty() ? nullptr : &entry.handle;
+}
+
+ContainerIndex::Entry* ContainerIndex::findEntry(string_view name) {
+    if (count == 0) {
+        return nullptr;
+    }
+    Entry& entry = slots[findSlot(name, hashName(name))];
+    return entry.handle.empty() ? nullptr : &entry;
+}
+
+void ContainerIndex::markDirty(string_view name) {
+    Entry* entry = findEntry(name);
+    if (entry != nullptr) {
+        entry->dirty = true;
+    }
+}
+
+bool ContainerIndex::insert(string_view name, ContainerHandle handle) {
+    if (handle.empty()) {
+        return false;
+    }
+    if (slots.empty()) {
+        slots.resize(INITIAL_SLOTS);
+    }
+
+    size_t hash = hashName(name);
+    size_t slot = findSlot(name, hash);
+    if (!slots[slot].handle.empty()) {
+        return false;
+    }
+
+    // Коэффициент заполнения не превышает 3/4
+    if ((count + 1) * 4 > slots.size() * 3) {
+        grow();
+        slot = findSlot(name, hash);
+    }
+
+    slots[slot].hash = hash;
+    slots[slot].name.assign(name);
+    slots[slot].handle = move(handle);
+    slots[slot].dirty = true;
+    slots[slot].saved = SectionLocation();
+    if (slots[slot].lock == nullptr) {
+        slots[slot].lock = make_unique<shared_mutex>();
+    }
+    count++;
+    return true;
+}
+
+void ContainerIndex::assign(string_view name, ContainerHandle handle) {
+    Entry* existing = findEntry(name);
+    if (existing != nullptr) {
+        if (handle.empty()) {
+            erase(name);
+        } else {
+            existing->handle = move(handle);
+            existing->dirty = true;
+        }
+        return;
+    }
+    insert(name, move(handle));
+}
+
+void ContainerIndex::closeHole(size_t hole) {
+    const size_t mask = slots.size() - 1;
+    size_t next = hole;
+
+    // Сдвигаем назад элементы цепочки, которые иначе оказались бы за дыркой
+    while (true) {
+        next = (next + 1) & mask;
+        if (slots[next].handle.empty()) {
+            break;
+        }
+        size_t home = slots[next].hash & mask;
+        bool stays = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (stays) {
+            continue;
+        }
+        slots[hole] = move(slots[next]);
+        hole = next;
+    }
+}
+
+bool ContainerIndex::erase(string_view name) {
+    if (count == 0) {
+        return false;
+    }
+    size_t slot = findSlot(name, hashName(name));
+    if (slots[slot].handle.empty()) {
+        return false;
+    }
+
+    slots[slot].handle = ContainerHandle();
+    count--;
+    closeHole(slot);
+    return true;
+}
+
+ContainerHandle ContainerIndex::take(string_view name) {
+    if (count == 0) {
+        return ContainerHandle();
+    }
+    size_t slot = findSlot(name, hashName(name));
+    ContainerHandle handle = move(slots[slot].handle);
+    if (!handle.empty()) {
+        count--;
+        closeHole(slot);
+    }
+    return handle;
+}
+
+bool ContainerIndex::rename(string_view from, string_view to) {
+    if (count == 0 || find(to) != nullptr) {
+        return false;
+    }
+    size_t slot = findSlot(from, hashName(from));
+    if (slots[slot].handle.empty()) {
+        return false;
+    }
+
+    // Содержимое не меняется, поэтому сохраненная секция остается действительной
+    ContainerHandle handle = move(slots[slot].handle);
+    bool dirty = slots[slot].dirty;
+    SectionLocation saved = slots[slot].saved;
+    count--;
+    closeHole(slot);
+    insert(to, move(handle));
+
+    Entry* renamed = findEntry(to);
+    renamed->dirty = dirty;
+    renamed->saved = saved;
+    return true;
+}
+
+MemoryUsage ContainerIndex::memoryUsage() const {
+    MemoryUsage usage;
+    usage.bytes = sizeof(ContainerIndex);
+    if (slots.capacity() > 0) {
+        usage.addBlock(slots.capacity() * sizeof(Entry));
+    }
+    for (const Entry& entry : slots) {
+        usage.addStringBuffer(entry.name);
+        if (!entry.handle.empty()) {
+            usage.payload += entry.name.size();
+        }
+        if (entry.lock != nullptr) {
+            usage.addBlock(sizeof(shared_mutex));
+        }
+    }
+    return usage;
+}
+
+void ContainerIndex::clear() {
+    for (Entry& entry : slots) {
+        entry.handle = ContainerHandle();
+        entry.name.clear();
+    }
+    count = 0;
+}
@@ -0,0 +1,213 @@
+#ifndef CONTAINERINDEX_H
+#define CONTAINERINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Array.h"
+#include "SingleList.h"
+#include "DoubleList.h"
+#include "Stack.h"
+#include "Queue.h"
+#include "FullBinaryTree.h"
+#include "HashTable.h"
+
+using namespace std;
+
+// Тип контейнера, на который указывает имя в базе данных
+enum class ContainerType : uint8_t {
+    NONE = 0,
+    ARRAY,
+    SINGLY_LIST,
+    DOUBLY_LIST,
+    STACK,
+    QUEUE,
+    TREE,
+    HASH_TABLE
+};
+
+template <typename T>
+struct ContainerTraits;
+
+template <>
+struct ContainerTraits<Array> {
+    static constexpr ContainerType type = ContainerType::ARRAY;
+};
+template <>
+struct ContainerTraits<SingleList> {
+    static constexpr ContainerType type = ContainerType::SINGLY_LIST;
+};
+template <>
+struct ContainerTraits<DoubleList> {
+    static constexpr ContainerType type = ContainerType::DOUBLY_LIST;
+};
+template <>
+struct ContainerTraits<Stack> {
+    static constexpr ContainerType type = ContainerType::STACK;
+};
+template <>
+struct ContainerTraits<Queue> {
+    static constexpr ContainerType type = ContainerType::QUEUE;
+};
+template <>
+struct ContainerTraits<FullBinaryTree> {
+    static constexpr ContainerType type = ContainerType::TREE;
+};
+template <>
+struct ContainerTraits<DoubleHashTable> {
+    static constexpr ContainerType type = ContainerType::HASH_TABLE;
+};
+
+// Имя типа для сообщений (array, singly list, ...)
+const char* containerTypeName(ContainerType type);
+
+// Владеющий указатель на контейнер любого типа с тегом типа
+class ContainerHandle {
+private:
+    ContainerType tag;
+    void* ptr;
+
+    void destroy();
+
+public:
+    ContainerHandle() : tag(ContainerType::NONE), ptr(nullptr) {}
+
+    template <typename T>
+    explicit ContainerHandle(unique_ptr<T> container)
+        : tag(ContainerTraits<T>::type), ptr(container.release()) {}
+
+    ~ContainerHandle() { destroy(); }
+
+    ContainerHandle(const ContainerHandle&) = delete;
+    ContainerHandle& operator=(const ContainerHandle&) = delete;
+
+    ContainerHandle(ContainerHandle&& other) noexcept : tag(other.tag), ptr(other.ptr) {
+        other.tag = ContainerType::NONE;
+        other.ptr = nullptr;
+    }
+
+    ContainerHandle& operator=(ContainerHandle&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            tag = other.tag;
+            ptr = other.ptr;
+            other.tag = ContainerType::NONE;
+            other.ptr = nullptr;
+        }
+        return *this;
+    }
+
+    ContainerType type() const { return tag; }
+    bool empty() const { return tag == ContainerType::NONE; }
+    void* raw() const { return ptr; }
+
+    // Возвращает nullptr, если контейнер другого типа
+    template <typename T>
+    T* get() const {
+        return tag == ContainerTraits<T>::type ? static_cast<T*>(ptr) : nullptr;
+    }
+};
+
+// Где лежит секция контейнера в последнем сохраненном файле снимка
+struct SectionLocation {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    uint32_t checksum = 0;
+};
+
+// Единое пространство имен контейнеров: открытая адресация с линейным
+// пробированием и удалением сдвигом назад (без надгробий)
+class ContainerIndex {
+public:
+    struct Entry {
+        size_t hash = 0;
+        string name;
+        ContainerHandle handle;
+        // dirty: контейнер менялся после сохранения, и его секцию в снимке
+        // (saved) нужно записать заново
+        bool dirty = true;
+        SectionLocation saved;
+        // Блокировка содержимого контейнера в конкурентном режиме базы
+        unique_ptr<shared_mutex> lock;
+    };
+
+    template <typename EntryType>
+    class basic_iterator {
+    private:
+        EntryType* current;
+        EntryType* end;
+
+        void skipEmpty() {
+            while (current != end && current->handle.empty()) {
+                ++current;
+            }
+        }
+
+    public:
+        basic_iterator(EntryType* begin_slot, EntryType* end_slot) : current(begin_slot), end(end_slot) {
+            skipEmpty();
+        }
+        EntryType& operator*() const { return *current; }
+        EntryType* operator->() const { return current; }
+        basic_iterator& operator++() {
+            ++current;
+            skipEmpty();
+            return *this;
+        }
+        bool operator!=(const basic_iterator& other) const { return current != other.current; }
+        bool operator==(const basic_iterator& other) const { return current == other.current; }
+    };
+
+    using iterator = basic_iterator<Entry>;
+    using const_iterator = basic_iterator<const Entry>;
+
+private:
+    vector<Entry> slots;
+    size_t count;
+
+    size_t findSlot(string_view name, size_t hash) const;
+    void closeHole(size_t hole);
+    void grow();
+
+public:
+    ContainerIndex();
+    ContainerIndex(ContainerIndex&& other) noexcept;
+    ContainerIndex& operator=(ContainerIndex&& other) noexcept;
+
+    ContainerHandle* find(string_view name);
+    const ContainerHandle* find(string_view name) const;
+    Entry* findEntry(string_view name);
+
+    // Отмечает контейнер измененным с момента последнего сохранения
+    void markDirty(string_view name);
+
+    // Добавляет контейнер; если имя уже занято, возвращает false и ничего не меняет
+    bool insert(string_view name, ContainerHandle handle);
+    // Добавляет или заменяет контейнер с этим именем
+    void assign(string_view name, ContainerHandle handle);
+    bool erase(string_view name);
+    // Удаляет имя, не уничтожая контейнер; пустой handle, если имени нет
+    ContainerHandle take(string_view name);
+    // Переименование не трогает сам контейнер; новое имя должно быть свободно
+    bool rename(string_view from, string_view to);
+    void clear();
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    // Память самого индекса: таблица слотов, имена и блокировки (без контейнеров)
+    MemoryUsage memoryUsage() const;
+
+    const_iterator begin() const { return const_iterator(slots.data(), slots.data() + slots.size()); }
+    const_iterator end() const {
+        return const_iterator(slots.data() + slots.size(), slots.data() + slots.size());
+    }
+    iterator begin() { return iterator(slots.data(), slots.data() + slots.size()); }
+    iterator end() { return iterator(slots.data() + slots.size(), slots.data() + slots.size()); }
+};
+
+#endif
@@ -6,1260 +6,2212 @@
 #include "Queue.h"
 #include "FullBinaryTree.h"
 #include "HashTable.h"
+#include "Snapshot.h"
 #include <fstream>
 #include <sstream>
 #include <queue>
 #include <stdexcept>
 #include <memory>
+#include <functional>
+#include <cstdio>
+#include <cerrno>
+
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace std;
 
-// ========== Вспомогательные методы ==========
+Database& Database::operator=(Database&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    // Поля присваиваются по порядку объявления, и journal заменился бы раньше,
+    // чем compaction дождется потока, который еще пишет в старый журнал
+    compaction.join();
+
+    containers = move(other.containers);
+    tokens = move(other.tokens);
+    resolved = move(other.resolved);
+    concurrent = other.concurrent;
+    index_lock = move(other.index_lock);
+    background_save = move(other.background_save);
+    background_save_ok = other.background_save_ok;
+    journal = move(other.journal);
+    journal_base = move(other.journal_base);
+    compaction = move(other.compaction);
+    stats = move(other.stats);
+    stats_enabled = other.stats_enabled;
+    slow_log = move(other.slow_log);
+    snapshot_file = move(other.snapshot_file);
+    snapshot_threads = other.snapshot_threads;
+    query_threads = other.query_threads;
+    return *this;
+}
+
+// ========== Сохранение и загрузка ==========
+
+// Снимок — один двоичный файл с таблицей секций и контрольными суммами (Snapshot.h)
+bool Database::saveToFile(const string& filename) const {
+    return writeSnapshotFile(filename, containers, snapshot_threads);
+}
+
+// Изменения отмечаются в dispatch: флаг dirty у контейнера, к которому
+// обратилась успешная изменяющая команда
+bool Database::saveIncremental(const string& filename) {
+    return updateSnapshotFile(filename, containers, snapshot_file, snapshot_threads);
+}
+
+// ========== Фоновое сохранение ==========
 
-vector<string> Database::splitCommand(const string& command) const {
-    vector<string> tokens;
-    istringstream iss(command);
-    string token;
-    
-    while (iss >> token) {
-        tokens.push_back(token);
+bool Database::ChildProcess::reap(bool block, bool& ok) {
+    ok = true;
+    if (pid < 0) {
+        return true;
     }
-    
-    return tokens;
+    int status = 0;
+    pid_t result;
+    do {
+        result = ::waitpid(pid, &status, block ? 0 : WNOHANG);
+    } while (result < 0 && errno == EINTR);
+    if (result == 0) {
+        return false;
+    }
+    pid = -1;
+    ok = result > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    return true;
 }
 
-bool Database::isArrayCommand(const string& cmd) const {
-    return cmd.size() >= 2 && cmd[0] == 'M' && cmd != "MPRINT";
+bool Database::saveInBackground(const string& filename) {
+    if (backgroundSaveInProgress()) {
+        return false;
+    }
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        return false;
+    }
+    if (pid == 0) {
+        // В дочернем процессе есть только этот поток, поэтому пул не нужен.
+        // _exit не запускает деструкторы и не сбрасывает буферы родителя.
+        bool ok = writeSnapshotFile(filename, containers, 1);
+        ::_exit(ok ? 0 : 1);
+    }
+    background_save.pid = pid;
+    return true;
 }
 
-bool Database::isSinglyListCommand(const string& cmd) const {
-    return cmd.size() >= 2 && cmd[0] == 'F' && cmd != "FPRINT";
+bool Database::backgroundSaveInProgress() {
+    if (background_save.pid < 0) {
+        return false;
+    }
+    bool ok;
+    if (!background_save.reap(false, ok)) {
+        return true;
+    }
+    background_save_ok = ok;
+    return false;
 }
 
-bool Database::isDoublyListCommand(const string& cmd) const {
-    return cmd.size() >= 2 && cmd[0] == 'L' && cmd != "LPRINT";
+bool Database::waitForBackgroundSave() {
+    bool ok;
+    if (background_save.pid >= 0 && background_save.reap(true, ok)) {
+        background_save_ok = ok;
+    }
+    return background_save_ok;
 }
 
-bool Database::isStackCommand(const string& cmd) const {
-    return cmd.size() >= 2 && cmd[0] == 'S' && cmd != "SPRINT";
+// Неудачная загрузка (нет файла, испорченные данные) не меняет базу
+bool Database::loadFromFile(const string& filename) {
+    ContainerIndex loaded;
+    SnapshotFileState loaded_file;
+    if (!readSnapshotFile(filename, loaded, snapshot_threads, &loaded_file)) {
+        return false;
+    }
+    containers = move(loaded);
+    snapshot_file = move(loaded_file);
+    resolved.reset();
+    return true;
 }
 
-bool Database::isQueueCommand(const string& cmd) const {
-    return cmd.size() >= 2 && cmd[0] == 'Q' && cmd != "QPRINT";
+size_t Database::defaultSnapshotThreads() {
+    size_t cores = thread::hardware_concurrency();
+    return cores == 0 ? 1 : cores;
 }
 
-bool Database::isTreeCommand(const string& cmd) const {
-    return cmd.size() >= 2 && cmd[0] == 'T' && cmd != "TPRINT";
+void Database::clear() {
+    containers.clear();
+    resolved.reset();
 }
 
-bool Database::isDoubleHashTableCommand(const string& cmd) const {
-    return (cmd == "HCREATE" || cmd == "hcreate" || 
-            cmd == "HINSERT" || cmd == "hinsert" ||
-            cmd == "HSEARCH" || cmd == "hsearch" ||
-            cmd == "HDELETE" || cmd == "hdelete" ||
-            cmd == "HPRINT" || cmd == "hprint" ||
-            cmd == "HSIZE" || cmd == "hsize");
+ContainerHandle Database::takeContainer(string_view name) {
+    resolved.reset();
+    return containers.take(name);
 }
 
-// ========== Сохранение и загрузка ==========
+bool Database::adoptContainer(string_view name, ContainerHandle& handle) {
+    if (handle.empty() || containers.find(name) != nullptr) {
+        return false;
+    }
+    return containers.insert(name, move(handle));
+}
 
-bool Database::saveToFile(const string& filename) const {
-    ofstream file(filename);
-    if (!file.is_open()) {
+// ========== Журнал ==========
+
+bool Database::openJournal(const string& base_path, FsyncPolicy policy, int interval_ms) {
+    closeJournal();
+    clear();
+
+    JournalManifest manifest;
+    if (!Journal::readManifest(base_path, manifest) && ifstream(Journal::manifestPath(base_path)).is_open()) {
         return false;
     }
-    
-    // Сохраняем массивы
-    for (const auto& pair : arrays) {
-        file << "ARRAY " << pair.first << " ";
-        const Array* arr = pair.second.get();
-        file << arr->length() << " ";
-        for (int i = 0; i < arr->length(); ++i) {
-            file << arr->get(i) << " ";
-        }
-        file << "\n";
-    }
-    
-    // Сохраняем односвязные списки
-    for (const auto& pair : singly_lists) {
-        file << "SINGLY_LIST " << pair.first << " ";
-        const SingleList* list = pair.second.get();
-        
-        // Для списков нужен специальный формат
-        // Сохраним через сериализацию в отдельный файл
-        string list_filename = pair.first + "_slist.txt";
-        list->serialize_text(list_filename);
-        
-        ifstream list_file(list_filename);
-        string content((istreambuf_iterator<char>(list_file)), 
-                       istreambuf_iterator<char>());
-        list_file.close();
-        
-        file << content << "\n";
-        remove(list_filename.c_str());
-    }
-    
-    // Сохраняем двусвязные списки
-    for (const auto& pair : doubly_lists) {
-        file << "DOUBLY_LIST " << pair.first << " ";
-        const DoubleList* list = pair.second.get();
-        
-        string list_filename = pair.first + "_dlist.txt";
-        list->serialize_text(list_filename);
-        
-        ifstream list_file(list_filename);
-        string content((istreambuf_iterator<char>(list_file)), 
-                       istreambuf_iterator<char>());
-        list_file.close();
-        
-        file << content << "\n";
-        remove(list_filename.c_str());
-    }
-    
-    // Сохраняем стеки
-    for (const auto& pair : stacks) {
-        file << "STACK " << pair.first << " ";
-        const Stack* stack = pair.second.get();
-        
-        // Создаем временный стек для сохранения
-        Stack temp_stack = *stack;
-        vector<string> elements;
-        while (!temp_stack.is_empty()) {
-            elements.push_back(temp_stack.pop());
-        }
-        
-        file << elements.size() << " ";
-        for (int i = elements.size() - 1; i >= 0; --i) {
-            file << elements[i] << " ";
-        }
-        file << "\n";
-    }
-    
-    // Сохраняем очереди
-    for (const auto& pair : queues) {
-        file << "QUEUE " << pair.first << " ";
-        const Queue* queue = pair.second.get();
-        
-        // Создаем временную очередь для сохранения
-        Queue temp_queue = *queue;
-        vector<string> elements;
-        while (!temp_queue.is_empty()) {
-            elements.push_back(temp_queue.pop());
-        }
-        
-        file << elements.size() << " ";
-        for (const auto& elem : elements) {
-            file << elem << " ";
-        }
-        file << "\n";
-    }
-    
-    // Сохраняем деревья
-    for (const auto& pair : trees) {
-        file << "TREE " << pair.first << " ";
-        const FullBinaryTree* tree = pair.second.get();
-        
-        string tree_filename = pair.first + "_tree.txt";
-        tree->serialize_text(tree_filename);
-        
-        ifstream tree_file(tree_filename);
-        string content((istreambuf_iterator<char>(tree_file)), 
-                       istreambuf_iterator<char>());
-        tree_file.close();
-        
-        file << content << "\n";
-        remove(tree_filename.c_str());
-    }
-    
-    // Сохраняем двойные хэш-таблицы
-    for (const auto& pair : double_hash_tables) {
-        file << "DOUBLE_HASH_TABLE " << pair.first << " ";
-        const DoubleHashTable* table = pair.second.get();
-        
-        string table_filename = pair.first + "_dhash.bin";
-        table->serialize_binary(table_filename);
-        
-        ifstream table_file(table_filename, ios::binary);
-        string content((istreambuf_iterator<char>(table_file)), 
-                       istreambuf_iterator<char>());
-        table_file.close();
-        
-        // Кодируем бинарные данные в base64 для текстового файла
-        file << table_filename << " " << content.size() << " ";
-        // Здесь можно добавить base64 кодирование, но для простоты сохраним в отдельный файл
-        file << "\n";
-        remove(table_filename.c_str());
-    }
-    
-    file.close();
+    if (!manifest.snapshot.empty() && !loadFromFile(manifest.snapshot)) {
+        return false;
+    }
+
+    // Журнал еще не подключен, поэтому проигранные команды не пишутся повторно
+    string reply;
+    auto apply = [this, &reply](string_view command) {
+        reply.clear();
+        dispatch(command, reply);
+    };
+    for (uint64_t number = manifest.first_segment;; ++number) {
+        string path = Journal::segmentPath(base_path, number);
+        ifstream probe(path);
+        if (!probe.is_open()) {
+            break;
+        }
+        probe.close();
+        Journal::replaySegment(path, apply);
+    }
+
+    auto opened = make_unique<Journal>();
+    if (!opened->open(base_path, policy, interval_ms)) {
+        return false;
+    }
+    journal = move(opened);
+    journal_base = base_path;
     return true;
 }
 
-bool Database::loadFromFile(const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
+void Database::closeJournal() {
+    compaction.join();
+    journal.reset();
+    journal_base.clear();
+}
+
+bool Database::syncJournal() {
+    return journal != nullptr && journal->sync();
+}
+
+// Строит снимок в отдельной базе: живая база не блокируется и не копируется
+static void foldJournal(Journal* journal, string base_path, JournalManifest manifest, uint64_t last_segment) {
+    // Сжатие идет параллельно с обработкой команд и не должно занимать все ядра
+    Database folded;
+    folded.setSnapshotThreads(1);
+    if (!manifest.snapshot.empty() && !folded.loadFromFile(manifest.snapshot)) {
+        journal->abortCompaction();
+        return;
+    }
+
+    auto apply = [&folded](string_view command) { folded.executeCommand(command); };
+    for (uint64_t number = manifest.first_segment; number <= last_segment; ++number) {
+        Journal::replaySegment(Journal::segmentPath(base_path, number), apply);
+    }
+
+    string snapshot = Journal::snapshotPath(base_path, last_segment);
+    if (!folded.saveToFile(snapshot) || !Journal::syncFile(snapshot)) {
+        journal->abortCompaction();
+        return;
+    }
+    journal->finishCompaction(snapshot, last_segment + 1);
+}
+
+bool Database::compactJournal() {
+    if (journal == nullptr || !journal->beginCompaction()) {
         return false;
     }
-    
-    // Очищаем текущие данные
-    clear();
-    
-    string line;
-    while (getline(file, line)) {
-        if (line.empty()) continue;
-        
-        istringstream iss(line);
-        string type, name;
-        
-        if (!(iss >> type >> name)) {
-            continue;
-        }
-        
-        if (type == "ARRAY") {
-            int size;
-            iss >> size;
-            
-            auto array_ptr = make_unique<Array>();
-            for (int i = 0; i < size; ++i) {
-                string value;
-                iss >> value;
-                array_ptr->push_back(value);
-            }
-            arrays[name] = move(array_ptr);
-        }
-        else if (type == "SINGLY_LIST") {
-            int size;
-            iss >> size;
-            
-            auto list_ptr = make_unique<SingleList>();
-            for (int i = 0; i < size; ++i) {
-                string value;
-                iss >> value;
-                list_ptr->push_back(value);
-            }
-            singly_lists[name] = move(list_ptr);
-        }
-        else if (type == "DOUBLY_LIST") {
-            int size;
-            iss >> size;
-            
-            auto list_ptr = make_unique<DoubleList>();
-            for (int i = 0; i < size; ++i) {
-                string value;
-                iss >> value;
-                list_ptr->push_back(value);
-            }
-            doubly_lists[name] = move(list_ptr);
-        }
-        else if (type == "STACK") {
-            int size;
-            iss >> size;
-            
-            auto stack_ptr = make_unique<Stack>();
-            vector<string> elements;
-            for (int i = 0; i < size; ++i) {
-                string value;
-                iss >> value;
-                elements.push_back(value);
-            }
-            
-            // Восстанавливаем стек в правильном порядке
-            for (int i = elements.size() - 1; i >= 0; --i) {
-                stack_ptr->push(elements[i]);
-            }
-            stacks[name] = move(stack_ptr);
-        }
-        else if (type == "QUEUE") {
-            int size;
-            iss >> size;
-            
-            auto queue_ptr = make_unique<Queue>();
-            for (int i = 0; i < size; ++i) {
-                string value;
-                iss >> value;
-                queue_ptr->push(value);
-            }
-            queues[name] = move(queue_ptr);
-        }
-        else if (type == "TREE") {
-            int size;
-            iss >> size;
-            
-            auto tree_ptr = make_unique<FullBinaryTree>();
-            // Дерево загружаем через специальный метод
-            string tree_filename = name + "_tree_load.txt";
-            ofstream temp_file(tree_filename);
-            
-            temp_file << size << endl;
-            for (int i = 0; i < size; ++i) {
-                string line_rest;
-                getline(iss, line_rest);
-                if (line_rest.empty() && i == 0) {
-                    // Первая строка уже считана
-                    continue;
-                }
-                temp_file << line_rest << endl;
-            }
-            temp_file.close();
-            
-            tree_ptr->deserialize_text(tree_filename);
-            trees[name] = move(tree_ptr);
-            
-            remove(tree_filename.c_str());
-        }
-        else if (type == "DOUBLE_HASH_TABLE") {
-            string table_filename;
-            int data_size;
-            iss >> table_filename >> data_size;
-            
-            auto table_ptr = make_unique<DoubleHashTable>();
-            table_ptr->deserialize_binary(table_filename);
-            double_hash_tables[name] = move(table_ptr);
-        }
+    compaction.join();
+
+    // Новые команды идут в свежий сегмент, закрытые сворачиваются в снимок
+    uint64_t last_segment = journal->rotate();
+    if (last_segment == 0) {
+        journal->abortCompaction();
+        return false;
     }
-    
-    file.close();
+    compaction.worker = thread(foldJournal, journal.get(), journal_base, journal->currentManifest(), last_segment);
     return true;
 }
 
-void Database::clear() {
-    arrays.clear();
-    singly_lists.clear();
-    doubly_lists.clear();
-    stacks.clear();
-    queues.clear();
-    trees.clear();
-    double_hash_tables.clear();
+void Database::waitForCompaction() {
+    compaction.join();
+}
 
 // ========== Геттеры ==========
 
 const Array* Database::getArray(const string& name) const {
-    auto it = arrays.find(name);
-    return it != arrays.end() ? it->second.get() : nullptr;
+    return lookup<Array>(name);
 }
 
 const SingleList* Database::getSinglyList(const string& name) const {
-    auto it = singly_lists.find(name);
-    return it != singly_lists.end() ? it->second.get() : nullptr;
+    return lookup<SingleList>(name);
 }
 
 const DoubleList* Database::getDoublyList(const string& name) const {
-    auto it = doubly_lists.find(name);
-    return it != doubly_lists.end() ? it->second.get() : nullptr;
+    return lookup<DoubleList>(name);
 }
 
 const Stack* Database::getStack(const string& name) const {
-    auto it = stacks.find(name);
-    return it != stacks.end() ? it->second.get() : nullptr;
+    return lookup<Stack>(name);
 }
 
 const Queue* Database::getQueue(const string& name) const {
-    auto it = queues.find(name);
-    return it != queues.end() ? it->second.get() : nullptr;
+    return lookup<Queue>(name);
 }
 
 const FullBinaryTree* Database::getTree(const string& name) const {
-    auto it = trees.find(name);
-    return it != trees.end() ? it->second.get() : nullptr;
+    return lookup<FullBinaryTree>(name);
 }
 
-const DoubleHashTable* Database::getDoubleHashTable(const string& name) const {
-    auto it = double_hash_tables.find(name);
-    return it != double_hash_tables.end() ? it->second.get() : nullptr;
+const DoubleHashTable* Database::getHashTable(const string& name) const {
+    return lookup<DoubleHashTable>(name);
 }
 
 // ========== Обработка команд ==========
 
-string Database::executeCommand(const string& command) {
-    vector<string> tokens = splitCommand(command);
-    
-    if (tokens.empty()) {
-        return "ERROR: Empty command";
-    }
-    
-    string cmd = tokens[0];
-    
-    // Команда PRINT для любого контейнера
-    if (cmd == "PRINT" || cmd == "print") {
-        if (tokens.size() < 2) {
-            return "ERROR: PRINT requires container name";
-        }
-        
-        string container_name = tokens[1];
-        
-        if (arrays.find(container_name) != arrays.end()) {
-            arrays[container_name]->print();
-            return "SUCCESS";
-        }
-        else if (singly_lists.find(container_name) != singly_lists.end()) {
-            singly_lists[container_name]->print_forward();
-            return "SUCCESS";
-        }
-        else if (doubly_lists.find(container_name) != doubly_lists.end()) {
-            doubly_lists[container_name]->print_forward();
-            return "SUCCESS";
+array<Database::CommandHandler, OPCODE_COUNT> Database::makeCommandHandlers() {
+    array<CommandHandler, OPCODE_COUNT> handlers{};
+
+    handlers[static_cast<size_t>(Opcode::PRINT)] = &Database::handlePrint;
+    handlers[static_cast<size_t>(Opcode::LIST)] = &Database::handleList;
+    handlers[static_cast<size_t>(Opcode::SAVE)] = &Database::handleSave;
+    handlers[static_cast<size_t>(Opcode::BGSAVE)] = &Database::handleBgSave;
+    handlers[static_cast<size_t>(Opcode::LOAD)] = &Database::handleLoad;
+    handlers[static_cast<size_t>(Opcode::CLEAR)] = &Database::handleClear;
+    handlers[static_cast<size_t>(Opcode::HELP)] = &Database::handleHelp;
+    handlers[static_cast<size_t>(Opcode::STATS)] = &Database::handleStats;
+    handlers[static_cast<size_t>(Opcode::INFO)] = &Database::handleInfo;
+    handlers[static_cast<size_t>(Opcode::SLOWLOG)] = &Database::handleSlowLog;
+    handlers[static_cast<size_t>(Opcode::MEMORY)] = &Database::handleMemory;
+    handlers[static_cast<size_t>(Opcode::TYPE)] = &Database::handleType;
+    handlers[static_cast<size_t>(Opcode::EXISTS)] = &Database::handleExists;
+    handlers[static_cast<size_t>(Opcode::DEL)] = &Database::handleDel;
+    handlers[static_cast<size_t>(Opcode::RENAME)] = &Database::handleRename;
+
+    handlers[static_cast<size_t>(Opcode::MCREATE)] = &Database::handleMCreate;
+    handlers[static_cast<size_t>(Opcode::MPUSH)] = &Database::handleMPush;
+    handlers[static_cast<size_t>(Opcode::MINSERT)] = &Database::handleMInsert;
+    handlers[static_cast<size_t>(Opcode::MGET)] = &Database::handleMGet;
+    handlers[static_cast<size_t>(Opcode::MDEL)] = &Database::handleMDel;
+    handlers[static_cast<size_t>(Opcode::MREPLACE)] = &Database::handleMReplace;
+    handlers[static_cast<size_t>(Opcode::MSIZE)] = &Database::handleMSize;
+    handlers[static_cast<size_t>(Opcode::MFIND)] = &Database::handleMFind;
+    handlers[static_cast<size_t>(Opcode::MCOUNT)] = &Database::handleMCount;
+    handlers[static_cast<size_t>(Opcode::MFILTER)] = &Database::handleMFilter;
+    handlers[static_cast<size_t>(Opcode::MSORT)] = &Database::handleMSort;
+    handlers[static_cast<size_t>(Opcode::MSORTED)] = &Database::handleMSorted;
+
+    handlers[static_cast<size_t>(Opcode::FCREATE)] = &Database::handleFCreate;
+    handlers[static_cast<size_t>(Opcode::FPUSH)] = &Database::handleFPush;
+    handlers[static_cast<size_t>(Opcode::FDEL)] = &Database::handleFDel;
+    handlers[static_cast<size_t>(Opcode::FGET)] = &Database::handleFGet;
+    handlers[static_cast<size_t>(Opcode::FSIZE)] = &Database::handleFSize;
+    handlers[static_cast<size_t>(Opcode::FPRINT_BACKWARD)] = &Database::handleFPrintBackward;
+    handlers[static_cast<size_t>(Opcode::FINDEX)] = &Database::handleFIndex;
+
+    handlers[static_cast<size_t>(Opcode::LCREATE)] = &Database::handleLCreate;
+    handlers[static_cast<size_t>(Opcode::LPUSH)] = &Database::handleLPush;
+    handlers[static_cast<size_t>(Opcode::LDEL)] = &Database::handleLDel;
+    handlers[static_cast<size_t>(Opcode::LGET)] = &Database::handleLGet;
+    handlers[static_cast<size_t>(Opcode::LSIZE)] = &Database::handleLSize;
+    handlers[static_cast<size_t>(Opcode::LPRINT_BACKWARD)] = &Database::handleLPrintBackward;
+    handlers[static_cast<size_t>(Opcode::LINDEX)] = &Database::handleLIndex;
+
+    handlers[static_cast<size_t>(Opcode::SCREATE)] = &Database::handleSCreate;
+    handlers[static_cast<size_t>(Opcode::SPUSH)] = &Database::handleSPush;
+    handlers[static_cast<size_t>(Opcode::SPOP)] = &Database::handleSPop;
+    handlers[static_cast<size_t>(Opcode::SPEEK)] = &Database::handleSPeek;
+    handlers[static_cast<size_t>(Opcode::SSIZE)] = &Database::handleSSize;
+
+    handlers[static_cast<size_t>(Opcode::QCREATE)] = &Database::handleQCreate;
+    handlers[static_cast<size_t>(Opcode::QPUSH)] = &Database::handleQPush;
+    handlers[static_cast<size_t>(Opcode::QPOP)] = &Database::handleQPop;
+    handlers[static_cast<size_t>(Opcode::QPEEK)] = &Database::handleQPeek;
+    handlers[static_cast<size_t>(Opcode::QSIZE)] = &Database::handleQSize;
+
+    handlers[static_cast<size_t>(Opcode::TCREATE)] = &Database::handleTCreate;
+    handlers[static_cast<size_t>(Opcode::TINSERT)] = &Database::handleTInsert;
+    handlers[static_cast<size_t>(Opcode::TSEARCH)] = &Database::handleTSearch;
+    handlers[static_cast<size_t>(Opcode::TISFULL)] = &Database::handleTIsFull;
+    handlers[static_cast<size_t>(Opcode::THEIGHT)] = &Database::handleTHeight;
+    handlers[static_cast<size_t>(Opcode::TSIZE)] = &Database::handleTSize;
+    handlers[static_cast<size_t>(Opcode::TTRAVERSE)] = &Database::handleTTraverse;
+
+    handlers[static_cast<size_t>(Opcode::HCREATE)] = &Database::handleHCreate;
+    handlers[static_cast<size_t>(Opcode::HINSERT)] = &Database::handleHInsert;
+    handlers[static_cast<size_t>(Opcode::HSEARCH)] = &Database::handleHSearch;
+    handlers[static_cast<size_t>(Opcode::HDELETE)] = &Database::handleHDelete;
+    handlers[static_cast<size_t>(Opcode::HPRINT)] = &Database::handleHPrint;
+    handlers[static_cast<size_t>(Opcode::HSIZE)] = &Database::handleHSize;
+
+    return handlers;
+}
+
+const array<Database::CommandHandler, OPCODE_COUNT> Database::command_handlers =
+    Database::makeCommandHandlers();
+
+// Сообщение об отсутствующем имени контейнера для каждого семейства команд
+static const char* missingNameError(CommandFamily family) {
+    switch (family) {
+        case CommandFamily::ARRAY:
+            return "ERROR: Array command requires container name";
+        case CommandFamily::SINGLY_LIST:
+            return "ERROR: Singly list command requires container name";
+        case CommandFamily::DOUBLY_LIST:
+            return "ERROR: Doubly list command requires container name";
+        case CommandFamily::STACK:
+            return "ERROR: Stack command requires container name";
+        case CommandFamily::QUEUE:
+            return "ERROR: Queue command requires container name";
+        case CommandFamily::TREE:
+            return "ERROR: Tree command requires container name";
+        case CommandFamily::HASH_TABLE:
+            return "ERROR: Double hash table command requires container name";
+        case CommandFamily::GENERAL:
+            break;
+    }
+    return nullptr;
+}
+
+template <typename T>
+T* Database::findContainer(string_view name) {
+    // В конкурентном режиме кэш общий для всех потоков, поэтому не используется
+    if (!concurrent && resolved.type == ContainerTraits<T>::type && resolved.name == name) {
+        return static_cast<T*>(resolved.container);
+    }
+
+    ContainerHandle* handle = containers.find(name);
+    T* container = handle != nullptr ? handle->get<T>() : nullptr;
+    if (container != nullptr && !concurrent) {
+        resolved.type = ContainerTraits<T>::type;
+        resolved.name.assign(name);
+        resolved.container = container;
+    }
+    return container;
+}
+
+// Создает контейнер, если имя свободно во всем пространстве имен
+template <typename T>
+void Database::createContainer(string_view name, const char* label, string& out) {
+    const ContainerHandle* existing = containers.find(name);
+    if (existing != nullptr) {
+        if (existing->type() == ContainerTraits<T>::type) {
+            out.append("ERROR: ").append(label).append(" already exists: ").append(name);
+        } else {
+            out.append("ERROR: Name already used by ").append(containerTypeName(existing->type()));
+            out.append(": ").append(name);
         }
-        else if (stacks.find(container_name) != stacks.end()) {
-            stacks[container_name]->print();
-            return "SUCCESS";
+        return;
+    }
+    containers.insert(name, ContainerHandle(make_unique<T>()));
+    out.append("SUCCESS: ").append(label).append(" created: ").append(name);
+}
+
+template <typename T>
+void Database::switchValueIndex(const CommandTokens& args, const char* label, string& out) {
+    if (args.size() < 3 || (!isKeyword(args[2], "ON") && !isKeyword(args[2], "OFF"))) {
+        out.append("ERROR: ").append(args[0]).append(" requires ON or OFF");
+        return;
+    }
+    T* list = findContainer<T>(args[1]);
+    if (list == nullptr) {
+        out.append("ERROR: ").append(label).append(" not found: ").append(args[1]);
+        return;
+    }
+    bool enable = isKeyword(args[2], "ON");
+    list->set_value_index(enable);
+    out += enable ? "SUCCESS: Value index enabled" : "SUCCESS: Value index disabled";
+}
+
+// Какие блокировки берет команда в конкурентном режиме
+enum class LockScope : uint8_t {
+    INDEX_SHARED,     // читает только имена
+    INDEX_EXCLUSIVE,  // меняет набор имен или работает со всей базой
+    CONTAINER         // работает с одним контейнером
+};
+
+static LockScope lockScopeOf(const CommandSpec& spec) {
+    switch (spec.opcode) {
+        case Opcode::LIST:
+        case Opcode::HELP:
+        case Opcode::SLOWLOG:
+        case Opcode::TYPE:
+        case Opcode::EXISTS:
+            return LockScope::INDEX_SHARED;
+        case Opcode::PRINT:
+            return LockScope::CONTAINER;
+        case Opcode::MCREATE:
+        case Opcode::FCREATE:
+        case Opcode::LCREATE:
+        case Opcode::SCREATE:
+        case Opcode::QCREATE:
+        case Opcode::TCREATE:
+        case Opcode::HCREATE:
+            return LockScope::INDEX_EXCLUSIVE;
+        default:
+            return spec.family == CommandFamily::GENERAL ? LockScope::INDEX_EXCLUSIVE : LockScope::CONTAINER;
+    }
+}
+
+const CommandSpec* Database::parseCommand(string_view command, CommandTokens& args, string& out, Opcode& opcode) {
+    opcode = Opcode::UNKNOWN;
+    if (args.tokenize(command) == 0) {
+        out += "ERROR: Empty command";
+        return nullptr;
+    }
+
+    const CommandSpec* spec = findCommand(args[0]);
+    if (spec == nullptr) {
+        out.append("ERROR: Unknown command: ").append(args[0]);
+        return nullptr;
+    }
+
+    opcode = spec->opcode;
+    if (spec->family != CommandFamily::GENERAL && args.size() < 2) {
+        out += missingNameError(spec->family);
+        return nullptr;
+    }
+    return spec;
+}
+
+void Database::runCommand(const CommandSpec& spec, string_view command, const CommandTokens& args, string& out) {
+    // После сбоя журнала изменения не принимаются: иначе восстановленная
+    // после перезапуска база разойдется с той, что видели клиенты
+    if (spec.mutates && journal != nullptr && journal->hasFailed()) {
+        out += "ERROR: journal write failed";
+        return;
+    }
+    size_t reply_start = out.size();
+    CommandHandler handler = command_handlers[static_cast<size_t>(spec.opcode)];
+    (this->*handler)(args, out);
+
+    if (!spec.mutates || out.compare(reply_start, 5, "ERROR") == 0) {
+        return;
+    }
+    // Контейнер будет записан заново при следующем инкрементальном сохранении
+    if (spec.family != CommandFamily::GENERAL) {
+        containers.markDirty(args[1]);
+    }
+    // В журнал попадают только изменения: ошибки при проигрывании ничего не меняют.
+    // Изменение уже применено, поэтому ответ обработчика остается (повтор
+    // команды применил бы ее дважды), а потеря надежности сообщается отдельно;
+    // следующие изменения отклоняются проверкой выше.
+    if (journal != nullptr && !journal->append(command)) {
+        out += "\nWARNING: journal write failed, change is not durable";
+    }
+}
+
+void Database::dispatch(string_view command, string& out) {
+    bool record_stats = stats_enabled && stats != nullptr;
+    bool record_slow = slow_log != nullptr && slow_log->enabled();
+    if (!record_stats && !record_slow) {
+        execute(command, out);
+        return;
+    }
+
+    uint64_t start = CommandStats::now();
+    size_t reply_start = out.size();
+    Opcode opcode = execute(command, out);
+    uint64_t elapsed = CommandStats::now() - start;
+    if (record_stats) {
+        stats->record(opcode, elapsed, out.compare(reply_start, 5, "ERROR") == 0);
+    }
+    if (record_slow && slow_log->isSlow(elapsed)) {
+        recordSlowCommand(command, elapsed);
+    }
+}
+
+Opcode Database::execute(string_view command, string& out) {
+    if (concurrent) {
+        return dispatchConcurrent(command, out);
+    }
+    Opcode opcode;
+    const CommandSpec* spec = parseCommand(command, tokens, out, opcode);
+    if (spec != nullptr) {
+        runCommand(*spec, command, tokens, out);
+    }
+    return opcode;
+}
+
+// Пространство имен защищено index_lock: изменение набора имен исключает все
+// остальные команды. Команды к контейнеру держат его общей блокировкой и
+// вдобавок блокируют сам контейнер: чтение — совместно, изменение — монопольно.
+Opcode Database::dispatchConcurrent(string_view command, string& out) {
+    CommandTokens args;
+    Opcode opcode;
+    const CommandSpec* spec = parseCommand(command, args, out, opcode);
+    if (spec == nullptr) {
+        return opcode;
+    }
+
+    switch (lockScopeOf(*spec)) {
+        case LockScope::INDEX_EXCLUSIVE: {
+            unique_lock<shared_mutex> index_guard(index_lock.mutex);
+            runCommand(*spec, command, args, out);
+            return opcode;
+        }
+        case LockScope::INDEX_SHARED: {
+            shared_lock<shared_mutex> index_guard(index_lock.mutex);
+            runCommand(*spec, command, args, out);
+            return opcode;
+        }
+        case LockScope::CONTAINER:
+            break;
+    }
+
+    shared_lock<shared_mutex> index_guard(index_lock.mutex);
+    ContainerIndex::Entry* entry = containers.findEntry(args[1]);
+    if (entry == nullptr) {
+        // Контейнера нет: обработчик только сообщит об ошибке
+        runCommand(*spec, command, args, out);
+    } else if (spec->mutates) {
+        unique_lock<shared_mutex> container_guard(*entry->lock);
+        runCommand(*spec, command, args, out);
+    } else {
+        shared_lock<shared_mutex> container_guard(*entry->lock);
+        runCommand(*spec, command, args, out);
+    }
+    return opcode;
+}
+
+string Database::executeCommand(string_view command) {
+    string result;
+    dispatch(command, result);
+    return result;
+}
+
+void Database::executeCommand(string_view command, string& output) {
+    dispatch(command, output);
+}
+
+size_t Database::executeBatch(string_view commands, string& output) {
+    size_t executed = 0;
+    size_t pos = 0;
+
+    while (pos < commands.size()) {
+        size_t end = commands.find('\n', pos);
+        if (end == string_view::npos) {
+            end = commands.size();
         }
-        else if (queues.find(container_name) != queues.end()) {
-            queues[container_name]->print();
-            return "SUCCESS";
+
+        string_view command = commands.substr(pos, end - pos);
+        pos = end + 1;
+
+        // Пустые строки между командами пропускаются
+        if (command.find_first_not_of(" \t\r") == string_view::npos) {
+            continue;
         }
-        else if (trees.find(container_name) != trees.end()) {
-            trees[container_name]->print();
-            return "SUCCESS";
+
+        dispatch(command, output);
+        output += '\n';
+        ++executed;
+    }
+
+    return executed;
+}
+
+size_t Database::executeBatch(const string_view* commands, size_t count, string& output) {
+    for (size_t i = 0; i < count; ++i) {
+        dispatch(commands[i], output);
+        output += '\n';
+    }
+    return count;
+}
+
+// ========== Общие команды ==========
+
+void Database::handlePrint(const CommandTokens& args, string& out) {
+    if (args.size() < 2) {
+        out += "ERROR: PRINT requires container name";
+        return;
+    }
+
+    const ContainerHandle* handle = containers.find(args[1]);
+    if (handle == nullptr) {
+        out.append("ERROR: Container not found: ").append(args[1]);
+        return;
+    }
+
+    // Содержимое контейнера возвращается вызывающему в ответе перед SUCCESS
+    BufferSink sink(out);
+    TextWriter text(sink);
+    switch (handle->type()) {
+        case ContainerType::ARRAY:
+            handle->get<Array>()->print(text);
+            break;
+        case ContainerType::SINGLY_LIST:
+            handle->get<SingleList>()->print_forward(text);
+            break;
+        case ContainerType::DOUBLY_LIST:
+            handle->get<DoubleList>()->print_forward(text);
+            break;
+        case ContainerType::STACK:
+            handle->get<Stack>()->print(text);
+            break;
+        case ContainerType::QUEUE:
+            handle->get<Queue>()->print(text);
+            break;
+        case ContainerType::TREE:
+            handle->get<FullBinaryTree>()->print(text);
+            break;
+        case ContainerType::HASH_TABLE:
+            handle->get<DoubleHashTable>()->print(text);
+            break;
+        case ContainerType::NONE:
+            break;
+    }
+    text.flush();
+    out += "SUCCESS";
+}
+
+void Database::handleList(const CommandTokens& args, string& out) {
+    (void)args;
+    vector<pair<string, ContainerType>> items;
+    collectContainers(items);
+    formatContainerList(items, out);
+}
+
+void Database::collectContainers(vector<pair<string, ContainerType>>& result) const {
+    result.reserve(result.size() + containers.size());
+    for (const auto& entry : containers) {
+        result.emplace_back(entry.name, entry.handle.type());
+    }
+}
+
+void Database::formatContainerList(const vector<pair<string, ContainerType>>& items, string& out) {
+    // Имена группируются по типу за один проход
+    string arrays, singly_lists, doubly_lists, stacks, queues, trees, hash_tables;
+    for (const auto& [name, type] : items) {
+        switch (type) {
+            case ContainerType::ARRAY:
+                arrays.append("  ").append(name).append("\n");
+                break;
+            case ContainerType::SINGLY_LIST:
+                singly_lists.append(name).append(" ");
+                break;
+            case ContainerType::DOUBLY_LIST:
+                doubly_lists.append(name).append(" ");
+                break;
+            case ContainerType::STACK:
+                stacks.append(name).append(" ");
+                break;
+            case ContainerType::QUEUE:
+                queues.append(name).append(" ");
+                break;
+            case ContainerType::TREE:
+                trees.append(name).append(" ");
+                break;
+            case ContainerType::HASH_TABLE:
+                hash_tables.append(name).append(" ");
+                break;
+            case ContainerType::NONE:
+                break;
         }
-        else if (double_hash_tables.find(container_name) != double_hash_tables.end()) {
-            double_hash_tables[container_name]->print();
-            return "SUCCESS";
+    }
+
+    out += "CONTAINERS:\n";
+
+    if (!arrays.empty()) {
+        out.append("Arrays:\n").append(arrays).append("\n");
+    }
+    if (!singly_lists.empty()) {
+        out.append("Singly Linked Lists: ").append(singly_lists).append("\n");
+    }
+    if (!doubly_lists.empty()) {
+        out.append("Doubly Linked Lists: ").append(doubly_lists).append("\n");
+    }
+    if (!stacks.empty()) {
+        out.append("Stacks: ").append(stacks).append("\n");
+    }
+    if (!queues.empty()) {
+        out.append("Queues: ").append(queues).append("\n");
+    }
+    if (!trees.empty()) {
+        out.append("Trees: ").append(trees).append("\n");
+    }
+    if (!hash_tables.empty()) {
+        out.append("Double Hash Tables: ").append(hash_tables).append("\n");
+    }
+
+    if (items.empty()) {
+        out += "No containers found.";
+    }
+}
+
+void Database::handleSave(const CommandTokens& args, string& out) {
+    if (args.size() < 2) {
+        out += "ERROR: SAVE requires filename";
+        return;
+    }
+    string filename(args[1]);
+    if (saveIncremental(filename)) {
+        out.append("SUCCESS: Database saved to ").append(filename);
+    } else {
+        out += "ERROR: Failed to save database";
+    }
+}
+
+void Database::handleBgSave(const CommandTokens& args, string& out) {
+    if (args.size() < 2) {
+        out += "ERROR: BGSAVE requires filename";
+        return;
+    }
+    if (backgroundSaveInProgress()) {
+        out += "ERROR: Background save already in progress";
+        return;
+    }
+    string filename(args[1]);
+    if (saveInBackground(filename)) {
+        out.append("SUCCESS: Background save started to ").append(filename);
+    } else {
+        out += "ERROR: Failed to start background save";
+    }
+}
+
+void Database::handleLoad(const CommandTokens& args, string& out) {
+    if (args.size() < 2) {
+        out += "ERROR: LOAD requires filename";
+        return;
+    }
+    // В журнал попало бы только имя файла, а при восстановлении файл мог уже
+    // измениться; загруженные данные не стали бы основой для проигрывания
+    if (journal != nullptr) {
+        out += "ERROR: LOAD is not allowed while the journal is open";
+        return;
+    }
+    string filename(args[1]);
+    if (loadFromFile(filename)) {
+        out.append("SUCCESS: Database loaded from ").append(filename);
+    } else {
+        out += "ERROR: Failed to load database";
+    }
+}
+
+void Database::handleClear(const CommandTokens& args, string& out) {
+    (void)args;
+    clear();
+    out += "SUCCESS: Database cleared";
+}
+
+void Database::handleHelp(const CommandTokens& args, string& out) {
+    (void)args;
+    out += Database::getHelpText();
+}
+
+static size_t containerElements(const ContainerHandle& handle) {
+    switch (handle.type()) {
+        case ContainerType::ARRAY:
+            return static_cast<size_t>(handle.get<Array>()->length());
+        case ContainerType::SINGLY_LIST:
+            return static_cast<size_t>(handle.get<SingleList>()->get_size());
+        case ContainerType::DOUBLY_LIST:
+            return static_cast<size_t>(handle.get<DoubleList>()->get_size());
+        case ContainerType::STACK:
+            return static_cast<size_t>(handle.get<Stack>()->get_size());
+        case ContainerType::QUEUE:
+            return static_cast<size_t>(handle.get<Queue>()->get_size());
+        case ContainerType::TREE:
+            return static_cast<size_t>(handle.get<FullBinaryTree>()->get_size());
+        case ContainerType::HASH_TABLE:
+            return static_cast<size_t>(handle.get<DoubleHashTable>()->get_size());
+        case ContainerType::NONE:
+            break;
+    }
+    return 0;
+}
+
+// Обходит все узлы и ячейки контейнера: время пропорционально его размеру
+static MemoryUsage containerMemory(const ContainerHandle& handle) {
+    switch (handle.type()) {
+        case ContainerType::ARRAY:
+            return handle.get<Array>()->memory_usage();
+        case ContainerType::SINGLY_LIST:
+            return handle.get<SingleList>()->memory_usage();
+        case ContainerType::DOUBLY_LIST:
+            return handle.get<DoubleList>()->memory_usage();
+        case ContainerType::STACK:
+            return handle.get<Stack>()->memory_usage();
+        case ContainerType::QUEUE:
+            return handle.get<Queue>()->memory_usage();
+        case ContainerType::TREE:
+            return handle.get<FullBinaryTree>()->memory_usage();
+        case ContainerType::HASH_TABLE:
+            return handle.get<DoubleHashTable>()->memory_usage();
+        case ContainerType::NONE:
+            break;
+    }
+    return MemoryUsage();
+}
+
+// Размер контейнера для статистики: число элементов и занятая память
+struct ContainerUsage {
+    size_t elements = 0;
+    size_t bytes = 0;
+};
+
+static ContainerUsage containerUsage(const ContainerHandle& handle) {
+    ContainerUsage usage;
+    usage.elements = containerElements(handle);
+    usage.bytes = containerMemory(handle).bytes;
+    return usage;
+}
+
+// Имена контейнеров могут содержать кавычки и обратную косую черту
+static void appendEscaped(string& out, string_view text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
         }
-        else if (cuckoo_hash_tables.find(container_name) != cuckoo_hash_tables.end()) {
-            cuckoo_hash_tables[container_name]->print();
-            return "SUCCESS";
+        out += c;
+    }
+}
+
+static void appendMicros(string& out, uint64_t nanos) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.1fus", static_cast<double>(nanos) / 1000.0);
+    out += buffer;
+}
+
+static void appendSeconds(string& out, uint64_t nanos) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.9g", static_cast<double>(nanos) / 1e9);
+    out += buffer;
+}
+
+// Имя кода команды для отчета
+static string_view opcodeName(Opcode opcode) {
+    for (const auto& spec : COMMAND_SPECS) {
+        if (spec.opcode == opcode) {
+            return spec.name;
         }
-        else {
-            return "ERROR: Container not found: " + container_name;
+    }
+    return "UNKNOWN";
+}
+
+StatsSummary& StatsSummary::operator+=(const StatsSummary& other) {
+    commands->merge(*other.commands);
+    containers.insert(containers.end(), other.containers.begin(), other.containers.end());
+    index_bytes += other.index_bytes;
+    journal = journal || other.journal;
+    concurrent = concurrent || other.concurrent;
+    return *this;
+}
+
+void Database::appendStats(StatsFormat format, string& out) const {
+    StatsSummary summary;
+    collectStats(summary);
+    formatStats(summary, format, out);
+}
+
+void Database::collectStats(StatsSummary& result) const {
+    // У перемещенной базы счетчиков нет: в сводку попадают только контейнеры
+    if (stats != nullptr) {
+        result.commands->merge(*stats);
+    }
+    result.containers.reserve(result.containers.size() + containers.size());
+    for (const auto& entry : containers) {
+        ContainerUsage usage = containerUsage(entry.handle);
+        result.containers.push_back({entry.name, entry.handle.type(), usage.elements, usage.bytes});
+    }
+    result.index_bytes += containers.memoryUsage().bytes;
+    result.journal = result.journal || journal != nullptr;
+    result.concurrent = result.concurrent || concurrent;
+}
+
+void Database::formatStats(const StatsSummary& summary, StatsFormat format, string& out) {
+    const CommandStats& stats = *summary.commands;
+    const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+    if (format == StatsFormat::JSON) {
+        out += "{\"commands\":{";
+        bool first = true;
+        for (size_t i = 0; i < OPCODE_COUNT; ++i) {
+            const OpcodeStats& entry = stats[static_cast<Opcode>(i)];
+            const LatencyHistogram& latency = entry.latency;
+            if (entry.calls() == 0) {
+                continue;
+            }
+            out.append(first ? "\"" : ",\"").append(opcodeName(static_cast<Opcode>(i))).append("\":{");
+            first = false;
+            out.append("\"calls\":").append(to_string(entry.calls()));
+            out.append(",\"errors\":").append(to_string(entry.errors.load()));
+            out.append(",\"sum_ns\":").append(to_string(CommandStats::toNanos(latency.sum())));
+            out.append(",\"p50_ns\":").append(to_string(CommandStats::toNanos(latency.percentile(0.5))));
+            out.append(",\"p99_ns\":").append(to_string(CommandStats::toNanos(latency.percentile(0.99))));
+            out.append(",\"max_ns\":").append(to_string(CommandStats::toNanos(latency.max())));
+            // Непустые корзины: [верхняя граница в нс, число значений]
+            out += ",\"histogram\":[";
+            bool first_bucket = true;
+            for (size_t bucket = 0; bucket < LatencyHistogram::BUCKETS; ++bucket) {
+                uint64_t count = latency.bucketCount(bucket);
+                if (count == 0) {
+                    continue;
+                }
+                out.append(first_bucket ? "[" : ",[");
+                out.append(to_string(CommandStats::toNanos(LatencyHistogram::bucketUpperBound(bucket)))).append(",");
+                out.append(to_string(count)).append("]");
+                first_bucket = false;
+            }
+            out += "]}";
+        }
+        out += "},\"containers\":[";
+        first = true;
+        for (const auto& entry : summary.containers) {
+            out.append(first ? "{\"name\":\"" : ",{\"name\":\"");
+            appendEscaped(out, entry.name);
+            out.append("\",\"type\":\"").append(containerTypeName(entry.type));
+            out.append("\",\"elements\":").append(to_string(entry.elements));
+            out.append(",\"bytes\":").append(to_string(entry.bytes)).append("}");
+            first = false;
+        }
+        out += "]}";
+        return;
+    }
+
+    if (format == StatsFormat::PROMETHEUS) {
+        out += "# TYPE lab3_commands_total counter\n";
+        out += "# TYPE lab3_command_errors_total counter\n";
+        out += "# TYPE lab3_command_duration_seconds summary\n";
+        for (size_t i = 0; i < OPCODE_COUNT; ++i) {
+            const OpcodeStats& entry = stats[static_cast<Opcode>(i)];
+            if (entry.calls() == 0) {
+                continue;
+            }
+            string label = "command=\"" + string(opcodeName(static_cast<Opcode>(i))) + "\"";
+            out.append("lab3_commands_total{").append(label).append("} ");
+            out.append(to_string(entry.calls())).append("\n");
+            out.append("lab3_command_errors_total{").append(label).append("} ");
+            out.append(to_string(entry.errors.load())).append("\n");
+            for (double quantile : quantiles) {
+                char quantile_text[16];
+                snprintf(quantile_text, sizeof(quantile_text), "%g", quantile);
+                out.append("lab3_command_duration_seconds{").append(label).append(",quantile=\"");
+                out.append(quantile_text).append("\"} ");
+                appendSeconds(out, CommandStats::toNanos(entry.latency.percentile(quantile)));
+                out += "\n";
+            }
+            out.append("lab3_command_duration_seconds_sum{").append(label).append("} ");
+            appendSeconds(out, CommandStats::toNanos(entry.latency.sum()));
+            out.append("\nlab3_command_duration_seconds_count{").append(label).append("} ");
+            out.append(to_string(entry.latency.count())).append("\n");
+        }
+        out += "# TYPE lab3_container_elements gauge\n";
+        out += "# TYPE lab3_container_bytes gauge\n";
+        for (const auto& entry : summary.containers) {
+            string label = "name=\"";
+            appendEscaped(label, entry.name);
+            label.append("\",type=\"").append(containerTypeName(entry.type)).append("\"");
+            out.append("lab3_container_elements{").append(label).append("} ");
+            out.append(to_string(entry.elements)).append("\n");
+            out.append("lab3_container_bytes{").append(label).append("} ");
+            out.append(to_string(entry.bytes)).append("\n");
+        }
+        return;
+    }
+
+    out += "COMMAND STATS:\n";
+    for (size_t i = 0; i < OPCODE_COUNT; ++i) {
+        const OpcodeStats& entry = stats[static_cast<Opcode>(i)];
+        if (entry.calls() == 0) {
+            continue;
         }
+        out.append("  ").append(opcodeName(static_cast<Opcode>(i)));
+        out.append(" calls=").append(to_string(entry.calls()));
+        out.append(" errors=").append(to_string(entry.errors.load()));
+        out += " p50=";
+        appendMicros(out, CommandStats::toNanos(entry.latency.percentile(0.5)));
+        out += " p99=";
+        appendMicros(out, CommandStats::toNanos(entry.latency.percentile(0.99)));
+        out += " max=";
+        appendMicros(out, CommandStats::toNanos(entry.latency.max()));
+        out += "\n";
     }
-    
-    // Обработка команд для массивов (M)
-    else if (isArrayCommand(cmd)) {
-        if (tokens.size() < 2) {
-            return "ERROR: Array command requires container name";
-        }
-        
-        string array_name = tokens[1];
-        
-        if (cmd == "MCREATE" || cmd == "mcreate") {
-            if (arrays.find(array_name) != arrays.end()) {
-                return "ERROR: Array already exists: " + array_name;
-            }
-            arrays[array_name] = make_unique<Array>();
-            return "SUCCESS: Array created: " + array_name;
-        }
-        else if (cmd == "MPUSH" || cmd == "mpush") {
-            if (tokens.size() < 3) {
-                return "ERROR: MPUSH requires value";
-            }
-            if (arrays.find(array_name) == arrays.end()) {
-                return "ERROR: Array not found: " + array_name;
-            }
-            arrays[array_name]->push_back(tokens[2]);
-            return "SUCCESS: Value pushed to array";
-        }
-        else if (cmd == "MINSERT" || cmd == "minsert") {
-            if (tokens.size() < 4) {
-                return "ERROR: MINSERT requires index and value";
-            }
-            if (arrays.find(array_name) == arrays.end()) {
-                return "ERROR: Array not found: " + array_name;
-            }
-            try {
-                int index = stoi(tokens[2]);
-                if (arrays[array_name]->insert(index, tokens[3])) {
-                    return "SUCCESS: Value inserted at index " + tokens[2];
-                } else {
-                    return "ERROR: Invalid index";
-                }
-            } catch (const exception& e) {
-                return "ERROR: Invalid index format";
-            }
-        }
-        else if (cmd == "MGET" || cmd == "mget") {
-            if (tokens.size() < 3) {
-                return "ERROR: MGET requires index";
-            }
-            if (arrays.find(array_name) == arrays.end()) {
-                return "ERROR: Array not found: " + array_name;
-            }
-            try {
-                int index = stoi(tokens[2]);
-                string value = arrays[array_name]->get(index);
-                if (!value.empty()) {
-                    return "VALUE: " + value;
-                } else {
-                    return "ERROR: Invalid index or empty value";
-                }
-            } catch (const exception& e) {
-                return "ERROR: Invalid index format";
-            }
-        }
-        else if (cmd == "MDEL" || cmd == "mdel") {
-            if (tokens.size() < 3) {
-                return "ERROR: MDEL requires index";
-            }
-            if (arrays.find(array_name) == arrays.end()) {
-                return "ERROR: Array not found: " + array_name;
-            }
-            try {
-                int index = stoi(tokens[2]);
-                if (arrays[array_name]->remove(index)) {
-                    return "SUCCESS: Element removed at index " + tokens[2];
-                } else {
-                    return "ERROR: Invalid index";
-                }
-            } catch (const exception& e) {
-                return "ERROR: Invalid index format";
-            }
-        }
-        else if (cmd == "MREPLACE" || cmd == "mreplace") {
-            if (tokens.size() < 4) {
-                return "ERROR: MREPLACE requires index and value";
-            }
-            if (arrays.find(array_name) == arrays.end()) {
-                return "ERROR: Array not found: " + array_name;
-            }
-            try {
-                int index = stoi(tokens[2]);
-                if (arrays[array_name]->replace(index, tokens[3])) {
-                    return "SUCCESS: Value replaced at index " + tokens[2];
-                } else {
-                    return "ERROR: Invalid index";
-                }
-            } catch (const exception& e) {
-                return "ERROR: Invalid index format";
-            }
-        }
-        else if (cmd == "MSIZE" || cmd == "msize") {
-            if (arrays.find(array_name) == arrays.end()) {
-                return "ERROR: Array not found: " + array_name;
-            }
-            return "SIZE: " + to_string(arrays[array_name]->length());
-        }
+    out += "CONTAINERS:\n";
+    for (const auto& entry : summary.containers) {
+        out.append("  ").append(entry.name).append(" (").append(containerTypeName(entry.type));
+        out.append("): ").append(to_string(entry.elements)).append(" elements, ");
+        out.append(to_string(entry.bytes)).append(" bytes\n");
     }
-    
-    // Обработка команд для односвязных списков (F)
-    else if (isSinglyListCommand(cmd)) {
-        if (tokens.size() < 2) {
-            return "ERROR: Singly list command requires container name";
-        }
-        
-        string list_name = tokens[1];
-        
-        if (cmd == "FCREATE" || cmd == "fcreate") {
-            if (singly_lists.find(list_name) != singly_lists.end()) {
-                return "ERROR: Singly list already exists: " + list_name;
-            }
-            singly_lists[list_name] = make_unique<SingleList>();
-            return "SUCCESS: Singly list created: " + list_name;
-        }
-        else if (cmd == "FPUSH" || cmd == "fpush") {
-            if (tokens.size() < 4) {
-                return "ERROR: FPUSH requires type and value";
-            }
-            if (singly_lists.find(list_name) == singly_lists.end()) {
-                return "ERROR: Singly list not found: " + list_name;
-            }
-            
-            string push_type = tokens[2];
-            SingleList* list = singly_lists[list_name].get();
-            
-            if (push_type == "FRONT" || push_type == "front") {
-                string value = tokens[3];
-                list->push_front(value);
-                return "SUCCESS: Value pushed to front";
-            }
-            else if (push_type == "BACK" || push_type == "back") {
-                string value = tokens[3];
-                list->push_back(value);
-                return "SUCCESS: Value pushed to back";
-            }
-            else if (push_type == "BEFORE" || push_type == "before") {
-                if (tokens.size() < 5) {
-                    return "ERROR: FPUSH BEFORE requires target value";
-                }
-                if (list->insert_before(tokens[3], tokens[4])) {
-                    return "SUCCESS: Value inserted before target";
-                } else {
-                    return "ERROR: Target not found";
-                }
-            }
-            else if (push_type == "AFTER" || push_type == "after") {
-                if (tokens.size() < 5) {
-                    return "ERROR: FPUSH AFTER requires target value";
-                }
-                if (list->insert_after(tokens[3], tokens[4])) {
-                    return "SUCCESS: Value inserted after target";
-                } else {
-                    return "ERROR: Target not found";
-                }
-            }
-            else {
-                return "ERROR: Invalid push type. Use FRONT/BACK/BEFORE/AFTER";
-            }
-        }
-        else if (cmd == "FDEL" || cmd == "fdel") {
-            if (tokens.size() < 3) {
-                return "ERROR: FDEL requires type";
-            }
-            if (singly_lists.find(list_name) == singly_lists.end()) {
-                return "ERROR: Singly list not found: " + list_name;
-            }
-            
-            string del_type = tokens[2];
-            SingleList* list = singly_lists[list_name].get();
-            
-            if (del_type == "FRONT" || del_type == "front") {
-                if (list->pop_front()) {
-                    return "SUCCESS: Front element removed";
-                } else {
-                    return "ERROR: List is empty";
-                }
-            }
-            else if (del_type == "BACK" || del_type == "back") {
-                if (list->pop_back()) {
-                    return "SUCCESS: Back element removed";
-                } else {
-                    return "ERROR: List is empty";
-                }
-            }
-            else if (del_type == "VALUE" || del_type == "value") {
-                if (tokens.size() < 4) {
-                    return "ERROR: FDEL VALUE requires target value";
-                }
-                if (list->remove_value(tokens[3])) {
-                    return "SUCCESS: Value removed";
-                } else {
-                    return "ERROR: Value not found";
-                }
-            }
-            else if (del_type == "BEFORE" || del_type == "before") {
-                if (tokens.size() < 4) {
-                    return "ERROR: FDEL BEFORE requires target value";
-                }
-                if (list->remove_before(tokens[3])) {
-                    return "SUCCESS: Element before target removed";
-                } else {
-                    return "ERROR: Cannot remove before target";
-                }
-            }
-            else if (del_type == "AFTER" || del_type == "after") {
-                if (tokens.size() < 4) {
-                    return "ERROR: FDEL AFTER requires target value";
-                }
-                if (list->remove_after(tokens[3])) {
-                    return "SUCCESS: Element after target removed";
-                } else {
-                    return "ERROR: Cannot remove after target";
-                }
-            }
-            else {
-                return "ERROR: Invalid delete type. Use FRONT/BACK/VALUE/BEFORE/AFTER";
-            }
-        }
-        else if (cmd == "FGET" || cmd == "fget") {
-            if (singly_lists.find(list_name) == singly_lists.end()) {
-                return "ERROR: Singly list not found: " + list_name;
-            }
-            SingleList* list = singly_lists[list_name].get();
-            
-            if (tokens.size() == 2) {
-                string result = "LIST: ";
-                SNode* current = list->find_first();
-                while (current != nullptr) {
-                    result += current->data;
-                    current = list->find_next(current);
-                    if (current != nullptr) result += " -> ";
-                }
-                return result;
-            }
-            else if (tokens.size() == 3) {
-                SNode* found = list->find(tokens[2]);
-                if (found) {
-                    return "FOUND: " + found->data;
-                } else {
-                    return "NOT_FOUND";
-                }
-            }
-            else {
-                return "ERROR: FGET requires either no arguments (to display list) or one argument (to search)";
-            }
-        }
-        else if (cmd == "FSIZE" || cmd == "fsize") {
-            if (singly_lists.find(list_name) == singly_lists.end()) {
-                return "ERROR: Singly list not found: " + list_name;
-            }
-            return "SIZE: " + to_string(singly_lists[list_name]->get_size());
-        }
-        else if (cmd == "FPRINT_BACKWARD" || cmd == "fprint_backward") {
-            if (singly_lists.find(list_name) == singly_lists.end()) {
-                return "ERROR: Singly list not found: " + list_name;
-            }
-            singly_lists[list_name]->print_backward();
-            return "SUCCESS";
-        }
+}
+
+void Database::handleStats(const CommandTokens& args, string& out) {
+    if (args.size() < 2) {
+        appendStats(StatsFormat::TEXT, out);
+    } else if (isKeyword(args[1], "JSON")) {
+        appendStats(StatsFormat::JSON, out);
+    } else if (isKeyword(args[1], "PROMETHEUS")) {
+        appendStats(StatsFormat::PROMETHEUS, out);
+    } else if (isKeyword(args[1], "RESET")) {
+        resetStats();
+        out += "SUCCESS: Statistics reset";
+    } else {
+        out.append("ERROR: Unknown STATS option: ").append(args[1]);
     }
-    
-    // Обработка команд для двусвязных списков (L)
-    else if (isDoublyListCommand(cmd)) {
-        if (tokens.size() < 2) {
-            return "ERROR: Doubly list command requires container name";
-        }
-        
-        string list_name = tokens[1];
-        
-        if (cmd == "LCREATE" || cmd == "lcreate") {
-            if (doubly_lists.find(list_name) != doubly_lists.end()) {
-                return "ERROR: Doubly list already exists: " + list_name;
-            }
-            doubly_lists[list_name] = make_unique<DoubleList>();
-            return "SUCCESS: Doubly list created: " + list_name;
-        }
-        else if (cmd == "LPUSH" || cmd == "lpush") {
-            if (tokens.size() < 4) {
-                return "ERROR: LPUSH requires type and value";
-            }
-            if (doubly_lists.find(list_name) == doubly_lists.end()) {
-                return "ERROR: Doubly list not found: " + list_name;
-            }
-            
-            string push_type = tokens[2];
-            string value = tokens[3];
-            DoubleList* list = doubly_lists[list_name].get();
-            
-            if (push_type == "FRONT" || push_type == "front") {
-                list->push_front(value);
-                return "SUCCESS: Value pushed to front";
-            }
-            else if (push_type == "BACK" || push_type == "back") {
-                list->push_back(value);
-                return "SUCCESS: Value pushed to back";
-            }
-            else if (push_type == "BEFORE" || push_type == "before") {
-                if (tokens.size() < 5) {
-                    return "ERROR: LPUSH BEFORE requires target value";
-                }
-                if (list->insert_before(tokens[3], tokens[4])) {
-                    return "SUCCESS: Value inserted before target";
-                } else {
-                    return "ERROR: Target not found";
-                }
-            }
-            else if (push_type == "AFTER" || push_type == "after") {
-                if (tokens.size() < 5) {
-                    return "ERROR: LPUSH AFTER requires target value";
-                }
-                if (list->insert_after(tokens[3], tokens[4])) {
-                    return "SUCCESS: Value inserted after target";
-                } else {
-                    return "ERROR: Target not found";
-                }
-            }
-            else {
-                return "ERROR: Invalid push type. Use FRONT/BACK/BEFORE/AFTER";
-            }
-        }
-        else if (cmd == "LDEL" || cmd == "ldel") {
-            if (tokens.size() < 3) {
-                return "ERROR: LDEL requires type";
-            }
-            if (doubly_lists.find(list_name) == doubly_lists.end()) {
-                return "ERROR: Doubly list not found: " + list_name;
-            }
-            
-            string del_type = tokens[2];
-            DoubleList* list = doubly_lists[list_name].get();
-            
-            if (del_type == "FRONT" || del_type == "front") {
-                if (list->pop_front()) {
-                    return "SUCCESS: Front element removed";
-                } else {
-                    return "ERROR: List is empty";
-                }
-            }
-            else if (del_type == "BACK" || del_type == "back") {
-                if (list->pop_back()) {
-                    return "SUCCESS: Back element removed";
-                } else {
-                    return "ERROR: List is empty";
-                }
-            }
-            else if (del_type == "VALUE" || del_type == "value") {
-                if (tokens.size() < 4) {
-                    return "ERROR: LDEL VALUE requires target value";
-                }
-                if (list->remove_value(tokens[3])) {
-                    return "SUCCESS: Value removed";
-                } else {
-                    return "ERROR: Value not found";
-                }
-            }
-            else if (del_type == "BEFORE" || del_type == "before"){
-                if (tokens.size() < 4){
-                    return "ERROR: LDEL BEFORE requires target value";
-                }
-                if(list->remove_before(tokens[3])){
-                    return "SUCCESS: Element before target removed";
-                } else {
-                    return "ERROR: Cannot remove before target";
-                }
-            }
-            else if (del_type == "AFTER" || del_type == "after"){
-                if (tokens.size() < 4){
-                    return "ERROR: LDEL AFTER requires target value";
-                }
-                if(list->remove_after(tokens[3])){
-                    return "SUCCESS: Element after target removed";
-                } else {
-                    return "ERROR: Cannot remove after target";
-                }
-            }
-            else {
-                return "ERROR: Invalid delete type. Use FRONT/BACK/VALUE/BEFORE/AFTER";
-            }
-        }
-        else if (cmd == "LGET" || cmd == "lget") {
-            if (doubly_lists.find(list_name) == doubly_lists.end()) {
-                return "ERROR: Doubly list not found: " + list_name;
-            }
-            DoubleList* list = doubly_lists[list_name].get();
-            
-            if (tokens.size() == 2) {
-                string result = "LIST: ";
-                DNode* current = list->find_first();
-                while (current != nullptr) {
-                    result += current->data;
-                    current = list->find_next(current);
-                    if (current != nullptr) result += " <-> ";
-                }
-                return result;
-            }
-            else if (tokens.size() == 3) {
-                DNode* found = list->find(tokens[2]);
-                if (found) {
-                    return "FOUND: " + found->data;
-                } else {
-                    return "NOT_FOUND";
-                }
-            }
-        }
-        else if (cmd == "LPRINT_BACKWARD" || cmd == "lprint_backward") {
-            if (doubly_lists.find(list_name) == doubly_lists.end()) {
-                return "ERROR: Doubly list not found: " + list_name;
-            }
-            doubly_lists[list_name]->print_backward();
-            return "SUCCESS";
-        }
-        else if (cmd == "LSIZE" || cmd == "lsize") {
-            if (doubly_lists.find(list_name) == doubly_lists.end()) {
-                return "ERROR: Doubly list not found: " + list_name;
-            }
-            return "SIZE: " + to_string(doubly_lists[list_name]->get_size());
-        }
+}
+
+void Database::handleInfo(const CommandTokens& args, string& out) {
+    (void)args;
+    StatsSummary summary;
+    collectStats(summary);
+    formatInfo(summary, out);
+}
+
+void Database::formatInfo(const StatsSummary& summary, string& out) {
+    size_t elements = 0;
+    size_t bytes = summary.index_bytes;
+    for (const auto& entry : summary.containers) {
+        elements += entry.elements;
+        bytes += entry.bytes;
     }
-    
-    // Обработка команд для стеков (S)
-    else if (isStackCommand(cmd)) {
-        if (tokens.size() < 2) {
-            return "ERROR: Stack command requires container name";
-        }
-        
-        string stack_name = tokens[1];
-        
-        if (cmd == "SCREATE" || cmd == "screate") {
-            if (stacks.find(stack_name) != stacks.end()) {
-                return "ERROR: Stack already exists: " + stack_name;
-            }
-            stacks[stack_name] = make_unique<Stack>();
-            return "SUCCESS: Stack created: " + stack_name;
-        }
-        else if (cmd == "SPUSH" || cmd == "spush") {
-            if (tokens.size() < 3) {
-                return "ERROR: SPUSH requires value";
-            }
-            if (stacks.find(stack_name) == stacks.end()) {
-                return "ERROR: Stack not found: " + stack_name;
+    uint64_t calls = 0;
+    uint64_t errors = 0;
+    for (size_t i = 0; i < OPCODE_COUNT; ++i) {
+        calls += (*summary.commands)[static_cast<Opcode>(i)].calls();
+        errors += (*summary.commands)[static_cast<Opcode>(i)].errors.load();
+    }
+
+    out.append("containers: ").append(to_string(summary.containers.size())).append("\n");
+    out.append("elements: ").append(to_string(elements)).append("\n");
+    out.append("memory_bytes: ").append(to_string(bytes)).append("\n");
+    out.append("commands: ").append(to_string(calls)).append("\n");
+    out.append("errors: ").append(to_string(errors)).append("\n");
+    out.append("journal: ").append(summary.journal ? "on" : "off").append("\n");
+    out.append("concurrent: ").append(summary.concurrent ? "on" : "off");
+}
+
+void Database::recordSlowCommand(string_view command, uint64_t ticks) {
+    // Команда уже выполнена: разбираем ее заново, чтобы найти контейнер
+    CommandTokens args;
+    args.tokenize(command);
+    const CommandSpec* spec = args.empty() ? nullptr : findCommand(args[0]);
+    size_t container_size = 0;
+    if (spec != nullptr && args.size() >= 2 && lockScopeOf(*spec) == LockScope::CONTAINER) {
+        if (concurrent) {
+            shared_lock<shared_mutex> index_guard(index_lock.mutex);
+            ContainerIndex::Entry* entry = containers.findEntry(args[1]);
+            if (entry != nullptr) {
+                shared_lock<shared_mutex> container_guard(*entry->lock);
+                container_size = containerElements(entry->handle);
             }
-            stacks[stack_name]->push(tokens[2]);
-            return "SUCCESS: Value pushed to stack";
+        } else {
+            const ContainerHandle* handle = containers.find(args[1]);
+            container_size = handle != nullptr ? containerElements(*handle) : 0;
         }
-        else if (cmd == "SPOP" || cmd == "spop") {
-            if (stacks.find(stack_name) == stacks.end()) {
-                return "ERROR: Stack not found: " + stack_name;
-            }
-            try {
-                string value = stacks[stack_name]->pop();
-                if (!value.empty()) {
-                    return "POPPED: " + value;
-                } else {
-                    return "ERROR: Stack is empty";
-                }
-            } catch (const runtime_error& e) {
-                return "ERROR: Stack is empty";
-            }
+    }
+    slow_log->record(command, ticks, container_size);
+}
+
+void Database::handleSlowLog(const CommandTokens& args, string& out) {
+    if (args.size() < 2) {
+        out += "ERROR: SLOWLOG requires GET, LEN, RESET or THRESHOLD";
+        return;
+    }
+
+    if (isKeyword(args[1], "GET")) {
+        int count = 10;
+        if (args.size() >= 3 && (!parseInt(args[2], count) || count < 0)) {
+            out += "ERROR: Invalid count format";
+            return;
+        }
+        formatSlowLog(slow_log->entries(static_cast<size_t>(count)), out);
+    } else if (isKeyword(args[1], "LEN")) {
+        out.append("LEN: ").append(to_string(slow_log->size()));
+    } else if (isKeyword(args[1], "RESET")) {
+        resetSlowLog();
+        out += "SUCCESS: Slow log reset";
+    } else if (isKeyword(args[1], "THRESHOLD")) {
+        if (args.size() < 3) {
+            uint64_t micros = slow_log->threshold();
+            out += "THRESHOLD: ";
+            out += micros == SlowLog::DISABLED ? string("off") : to_string(micros) + "us";
+            return;
+        }
+        if (isKeyword(args[2], "OFF")) {
+            slow_log->setThreshold(SlowLog::DISABLED);
+            out += "SUCCESS: Slow log disabled";
+            return;
+        }
+        int micros;
+        if (!parseInt(args[2], micros) || micros < 0) {
+            out += "ERROR: Invalid threshold format";
+            return;
+        }
+        slow_log->setThreshold(static_cast<uint64_t>(micros));
+        out.append("SUCCESS: Slow log threshold set to ").append(args[2]).append("us");
+    } else {
+        out.append("ERROR: Unknown SLOWLOG option: ").append(args[1]);
+    }
+}
+
+void Database::formatSlowLog(const vector<SlowLogEntry>& entries, string& out) {
+    out.append("SLOWLOG: ").append(to_string(entries.size())).append(" entries");
+    for (const auto& entry : entries) {
+        char time[48];
+        snprintf(time, sizeof(time), "%llu.%06llu",
+                 static_cast<unsigned long long>(entry.timestamp_us / 1000000),
+                 static_cast<unsigned long long>(entry.timestamp_us % 1000000));
+        out.append("\n  id=").append(to_string(entry.id));
+        out.append(" time=").append(time);
+        out += " duration=";
+        appendMicros(out, entry.duration_ns);
+        out.append(" size=").append(to_string(entry.container_size));
+        out.append(" command=").append(entry.command);
+        if (entry.command_length > entry.command.size()) {
+            out.append("... (").append(to_string(entry.command_length - entry.command.size()));
+            out += " more bytes)";
         }
-        else if (cmd == "SPEEK" || cmd == "speek") {
-            if (stacks.find(stack_name) == stacks.end()) {
-                return "ERROR: Stack not found: " + stack_name;
-            }
-            try {
-                string value = stacks[stack_name]->peek();
-                if (!value.empty()) {
-                    return "PEEK: " + value;
-                } else {
-                    return "ERROR: Stack is empty";
-                }
-            } catch (const runtime_error& e) {
-                return "ERROR: Stack is empty";
-            }
+    }
+}
+
+void Database::handleMemory(const CommandTokens& args, string& out) {
+    if (args.size() >= 2 && isKeyword(args[1], "USAGE")) {
+        if (args.size() < 3) {
+            out += "ERROR: MEMORY USAGE requires container name";
+            return;
+        }
+        const ContainerHandle* handle = containers.find(args[2]);
+        if (handle == nullptr) {
+            out.append("ERROR: Container not found: ").append(args[2]);
+            return;
+        }
+        MemoryUsage usage = containerMemory(*handle);
+        out.append("MEMORY: ").append(to_string(usage.bytes)).append(" bytes (payload ");
+        out.append(to_string(usage.payload)).append(", overhead ").append(to_string(usage.bytes - usage.payload));
+        out.append(", heap blocks ").append(to_string(usage.heap_blocks));
+        out.append(", elements ").append(to_string(containerElements(*handle))).append(")");
+        return;
+    }
+    if (args.size() < 2 || !isKeyword(args[1], "STATS")) {
+        out += "ERROR: MEMORY requires USAGE <name> or STATS";
+        return;
+    }
+
+    MemorySummary summary;
+    collectMemory(summary);
+    formatMemoryStats(summary, out);
+}
+
+void Database::collectMemory(MemorySummary& result) const {
+    for (const auto& entry : containers) {
+        size_t type = static_cast<size_t>(entry.handle.type());
+        ++result.counts[type];
+        result.elements[type] += containerElements(entry.handle);
+        result.usage[type] += containerMemory(entry.handle);
+    }
+    result.index += containers.memoryUsage();
+}
+
+void Database::formatMemoryStats(const MemorySummary& summary, string& out) {
+    size_t total = summary.index.bytes;
+    out += "MEMORY STATS:";
+    for (size_t type = 1; type < MemorySummary::TYPE_COUNT; ++type) {
+        if (summary.counts[type] == 0) {
+            continue;
         }
-        else if (cmd == "SSIZE" || cmd == "ssize") {
-            if (stacks.find(stack_name) == stacks.end()) {
-                return "ERROR: Stack not found: " + stack_name;
-            }
-            return "SIZE: " + to_string(stacks[stack_name]->get_size());
+        const MemoryUsage& usage = summary.usage[type];
+        total += usage.bytes;
+        out.append("\n  ").append(containerTypeName(static_cast<ContainerType>(type))).append(": ");
+        out.append(to_string(summary.counts[type])).append(" containers, ");
+        out.append(to_string(summary.elements[type])).append(" elements, ");
+        out.append(to_string(usage.bytes)).append(" bytes, payload ");
+        out.append(to_string(usage.payload));
+        if (summary.elements[type] > 0) {
+            char per_element[32];
+            snprintf(per_element, sizeof(per_element), ", %.1f bytes/element",
+                     static_cast<double>(usage.bytes) / static_cast<double>(summary.elements[type]));
+            out += per_element;
         }
     }
-    
-    // Обработка команд для очередей (Q)
-    else if (isQueueCommand(cmd)) {
-        if (tokens.size() < 2) {
-            return "ERROR: Queue command requires container name";
-        }
-        
-        string queue_name = tokens[1];
-        
-        if (cmd == "QCREATE" || cmd == "qcreate") {
-            if (queues.find(queue_name) != queues.end()) {
-                return "ERROR: Queue already exists: " + queue_name;
-            }
-            queues[queue_name] = make_unique<Queue>();
-            return "SUCCESS: Queue created: " + queue_name;
+    out.append("\n  index: ").append(to_string(summary.index.bytes)).append(" bytes");
+    out.append("\n  total: ").append(to_string(total)).append(" bytes");
+}
+
+void Database::handleType(const CommandTokens& args, string& out) {
+    if (args.size() < 2) {
+        out += "ERROR: TYPE requires container name";
+        return;
+    }
+    const ContainerHandle* handle = containers.find(args[1]);
+    if (handle == nullptr) {
+        out.append("ERROR: Container not found: ").append(args[1]);
+        return;
+    }
+    out.append("TYPE: ").append(containerTypeName(handle->type()));
+}
+
+void Database::handleExists(const CommandTokens& args, string& out) {
+    if (args.size() < 2) {
+        out += "ERROR: EXISTS requires container name";
+        return;
+    }
+    out += containers.find(args[1]) != nullptr ? "EXISTS: YES" : "EXISTS: NO";
+}
+
+void Database::handleDel(const CommandTokens& args, string& out) {
+    if (args.size() < 2) {
+        out += "ERROR: DEL requires container name";
+        return;
+    }
+    resolved.reset();
+    if (containers.erase(args[1])) {
+        out.append("SUCCESS: Container deleted: ").append(args[1]);
+    } else {
+        out.append("ERROR: Container not found: ").append(args[1]);
+    }
+}
+
+void Database::handleRename(const CommandTokens& args, string& out) {
+    if (args.size() < 3) {
+        out += "ERROR: RENAME requires old and new container names";
+        return;
+    }
+    if (containers.find(args[1]) == nullptr) {
+        out.append("ERROR: Container not found: ").append(args[1]);
+        return;
+    }
+    resolved.reset();
+    if (containers.rename(args[1], args[2])) {
+        out.append("SUCCESS: Container renamed: ").append(args[1]).append(" -> ").append(args[2]);
+    } else {
+        out.append("ERROR: Name already in use: ").append(args[2]);
+    }
+}
+
+// ========== Массивы (M) ==========
+
+void Database::handleMCreate(const CommandTokens& args, string& out) {
+    createContainer<Array>(args[1], "Array", out);
+}
+
+void Database::handleMPush(const CommandTokens& args, string& out) {
+    if (args.size() < 3) {
+        out += "ERROR: MPUSH requires value";
+        return;
+    }
+    auto* container = findContainer<Array>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Array not found: ").append(args[1]);
+        return;
+    }
+    container->push_back(args[2]);
+    out += "SUCCESS: Value pushed to array";
+}
+
+void Database::handleMInsert(const CommandTokens& args, string& out) {
+    if (args.size() < 4) {
+        out += "ERROR: MINSERT requires index and value";
+        return;
+    }
+    auto* container = findContainer<Array>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Array not found: ").append(args[1]);
+        return;
+    }
+    int index;
+    if (!parseInt(args[2], index)) {
+        out += "ERROR: Invalid index format";
+        return;
+    }
+    if (container->insert(index, args[3])) {
+        out.append("SUCCESS: Value inserted at index ").append(args[2]);
+    } else {
+        out += "ERROR: Invalid index";
+    }
+}
+
+void Database::handleMGet(const CommandTokens& args, string& out) {
+    if (args.size() < 3) {
+        out += "ERROR: MGET requires index";
+        return;
+    }
+    auto* container = findContainer<Array>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Array not found: ").append(args[1]);
+        return;
+    }
+    int index;
+    if (!parseInt(args[2], index)) {
+        out += "ERROR: Invalid index format";
+        return;
+    }
+    string_view value = container->view(index);
+    if (!value.empty()) {
+        out.append("VALUE: ").append(value);
+    } else {
+        out += "ERROR: Invalid index or empty value";
+    }
+}
+
+void Database::handleMDel(const CommandTokens& args, string& out) {
+    if (args.size() < 3) {
+        out += "ERROR: MDEL requires index";
+        return;
+    }
+    auto* container = findContainer<Array>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Array not found: ").append(args[1]);
+        return;
+    }
+    int index;
+    if (!parseInt(args[2], index)) {
+        out += "ERROR: Invalid index format";
+        return;
+    }
+    if (container->remove(index)) {
+        out.append("SUCCESS: Element removed at index ").append(args[2]);
+    } else {
+        out += "ERROR: Invalid index";
+    }
+}
+
+void Database::handleMReplace(const CommandTokens& args, string& out) {
+    if (args.size() < 4) {
+        out += "ERROR: MREPLACE requires index and value";
+        return;
+    }
+    auto* container = findContainer<Array>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Array not found: ").append(args[1]);
+        return;
+    }
+    int index;
+    if (!parseInt(args[2], index)) {
+        out += "ERROR: Invalid index format";
+        return;
+    }
+    if (container->replace(index, args[3])) {
+        out.append("SUCCESS: Value replaced at index ").append(args[2]);
+    } else {
+        out += "ERROR: Invalid index";
+    }
+}
+
+void Database::handleMSize(const CommandTokens& args, string& out) {
+    auto* container = findContainer<Array>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Array not found: ").append(args[1]);
+        return;
+    }
+    out.append("SIZE: ").append(to_string(container->length()));
+}
+
+// Необязательный режим сравнения после образца: EXACT (по умолчанию),
+// PREFIX или SUBSTR
+static bool parseMatchMode(const CommandTokens& args, size_t position, MatchMode& mode) {
+    mode = MatchMode::EXACT;
+    if (args.size() <= position) {
+        return true;
+    }
+    if (isKeyword(args[position], "EXACT")) {
+        mode = MatchMode::EXACT;
+    } else if (isKeyword(args[position], "PREFIX")) {
+        mode = MatchMode::PREFIX;
+    } else if (isKeyword(args[position], "SUBSTR")) {
+        mode = MatchMode::SUBSTRING;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void Database::handleMFind(const CommandTokens& args, string& out) {
+    MatchMode mode;
+    if (args.size() < 3) {
+        out += "ERROR: MFIND requires pattern";
+        return;
+    }
+    if (!parseMatchMode(args, 3, mode)) {
+        out += "ERROR: Match mode must be EXACT, PREFIX or SUBSTR";
+        return;
+    }
+    auto* container = findContainer<Array>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Array not found: ").append(args[1]);
+        return;
+    }
+    int index = container->find(args[2], mode);
+    if (index >= 0) {
+        out.append("INDEX: ").append(to_string(index));
+    } else {
+        out += "NOT_FOUND";
+    }
+}
+
+void Database::handleMCount(const CommandTokens& args, string& out) {
+    MatchMode mode;
+    if (args.size() < 3) {
+        out += "ERROR: MCOUNT requires pattern";
+        return;
+    }
+    if (!parseMatchMode(args, 3, mode)) {
+        out += "ERROR: Match mode must be EXACT, PREFIX or SUBSTR";
+        return;
+    }
+    auto* container = findContainer<Array>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Array not found: ").append(args[1]);
+        return;
+    }
+    out.append("COUNT: ").append(to_string(container->count_matches(args[2], mode, query_threads)));
+}
+
+// MFILTER <name> <pattern> [EXACT|PREFIX|SUBSTR] [LIMIT n]: строка
+// "[индекс] значение" на каждое совпадение и их число в конце
+void Database::handleMFilter(const CommandTokens& args, string& out) {
+    MatchMode mode;
+    if (args.size() < 3) {
+        out += "ERROR: MFILTER requires pattern";
+        return;
+    }
+    size_t position = 3;
+    if (args.size() > position && !isKeyword(args[position], "LIMIT")) {
+        if (!parseMatchMode(args, position, mode)) {
+            out += "ERROR: Match mode must be EXACT, PREFIX or SUBSTR";
+            return;
+        }
+        ++position;
+    } else {
+        mode = MatchMode::EXACT;
+    }
+    size_t limit = SIZE_MAX;
+    if (args.size() > position) {
+        int parsed;
+        if (!isKeyword(args[position], "LIMIT") || args.size() <= position + 1 || !parseInt(args[position + 1], parsed) ||
+            parsed < 0) {
+            out += "ERROR: MFILTER expects LIMIT <count>";
+            return;
+        }
+        limit = static_cast<size_t>(parsed);
+    }
+    auto* container = findContainer<Array>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Array not found: ").append(args[1]);
+        return;
+    }
+    vector<int> indices = container->filter(args[2], mode, limit, query_threads);
+    for (int index : indices) {
+        out.append("[").append(to_string(index)).append("] ").append(container->view(index)).append("\n");
+    }
+    out.append("MATCHES: ").append(to_string(indices.size()));
+}
+
+void Database::handleMSort(const CommandTokens& args, string& out) {
+    auto* container = findContainer<Array>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Array not found: ").append(args[1]);
+        return;
+    }
+    container->sort(query_threads);
+    out += "SUCCESS: Array sorted";
+}
+
+// MSORTED <name> [STABLE]: номера значений в порядке возрастания, массив не меняется
+void Database::handleMSorted(const CommandTokens& args, string& out) {
+    bool stable = false;
+    if (args.size() >= 3) {
+        if (!isKeyword(args[2], "STABLE")) {
+            out += "ERROR: MSORTED accepts only STABLE";
+            return;
+        }
+        stable = true;
+    }
+    auto* container = findContainer<Array>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Array not found: ").append(args[1]);
+        return;
+    }
+    vector<int> order = container->sorted_order(stable, query_threads);
+    out.reserve(out.size() + 8 + order.size() * 8);
+    out += "ORDER:";
+    for (int index : order) {
+        out.append(" ").append(to_string(index));
+    }
+}
+
+// ========== Односвязные списки (F) ==========
+
+void Database::handleFCreate(const CommandTokens& args, string& out) {
+    createContainer<SingleList>(args[1], "Singly list", out);
+}
+
+void Database::handleFPush(const CommandTokens& args, string& out) {
+    if (args.size() < 4) {
+        out += "ERROR: FPUSH requires type and value";
+        return;
+    }
+    SingleList* list = findContainer<SingleList>(args[1]);
+    if (list == nullptr) {
+        out.append("ERROR: Singly list not found: ").append(args[1]);
+        return;
+    }
+
+    string_view push_type = args[2];
+
+    if (isKeyword(push_type, "FRONT")) {
+        list->push_front(string(args[3]));
+        out += "SUCCESS: Value pushed to front";
+    }
+    else if (isKeyword(push_type, "BACK")) {
+        list->push_back(string(args[3]));
+        out += "SUCCESS: Value pushed to back";
+    }
+    else if (isKeyword(push_type, "BEFORE")) {
+        if (args.size() < 5) {
+            out += "ERROR: FPUSH BEFORE requires target value";
+            return;
         }
-        else if (cmd == "QPUSH" || cmd == "qpush") {
-            if (tokens.size() < 3) {
-                return "ERROR: QPUSH requires value";
-            }
-            if (queues.find(queue_name) == queues.end()) {
-                return "ERROR: Queue not found: " + queue_name;
-            }
-            queues[queue_name]->push(tokens[2]);
-            return "SUCCESS: Value pushed to queue";
+        if (list->insert_before(string(args[3]), string(args[4]))) {
+            out += "SUCCESS: Value inserted before target";
+        } else {
+            out += "ERROR: Target not found";
         }
-        else if (cmd == "QPOP" || cmd == "qpop") {
-            if (queues.find(queue_name) == queues.end()) {
-                return "ERROR: Queue not found: " + queue_name;
-            }
-            try {
-                string value = queues[queue_name]->pop();
-                if (!value.empty()) {
-                    return "POPPED: " + value;
-                } else {
-                    return "ERROR: Queue is empty";
-                }
-            } catch (const runtime_error& e) {
-                return "ERROR: Queue is empty";
-            }
+    }
+    else if (isKeyword(push_type, "AFTER")) {
+        if (args.size() < 5) {
+            out += "ERROR: FPUSH AFTER requires target value";
+            return;
         }
-        else if (cmd == "QPEEK" || cmd == "qpeek") {
-            if (queues.find(queue_name) == queues.end()) {
-                return "ERROR: Queue not found: " + queue_name;
-            }
-            try {
-                string value = queues[queue_name]->peek();
-                if (!value.empty()) {
-                    return "PEEK: " + value;
-                } else {
-                    return "ERROR: Queue is empty";
-                }
-            } catch (const runtime_error& e) {
-                return "ERROR: Queue is empty";
-            }
+        if (list->insert_after(string(args[3]), string(args[4]))) {
+            out += "SUCCESS: Value inserted after target";
+        } else {
+            out += "ERROR: Target not found";
         }
-        else if (cmd == "QSIZE" || cmd == "qsize") {
-            if (queues.find(queue_name) == queues.end()) {
-                return "ERROR: Queue not found: " + queue_name;
-            }
-            return "SIZE: " + to_string(queues[queue_name]->get_size());
+    }
+    else {
+        out += "ERROR: Invalid push type. Use FRONT/BACK/BEFORE/AFTER";
+    }
+}
+
+void Database::handleFDel(const CommandTokens& args, string& out) {
+    if (args.size() < 3) {
+        out += "ERROR: FDEL requires type";
+        return;
+    }
+    SingleList* list = findContainer<SingleList>(args[1]);
+    if (list == nullptr) {
+        out.append("ERROR: Singly list not found: ").append(args[1]);
+        return;
+    }
+
+    string_view del_type = args[2];
+
+    if (isKeyword(del_type, "FRONT")) {
+        if (list->pop_front()) {
+            out += "SUCCESS: Front element removed";
+        } else {
+            out += "ERROR: List is empty";
         }
     }
-    
-    // Обработка команд для деревьев (T)
-    else if (isTreeCommand(cmd)) {
-        if (tokens.size() < 2) {
-            return "ERROR: Tree command requires container name";
+    else if (isKeyword(del_type, "BACK")) {
+        if (list->pop_back()) {
+            out += "SUCCESS: Back element removed";
+        } else {
+            out += "ERROR: List is empty";
         }
-        
-        string tree_name = tokens[1];
-        
-        if (cmd == "TCREATE" || cmd == "tcreate") {
-            if (trees.find(tree_name) != trees.end()) {
-                return "ERROR: Tree already exists: " + tree_name;
-            }
-            trees[tree_name] = make_unique<FullBinaryTree>();
-            return "SUCCESS: Tree created: " + tree_name;
+    }
+    else if (isKeyword(del_type, "VALUE")) {
+        if (args.size() < 4) {
+            out += "ERROR: FDEL VALUE requires target value";
+            return;
         }
-        else if (cmd == "TINSERT" || cmd == "tinsert") {
-            if (tokens.size() < 4) {
-                return "ERROR: TINSERT requires key and value";
-            }
-            if (trees.find(tree_name) == trees.end()) {
-                return "ERROR: Tree not found: " + tree_name;
-            }
-            
-            try {
-                int key = stoi(tokens[2]);
-                if (trees[tree_name]->insert(key, tokens[3])) {
-                    return "SUCCESS: Value inserted with key " + tokens[2];
-                } else {
-                    return "ERROR: Failed to insert value (key might already exist)";
-                }
-            } catch (const exception& e) {
-                return "ERROR: Invalid key format";
-            }
+        if (list->remove_value(string(args[3]))) {
+            out += "SUCCESS: Value removed";
+        } else {
+            out += "ERROR: Value not found";
         }
-        else if (cmd == "TSEARCH" || cmd == "tsearch") {
-            if (tokens.size() < 3) {
-                return "ERROR: TSEARCH requires key";
-            }
-            if (trees.find(tree_name) == trees.end()) {
-                return "ERROR: Tree not found: " + tree_name;
-            }
-            
-            try {
-                int key = stoi(tokens[2]);
-                string value = trees[tree_name]->search(key);
-                if (!value.empty()) {
-                    return "FOUND: " + value;
-                } else {
-                    return "NOT_FOUND";
-                }
-            } catch (const exception& e) {
-                return "ERROR: Invalid key format";
-            }
+    }
+    else if (isKeyword(del_type, "BEFORE")) {
+        if (args.size() < 4) {
+            out += "ERROR: FDEL BEFORE requires target value";
+            return;
         }
-        else if (cmd == "TISFULL" || cmd == "tisfull") {
-            if (trees.find(tree_name) == trees.end()) {
-                return "ERROR: Tree not found: " + tree_name;
-            }
-            
-            bool is_full = trees[tree_name]->is_full();
-            return "IS_FULL: " + string(is_full ? "YES" : "NO");
+        if (list->remove_before(string(args[3]))) {
+            out += "SUCCESS: Element before target removed";
+        } else {
+            out += "ERROR: Cannot remove before target";
         }
-        else if (cmd == "THEIGHT" || cmd == "theight") {
-            if (trees.find(tree_name) == trees.end()) {
-                return "ERROR: Tree not found: " + tree_name;
-            }
-            
-            int height = trees[tree_name]->height();
-            return "HEIGHT: " + to_string(height);
+    }
+    else if (isKeyword(del_type, "AFTER")) {
+        if (args.size() < 4) {
+            out += "ERROR: FDEL AFTER requires target value";
+            return;
         }
-        else if (cmd == "TSIZE" || cmd == "tsize") {
-            if (trees.find(tree_name) == trees.end()) {
-                return "ERROR: Tree not found: " + tree_name;
-            }
-            
-            return "SIZE: " + to_string(trees[tree_name]->get_size());
+        if (list->remove_after(string(args[3]))) {
+            out += "SUCCESS: Element after target removed";
+        } else {
+            out += "ERROR: Cannot remove after target";
         }
-        else if (cmd == "TTRAVERSE" || cmd == "ttraverse") {
-            if (tokens.size() < 3) {
-                return "ERROR: TTRAVERSE requires type (INORDER/PREORDER/POSTORDER/LEVEL)";
-            }
-            if (trees.find(tree_name) == trees.end()) {
-                return "ERROR: Tree not found: " + tree_name;
-            }
-            
-            string traverse_type = tokens[2];
-            
-            if (traverse_type == "INORDER" || traverse_type == "inorder") {
-                trees[tree_name]->inorder();
-                return "SUCCESS";
-            }
-            else if (traverse_type == "PREORDER" || traverse_type == "preorder") {
-                trees[tree_name]->preorder();
-                return "SUCCESS";
-            }
-            else if (traverse_type == "POSTORDER" || traverse_type == "postorder") {
-                trees[tree_name]->postorder();
-                return "SUCCESS";
-            }
-            else if (traverse_type == "LEVEL" || traverse_type == "level") {
-                trees[tree_name]->level_order();
-                return "SUCCESS";
-            }
-            else {
-                return "ERROR: Invalid traverse type. Use INORDER/PREORDER/POSTORDER/LEVEL";
-            }
+    }
+    else {
+        out += "ERROR: Invalid delete type. Use FRONT/BACK/VALUE/BEFORE/AFTER";
+    }
+}
+
+void Database::handleFGet(const CommandTokens& args, string& out) {
+    SingleList* list = findContainer<SingleList>(args[1]);
+    if (list == nullptr) {
+        out.append("ERROR: Singly list not found: ").append(args[1]);
+        return;
+    }
+
+    if (args.size() == 2) {
+        out += "LIST: ";
+        for (auto it = list->begin(); it != list->end();) {
+            out += *it;
+            if (++it != list->end()) out += " -> ";
         }
     }
-    
-    // Обработка команд для двойных хэш-таблиц (H)
-    else if (isDoubleHashTableCommand(cmd)) {
-        if (tokens.size() < 2) {
-            return "ERROR: Double hash table command requires container name";
+    else if (args.size() == 3) {
+        SNode* found = list->find(string(args[2]));
+        if (found) {
+            out.append("FOUND: ").append(found->data);
+        } else {
+            out += "NOT_FOUND";
         }
-        
-        string table_name = tokens[1];
-        
-        if (cmd == "HCREATE" || cmd == "hcreate") {
-            if (double_hash_tables.find(table_name) != double_hash_tables.end()) {
-                return "ERROR: Double hash table already exists: " + table_name;
-            }
-            double_hash_tables[table_name] = make_unique<DoubleHashTable>(10);
-            return "SUCCESS: Double hash table created: " + table_name;
+    }
+    else {
+        out += "ERROR: FGET requires either no arguments (to display list) or one argument (to search)";
+    }
+}
+
+void Database::handleFSize(const CommandTokens& args, string& out) {
+    auto* container = findContainer<SingleList>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Singly list not found: ").append(args[1]);
+        return;
+    }
+    out.append("SIZE: ").append(to_string(container->get_size()));
+}
+
+void Database::handleFPrintBackward(const CommandTokens& args, string& out) {
+    auto* container = findContainer<SingleList>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Singly list not found: ").append(args[1]);
+        return;
+    }
+    BufferSink sink(out);
+    TextWriter text(sink);
+    container->print_backward(text);
+    text.flush();
+    out += "SUCCESS";
+}
+
+void Database::handleFIndex(const CommandTokens& args, string& out) {
+    switchValueIndex<SingleList>(args, "Singly list", out);
+}
+
+// ========== Двусвязные списки (L) ==========
+
+void Database::handleLCreate(const CommandTokens& args, string& out) {
+    createContainer<DoubleList>(args[1], "Doubly list", out);
+}
+
+void Database::handleLPush(const CommandTokens& args, string& out) {
+    if (args.size() < 4) {
+        out += "ERROR: LPUSH requires type and value";
+        return;
+    }
+    DoubleList* list = findContainer<DoubleList>(args[1]);
+    if (list == nullptr) {
+        out.append("ERROR: Doubly list not found: ").append(args[1]);
+        return;
+    }
+
+    string_view push_type = args[2];
+
+    if (isKeyword(push_type, "FRONT")) {
+        list->push_front(string(args[3]));
+        out += "SUCCESS: Value pushed to front";
+    }
+    else if (isKeyword(push_type, "BACK")) {
+        list->push_back(string(args[3]));
+        out += "SUCCESS: Value pushed to back";
+    }
+    else if (isKeyword(push_type, "BEFORE")) {
+        if (args.size() < 5) {
+            out += "ERROR: LPUSH BEFORE requires target value";
+            return;
         }
-        else if (cmd == "HINSERT" || cmd == "hinsert") {
-            if (tokens.size() < 4) {
-                return "ERROR: HINSERT requires key and value";
-            }
-            if (double_hash_tables.find(table_name) == double_hash_tables.end()) {
-                return "ERROR: Double hash table not found: " + table_name;
-            }
-            if (double_hash_tables[table_name]->insert(tokens[2], tokens[3])) {
-                return "SUCCESS: Key-Value inserted";
-            } else {
-                return "ERROR: Failed to insert";
-            }
+        if (list->insert_before(string(args[3]), string(args[4]))) {
+            out += "SUCCESS: Value inserted before target";
+        } else {
+            out += "ERROR: Target not found";
         }
-        else if (cmd == "HSEARCH" || cmd == "hsearch") {
-            if (tokens.size() < 3) {
-                return "ERROR: HSEARCH requires key";
-            }
-            if (double_hash_tables.find(table_name) == double_hash_tables.end()) {
-                return "ERROR: Double hash table not found: " + table_name;
-            }
-            string value = double_hash_tables[table_name]->search(tokens[2]);
-            if (!value.empty()) {
-                return "FOUND: " + value;
-            } else {
-                return "NOT_FOUND";
-            }
+    }
+    else if (isKeyword(push_type, "AFTER")) {
+        if (args.size() < 5) {
+            out += "ERROR: LPUSH AFTER requires target value";
+            return;
         }
-        else if (cmd == "HDELETE" || cmd == "hdelete") {
-            if (tokens.size() < 3) {
-                return "ERROR: HDELETE requires key";
-            }
-            if (double_hash_tables.find(table_name) == double_hash_tables.end()) {
-                return "ERROR: Double hash table not found: " + table_name;
-            }
-            if (double_hash_tables[table_name]->remove(tokens[2])) {
-                return "SUCCESS: Key deleted";
-            } else {
-                return "ERROR: Key not found";
-            }
+        if (list->insert_after(string(args[3]), string(args[4]))) {
+            out += "SUCCESS: Value inserted after target";
+        } else {
+            out += "ERROR: Target not found";
         }
-        else if (cmd == "HPRINT" || cmd == "hprint") {
-            if (double_hash_tables.find(table_name) == double_hash_tables.end()) {
-                return "ERROR: Double hash table not found: " + table_name;
-            }
-            double_hash_tables[table_name]->print();
-            return "SUCCESS";
+    }
+    else {
+        out += "ERROR: Invalid push type. Use FRONT/BACK/BEFORE/AFTER";
+    }
+}
+
+void Database::handleLDel(const CommandTokens& args, string& out) {
+    if (args.size() < 3) {
+        out += "ERROR: LDEL requires type";
+        return;
+    }
+    DoubleList* list = findContainer<DoubleList>(args[1]);
+    if (list == nullptr) {
+        out.append("ERROR: Doubly list not found: ").append(args[1]);
+        return;
+    }
+
+    string_view del_type = args[2];
+
+    if (isKeyword(del_type, "FRONT")) {
+        if (list->pop_front()) {
+            out += "SUCCESS: Front element removed";
+        } else {
+            out += "ERROR: List is empty";
         }
-        else if (cmd == "HSIZE" || cmd == "hsize") {
-            if (double_hash_tables.find(table_name) == double_hash_tables.end()) {
-                return "ERROR: Double hash table not found: " + table_name;
-            }
-            return "SIZE: " + to_string(double_hash_tables[table_name]->get_size());
+    }
+    else if (isKeyword(del_type, "BACK")) {
+        if (list->pop_back()) {
+            out += "SUCCESS: Back element removed";
+        } else {
+            out += "ERROR: List is empty";
         }
     }
-    
-    // Команды управления базой данных
-    else if (cmd == "SAVE" || cmd == "save") {
-        if (tokens.size() < 2) {
-            return "ERROR: SAVE requires filename";
+    else if (isKeyword(del_type, "VALUE")) {
+        if (args.size() < 4) {
+            out += "ERROR: LDEL VALUE requires target value";
+            return;
         }
-        if (saveToFile(tokens[1])) {
-            return "SUCCESS: Database saved to " + tokens[1];
+        if (list->remove_value(string(args[3]))) {
+            out += "SUCCESS: Value removed";
         } else {
-            return "ERROR: Failed to save database";
+            out += "ERROR: Value not found";
         }
     }
-    else if (cmd == "LOAD" || cmd == "load") {
-        if (tokens.size() < 2) {
-            return "ERROR: LOAD requires filename";
+    else if (isKeyword(del_type, "BEFORE")) {
+        if (args.size() < 4) {
+            out += "ERROR: LDEL BEFORE requires target value";
+            return;
         }
-        if (loadFromFile(tokens[1])) {
-            return "SUCCESS: Database loaded from " + tokens[1];
+        if (list->remove_before(string(args[3]))) {
+            out += "SUCCESS: Element before target removed";
         } else {
-            return "ERROR: Failed to load database";
+            out += "ERROR: Cannot remove before target";
         }
     }
-    else if (cmd == "HELP" || cmd == "help") {
-        return Database::getHelpText();
-    }
-    else if (cmd == "CLEAR" || cmd == "clear") {
-        clear();
-        return "SUCCESS: Database cleared";
-    }
-    else if (cmd == "LIST" || cmd == "list") {
-        string result = "CONTAINERS:\n";
-        bool hasContainers = false;
-        
-        if (!arrays.empty()) {
-            result += "Arrays:\n";
-            for (const auto& pair : arrays) {
-                result += "  " + pair.first + "\n";
-            }
-            result += "\n";
+    else if (isKeyword(del_type, "AFTER")) {
+        if (args.size() < 4) {
+            out += "ERROR: LDEL AFTER requires target value";
+            return;
         }
-        
-        if (!singly_lists.empty()) {
-            result += "Singly Linked Lists: ";
-            for (const auto& pair : singly_lists) {
-                result += pair.first + " ";
-            }
-            result += "\n";
-        }
-        
-        if (!doubly_lists.empty()) {
-            result += "Doubly Linked Lists: ";
-            for (const auto& pair : doubly_lists) {
-                result += pair.first + " ";
-            }
-            result += "\n";
+        if (list->remove_after(string(args[3]))) {
+            out += "SUCCESS: Element after target removed";
+        } else {
+            out += "ERROR: Cannot remove after target";
         }
-        
-        if (!stacks.empty()) {
-            result += "Stacks: ";
-            for (const auto& pair : stacks) {
-                result += pair.first + " ";
-            }
-            result += "\n";
+    }
+    else {
+        out += "ERROR: Invalid delete type. Use FRONT/BACK/VALUE/BEFORE/AFTER";
+    }
+}
+
+void Database::handleLGet(const CommandTokens& args, string& out) {
+    DoubleList* list = findContainer<DoubleList>(args[1]);
+    if (list == nullptr) {
+        out.append("ERROR: Doubly list not found: ").append(args[1]);
+        return;
+    }
+
+    if (args.size() == 2) {
+        out += "LIST: ";
+        for (auto it = list->begin(); it != list->end();) {
+            out += *it;
+            if (++it != list->end()) out += " <-> ";
         }
-        
-        if (!queues.empty()) {
-            result += "Queues: ";
-            for (const auto& pair : queues) {
-                result += pair.first + " ";
-            }
-            result += "\n";
+    }
+    else if (args.size() == 3) {
+        DNode* found = list->find(string(args[2]));
+        if (found) {
+            out.append("FOUND: ").append(found->data);
+        } else {
+            out += "NOT_FOUND";
         }
-        
-        if (!trees.empty()) {
-            result += "Trees: ";
-            for (const auto& pair : trees) {
-                result += pair.first + " ";
-            }
-            result += "\n";
+    }
+    else {
+        out += "ERROR: LGET requires either no arguments (to display list) or one argument (to search)";
+    }
+}
+
+void Database::handleLSize(const CommandTokens& args, string& out) {
+    auto* container = findContainer<DoubleList>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Doubly list not found: ").append(args[1]);
+        return;
+    }
+    out.append("SIZE: ").append(to_string(container->get_size()));
+}
+
+void Database::handleLPrintBackward(const CommandTokens& args, string& out) {
+    auto* container = findContainer<DoubleList>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Doubly list not found: ").append(args[1]);
+        return;
+    }
+    BufferSink sink(out);
+    TextWriter text(sink);
+    container->print_backward(text);
+    text.flush();
+    out += "SUCCESS";
+}
+
+void Database::handleLIndex(const CommandTokens& args, string& out) {
+    switchValueIndex<DoubleList>(args, "Doubly list", out);
+}
+
+// ========== Стеки (S) ==========
+
+void Database::handleSCreate(const CommandTokens& args, string& out) {
+    createContainer<Stack>(args[1], "Stack", out);
+}
+
+void Database::handleSPush(const CommandTokens& args, string& out) {
+    if (args.size() < 3) {
+        out += "ERROR: SPUSH requires value";
+        return;
+    }
+    auto* container = findContainer<Stack>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Stack not found: ").append(args[1]);
+        return;
+    }
+    container->push(string(args[2]));
+    out += "SUCCESS: Value pushed to stack";
+}
+
+void Database::handleSPop(const CommandTokens& args, string& out) {
+    auto* container = findContainer<Stack>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Stack not found: ").append(args[1]);
+        return;
+    }
+    try {
+        string value = container->pop();
+        if (!value.empty()) {
+            out.append("POPPED: ").append(value);
+            return;
+        } else {
+            out += "ERROR: Stack is empty";
+            return;
         }
-        
-        if (!double_hash_tables.empty()) {
-            result += "Double Hash Tables: ";
-            for (const auto& pair : double_hash_tables) {
-                result += pair.first + " ";
-            }
-            result += "\n";
+    } catch (const runtime_error& e) {
+        out += "ERROR: Stack is empty";
+    }
+}
+
+void Database::handleSPeek(const CommandTokens& args, string& out) {
+    auto* container = findContainer<Stack>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Stack not found: ").append(args[1]);
+        return;
+    }
+    try {
+        string value = container->peek();
+        if (!value.empty()) {
+            out.append("PEEK: ").append(value);
+            return;
+        } else {
+            out += "ERROR: Stack is empty";
+            return;
         }
-        
-        if (!cuckoo_hash_tables.empty()) {
-            result += "Cuckoo Hash Tables: ";
-            for (const auto& pair : cuckoo_hash_tables) {
-                result += pair.first + " ";
-            }
-            result += "\n";
+    } catch (const runtime_error& e) {
+        out += "ERROR: Stack is empty";
+    }
+}
+
+void Database::handleSSize(const CommandTokens& args, string& out) {
+    auto* container = findContainer<Stack>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Stack not found: ").append(args[1]);
+        return;
+    }
+    out.append("SIZE: ").append(to_string(container->get_size()));
+}
+
+// ========== Очереди (Q) ==========
+
+void Database::handleQCreate(const CommandTokens& args, string& out) {
+    createContainer<Queue>(args[1], "Queue", out);
+}
+
+void Database::handleQPush(const CommandTokens& args, string& out) {
+    if (args.size() < 3) {
+        out += "ERROR: QPUSH requires value";
+        return;
+    }
+    auto* container = findContainer<Queue>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Queue not found: ").append(args[1]);
+        return;
+    }
+    container->push(string(args[2]));
+    out += "SUCCESS: Value pushed to queue";
+}
+
+void Database::handleQPop(const CommandTokens& args, string& out) {
+    auto* container = findContainer<Queue>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Queue not found: ").append(args[1]);
+        return;
+    }
+    try {
+        string value = container->pop();
+        if (!value.empty()) {
+            out.append("POPPED: ").append(value);
+            return;
+        } else {
+            out += "ERROR: Queue is empty";
+            return;
         }
-        
-        if (result == "CONTAINERS:\n") {
-            result += "No containers found.";
+    } catch (const runtime_error& e) {
+        out += "ERROR: Queue is empty";
+    }
+}
+
+void Database::handleQPeek(const CommandTokens& args, string& out) {
+    auto* container = findContainer<Queue>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Queue not found: ").append(args[1]);
+        return;
+    }
+    try {
+        string value = container->peek();
+        if (!value.empty()) {
+            out.append("PEEK: ").append(value);
+            return;
+        } else {
+            out += "ERROR: Queue is empty";
+            return;
         }
-        
-        return result;
+    } catch (const runtime_error& e) {
+        out += "ERROR: Queue is empty";
+    }
+}
+
+void Database::handleQSize(const CommandTokens& args, string& out) {
+    auto* container = findContainer<Queue>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Queue not found: ").append(args[1]);
+        return;
+    }
+    out.append("SIZE: ").append(to_string(container->get_size()));
+}
+
+// ========== Деревья (T) ==========
+
+void Database::handleTCreate(const CommandTokens& args, string& out) {
+    createContainer<FullBinaryTree>(args[1], "Tree", out);
+}
+
+void Database::handleTInsert(const CommandTokens& args, string& out) {
+    if (args.size() < 4) {
+        out += "ERROR: TINSERT requires key and value";
+        return;
+    }
+    auto* container = findContainer<FullBinaryTree>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Tree not found: ").append(args[1]);
+        return;
+    }
+    int key;
+    if (!parseInt(args[2], key)) {
+        out += "ERROR: Invalid key format";
+        return;
+    }
+    if (container->insert(key, string(args[3]))) {
+        out.append("SUCCESS: Value inserted with key ").append(args[2]);
+    } else {
+        out += "ERROR: Failed to insert value (key might already exist)";
+    }
+}
+
+void Database::handleTSearch(const CommandTokens& args, string& out) {
+    if (args.size() < 3) {
+        out += "ERROR: TSEARCH requires key";
+        return;
+    }
+    auto* container = findContainer<FullBinaryTree>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Tree not found: ").append(args[1]);
+        return;
+    }
+    int key;
+    if (!parseInt(args[2], key)) {
+        out += "ERROR: Invalid key format";
+        return;
+    }
+    string value = container->search(key);
+    if (!value.empty()) {
+        out.append("FOUND: ").append(value);
+    } else {
+        out += "NOT_FOUND";
+    }
+}
+
+void Database::handleTIsFull(const CommandTokens& args, string& out) {
+    auto* container = findContainer<FullBinaryTree>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Tree not found: ").append(args[1]);
+        return;
+    }
+    bool is_full = container->is_full();
+    out.append("IS_FULL: ").append(string(is_full ? "YES" : "NO"));
+}
+
+void Database::handleTHeight(const CommandTokens& args, string& out) {
+    auto* container = findContainer<FullBinaryTree>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Tree not found: ").append(args[1]);
+        return;
+    }
+    out.append("HEIGHT: ").append(to_string(container->height()));
+}
+
+void Database::handleTSize(const CommandTokens& args, string& out) {
+    auto* container = findContainer<FullBinaryTree>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Tree not found: ").append(args[1]);
+        return;
+    }
+    out.append("SIZE: ").append(to_string(container->get_size()));
+}
+
+void Database::handleTTraverse(const CommandTokens& args, string& out) {
+    if (args.size() < 3) {
+        out += "ERROR: TTRAVERSE requires type (INORDER/PREORDER/POSTORDER/LEVEL)";
+        return;
+    }
+    FullBinaryTree* tree = findContainer<FullBinaryTree>(args[1]);
+    if (tree == nullptr) {
+        out.append("ERROR: Tree not found: ").append(args[1]);
+        return;
+    }
+
+    string_view traverse_type = args[2];
+    BufferSink sink(out);
+    TextWriter text(sink);
+
+    if (isKeyword(traverse_type, "INORDER")) {
+        tree->inorder(text);
+    }
+    else if (isKeyword(traverse_type, "PREORDER")) {
+        tree->preorder(text);
+    }
+    else if (isKeyword(traverse_type, "POSTORDER")) {
+        tree->postorder(text);
+    }
+    else if (isKeyword(traverse_type, "LEVEL")) {
+        tree->level_order(text);
+    }
+    else {
+        out += "ERROR: Invalid traverse type. Use INORDER/PREORDER/POSTORDER/LEVEL";
+        return;
+    }
+    text.flush();
+    out += "SUCCESS";
+}
+
+// ========== Хэш-таблицы (H) ==========
+
+void Database::handleHCreate(const CommandTokens& args, string& out) {
+    createContainer<DoubleHashTable>(args[1], "Double hash table", out);
+}
+
+void Database::handleHInsert(const CommandTokens& args, string& out) {
+    if (args.size() < 4) {
+        out += "ERROR: HINSERT requires key and value";
+        return;
+    }
+    auto* container = findContainer<DoubleHashTable>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Double hash table not found: ").append(args[1]);
+        return;
+    }
+    if (container->insert(string(args[2]), string(args[3]))) {
+        out += "SUCCESS: Key-Value inserted";
+    } else {
+        out += "ERROR: Failed to insert";
+    }
+}
+
+void Database::handleHSearch(const CommandTokens& args, string& out) {
+    if (args.size() < 3) {
+        out += "ERROR: HSEARCH requires key";
+        return;
+    }
+    auto* container = findContainer<DoubleHashTable>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Double hash table not found: ").append(args[1]);
+        return;
+    }
+    string value = container->search(string(args[2]));
+    if (!value.empty()) {
+        out.append("FOUND: ").append(value);
+    } else {
+        out += "NOT_FOUND";
+    }
+}
+
+void Database::handleHDelete(const CommandTokens& args, string& out) {
+    if (args.size() < 3) {
+        out += "ERROR: HDELETE requires key";
+        return;
+    }
+    auto* container = findContainer<DoubleHashTable>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Double hash table not found: ").append(args[1]);
+        return;
+    }
+    if (container->remove(string(args[2]))) {
+        out += "SUCCESS: Key deleted";
+    } else {
+        out += "ERROR: Key not found";
+    }
+}
+
+void Database::handleHPrint(const CommandTokens& args, string& out) {
+    auto* container = findContainer<DoubleHashTable>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Double hash table not found: ").append(args[1]);
+        return;
+    }
+    BufferSink sink(out);
+    TextWriter text(sink);
+    container->print(text);
+    text.flush();
+    out += "SUCCESS";
+}
+
+void Database::handleHSize(const CommandTokens& args, string& out) {
+    auto* container = findContainer<DoubleHashTable>(args[1]);
+    if (container == nullptr) {
+        out.append("ERROR: Double hash table not found: ").append(args[1]);
+        return;
     }
-    
-    // Обработка неизвестных команд
-    return "ERROR: Unknown command: " + cmd;
+    out.append("SIZE: ").append(to_string(container->get_size()));
 }
 
 // ========== Статические методы ==========
@@ -1270,8 +2222,17 @@ string Database::getHelpText() {
            "  PRINT <container>         - Print any container\n"
            "  LIST                      - List all containers\n"
            "  SAVE <filename>           - Save database to file\n"
-           "  LOAD <filename>           - Load database from file\n"
+           "  BGSAVE <filename>         - Save database in background\n"
+           "  LOAD <filename>           - Load database from file (not with a journal)\n"
            "  CLEAR                     - Clear all containers\n"
+           "  TYPE <container>          - Show container type\n"
+           "  EXISTS <container>        - Check if container exists\n"
+           "  DEL <container>           - Delete container\n"
+           "  RENAME <old> <new>        - Rename container\n"
+           "  STATS [JSON|PROMETHEUS|RESET] - Command and container statistics\n"
+           "  INFO                      - Database summary\n"
+           "  SLOWLOG GET [N]|LEN|RESET|THRESHOLD [us|OFF] - Slow command log\n"
+           "  MEMORY USAGE <name>|STATS - Exact memory use of a container or of the database\n"
            "  HELP                      - Show this help\n\n"
            
            "ARRAYS (M):\n"
@@ -1281,7 +2242,12 @@ string Database::getHelpText() {
            "  MGET <name> <idx>         - Get value at index\n"
            "  MDEL <name> <idx>         - Delete value at index\n"
            "  MREPLACE <name> <idx> <val>- Replace value at index\n"
-           "  MSIZE <name>              - Get array size\n\n"
+           "  MSIZE <name>              - Get array size\n"
+           "  MFIND <name> <pattern> [EXACT|PREFIX|SUBSTR] - Index of first match\n"
+           "  MCOUNT <name> <pattern> [EXACT|PREFIX|SUBSTR] - Number of matches\n"
+           "  MFILTER <name> <pattern> [EXACT|PREFIX|SUBSTR] [LIMIT n] - Matching values\n"
+           "  MSORT <name>              - Sort array in place\n"
+           "  MSORTED <name> [STABLE]   - Indices of values in sorted order\n\n"
            
            "SINGLY LINKED LISTS (F):\n"
            "  FCREATE <name>            - Create new list\n"
@@ -1297,7 +2263,8 @@ string Database::getHelpText() {
            "  FGET <name>               - Display entire list\n"
            "  FGET <name> <value>       - Search for value\n"
            "  FSIZE <name>              - Get list size\n"
-           "  FPRINT_BACKWARD <name>    - Print list backwards\n\n"
+           "  FPRINT_BACKWARD <name>    - Print list backwards\n"
+           "  FINDEX <name> ON|OFF      - Value index for O(1) search/insert/remove\n\n"
            
            "DOUBLY LINKED LISTS (L):\n"
            "  LCREATE <name>            - Create new list\n"
@@ -1313,7 +2280,8 @@ string Database::getHelpText() {
            "  LGET <name>               - Display entire list\n"
            "  LGET <name> <value>       - Search for value\n"
            "  LSIZE <name>              - Get list size\n"
-           "  LPRINT_BACKWARD <name>    - Print list backwards\n\n"
+           "  LPRINT_BACKWARD <name>    - Print list backwards\n"
+           "  LINDEX <name> ON|OFF      - Value index for O(1) search/insert/remove\n\n"
            
            "STACKS (S):\n"
            "  SCREATE <name>            - Create new stack\n"
@@ -1347,5 +2315,5 @@ string Database::getHelpText() {
            "  HSEARCH <name> <key>      - Search by key\n"
            "  HDELETE <name> <key>      - Delete by key\n"
            "  HPRINT <name>             - Print hash table\n"
-           "  HSIZE <name>              - Get hash table size\n\n"
+           "  HSIZE <name>              - Get hash table size\n\n";
 }
\ No newline at end of file
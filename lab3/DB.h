@@ -1,10 +1,16 @@
 #ifndef DB_H
 #define DB_H
 
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 #include <memory>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+
+#include <sys/types.h>
 
 using namespace std;
 
@@ -16,27 +22,273 @@ using namespace std;
 #include "Queue.h"
 #include "FullBinaryTree.h"
 #include "HashTable.h"
+#include "Command.h"
+#include "ContainerIndex.h"
+#include "Journal.h"
+#include "Snapshot.h"
+#include "Stats.h"
+
+// Итоги MEMORY STATS по типам контейнеров в порядке ContainerType; итоги
+// шардов складываются в итог всей базы
+struct MemorySummary {
+    static constexpr size_t TYPE_COUNT = static_cast<size_t>(ContainerType::HASH_TABLE) + 1;
+    array<size_t, TYPE_COUNT> counts{};
+    array<size_t, TYPE_COUNT> elements{};
+    array<MemoryUsage, TYPE_COUNT> usage{};
+    MemoryUsage index;
+
+    MemorySummary& operator+=(const MemorySummary& other) {
+        for (size_t type = 0; type < TYPE_COUNT; ++type) {
+            counts[type] += other.counts[type];
+            elements[type] += other.elements[type];
+            usage[type] += other.usage[type];
+        }
+        index += other.index;
+        return *this;
+    }
+};
+
+// Размер одного контейнера в отчете STATS
+struct ContainerStats {
+    string name;
+    ContainerType type = ContainerType::NONE;
+    size_t elements = 0;
+    size_t bytes = 0;
+};
+
+// Данные отчетов STATS и INFO; шардированная база собирает их с каждого
+// шарда и отчитывается по сумме
+struct StatsSummary {
+    unique_ptr<CommandStats> commands = make_unique<CommandStats>();
+    vector<ContainerStats> containers;
+    size_t index_bytes = 0;
+    bool journal = false;
+    bool concurrent = false;
+
+    StatsSummary& operator+=(const StatsSummary& other);
+};
 
 // Класс для управления базой данных контейнеров
 class Database {
 private:
-    unordered_map<string, unique_ptr<Array>> arrays;
-    unordered_map<string, unique_ptr<SingleList>> singly_lists;
-    unordered_map<string, unique_ptr<DoubleList>> doubly_lists;
-    unordered_map<string, unique_ptr<Stack>> stacks;
-    unordered_map<string, unique_ptr<Queue>> queues;
-    unordered_map<string, unique_ptr<FullBinaryTree>> trees;
-    unordered_map<string, unique_ptr<DoubleHashTable>> hash_tables;  
-
-    // Вспомогательные методы
-    vector<string> splitCommand(const string& command) const;
-    bool isArrayCommand(const string& cmd) const;
-    bool isSinglyListCommand(const string& cmd) const;
-    bool isDoublyListCommand(const string& cmd) const;
-    bool isStackCommand(const string& cmd) const;
-    bool isQueueCommand(const string& cmd) const;
-    bool isTreeCommand(const string& cmd) const;
-    bool isHashTableCommand(const string& cmd) const;  
+    // Все контейнеры в одном пространстве имен: имя -> тип + указатель
+    ContainerIndex containers;
+
+    using CommandHandler = void (Database::*)(const CommandTokens& args, string& out);
+
+    // Последний найденный контейнер: подряд идущие команды к одному и тому же
+    // контейнеру не ищут его в таблице заново. При перемещении кэш сбрасывается.
+    struct ResolvedContainer {
+        ContainerType type = ContainerType::NONE;
+        string name;
+        void* container = nullptr;
+
+        ResolvedContainer() = default;
+        ResolvedContainer(ResolvedContainer&&) noexcept {}
+        ResolvedContainer& operator=(ResolvedContainer&&) noexcept {
+            reset();
+            return *this;
+        }
+        void reset() {
+            type = ContainerType::NONE;
+            container = nullptr;
+        }
+    };
+
+    // Переиспользуемый буфер токенов текущей команды
+    CommandTokens tokens;
+    ResolvedContainer resolved;
+
+    // Конкурентный режим: общие буферы выше не используются, команды берут
+    // index_lock и блокировку своего контейнера (ContainerIndex::Entry::lock)
+    bool concurrent = false;
+
+    // Блокировка пространства имен; перемещенная база получает новую
+    struct IndexLock {
+        shared_mutex mutex;
+
+        IndexLock() = default;
+        IndexLock(IndexLock&&) noexcept {}
+        IndexLock& operator=(IndexLock&&) noexcept { return *this; }
+    };
+    IndexLock index_lock;
+
+    // Фоновый поток, который дожидается завершения при уничтожении и при
+    // перемещающем присваивании (иначе std::thread вызвал бы terminate)
+    struct BackgroundTask {
+        thread worker;
+
+        BackgroundTask() = default;
+        BackgroundTask(BackgroundTask&&) noexcept = default;
+        BackgroundTask& operator=(BackgroundTask&& other) noexcept {
+            join();
+            worker = move(other.worker);
+            return *this;
+        }
+        ~BackgroundTask() { join(); }
+        void join() {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    };
+
+    // Дочерний процесс фонового сохранения; при уничтожении и перемещающем
+    // присваивании его завершение дожидается так же, как у BackgroundTask
+    struct ChildProcess {
+        pid_t pid = -1;
+
+        ChildProcess() = default;
+        ChildProcess(ChildProcess&& other) noexcept : pid(other.pid) { other.pid = -1; }
+        ChildProcess& operator=(ChildProcess&& other) noexcept {
+            bool ok;
+            reap(true, ok);
+            pid = other.pid;
+            other.pid = -1;
+            return *this;
+        }
+        ~ChildProcess() {
+            bool ok;
+            reap(true, ok);
+        }
+
+        // Проверяет (block — дожидается), завершился ли процесс. true, если
+        // процесса больше нет; ok — завершился ли он успешно
+        bool reap(bool block, bool& ok);
+    };
+
+    ChildProcess background_save;
+    bool background_save_ok = true;
+
+    // Журнал изменений; сжатие объявлено после журнала и при уничтожении
+    // завершается раньше него (перемещающее присваивание ждет его явно)
+    unique_ptr<Journal> journal;
+    string journal_base;
+    BackgroundTask compaction;
+
+    // Счетчики и гистограммы задержек команд (STATS, INFO)
+    unique_ptr<CommandStats> stats = make_unique<CommandStats>();
+    bool stats_enabled = true;
+    // Журнал команд дольше порога (SLOWLOG)
+    unique_ptr<SlowLog> slow_log = make_unique<SlowLog>();
+
+    // Файл, с которым база синхронизирована для инкрементального сохранения
+    SnapshotFileState snapshot_file;
+
+    // Сколько потоков кодируют и разбирают секции снимка
+    size_t snapshot_threads = defaultSnapshotThreads();
+    // Сколько потоков обрабатывают большой массив в MCOUNT, MFILTER и MSORT
+    size_t query_threads = defaultSnapshotThreads();
+    static size_t defaultSnapshotThreads();
+
+    template <typename T>
+    const T* lookup(string_view name) const {
+        const ContainerHandle* handle = containers.find(name);
+        return handle != nullptr ? handle->get<T>() : nullptr;
+    }
+    template <typename T>
+    T* findContainer(string_view name);
+    template <typename T>
+    void createContainer(string_view name, const char* label, string& out);
+    // FINDEX/LINDEX: включает или выключает индекс значений списка
+    template <typename T>
+    void switchValueIndex(const CommandTokens& args, const char* label, string& out);
+    // dispatch замеряет время выполнения; execute и dispatchConcurrent
+    // возвращают код выполненной команды (UNKNOWN, если она не распознана)
+    void dispatch(string_view command, string& out);
+    Opcode execute(string_view command, string& out);
+    Opcode dispatchConcurrent(string_view command, string& out);
+    // Записывает медленную команду вместе с текущим размером ее контейнера
+    void recordSlowCommand(string_view command, uint64_t ticks);
+    // Разбирает команду; nullptr — ошибка уже записана в out. opcode известен,
+    // даже если у распознанной команды не хватает аргументов.
+    const CommandSpec* parseCommand(string_view command, CommandTokens& args, string& out, Opcode& opcode);
+    void runCommand(const CommandSpec& spec, string_view command, const CommandTokens& args, string& out);
+
+    // Таблица обработчиков, индексируемая кодом команды
+    static const array<CommandHandler, OPCODE_COUNT> command_handlers;
+    static array<CommandHandler, OPCODE_COUNT> makeCommandHandlers();
+
+    // Общие команды
+    void handlePrint(const CommandTokens& args, string& out);
+    void handleList(const CommandTokens& args, string& out);
+    void handleSave(const CommandTokens& args, string& out);
+    void handleBgSave(const CommandTokens& args, string& out);
+    void handleLoad(const CommandTokens& args, string& out);
+    void handleClear(const CommandTokens& args, string& out);
+    void handleHelp(const CommandTokens& args, string& out);
+    void handleStats(const CommandTokens& args, string& out);
+    void handleInfo(const CommandTokens& args, string& out);
+    void handleSlowLog(const CommandTokens& args, string& out);
+    void handleMemory(const CommandTokens& args, string& out);
+    void handleType(const CommandTokens& args, string& out);
+    void handleExists(const CommandTokens& args, string& out);
+    void handleDel(const CommandTokens& args, string& out);
+    void handleRename(const CommandTokens& args, string& out);
+
+    // Массивы (M)
+    void handleMCreate(const CommandTokens& args, string& out);
+    void handleMPush(const CommandTokens& args, string& out);
+    void handleMInsert(const CommandTokens& args, string& out);
+    void handleMGet(const CommandTokens& args, string& out);
+    void handleMDel(const CommandTokens& args, string& out);
+    void handleMReplace(const CommandTokens& args, string& out);
+    void handleMSize(const CommandTokens& args, string& out);
+    void handleMFind(const CommandTokens& args, string& out);
+    void handleMCount(const CommandTokens& args, string& out);
+    void handleMFilter(const CommandTokens& args, string& out);
+    void handleMSort(const CommandTokens& args, string& out);
+    void handleMSorted(const CommandTokens& args, string& out);
+
+    // Односвязные списки (F)
+    void handleFCreate(const CommandTokens& args, string& out);
+    void handleFPush(const CommandTokens& args, string& out);
+    void handleFDel(const CommandTokens& args, string& out);
+    void handleFGet(const CommandTokens& args, string& out);
+    void handleFSize(const CommandTokens& args, string& out);
+    void handleFPrintBackward(const CommandTokens& args, string& out);
+    void handleFIndex(const CommandTokens& args, string& out);
+
+    // Двусвязные списки (L)
+    void handleLCreate(const CommandTokens& args, string& out);
+    void handleLPush(const CommandTokens& args, string& out);
+    void handleLDel(const CommandTokens& args, string& out);
+    void handleLGet(const CommandTokens& args, string& out);
+    void handleLSize(const CommandTokens& args, string& out);
+    void handleLPrintBackward(const CommandTokens& args, string& out);
+    void handleLIndex(const CommandTokens& args, string& out);
+
+    // Стеки (S)
+    void handleSCreate(const CommandTokens& args, string& out);
+    void handleSPush(const CommandTokens& args, string& out);
+    void handleSPop(const CommandTokens& args, string& out);
+    void handleSPeek(const CommandTokens& args, string& out);
+    void handleSSize(const CommandTokens& args, string& out);
+
+    // Очереди (Q)
+    void handleQCreate(const CommandTokens& args, string& out);
+    void handleQPush(const CommandTokens& args, string& out);
+    void handleQPop(const CommandTokens& args, string& out);
+    void handleQPeek(const CommandTokens& args, string& out);
+    void handleQSize(const CommandTokens& args, string& out);
+
+    // Деревья (T)
+    void handleTCreate(const CommandTokens& args, string& out);
+    void handleTInsert(const CommandTokens& args, string& out);
+    void handleTSearch(const CommandTokens& args, string& out);
+    void handleTIsFull(const CommandTokens& args, string& out);
+    void handleTHeight(const CommandTokens& args, string& out);
+    void handleTSize(const CommandTokens& args, string& out);
+    void handleTTraverse(const CommandTokens& args, string& out);
+
+    // Хэш-таблицы (H)
+    void handleHCreate(const CommandTokens& args, string& out);
+    void handleHInsert(const CommandTokens& args, string& out);
+    void handleHSearch(const CommandTokens& args, string& out);
+    void handleHDelete(const CommandTokens& args, string& out);
+    void handleHPrint(const CommandTokens& args, string& out);
+    void handleHSize(const CommandTokens& args, string& out);
+
 public:
     Database() = default;
     ~Database() = default;
@@ -45,27 +297,98 @@ public:
     Database(const Database&) = delete;
     Database& operator=(const Database&) = delete;
     
-    // Разрешаем перемещение
+    // Разрешаем перемещение. Присваивание сначала дожидается сжатия: фоновый
+    // поток работает с журналом, который присваивание заменяет.
     Database(Database&&) = default;
-    Database& operator=(Database&&) = default;
+    Database& operator=(Database&& other) noexcept;
     
     // Управление базой данных
     bool saveToFile(const string& filename) const;
     bool loadFromFile(const string& filename);
+    // Сохраняет только контейнеры, измененные после последнего сохранения или
+    // загрузки этого же файла; в остальных случаях пишет снимок целиком.
+    // Используется командой SAVE.
+    bool saveIncremental(const string& filename);
+
+    // Фоновое сохранение (команда BGSAVE): fork() дает дочернему процессу
+    // копию памяти на момент вызова (copy-on-write), он пишет полный снимок,
+    // а эта база продолжает выполнять команды. false, если сохранение уже
+    // идет или процесс не удалось создать.
+    bool saveInBackground(const string& filename);
+    bool backgroundSaveInProgress();
+    // Дожидается фонового сохранения; возвращает результат последнего из них
+    bool waitForBackgroundSave();
     void clear();
+    // Число потоков для сохранения и загрузки (по умолчанию — по числу ядер);
+    // содержимое файла от него не зависит
+    void setSnapshotThreads(size_t threads) { snapshot_threads = threads == 0 ? 1 : threads; }
+    size_t snapshotThreads() const { return snapshot_threads; }
+    // Число потоков для MCOUNT, MFILTER, MSORT и MSORTED по большим массивам
+    // (по умолчанию — по числу ядер); массивы меньше 64K значений
+    // обрабатываются в одном потоке
+    void setQueryThreads(size_t threads) { query_threads = threads == 0 ? 1 : threads; }
+    size_t queryThreads() const { return query_threads; }
+
+    // Конкурентный режим: executeCommand и executeBatch можно вызывать из
+    // нескольких потоков. Читатели не блокируют друг друга, изменения одного
+    // контейнера не мешают работе с другими; CREATE, DEL, RENAME, CLEAR, SAVE
+    // и LOAD выполняются монопольно. Включается до того, как база станет
+    // общей; методы доступа к контейнерам (getArray...) не блокируются.
+    void setConcurrent(bool enabled) {
+        concurrent = enabled;
+        resolved.reset();
+    }
+    bool isConcurrent() const { return concurrent; }
+
+    // Статистика команд: число вызовов, ошибок и гистограмма задержек по
+    // каждому коду команды, плюс размер каждого контейнера. Запись стоит
+    // два чтения часов и несколько атомарных инкрементов на команду.
+    void setStatsEnabled(bool enabled) { stats_enabled = enabled; }
+    bool statsEnabled() const { return stats_enabled; }
+    const CommandStats* commandStats() const { return stats.get(); }
+    void resetStats() {
+        if (stats != nullptr) {
+            stats->reset();
+        }
+    }
+    // Отчет команды STATS в выбранном формате (JSON и Prometheus — для сбора
+    // метрик без отладчика)
+    void appendStats(StatsFormat format, string& out) const;
+    // Данные STATS и INFO этой базы (добавляются к result) и отчеты по ним
+    // (шардированная база строит отчеты по сумме данных шардов)
+    void collectStats(StatsSummary& result) const;
+    static void formatStats(const StatsSummary& summary, StatsFormat format, string& out);
+    static void formatInfo(const StatsSummary& summary, string& out);
+
+    // Журнал медленных команд: команды дольше порога (по умолчанию 10 мс)
+    // попадают в кольцевой буфер, откуда их читает SLOWLOG GET. Быстрые
+    // команды стоят лишь сравнения с порогом.
+    void setSlowLogThreshold(uint64_t micros) { slow_log->setThreshold(micros); }
+    void resetSlowLog() { slow_log->reset(); }
+    const SlowLog* slowLog() const { return slow_log.get(); }
+    // Ответ SLOWLOG GET для записей, упорядоченных от новых к старым
+    // (шардированная база сливает записи шардов по времени)
+    static void formatSlowLog(const vector<SlowLogEntry>& entries, string& out);
     
     // Интерфейс команд
-    string executeCommand(const string& command);
+    string executeCommand(string_view command);
+    // То же, но ответ дописывается в output без промежуточной строки
+    void executeCommand(string_view command, string& output);
+
+    // Пакетное выполнение: команды разделены переводом строки, результат каждой
+    // дописывается в output и завершается '\n'. Возвращает число выполненных команд.
+    size_t executeBatch(string_view commands, string& output);
+    size_t executeBatch(const string_view* commands, size_t count, string& output);
     
     // Методы для доступа к контейнерам (для тестирования)
-    bool hasArray(const string& name) const { return arrays.find(name) != arrays.end(); }
-    bool hasSinglyList(const string& name) const { return singly_lists.find(name) != singly_lists.end(); }
-    bool hasDoublyList(const string& name) const { return doubly_lists.find(name) != doubly_lists.end(); }
-    bool hasStack(const string& name) const { return stacks.find(name) != stacks.end(); }
-    bool hasQueue(const string& name) const { return queues.find(name) != queues.end(); }
-    bool hasTree(const string& name) const { return trees.find(name) != trees.end(); }
-    bool hasHashTable(const string& name) const { return hash_tables.find(name) != hash_tables.end(); } 
-    
+    bool hasArray(const string& name) const { return lookup<Array>(name) != nullptr; }
+    bool hasSinglyList(const string& name) const { return lookup<SingleList>(name) != nullptr; }
+    bool hasDoublyList(const string& name) const { return lookup<DoubleList>(name) != nullptr; }
+    bool hasStack(const string& name) const { return lookup<Stack>(name) != nullptr; }
+    bool hasQueue(const string& name) const { return lookup<Queue>(name) != nullptr; }
+    bool hasTree(const string& name) const { return lookup<FullBinaryTree>(name) != nullptr; }
+    bool hasHashTable(const string& name) const { return lookup<DoubleHashTable>(name) != nullptr; }
+
     // Геттеры (только для чтения)
     const Array* getArray(const string& name) const;
     const SingleList* getSinglyList(const string& name) const;
@@ -77,6 +400,37 @@ public:
 
     // Статические методы для помощи
     static string getHelpText();
+
+    // Перенос контейнера в другую базу (RENAME между шардами). В журнал не
+    // попадает. take возвращает пустой handle, если имени нет; adopt не
+    // трогает handle и возвращает false, если имя занято.
+    ContainerHandle takeContainer(string_view name);
+    bool adoptContainer(string_view name, ContainerHandle& handle);
+
+    // Имена и типы всех контейнеров и ответ LIST для такого набора (LIST
+    // собирает их из всех шардов)
+    void collectContainers(vector<pair<string, ContainerType>>& result) const;
+    static void formatContainerList(const vector<pair<string, ContainerType>>& items, string& out);
+
+    // Итоги MEMORY STATS по контейнерам этой базы (добавляются к result) и
+    // ответ для них (MEMORY STATS шардированной базы складывает итоги шардов)
+    void collectMemory(MemorySummary& result) const;
+    static void formatMemoryStats(const MemorySummary& summary, string& out);
+
+    // Журнал упреждающей записи. Открытие восстанавливает состояние: загружает
+    // последний снимок и проигрывает поверх него сегменты журнала. После этого
+    // каждая успешная изменяющая команда попадает в журнал до ответа.
+    bool openJournal(const string& base_path, FsyncPolicy policy = FsyncPolicy::INTERVAL,
+                     int interval_ms = 100);
+    void closeJournal();
+    bool hasJournal() const { return journal != nullptr; }
+    // Принудительно фиксирует на диске все записанные команды
+    bool syncJournal();
+
+    // Сворачивает снимок и закрытые сегменты в новый снимок в фоновом потоке,
+    // не останавливая обработку команд. false, если сжатие уже идет.
+    bool compactJournal();
+    void waitForCompaction();
 };
 
 #endif
\ No newline at end of file
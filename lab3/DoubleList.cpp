@@ -19,117 +19,112 @@ DoubleList::DoubleList(const DoubleList& other) {
     head = nullptr;
     tail = nullptr;
     size = 0;
+    set_value_index(other.has_value_index());
 
-    DNode* current = other.head;
-    while (current != nullptr) {
-        push_back(current->data);
-        current = current->next;
+    for (const string& value : other) {
+        push_back(value);
     }
 }
 
 DoubleList& DoubleList::operator=(const DoubleList& other) {
     if (this != &other) {
         clear();
-        DNode* current = other.head;
-        while (current != nullptr) {
-            push_back(current->data);
-            current = current->next;
+        set_value_index(other.has_value_index());
+        for (const string& value : other) {
+            push_back(value);
         }
     }
     return *this;
 }
 
 void DoubleList::clear() {
+    // Узлы разрушаются на месте, а память пула освобождается целыми блоками
     DNode* current = head;
     while (current != nullptr) {
         DNode* temp = current;
         current = current->next;
-        delete temp;
+        temp->~DNode();
     }
+    pool.release();
+    index.clear();
     head = nullptr;
     tail = nullptr;
     size = 0;
 }
 
-void DoubleList::push_front(const string& value) {
-    DNode* new_node = new DNode(value);
-    new_node->next = head;
-
-    if (head != nullptr) {
-        head->prev = new_node;
+DNode* DoubleList::locate(const string& value) const {
+    if (index.enabled()) {
+        return index.first(value);
     }
-
-    head = new_node;
-
-    if (tail == nullptr) {
-        tail = new_node;
+    DNode* current = head;
+    while (current != nullptr && current->data != value) {
+        current = current->next;
     }
-    size++;
+    return current;
 }
 
-void DoubleList::push_back(const string& value) {
-    DNode* new_node = new DNode(value);
-    new_node->prev = tail;
+void DoubleList::link_after(DNode* prev, DNode* node) {
+    node->prev = prev;
+    node->next = prev != nullptr ? prev->next : head;
 
-    if (tail != nullptr) {
-        tail->next = new_node;
+    if (node->prev != nullptr) {
+        node->prev->next = node;
+    } else {
+        head = node;
+    }
+    if (node->next != nullptr) {
+        node->next->prev = node;
+    } else {
+        tail = node;
     }
 
-    tail = new_node;
-
-    if (head == nullptr) {
-        head = new_node;
+    if (index.enabled()) {
+        index.inserted(node, prev);
     }
     size++;
 }
 
-bool DoubleList::insert_before(const string& target, const string& value) {
-    DNode* current = head;
-    while (current != nullptr && current->data != target) {
-        current = current->next;
+void DoubleList::unlink(DNode* node) {
+    if (index.enabled()) {
+        index.removed(node);
     }
-
-    if (current == nullptr)
-        return false;
-
-    if (current == head) {
-        push_front(value);
-        return true;
+    if (node->prev != nullptr) {
+        node->prev->next = node->next;
+    } else {
+        head = node->next;
+    }
+    if (node->next != nullptr) {
+        node->next->prev = node->prev;
+    } else {
+        tail = node->prev;
     }
+    pool.destroy(node);
+    size--;
+}
 
-    DNode* new_node = new DNode(value);
-    new_node->prev = current->prev;
-    new_node->next = current;
+void DoubleList::push_front(const string& value) {
+    link_after(nullptr, pool.create(value));
+}
 
-    current->prev->next = new_node;
-    current->prev = new_node;
+void DoubleList::push_back(const string& value) {
+    link_after(tail, pool.create(value));
+}
 
-    size++;
+bool DoubleList::insert_before(const string& target, const string& value) {
+    DNode* current = locate(target);
+    if (current == nullptr)
+        return false;
+
+    link_after(current->prev, pool.create(value));
     return true;
 }
 
 bool DoubleList::insert_after(const string& target, const string& value) {
-    DNode* current = head;
-    while (current != nullptr && current->data != target) {
-        current = current->next;
-    }
-
+    DNode* current = locate(target);
     if (current == nullptr)
         return false;
 
-    if (current == tail) {
-        push_back(value);
-        return true;
-    }
-
-    DNode* new_node = new DNode(value);
-    new_node->prev = current;
-    new_node->next = current->next;
-
-    current->next->prev = new_node;
-    current->next = new_node;
-
-    size++;
+    link_after(current, pool.create(value));
     return true;
 }
 
@@ -137,17 +132,7 @@ bool DoubleList::pop_front() {
     if (head == nullptr)
         return false;
 
-    DNode* temp = head;
-    head = head->next;
-
-    if (head != nullptr) {
-        head->prev = nullptr;
-    } else {
-        tail = nullptr;
-    }
-
-    delete temp;
-    size--;
+    unlink(head);
     return true;
 }
 
@@ -155,180 +140,146 @@ bool DoubleList::pop_back() {
     if (tail == nullptr)
         return false;
 
-    DNode* temp = tail;
-    tail = tail->prev;
-
-    if (tail != nullptr) {
-        tail->next = nullptr;
-    } else {
-        head = nullptr;
-    }
-
-    delete temp;
-    size--;
+    unlink(tail);
     return true;
 }
 
 bool DoubleList::remove_before(const string& target) {
-    DNode* current = head;
-    while (current != nullptr && current->data != target) {
-        current = current->next;
-    }
-
+    DNode* current = locate(target);
     if (current == nullptr || current->prev == nullptr)
         return false;
 
-    DNode* to_remove = current->prev;
-
-    if (to_remove == head) {
-        head = current;
-        current->prev = nullptr;
-    } else {
-        to_remove->prev->next = current;
-        current->prev = to_remove->prev;
-    }
-
-    delete to_remove;
-    size--;
+    unlink(current->prev);
     return true;
 }
 
 bool DoubleList::remove_after(const string& target) {
-    DNode* current = head;
-    while (current != nullptr && current->data != target) {
-        current = current->next;
-    }
-
+    DNode* current = locate(target);
     if (current == nullptr || current->next == nullptr)
         return false;
 
-    DNode* to_remove = current->next;
-
-    if (to_remove == tail) {
-        tail = current;
-        current->next = nullptr;
-    } else {
-        current->next = to_remove->next;
-        to_remove->next->prev = current;
-    }
-
-    delete to_remove;
-    size--;
+    unlink(current->next);
     return true;
 }
 
 bool DoubleList::remove_value(const string& value) {
-    DNode* current = head;
-    while (current != nullptr && current->data != value) {
-        current = current->next;
-    }
-
+    DNode* current = locate(value);
     if (current == nullptr)
         return false;
 
-    if (current == head) {
-        return pop_front();
-    }
-
-    if (current == tail) {
-        return pop_back();
-    }
-
-    current->prev->next = current->next;
-    current->next->prev = current->prev;
-
-    delete current;
-    size--;
+    unlink(current);
     return true;
 }
 
 DNode* DoubleList::find(const string& value) {
-    DNode* current = head;
-    while (current != nullptr) {
-        if (current->data == value) {
-            return current;
-        }
-        current = current->next;
+    return locate(value);
+}
+
+void DoubleList::set_value_index(bool enabled) {
+    if (enabled) {
+        index.enable(head);
+    } else if (index.enabled()) {
+        index.disable(head);
     }
-    return nullptr;
 }
 
 void DoubleList::print_forward() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    print_forward(out);
+}
+
+void DoubleList::print_forward(TextWriter& out) const {
     if (head == nullptr) {
-        cout << "Двусвязный список пуст" << endl;
+        out << "Двусвязный список пуст\n";
         return;
     }
 
-    cout << "Двусвязный список [" << size << "]: ";
-    DNode* current = head;
-    while (current != nullptr) {
-        cout << current->data;
-        if (current->next != nullptr) {
-            cout << " <-> ";
+    out << "Двусвязный список [" << size << "]: ";
+    for (iterator it = begin(); it != end();) {
+        out << *it;
+        if (++it != end()) {
+            out << " <-> ";
         }
-        current = current->next;
     }
-    cout << endl;
+    out << '\n';
 }
 
 void DoubleList::print_backward() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    print_backward(out);
+}
+
+void DoubleList::print_backward(TextWriter& out) const {
     if (tail == nullptr) {
-        cout << "Двусвязный список пуст" << endl;
+        out << "Двусвязный список пуст\n";
         return;
     }
 
-    cout << "Двусвязный список в обратном порядке [" << size << "]: ";
-    DNode* current = tail;
-    while (current != nullptr) {
-        cout << current->data;
-        if (current->prev != nullptr) {
-            cout << " <-> ";
+    out << "Двусвязный список в обратном порядке [" << size << "]: ";
+    for (reverse_iterator it = rbegin(); it != rend();) {
+        out << *it;
+        if (++it != rend()) {
+            out << " <-> ";
         }
-        current = current->prev;
     }
-    cout << endl;
+    out << '\n';
 }
 
 int DoubleList::get_size() const {
     return size;
 }
 
-bool DoubleList::serialize_binary(const string& filename) const {
-    ofstream file(filename, ios::binary);
-    if (!file.is_open()) {
-        return false;
+MemoryUsage DoubleList::memory_usage() const {
+    MemoryUsage usage;
+    usage.bytes = sizeof(DoubleList);
+    pool.addTo(usage);
+    for (DNode* node = head; node != nullptr; node = node->next) {
+        usage.addString(node->data);
     }
+    usage += index.memory_usage();
+    return usage;
+}
 
-    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+MemoryUsage DoubleList::index_memory_usage() const {
+    return index.memory_usage();
+}
 
-    DNode* current = head;
-    while (current != nullptr) {
-        size_t str_size = current->data.size();
-        file.write(reinterpret_cast<const char*>(&str_size), sizeof(str_size));
-        file.write(current->data.c_str(), str_size);
-        current = current->next;
+bool DoubleList::serialize_binary(const string& filename) const {
+    return writeBinaryFile(filename, *this);
+}
+
+bool DoubleList::deserialize_binary(const string& filename) {
+    return readBinaryFile(filename, *this);
+}
+
+void DoubleList::serialize_binary(ByteWriter& out) const {
+    uint64_t bytes = 0;
+    for (const string& value : *this) {
+        bytes += value.size();
     }
 
-    return true;
+    out.writeBulkHeader(static_cast<uint32_t>(size), bytes);
+    for (const string& value : *this) {
+        out.writeString(value);
+    }
 }
 
-bool DoubleList::deserialize_binary(const string& filename) {
-    ifstream file(filename, ios::binary);
-    if (!file.is_open()) {
+bool DoubleList::deserialize_binary(ByteReader& in) {
+    uint32_t new_size;
+    uint64_t bytes;
+    if (!in.readBulkHeader(new_size, bytes, 4)) {
         return false;
     }
 
-    int new_size;
-    file.read(reinterpret_cast<char*>(&new_size), sizeof(new_size));
-
     clear();
 
-    for (int i = 0; i < new_size; ++i) {
-        size_t str_size;
-        file.read(reinterpret_cast<char*>(&str_size), sizeof(str_size));
-
-        string value(str_size, '\0');
-        file.read(&value[0], str_size);
+    string value;
+    for (uint32_t i = 0; i < new_size; ++i) {
+        if (!in.readString(value)) {
+            return false;
+        }
         push_back(value);
     }
 
@@ -343,10 +294,8 @@ bool DoubleList::serialize_text(const string& filename) const {
 
     file << size << endl;
 
-    DNode* current = head;
-    while (current != nullptr) {
-        file << current->data << endl;
-        current = current->next;
+    for (const string& value : *this) {
+        file << value << endl;
     }
 
     return true;
@@ -2,8 +2,16 @@
 #define DOUBLELIST_H
 
 #include <fstream>
+#include <iterator>
 #include <string>
 
+#include "ByteStream.h"
+#include "ListIterator.h"
+#include "MemoryUsage.h"
+#include "NodePool.h"
+#include "TextWriter.h"
+#include "ValueIndex.h"
+
 using namespace std;
 
 class DNode {
@@ -11,8 +19,9 @@ public:
     string data;
     DNode* prev;
     DNode* next;
+    ValueLink<DNode>* link;  // запись индекса значений; nullptr без индекса
 
-    DNode(const string& value = "") : data(value), prev(nullptr), next(nullptr) {}
+    DNode(const string& value = "") : data(value), prev(nullptr), next(nullptr), link(nullptr) {}
 };
 
 class DoubleList {
@@ -20,10 +29,23 @@ private:
     DNode* head;
     DNode* tail;
     int size;
+    // Узлы списка; при очистке и разрушении память отдается блоками
+    NodePool<DNode> pool;
+    // Необязательный индекс значение -> узлы (set_value_index)
+    ValueIndex<DNode> index;
 
     void clear();
+    DNode* locate(const string& value) const;   // первый узел со значением value
+    void link_after(DNode* prev, DNode* node);  // prev == nullptr — в начало
+    void unlink(DNode* node);
 
 public:
+    // Двунаправленные итераторы по значениям (только чтение)
+    using iterator = ListIterator<DNode, bidirectional_iterator_tag>;
+    using const_iterator = iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = reverse_iterator;
+
     DoubleList();
     ~DoubleList();
     DoubleList(const DoubleList& other);
@@ -41,14 +63,32 @@ public:
     DNode* find(const string& value);
     DNode* find_first() const { return head; }
     DNode* find_next(DNode* current) const { return current ? current->next : nullptr; }
+    iterator begin() const { return iterator(head, &tail); }
+    iterator end() const { return iterator(nullptr, &tail); }
+    reverse_iterator rbegin() const { return reverse_iterator(end()); }
+    reverse_iterator rend() const { return reverse_iterator(begin()); }
     void print_forward() const;
+    void print_forward(TextWriter& out) const;
     void print_backward() const;
+    void print_backward(TextWriter& out) const;
     int get_size() const;
+    // Индекс значений: find, insert_before/after и remove_before/after/value
+    // находят узел за O(1) вместо прохода от головы
+    void set_value_index(bool enabled);
+    bool has_value_index() const { return index.enabled(); }
+    // Занятая память: объект, блоки в куче и емкость строк (вместе с индексом)
+    MemoryUsage memory_usage() const;
+    // Только индекс значений
+    MemoryUsage index_memory_usage() const;
 
     bool serialize_binary(const string& filename) const;
     bool deserialize_binary(const string& filename);
     bool serialize_text(const string& filename) const;
     bool deserialize_text(const string& filename);
+
+    // Сериализация в память (снимки базы данных)
+    void serialize_binary(ByteWriter& out) const;
+    bool deserialize_binary(ByteReader& in);
 };
 
 #endif
\ No newline at end of file
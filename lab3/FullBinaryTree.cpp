@@ -135,23 +135,47 @@ int FullBinaryTree::get_size() const {
     return size;
 }
 
+void FullBinaryTree::memory_usage_helper(const TreeNode* node, MemoryUsage& usage) const {
+    if (node == nullptr) {
+        return;
+    }
+    usage.addBlock(sizeof(TreeNode));
+    usage.addString(node->value);
+    usage.payload += sizeof(node->key);
+    memory_usage_helper(node->left, usage);
+    memory_usage_helper(node->right, usage);
+}
+
+MemoryUsage FullBinaryTree::memory_usage() const {
+    MemoryUsage usage;
+    usage.bytes = sizeof(FullBinaryTree);
+    memory_usage_helper(root, usage);
+    return usage;
+}
+
 void FullBinaryTree::print() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    print(out);
+}
+
+void FullBinaryTree::print(TextWriter& out) const {
     if (root == nullptr) {
-        cout << "Tree is empty" << endl;
+        out << "Tree is empty\n";
         return;
     }
 
-    cout << "Full Binary Tree structure:" << endl;
-    print_tree_helper(root, 0);
-    cout << endl;
+    out << "Full Binary Tree structure:\n";
+    print_tree_helper(root, 0, out);
+    out << '\n';
 
     bool is_full_tree = is_full();
-    cout << "Is full binary tree: " << (is_full_tree ? "YES" : "NO") << endl;
-    cout << "Tree size: " << size << endl;
-    cout << "Tree height: " << height() << endl;
+    out << "Is full binary tree: " << (is_full_tree ? "YES" : "NO") << '\n';
+    out << "Tree size: " << size << '\n';
+    out << "Tree height: " << height() << '\n';
 }
 
-void FullBinaryTree::print_tree_helper(const TreeNode* root, int space) const {
+void FullBinaryTree::print_tree_helper(const TreeNode* root, int space, TextWriter& out) const {
     const int COUNT = 5;
 
     if (root == nullptr) {
@@ -160,81 +184,105 @@ void FullBinaryTree::print_tree_helper(const TreeNode* root, int space) const {
 
     space += COUNT;
 
-    print_tree_helper(root->right, space);
+    print_tree_helper(root->right, space, out);
 
-    cout << endl;
+    out << '\n';
     for (int i = COUNT; i < space; i++) {
-        cout << " ";
+        out << " ";
     }
-    cout << root->key << ":" << root->value << endl;
+    out << root->key << ":" << root->value << '\n';
 
-    print_tree_helper(root->left, space);
+    print_tree_helper(root->left, space, out);
 }
 
 void FullBinaryTree::inorder() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    inorder(out);
+}
+
+void FullBinaryTree::inorder(TextWriter& out) const {
     if (root == nullptr) {
-        cout << "Дерево пусто" << endl;
+        out << "Дерево пусто\n";
         return;
     }
-    cout << "Inorder: ";
-    inorder_helper(root);
-    cout << endl;
+    out << "Inorder: ";
+    inorder_helper(root, out);
+    out << '\n';
 }
 
-void FullBinaryTree::inorder_helper(const TreeNode* node) const {
+void FullBinaryTree::inorder_helper(const TreeNode* node, TextWriter& out) const {
     if (node == nullptr)
         return;
 
-    inorder_helper(node->left);
-    cout << node->key << ":" << node->value << " ";
-    inorder_helper(node->right);
+    inorder_helper(node->left, out);
+    out << node->key << ":" << node->value << " ";
+    inorder_helper(node->right, out);
 }
 
 void FullBinaryTree::preorder() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    preorder(out);
+}
+
+void FullBinaryTree::preorder(TextWriter& out) const {
     if (root == nullptr) {
-        cout << "Дерево пусто" << endl;
+        out << "Дерево пусто\n";
         return;
     }
-    cout << "Preorder: ";
-    preorder_helper(root);
-    cout << endl;
+    out << "Preorder: ";
+    preorder_helper(root, out);
+    out << '\n';
 }
 
-void FullBinaryTree::preorder_helper(const TreeNode* node) const {
+void FullBinaryTree::preorder_helper(const TreeNode* node, TextWriter& out) const {
     if (node == nullptr)
         return;
 
-    cout << node->key << ":" << node->value << " ";
-    preorder_helper(node->left);
-    preorder_helper(node->right);
+    out << node->key << ":" << node->value << " ";
+    preorder_helper(node->left, out);
+    preorder_helper(node->right, out);
 }
 
 void FullBinaryTree::postorder() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    postorder(out);
+}
+
+void FullBinaryTree::postorder(TextWriter& out) const {
     if (root == nullptr) {
-        cout << "Дерево пусто" << endl;
+        out << "Дерево пусто\n";
         return;
     }
-    cout << "Postorder: ";
-    postorder_helper(root);
-    cout << endl;
+    out << "Postorder: ";
+    postorder_helper(root, out);
+    out << '\n';
 }
 
-void FullBinaryTree::postorder_helper(const TreeNode* node) const {
+void FullBinaryTree::postorder_helper(const TreeNode* node, TextWriter& out) const {
     if (node == nullptr)
         return;
 
-    postorder_helper(node->left);
-    postorder_helper(node->right);
-    cout << node->key << ":" << node->value << " ";
+    postorder_helper(node->left, out);
+    postorder_helper(node->right, out);
+    out << node->key << ":" << node->value << " ";
 }
 
 void FullBinaryTree::level_order() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    level_order(out);
+}
+
+void FullBinaryTree::level_order(TextWriter& out) const {
     if (root == nullptr) {
-        cout << "Дерево пусто" << endl;
+        out << "Дерево пусто\n";
         return;
     }
 
-    cout << "Level order: ";
+    out << "Level order: ";
     queue<const TreeNode*> q;
     q.push(root);
 
@@ -242,7 +290,7 @@ void FullBinaryTree::level_order() const {
         const TreeNode* current = q.front();
         q.pop();
 
-        cout << current->key << ":" << current->value << " ";
+        out << current->key << ":" << current->value << " ";
 
         if (current->left != nullptr) {
             q.push(current->left);
@@ -251,7 +299,7 @@ void FullBinaryTree::level_order() const {
             q.push(current->right);
         }
     }
-    cout << endl;
+    out << '\n';
 }
 
 void FullBinaryTree::free_tree_helper(TreeNode* node) {
@@ -264,69 +312,12 @@ void FullBinaryTree::free_tree_helper(TreeNode* node) {
     delete node;
 }
 
-void FullBinaryTree::serialize_binary_helper(ofstream& file, const TreeNode* node) const {
-    if (node == nullptr) {
-        int marker = -1;
-        file.write(reinterpret_cast<const char*>(&marker), sizeof(marker));
-        return;
-    }
-
-    file.write(reinterpret_cast<const char*>(&node->key), sizeof(node->key));
-
-    size_t str_size = node->value.size();
-    file.write(reinterpret_cast<const char*>(&str_size), sizeof(str_size));
-    file.write(node->value.c_str(), str_size);
-
-    serialize_binary_helper(file, node->left);
-    serialize_binary_helper(file, node->right);
-}
-
-TreeNode* FullBinaryTree::deserialize_binary_helper(ifstream& file) {
-    int key;
-    file.read(reinterpret_cast<char*>(&key), sizeof(key));
-
-    if (key == -1) {
-        return nullptr;
-    }
-
-    size_t str_size;
-    file.read(reinterpret_cast<char*>(&str_size), sizeof(str_size));
-
-    string value(str_size, '\0');
-    file.read(&value[0], str_size);
-
-    TreeNode* node = new TreeNode(key, value);
-    node->left = deserialize_binary_helper(file);
-    node->right = deserialize_binary_helper(file);
-
-    return node;
-}
-
 bool FullBinaryTree::serialize_binary(const string& filename) const {
-    ofstream file(filename, ios::binary);
-    if (!file.is_open()) {
-        return false;
-    }
-
-    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-    serialize_binary_helper(file, root);
-
-    return true;
+    return writeBinaryFile(filename, *this);
 }
 
 bool FullBinaryTree::deserialize_binary(const string& filename) {
-    ifstream file(filename, ios::binary);
-    if (!file.is_open()) {
-        return false;
-    }
-
-    free_tree_helper(root);
-    root = nullptr;
-
-    file.read(reinterpret_cast<char*>(&size), sizeof(size));
-    root = deserialize_binary_helper(file);
-
-    return true;
+    return readBinaryFile(filename, *this);
 }
 
 void FullBinaryTree::serialize_text_helper(ofstream& file, const TreeNode* node) const {
@@ -363,6 +354,72 @@ TreeNode* FullBinaryTree::deserialize_text_helper(ifstream& file) {
     return node;
 }
 
+// Прямой обход: маркер наличия узла, ключ, значение
+void FullBinaryTree::serialize_binary_helper(ByteWriter& out, const TreeNode* node) const {
+    if (node == nullptr) {
+        out.writeU8(0);
+        return;
+    }
+
+    out.writeU8(1);
+    out.writeI32(node->key);
+    out.writeString(node->value);
+    serialize_binary_helper(out, node->left);
+    serialize_binary_helper(out, node->right);
+}
+
+bool FullBinaryTree::deserialize_binary_helper(ByteReader& in, TreeNode*& node, int& count) {
+    uint8_t present;
+    if (!in.readU8(present)) {
+        return false;
+    }
+    if (present == 0) {
+        node = nullptr;
+        return true;
+    }
+
+    int32_t key;
+    string value;
+    if (!in.readI32(key) || !in.readString(value)) {
+        return false;
+    }
+
+    node = new TreeNode(key, value);
+    count++;
+    return deserialize_binary_helper(in, node->left, count) && deserialize_binary_helper(in, node->right, count);
+}
+
+static uint64_t value_bytes(const TreeNode* node) {
+    if (node == nullptr) {
+        return 0;
+    }
+    return node->value.size() + value_bytes(node->left) + value_bytes(node->right);
+}
+
+void FullBinaryTree::serialize_binary(ByteWriter& out) const {
+    out.writeBulkHeader(static_cast<uint32_t>(size), value_bytes(root));
+    serialize_binary_helper(out, root);
+}
+
+bool FullBinaryTree::deserialize_binary(ByteReader& in) {
+    uint32_t expected;
+    uint64_t bytes;
+    // Узел: маркер, ключ и длина значения
+    if (!in.readBulkHeader(expected, bytes, 9)) {
+        return false;
+    }
+
+    free_tree_helper(root);
+    root = nullptr;
+    size = 0;
+
+    // Недочитанное поддерево уже подвешено к root и будет освобождено вместе с ним
+    int count = 0;
+    bool ok = deserialize_binary_helper(in, root, count);
+    size = count;
+    return ok && static_cast<uint32_t>(count) == expected;
+}
+
 bool FullBinaryTree::serialize_text(const string& filename) const {
     ofstream file(filename);
     if (!file.is_open()) {
@@ -5,6 +5,10 @@
 #include <queue>
 #include <string>
 
+#include "ByteStream.h"
+#include "MemoryUsage.h"
+#include "TextWriter.h"
+
 using namespace std;
 
 class TreeNode {
@@ -25,15 +29,16 @@ private:
     string search_helper(const TreeNode* node, int key) const;
     bool is_full_binary_tree_helper(const TreeNode* node) const;
     int tree_height_helper(const TreeNode* node) const;
-    void inorder_helper(const TreeNode* node) const;
-    void preorder_helper(const TreeNode* node) const;
-    void postorder_helper(const TreeNode* node) const;
-    void print_tree_helper(const TreeNode* root, int space) const;
+    void inorder_helper(const TreeNode* node, TextWriter& out) const;
+    void preorder_helper(const TreeNode* node, TextWriter& out) const;
+    void postorder_helper(const TreeNode* node, TextWriter& out) const;
+    void print_tree_helper(const TreeNode* root, int space, TextWriter& out) const;
     void free_tree_helper(TreeNode* node);
     TreeNode* copy_tree_helper(const TreeNode* node);
+    void memory_usage_helper(const TreeNode* node, MemoryUsage& usage) const;
 
-    void serialize_binary_helper(ofstream& file, const TreeNode* node) const;
-    TreeNode* deserialize_binary_helper(ifstream& file);
+    void serialize_binary_helper(ByteWriter& out, const TreeNode* node) const;
+    bool deserialize_binary_helper(ByteReader& in, TreeNode*& node, int& count);
     void serialize_text_helper(ofstream& file, const TreeNode* node) const;
     TreeNode* deserialize_text_helper(ifstream& file);
 
@@ -48,16 +53,27 @@ public:
     bool is_full() const;
     int height() const;
     int get_size() const;
+    // Занятая память: объект, блоки в куче и емкость строк
+    MemoryUsage memory_usage() const;
     void print() const;
+    void print(TextWriter& out) const;
     void inorder() const;
+    void inorder(TextWriter& out) const;
     void preorder() const;
+    void preorder(TextWriter& out) const;
     void postorder() const;
+    void postorder(TextWriter& out) const;
     void level_order() const;
+    void level_order(TextWriter& out) const;
 
     bool serialize_binary(const string& filename) const;
     bool deserialize_binary(const string& filename);
     bool serialize_text(const string& filename) const;
     bool deserialize_text(const string& filename);
+
+    // Сериализация в память (снимки базы данных)
+    void serialize_binary(ByteWriter& out) const;
+    bool deserialize_binary(ByteReader& in);
 };
 
 #endif
\ No newline at end of file
@@ -143,20 +143,43 @@ bool DoubleHashTable::remove(const string& key) {
 }
 
 void DoubleHashTable::print() const {
-    cout << "Таблица с двойным хешированием (емкость: " << capacity << ", размер: " << size
-         << "):" << endl;
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    print(out);
+}
+
+void DoubleHashTable::print(TextWriter& out) const {
+    out << "Таблица с двойным хешированием (емкость: " << capacity << ", размер: " << size
+        << "):\n";
 
     for (int i = 0; i < capacity; i++) {
-        cout << "[" << i << "]: ";
+        out << "[" << i << "]: ";
         if (table[i].is_occupied && !table[i].is_deleted) {
-            cout << table[i].key << " -> " << table[i].value;
+            out << table[i].key << " -> " << table[i].value;
         } else if (table[i].is_deleted) {
-            cout << "УДАЛЕНО";
+            out << "УДАЛЕНО";
         } else {
-            cout << "пусто";
+            out << "пусто";
+        }
+        out << '\n';
+    }
+}
+
+MemoryUsage DoubleHashTable::memory_usage() const {
+    MemoryUsage usage;
+    usage.bytes = sizeof(DoubleHashTable);
+    // Ячейка с двумя строками занимает место, даже когда она пуста
+    usage.addArray<HashEntry>(static_cast<size_t>(capacity));
+    for (int i = 0; i < capacity; ++i) {
+        usage.addStringBuffer(table[i].key);
+        usage.addStringBuffer(table[i].value);
+    }
+    for (int i = 0; i < capacity; ++i) {
+        if (table[i].is_occupied && !table[i].is_deleted) {
+            usage.payload += table[i].key.size() + table[i].value.size();
         }
-        cout << endl;
     }
+    return usage;
 }
 
 void DoubleHashTable::restructure() {
@@ -181,65 +204,72 @@ void DoubleHashTable::restructure() {
 }
 
 bool DoubleHashTable::serialize_binary(const string& filename) const {
-    ofstream file(filename, ios::binary);
-    if (!file.is_open()) {
-        return false;
-    }
+    return writeBinaryFile(filename, *this);
+}
 
-    file.write(reinterpret_cast<const char*>(&capacity), sizeof(capacity));
-    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+bool DoubleHashTable::deserialize_binary(const string& filename) {
+    return readBinaryFile(filename, *this);
+}
 
+// Слоты записываются целиком вместе с надгробиями, чтобы сохранить цепочки проб
+void DoubleHashTable::serialize_binary(ByteWriter& out) const {
+    uint64_t bytes = 0;
     for (int i = 0; i < capacity; ++i) {
-        file.write(reinterpret_cast<const char*>(&table[i].is_occupied), sizeof(bool));
-        file.write(reinterpret_cast<const char*>(&table[i].is_deleted), sizeof(bool));
-
         if (table[i].is_occupied && !table[i].is_deleted) {
-            size_t key_size = table[i].key.size();
-            file.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
-            file.write(table[i].key.c_str(), key_size);
-
-            size_t value_size = table[i].value.size();
-            file.write(reinterpret_cast<const char*>(&value_size), sizeof(value_size));
-            file.write(table[i].value.c_str(), value_size);
+            bytes += table[i].key.size() + table[i].value.size();
         }
     }
 
-    return true;
+    out.writeU32(static_cast<uint32_t>(capacity));
+    out.writeBulkHeader(static_cast<uint32_t>(size), bytes);
+
+    for (int i = 0; i < capacity; ++i) {
+        uint8_t flags = (table[i].is_occupied ? 1 : 0) | (table[i].is_deleted ? 2 : 0);
+        out.writeU8(flags);
+        if (table[i].is_occupied && !table[i].is_deleted) {
+            out.writeString(table[i].key);
+            out.writeString(table[i].value);
+        }
+    }
 }
 
-bool DoubleHashTable::deserialize_binary(const string& filename) {
-    ifstream file(filename, ios::binary);
-    if (!file.is_open()) {
+bool DoubleHashTable::deserialize_binary(ByteReader& in) {
+    uint32_t new_capacity;
+    uint32_t new_size;
+    uint64_t bytes;
+    // Живая запись: две длины строк и байт флагов
+    if (!in.readU32(new_capacity) || !in.readBulkHeader(new_size, bytes, 9) || new_capacity < 2 ||
+        new_size > new_capacity) {
+        return false;
+    }
+    size_t left = in.remaining();
+    if (left != ByteSource::UNKNOWN_SIZE && new_capacity > left) {
         return false;
     }
 
     clear();
-
-    file.read(reinterpret_cast<char*>(&capacity), sizeof(capacity));
-    file.read(reinterpret_cast<char*>(&size), sizeof(size));
-
+    capacity = static_cast<int>(new_capacity);
     table = new HashEntry[capacity];
 
+    int live = 0;
     for (int i = 0; i < capacity; ++i) {
-        file.read(reinterpret_cast<char*>(&table[i].is_occupied), sizeof(bool));
-        file.read(reinterpret_cast<char*>(&table[i].is_deleted), sizeof(bool));
+        uint8_t flags;
+        if (!in.readU8(flags)) {
+            return false;
+        }
+        table[i].is_occupied = (flags & 1) != 0;
+        table[i].is_deleted = (flags & 2) != 0;
 
         if (table[i].is_occupied && !table[i].is_deleted) {
-            size_t key_size;
-            file.read(reinterpret_cast<char*>(&key_size), sizeof(key_size));
-
-            table[i].key.resize(key_size);
-            file.read(&table[i].key[0], key_size);
-
-            size_t value_size;
-            file.read(reinterpret_cast<char*>(&value_size), sizeof(value_size));
-
-            table[i].value.resize(value_size);
-            file.read(&table[i].value[0], value_size);
+            if (!in.readString(table[i].key) || !in.readString(table[i].value)) {
+                return false;
+            }
+            live++;
         }
     }
 
-    return true;
+    size = live;
+    return static_cast<uint32_t>(live) == new_size;
 }
 
 bool DoubleHashTable::serialize_text(const string& filename) const {
@@ -6,6 +6,10 @@
 #include <string>
 #include <iostream>
 
+#include "ByteStream.h"
+#include "MemoryUsage.h"
+#include "TextWriter.h"
+
 using namespace std;
 
 struct HashEntry {
@@ -40,6 +44,7 @@ public:
     string search(const string& key) const;
     bool remove(const string& key);
     void print() const;
+    void print(TextWriter& out) const;
     void restructure();
 
     bool serialize_binary(const string& filename) const;
@@ -47,9 +52,15 @@ public:
     bool serialize_text(const string& filename) const;
     bool deserialize_text(const string& filename);
 
+    // Сериализация в память (снимки базы данных)
+    void serialize_binary(ByteWriter& out) const;
+    bool deserialize_binary(ByteReader& in);
+
     int get_capacity() const { return capacity; }
     int get_size() const { return size; }
     double get_load_factor() const { return static_cast<double>(size) / capacity; }
+    // Занятая память: объект, блоки в куче и емкость строк
+    MemoryUsage memory_usage() const;
 };
 
 #endif
\ No newline at end of file
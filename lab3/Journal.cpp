@@ -0,0 +1,376 @@
+#include "Journal.h"
+
+#include "Checksum.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static constexpr size_t RECORD_HEADER_SIZE = 8;
+// Групповой коммит не дает буферу расти бесконечно между срабатываниями таймера
+static constexpr size_t PENDING_FLUSH_LIMIT = 1 << 20;
+
+static bool fileExists(const string& path) {
+    struct stat info;
+    return ::stat(path.c_str(), &info) == 0;
+}
+
+static bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+static void appendRecord(string& buffer, string_view command) {
+    uint32_t length = static_cast<uint32_t>(command.size());
+    uint32_t checksum = crc32(command.data(), command.size());
+    char header[RECORD_HEADER_SIZE];
+    memcpy(header, &length, sizeof(length));
+    memcpy(header + sizeof(length), &checksum, sizeof(checksum));
+    buffer.append(header, RECORD_HEADER_SIZE);
+    buffer.append(command.data(), command.size());
+}
+
+static bool syncDirectory(const string& path) {
+    size_t slash = path.rfind('/');
+    string directory = slash == string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+    int fd = ::open(directory.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+Journal::Journal()
+    : policy(FsyncPolicy::INTERVAL),
+      interval(100),
+      fd(-1),
+      segment(0),
+      stopping(false),
+      compacting(false),
+      write_failed(false) {}
+
+Journal::~Journal() {
+    close();
+}
+
+string Journal::manifestPath(const string& base) {
+    return base + ".manifest";
+}
+
+string Journal::segmentPath(const string& base, uint64_t number) {
+    return base + ".wal." + to_string(number);
+}
+
+string Journal::snapshotPath(const string& base, uint64_t number) {
+    return base + ".snap." + to_string(number);
+}
+
+bool Journal::readManifest(const string& base, JournalManifest& result) {
+    result = JournalManifest();
+    ifstream file(manifestPath(base));
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Манифест пишется целиком через rename, поэтому неполный или
+    // испорченный файл — ошибка, а не повод восстанавливаться по умолчанию
+    string line;
+    bool has_snapshot = false;
+    bool has_first_segment = false;
+    while (getline(file, line)) {
+        size_t space = line.find(' ');
+        if (space == string::npos) {
+            return false;
+        }
+        string key = line.substr(0, space);
+        string value = line.substr(space + 1);
+        if (key == "snapshot") {
+            result.snapshot = value == "-" ? "" : value;
+            has_snapshot = !value.empty();
+        } else if (key == "first_segment") {
+            const char* end = value.data() + value.size();
+            auto [parsed_end, error] = from_chars(value.data(), end, result.first_segment);
+            if (error != errc() || parsed_end != end || result.first_segment == 0) {
+                return false;
+            }
+            has_first_segment = true;
+        } else {
+            return false;
+        }
+    }
+    return has_snapshot && has_first_segment;
+}
+
+bool Journal::writeManifest(const string& base, const JournalManifest& value) {
+    string path = manifestPath(base);
+    string temp_path = path + ".tmp";
+
+    ostringstream content;
+    content << "snapshot " << (value.snapshot.empty() ? "-" : value.snapshot) << "\n";
+    content << "first_segment " << value.first_segment << "\n";
+    string text = content.str();
+
+    int file = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0) {
+        return false;
+    }
+    bool ok = writeAll(file, text.data(), text.size()) && ::fsync(file) == 0;
+    ::close(file);
+
+    // rename атомарен: после сбоя на диске либо старый, либо новый манифест
+    if (!ok || ::rename(temp_path.c_str(), path.c_str()) != 0) {
+        ::unlink(temp_path.c_str());
+        return false;
+    }
+    return syncDirectory(path);
+}
+
+bool Journal::syncFile(const string& path) {
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    bool ok = ::fsync(file) == 0;
+    ::close(file);
+    return ok;
+}
+
+size_t Journal::replaySegment(const string& path, const function<void(string_view)>& apply) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+    string data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+    size_t pos = 0;
+    size_t applied = 0;
+    while (data.size() - pos >= RECORD_HEADER_SIZE) {
+        uint32_t length;
+        uint32_t checksum;
+        memcpy(&length, data.data() + pos, sizeof(length));
+        memcpy(&checksum, data.data() + pos + sizeof(length), sizeof(checksum));
+
+        if (data.size() - pos - RECORD_HEADER_SIZE < length) {
+            break;
+        }
+        string_view command(data.data() + pos + RECORD_HEADER_SIZE, length);
+        if (crc32(command.data(), command.size()) != checksum) {
+            break;
+        }
+
+        apply(command);
+        applied++;
+        pos += RECORD_HEADER_SIZE + length;
+    }
+    return applied;
+}
+
+bool Journal::openSegment(uint64_t number) {
+    string path = segmentPath(base_path, number);
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    segment = number;
+    // Новый файл должен пережить сбой вместе со своими записями
+    syncDirectory(path);
+    return true;
+}
+
+bool Journal::open(const string& base, FsyncPolicy fsync_policy, int interval_ms) {
+    close();
+
+    base_path = base;
+    policy = fsync_policy;
+    interval = chrono::milliseconds(interval_ms > 0 ? interval_ms : 1);
+    if (!readManifest(base_path, manifest) && fileExists(manifestPath(base_path))) {
+        return false;
+    }
+    write_failed = false;
+
+    // Дописываем только в новый сегмент: в хвосте старого может быть оборванная запись
+    uint64_t number = manifest.first_segment;
+    while (fileExists(segmentPath(base_path, number))) {
+        number++;
+    }
+    if (!openSegment(number)) {
+        return false;
+    }
+
+    if (policy == FsyncPolicy::INTERVAL) {
+        stopping = false;
+        flusher = thread(&Journal::flusherLoop, this);
+    }
+    return true;
+}
+
+void Journal::close() {
+    if (flusher.joinable()) {
+        {
+            lock_guard<mutex> guard(buffer_lock);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        flusher.join();
+    }
+
+    lock_guard<mutex> io_guard(io_lock);
+    if (fd >= 0) {
+        flushPending(policy != FsyncPolicy::NEVER);
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+// Вызывается под io_lock
+bool Journal::flushPending(bool sync) {
+    string batch;
+    {
+        lock_guard<mutex> guard(buffer_lock);
+        batch.swap(pending);
+    }
+    bool ok = writeAll(fd, batch.data(), batch.size());
+    if (sync) {
+        ok = ::fdatasync(fd) == 0 && ok;
+    }
+    if (!ok) {
+        write_failed = true;
+    }
+    return ok;
+}
+
+void Journal::flusherLoop() {
+    unique_lock<mutex> guard(buffer_lock);
+    while (!stopping) {
+        wakeup.wait_for(guard, interval, [this] { return stopping || pending.size() >= PENDING_FLUSH_LIMIT; });
+        if (pending.empty()) {
+            continue;
+        }
+        // Все записи, накопленные за интервал, фиксируются одним fsync
+        guard.unlock();
+        {
+            lock_guard<mutex> io_guard(io_lock);
+            if (fd >= 0) {
+                flushPending(true);
+            }
+        }
+        guard.lock();
+    }
+}
+
+bool Journal::append(string_view command) {
+    // fd проверяется под io_lock: во время rotate он ненадолго закрыт
+    if (write_failed) {
+        return false;
+    }
+
+    if (policy == FsyncPolicy::INTERVAL) {
+        bool wake;
+        {
+            lock_guard<mutex> guard(buffer_lock);
+            appendRecord(pending, command);
+            wake = pending.size() >= PENDING_FLUSH_LIMIT;
+        }
+        if (wake) {
+            wakeup.notify_one();
+        }
+        return true;
+    }
+
+    lock_guard<mutex> io_guard(io_lock);
+    if (fd < 0) {
+        write_failed = true;
+        return false;
+    }
+    {
+        lock_guard<mutex> guard(buffer_lock);
+        appendRecord(pending, command);
+    }
+    return flushPending(policy == FsyncPolicy::ALWAYS);
+}
+
+bool Journal::sync() {
+    lock_guard<mutex> io_guard(io_lock);
+    if (fd < 0) {
+        return false;
+    }
+    return flushPending(true);
+}
+
+uint64_t Journal::rotate() {
+    lock_guard<mutex> io_guard(io_lock);
+    if (fd < 0) {
+        return 0;
+    }
+    flushPending(true);
+    ::close(fd);
+    fd = -1;
+
+    uint64_t sealed = segment;
+    if (!openSegment(sealed + 1)) {
+        write_failed = true;
+    }
+    return sealed;
+}
+
+JournalManifest Journal::currentManifest() {
+    lock_guard<mutex> io_guard(io_lock);
+    return manifest;
+}
+
+bool Journal::beginCompaction() {
+    bool expected = false;
+    return compacting.compare_exchange_strong(expected, true);
+}
+
+bool Journal::finishCompaction(const string& snapshot, uint64_t first_segment) {
+    JournalManifest previous;
+    JournalManifest next;
+    {
+        lock_guard<mutex> io_guard(io_lock);
+        previous = manifest;
+        next.snapshot = snapshot;
+        next.first_segment = first_segment;
+        if (!writeManifest(base_path, next)) {
+            compacting = false;
+            return false;
+        }
+        manifest = next;
+    }
+
+    // После записи манифеста старые файлы уже не нужны для восстановления
+    if (!previous.snapshot.empty() && previous.snapshot != snapshot) {
+        ::unlink(previous.snapshot.c_str());
+    }
+    for (uint64_t number = previous.first_segment; number < first_segment; ++number) {
+        ::unlink(segmentPath(base_path, number).c_str());
+    }
+
+    compacting = false;
+    return true;
+}
+
+void Journal::abortCompaction() {
+    compacting = false;
+}
@@ -0,0 +1,106 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace std;
+
+// Когда журнал вызывает fsync
+enum class FsyncPolicy : uint8_t {
+    ALWAYS,    // после каждой записи: ничего не теряется
+    INTERVAL,  // групповой коммит раз в N мс из фонового потока
+    NEVER      // данные уходят в ОС, синхронизацию выполняет ядро
+};
+
+// Состояние журнала на диске: последний снимок и первый сегмент, который
+// нужно проиграть поверх него
+struct JournalManifest {
+    string snapshot;
+    uint64_t first_segment = 1;
+};
+
+// Журнал упреждающей записи. Каждая запись: длина (4 байта), CRC-32 (4 байта),
+// текст команды. Журнал делится на сегменты base.wal.N; манифест base.manifest
+// заменяется атомарно через rename.
+class Journal {
+private:
+    string base_path;
+    FsyncPolicy policy;
+    chrono::milliseconds interval;
+    int fd;
+    uint64_t segment;
+    JournalManifest manifest;
+
+    // Порядок захвата: io_lock, затем buffer_lock
+    mutex io_lock;
+    mutex buffer_lock;
+    string pending;
+    condition_variable wakeup;
+    bool stopping;
+    thread flusher;
+    atomic<bool> compacting;
+    // Запись или fsync не удались либо сегмент не открыт;
+    // сбрасывается только повторным open
+    atomic<bool> write_failed;
+
+    bool openSegment(uint64_t number);
+    bool flushPending(bool sync);
+    void flusherLoop();
+
+public:
+    Journal();
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Открывает новый сегмент после всех существующих
+    bool open(const string& base, FsyncPolicy fsync_policy, int interval_ms);
+    void close();
+    bool isOpen() const { return fd >= 0; }
+    bool hasFailed() const { return write_failed.load(); }
+
+    // false — запись не попала в журнал (или, при INTERVAL, журнал уже
+    // неисправен: ошибки фонового сброса видны следующим append)
+    bool append(string_view command);
+    // Сбрасывает буфер группового коммита и вызывает fsync
+    bool sync();
+
+    // Закрывает текущий сегмент и начинает следующий; возвращает номер закрытого
+    uint64_t rotate();
+    uint64_t currentSegment() const { return segment; }
+    JournalManifest currentManifest();
+
+    // Одновременно выполняется не больше одного сжатия
+    bool beginCompaction();
+    // Фиксирует новый снимок в манифесте и удаляет поглощенные им файлы
+    bool finishCompaction(const string& snapshot, uint64_t first_segment);
+    void abortCompaction();
+    bool isCompacting() const { return compacting.load(); }
+
+    static string manifestPath(const string& base);
+    static string segmentPath(const string& base, uint64_t number);
+    static string snapshotPath(const string& base, uint64_t number);
+
+    // false — манифеста нет или он испорчен (неизвестная строка, нет одного
+    // из полей, неверный номер сегмента)
+    static bool readManifest(const string& base, JournalManifest& result);
+    static bool writeManifest(const string& base, const JournalManifest& value);
+
+    // Проигрывает записи сегмента; оборванный хвост (сбой во время записи)
+    // молча отбрасывается. Возвращает число проигранных записей.
+    static size_t replaySegment(const string& path, const function<void(string_view)>& apply);
+
+    // Сбрасывает содержимое файла на диск
+    static bool syncFile(const string& path);
+};
+
+#endif
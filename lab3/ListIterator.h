@@ -0,0 +1,59 @@
+#ifndef LISTITERATOR_H
+#define LISTITERATOR_H
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+
+using namespace std;
+
+// Итератор по значениям списка. Category — forward_iterator_tag для
+// SingleList, bidirectional_iterator_tag для DoubleList: тогда tail указывает
+// на поле tail списка, чтобы --end() давал последний элемент.
+// Значения только читаются: меняет их сам список, иначе индекс значений
+// (set_value_index) разойдется с узлами.
+template <typename Node, typename Category>
+class ListIterator {
+private:
+    const Node* node;
+    const Node* const* tail;
+
+public:
+    using iterator_category = Category;
+    using value_type = string;
+    using difference_type = ptrdiff_t;
+    using pointer = const string*;
+    using reference = const string&;
+
+    ListIterator() : node(nullptr), tail(nullptr) {}
+    explicit ListIterator(const Node* node, const Node* const* tail = nullptr) : node(node), tail(tail) {}
+
+    reference operator*() const { return node->data; }
+    pointer operator->() const { return &node->data; }
+
+    ListIterator& operator++() {
+        node = node->next;
+        return *this;
+    }
+    ListIterator operator++(int) {
+        ListIterator previous = *this;
+        node = node->next;
+        return previous;
+    }
+
+    // Только для узлов с prev
+    ListIterator& operator--() {
+        node = node != nullptr ? node->prev : *tail;
+        return *this;
+    }
+    ListIterator operator--(int) {
+        ListIterator previous = *this;
+        --*this;
+        return previous;
+    }
+
+    bool operator==(const ListIterator& other) const { return node == other.node; }
+    bool operator!=(const ListIterator& other) const { return node != other.node; }
+};
+
+#endif
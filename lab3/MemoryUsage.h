@@ -0,0 +1,60 @@
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+// Размер блока, который распределитель отдает под запрос в bytes байт.
+// Модель glibc malloc на 64-битной платформе: 8 байт заголовка, выравнивание
+// на 16 и блок не меньше 32 байт.
+inline size_t heapBlockSize(size_t bytes) {
+    size_t block = (bytes + sizeof(size_t) + 15) & ~size_t(15);
+    return block < 32 ? 32 : block;
+}
+
+// Занятая контейнером память: сам объект, каждый блок в куче (узлы, массивы
+// ячеек, буферы строк) с учетом заголовков распределителя и неиспользованной
+// емкости. payload — байты самих данных, остальное — накладные расходы.
+struct MemoryUsage {
+    size_t bytes = 0;
+    size_t payload = 0;
+    size_t heap_blocks = 0;
+
+    void addBlock(size_t requested) {
+        bytes += heapBlockSize(requested);
+        ++heap_blocks;
+    }
+
+    // new T[count] для типа с деструктором хранит перед массивом его длину
+    template <typename T>
+    void addArray(size_t count) {
+        addBlock(count * sizeof(T) + sizeof(size_t));
+    }
+
+    // Короткая строка хранится внутри объекта (SSO); длинная — в отдельном
+    // буфере емкостью capacity() + 1. Сам объект строки учитывает владелец.
+    void addStringBuffer(const string& value) {
+        const char* inline_begin = reinterpret_cast<const char*>(&value);
+        const char* buffer = value.data();
+        if (buffer < inline_begin || buffer >= inline_begin + sizeof(value)) {
+            addBlock(value.capacity() + 1);
+        }
+    }
+
+    // Строка с живыми данными
+    void addString(const string& value) {
+        payload += value.size();
+        addStringBuffer(value);
+    }
+
+    MemoryUsage& operator+=(const MemoryUsage& other) {
+        bytes += other.bytes;
+        payload += other.payload;
+        heap_blocks += other.heap_blocks;
+        return *this;
+    }
+};
+
+#endif
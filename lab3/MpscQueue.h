@@ -0,0 +1,71 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+
+using namespace std;
+
+// Узел очереди встраивается в сам элемент, поэтому очередь не выделяет память
+struct MpscNode {
+    atomic<MpscNode*> next{nullptr};
+};
+
+// Очередь без блокировок: много производителей, один потребитель (алгоритм
+// Вьюкова). push никогда не ждет; pop может вернуть nullptr, пока производитель
+// не закончил push, — тогда maybeNonEmpty() остается true.
+class MpscQueue {
+private:
+    atomic<MpscNode*> head;  // последний добавленный узел (производители)
+    MpscNode* tail;          // следующий на извлечение (потребитель)
+    MpscNode stub;
+
+public:
+    MpscQueue() : head(&stub), tail(&stub) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(MpscNode* node) {
+        node->next.store(nullptr, memory_order_relaxed);
+        MpscNode* prev = head.exchange(node, memory_order_seq_cst);
+        prev->next.store(node, memory_order_release);
+    }
+
+    // Только поток-потребитель
+    MpscNode* pop() {
+        MpscNode* first = tail;
+        MpscNode* next = first->next.load(memory_order_acquire);
+        if (first == &stub) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            tail = next;
+            first = next;
+            next = next->next.load(memory_order_acquire);
+        }
+        if (next != nullptr) {
+            tail = next;
+            return first;
+        }
+        if (first != head.load(memory_order_seq_cst)) {
+            return nullptr;
+        }
+        // first — последний узел: возвращаем заглушку в конец, чтобы его отдать
+        push(&stub);
+        next = first->next.load(memory_order_acquire);
+        if (next != nullptr) {
+            tail = next;
+            return first;
+        }
+        return nullptr;
+    }
+
+    // Только поток-потребитель: false — очередь точно пуста
+    bool maybeNonEmpty() const {
+        // Хвост, отличный от заглушки, — еще не извлеченный элемент
+        return tail != &stub || tail->next.load(memory_order_acquire) != nullptr ||
+               head.load(memory_order_seq_cst) != tail;
+    }
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "MemoryUsage.h"
+
+using namespace std;
+
+// Пул узлов списка: узлы нарезаются из крупных блоков (слэбов), освобожденные
+// узлы уходят в список свободных и выдаются снова первыми. Узлы, добавленные
+// подряд, лежат в памяти подряд, поэтому обход такого списка идет по
+// нескольким страницам, а не по всей куче. release() отдает все блоки разом,
+// без освобождения каждого узла.
+template <typename Node>
+class NodePool {
+private:
+    union Slot {
+        Slot* next_free;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    struct Slab {
+        unique_ptr<Slot[]> slots;
+        size_t count;
+    };
+
+    // Первый блок мал, чтобы короткие списки не занимали лишнего; дальше
+    // размер удваивается до MAX_SLAB_BYTES
+    static constexpr size_t FIRST_SLAB_NODES = 8;
+    static constexpr size_t MAX_SLAB_BYTES = 64 * 1024;
+    static constexpr size_t MAX_SLAB_NODES =
+        MAX_SLAB_BYTES / sizeof(Slot) > FIRST_SLAB_NODES ? MAX_SLAB_BYTES / sizeof(Slot) : FIRST_SLAB_NODES;
+
+    vector<Slab> slabs;
+    size_t used = 0;  // занятых ячеек в последнем блоке
+    Slot* free_list = nullptr;
+
+    Slot* take() {
+        if (free_list != nullptr) {
+            Slot* slot = free_list;
+            free_list = slot->next_free;
+            return slot;
+        }
+        if (slabs.empty() || used == slabs.back().count) {
+            size_t count = slabs.empty() ? FIRST_SLAB_NODES : min(slabs.back().count * 2, MAX_SLAB_NODES);
+            slabs.push_back({unique_ptr<Slot[]>(new Slot[count]), count});
+            used = 0;
+        }
+        return &slabs.back().slots[used++];
+    }
+
+public:
+    NodePool() = default;
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    template <typename... Args>
+    Node* create(Args&&... args) {
+        Slot* slot = take();
+        try {
+            return new (slot->storage) Node(forward<Args>(args)...);
+        } catch (...) {
+            slot->next_free = free_list;
+            free_list = slot;
+            throw;
+        }
+    }
+
+    void destroy(Node* node) {
+        node->~Node();
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->next_free = free_list;
+        free_list = slot;
+    }
+
+    // Отдает всю память; узлы к этому моменту должны быть разрушены
+    void release() {
+        vector<Slab>().swap(slabs);
+        used = 0;
+        free_list = nullptr;
+    }
+
+    // Блоки пула; строки узлов учитывает владелец
+    void addTo(MemoryUsage& usage) const {
+        for (const auto& slab : slabs) {
+            usage.addBlock(slab.count * sizeof(Slot));
+        }
+        if (slabs.capacity() > 0) {
+            usage.addBlock(slabs.capacity() * sizeof(Slab));
+        }
+    }
+};
+
+#endif
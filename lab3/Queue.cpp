@@ -107,64 +107,87 @@ int Queue::get_size() const {
     return size;
 }
 
+MemoryUsage Queue::memory_usage() const {
+    MemoryUsage usage;
+    usage.bytes = sizeof(Queue);
+    usage.addArray<string>(static_cast<size_t>(capacity));
+    // Извлеченные значения остаются в своих ячейках до перезаписи
+    for (int i = 0; i < capacity; ++i) {
+        usage.addStringBuffer(data[i]);
+    }
+    for (int i = 0; i < size; ++i) {
+        usage.payload += data[(front + i) % capacity].size();
+    }
+    return usage;
+}
+
 void Queue::print() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    print(out);
+}
+
+void Queue::print(TextWriter& out) const {
     if (size == 0) {
-        cout << "очередь пуста" << endl;
+        out << "очередь пуста\n";
         return;
     }
 
-    cout << "Очередь (начало -> конец) [" << size << "]: ";
+    out << "Очередь (начало -> конец) [" << size << "]: ";
     for (int i = 0; i < size; i++) {
         int index = (front + i) % capacity;
-        cout << data[index];
+        out << data[index];
         if (i < size - 1) {
-            cout << " -> ";
+            out << " -> ";
         }
     }
-    cout << endl;
+    out << '\n';
 }
 
 bool Queue::serialize_binary(const string& filename) const {
-    ofstream file(filename, ios::binary);
-    if (!file.is_open()) {
-        return false;
-    }
+    return writeBinaryFile(filename, *this);
+}
 
-    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+bool Queue::deserialize_binary(const string& filename) {
+    return readBinaryFile(filename, *this);
+}
 
+void Queue::serialize_binary(ByteWriter& out) const {
+    uint64_t bytes = 0;
     for (int i = 0; i < size; ++i) {
-        int index = (front + i) % capacity;
-        size_t str_size = data[index].size();
-        file.write(reinterpret_cast<const char*>(&str_size), sizeof(str_size));
-        file.write(data[index].c_str(), str_size);
+        bytes += data[(front + i) % capacity].size();
     }
 
-    return true;
+    out.writeBulkHeader(static_cast<uint32_t>(size), bytes);
+    for (int i = 0; i < size; ++i) {
+        out.writeString(data[(front + i) % capacity]);
+    }
 }
 
-bool Queue::deserialize_binary(const string& filename) {
-    ifstream file(filename, ios::binary);
-    if (!file.is_open()) {
+bool Queue::deserialize_binary(ByteReader& in) {
+    uint32_t new_size;
+    uint64_t bytes;
+    if (!in.readBulkHeader(new_size, bytes, 4)) {
         return false;
     }
 
-    int new_size;
-    file.read(reinterpret_cast<char*>(&new_size), sizeof(new_size));
-
     clear();
-    data = new string[new_size];
-    capacity = new_size;
+    capacity = new_size > 0 ? bulkReserve(new_size) : 10;
+    data = new string[capacity];
     front = 0;
     rear = -1;
     size = 0;
 
-    for (int i = 0; i < new_size; ++i) {
-        size_t str_size;
-        file.read(reinterpret_cast<char*>(&str_size), sizeof(str_size));
-
-        string value(str_size, '\0');
-        file.read(&value[0], str_size);
-        push(value);
+    // Элементы ложатся с начала массива, поэтому front остается нулевым
+    for (uint32_t i = 0; i < new_size; ++i) {
+        if (size == capacity) {
+            resize(capacity * 2);
+        }
+        if (!in.readString(data[rear + 1])) {
+            return false;
+        }
+        rear++;
+        size++;
     }
 
     return true;
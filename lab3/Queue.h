@@ -4,6 +4,10 @@
 #include <fstream>
 #include <string>
 
+#include "ByteStream.h"
+#include "MemoryUsage.h"
+#include "TextWriter.h"
+
 using namespace std;
 
 class Queue {
@@ -28,12 +32,19 @@ public:
     string peek() const;
     bool is_empty() const;
     int get_size() const;
+    // Занятая память: объект, блоки в куче и емкость строк
+    MemoryUsage memory_usage() const;
     void print() const;
+    void print(TextWriter& out) const;
 
     bool serialize_binary(const string& filename) const;
     bool deserialize_binary(const string& filename);
     bool serialize_text(const string& filename) const;
     bool deserialize_text(const string& filename);
+
+    // Сериализация в память (снимки базы данных)
+    void serialize_binary(ByteWriter& out) const;
+    bool deserialize_binary(ByteReader& in);
 };
 
 #endif
\ No newline at end of file
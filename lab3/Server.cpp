@@ -0,0 +1,465 @@
+#include "Server.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+static constexpr size_t READ_CHUNK = 64 * 1024;
+// Сколько байт читается из одного соединения за событие, чтобы активный
+// клиент не задерживал остальных
+static constexpr size_t READ_BUDGET = 4 * READ_CHUNK;
+// Пока клиент не забрал столько ответов, новые команды от него не читаются
+static constexpr size_t OUTPUT_LIMIT = 4 << 20;
+// Обработанное начало буфера удаляется, когда становится больше этого порога
+static constexpr size_t COMPACT_THRESHOLD = 64 * 1024;
+static constexpr int MAX_EVENTS = 64;
+
+static bool setNonBlocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static void setNoDelay(int fd) {
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+static bool fillUnixAddress(const string& path, sockaddr_un& address) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    memcpy(address.sun_path, path.data(), path.size());
+    return true;
+}
+
+static void fillLoopbackAddress(uint16_t port, sockaddr_in& address) {
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+}
+
+// Удаляет уже обработанное начало буфера
+static void compactBuffer(string& buffer, size_t& pos) {
+    if (pos == buffer.size()) {
+        buffer.clear();
+        pos = 0;
+    } else if (pos >= COMPACT_THRESHOLD) {
+        buffer.erase(0, pos);
+        pos = 0;
+    }
+}
+
+// ========== Server ==========
+
+Server::Server(Database& database)
+    : db(database), epoll_fd(-1), wake_fd(-1), tcp_port(0), stopping(false) {
+    epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd >= 0 && wake_fd >= 0) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = wake_fd;
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+    }
+}
+
+Server::~Server() {
+    for (size_t fd = 0; fd < connections.size(); ++fd) {
+        if (connections[fd] != nullptr) {
+            closeConnection(static_cast<int>(fd));
+        }
+    }
+    for (int fd : listen_fds) {
+        ::close(fd);
+    }
+    if (!unix_path.empty()) {
+        ::unlink(unix_path.c_str());
+    }
+    if (wake_fd >= 0) {
+        ::close(wake_fd);
+    }
+    if (epoll_fd >= 0) {
+        ::close(epoll_fd);
+    }
+}
+
+bool Server::addListener(int fd) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_fd < 0 || !setNonBlocking(fd) || ::listen(fd, SOMAXCONN) != 0 ||
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        ::close(fd);
+        return false;
+    }
+    listen_fds.push_back(fd);
+    return true;
+}
+
+bool Server::listenUnix(const string& path) {
+    sockaddr_un address;
+    if (!fillUnixAddress(path, address)) {
+        return false;
+    }
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (!addListener(fd)) {
+        ::unlink(path.c_str());
+        return false;
+    }
+    unix_path = path;
+    return true;
+}
+
+bool Server::listenTcp(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in address;
+    fillLoopbackAddress(port, address);
+    socklen_t length = sizeof(address);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (!addListener(fd)) {
+        return false;
+    }
+    tcp_port = ntohs(address.sin_port);
+    return true;
+}
+
+void Server::stop() {
+    stopping.store(true);
+    uint64_t one = 1;
+    ssize_t written = ::write(wake_fd, &one, sizeof(one));
+    (void)written;
+}
+
+size_t Server::connectionCount() const {
+    size_t count = 0;
+    for (const auto& conn : connections) {
+        count += conn != nullptr ? 1 : 0;
+    }
+    return count;
+}
+
+void Server::run() {
+    epoll_event events[MAX_EVENTS];
+
+    while (!stopping.load()) {
+        int ready = ::epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            uint32_t flags = events[i].events;
+
+            if (fd == wake_fd) {
+                uint64_t value;
+                ssize_t got = ::read(wake_fd, &value, sizeof(value));
+                (void)got;
+                continue;
+            }
+            bool listener = false;
+            for (int listen_fd : listen_fds) {
+                if (fd == listen_fd) {
+                    acceptClients(listen_fd);
+                    listener = true;
+                    break;
+                }
+            }
+            if (listener || static_cast<size_t>(fd) >= connections.size() || connections[fd] == nullptr) {
+                continue;
+            }
+
+            handleConnection(*connections[fd], flags);
+        }
+    }
+}
+
+// Во входном буфере есть команда, отложенная из-за переполненного выходного
+bool Server::hasCompleteLine(const Connection& conn) {
+    return conn.input.find('\n', conn.input_pos) != string::npos;
+}
+
+void Server::handleConnection(Connection& conn, uint32_t flags) {
+    if (conn.reading && (flags & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+        // Даже после закрытия клиентом выполняем уже присланные команды
+        conn.reading = readInput(conn);
+    }
+    // Выполняем и команды, отложенные из-за переполненного выходного буфера
+    processInput(conn);
+    if (!writeOutput(conn)) {
+        closeConnection(conn.fd);
+        return;
+    }
+    // Клиент больше ничего не пришлет, все присланные команды выполнены
+    // и все ответы отданы
+    if (!conn.reading && conn.output_pos == conn.output.size() && !hasCompleteLine(conn)) {
+        closeConnection(conn.fd);
+        return;
+    }
+    updateEvents(conn);
+}
+
+void Server::acceptClients(int listen_fd) {
+    while (true) {
+        int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            // EAGAIN — очередь пуста; при остальных ошибках попробуем на следующем событии
+            return;
+        }
+        setNoDelay(fd);
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        if (static_cast<size_t>(fd) >= connections.size()) {
+            connections.resize(static_cast<size_t>(fd) + 1);
+        }
+        connections[fd] = make_unique<Connection>();
+        connections[fd]->fd = fd;
+        connections[fd]->events = EPOLLIN;
+    }
+}
+
+bool Server::readInput(Connection& conn) {
+    size_t budget = READ_BUDGET;
+    while (budget > 0) {
+        size_t old_size = conn.input.size();
+        conn.input.resize(old_size + READ_CHUNK);
+        ssize_t got = ::recv(conn.fd, &conn.input[old_size], READ_CHUNK, 0);
+        conn.input.resize(old_size + (got > 0 ? static_cast<size_t>(got) : 0));
+
+        if (got > 0) {
+            budget -= min(budget, static_cast<size_t>(got));
+            continue;
+        }
+        if (got == 0) {
+            return false;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    return true;
+}
+
+void Server::processInput(Connection& conn) {
+    char header[24];
+
+    while (conn.output.size() - conn.output_pos < OUTPUT_LIMIT) {
+        size_t end = conn.input.find('\n', conn.input_pos);
+        if (end == string::npos) {
+            if (conn.input.size() - conn.input_pos > SERVER_MAX_LINE) {
+                // Строка без конца: соединение закроется, когда уйдут ответы
+                conn.input.clear();
+                conn.input_pos = 0;
+                conn.reading = false;
+            }
+            break;
+        }
+
+        string_view line(conn.input.data() + conn.input_pos, end - conn.input_pos);
+        conn.input_pos = end + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        reply.clear();
+        db.executeCommand(line, reply);
+
+        char* header_end = to_chars(header, header + sizeof(header) - 1, reply.size()).ptr;
+        *header_end++ = '\n';
+        conn.output.append(header, header_end);
+        conn.output += reply;
+    }
+    compactBuffer(conn.input, conn.input_pos);
+}
+
+bool Server::writeOutput(Connection& conn) {
+    while (conn.output_pos < conn.output.size()) {
+        ssize_t sent = ::send(conn.fd, conn.output.data() + conn.output_pos,
+                              conn.output.size() - conn.output_pos, MSG_NOSIGNAL);
+        if (sent > 0) {
+            conn.output_pos += static_cast<size_t>(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        return false;
+    }
+    compactBuffer(conn.output, conn.output_pos);
+    return true;
+}
+
+void Server::updateEvents(Connection& conn) {
+    size_t pending = conn.output.size() - conn.output_pos;
+    uint32_t wanted = 0;
+    if (conn.reading && pending < OUTPUT_LIMIT) {
+        wanted |= EPOLLIN;
+    }
+    // Отложенные команды выполняются на следующем EPOLLOUT: новых данных
+    // от клиента для EPOLLIN может уже не быть
+    if (pending > 0 || hasCompleteLine(conn)) {
+        wanted |= EPOLLOUT;
+    }
+    if (wanted == conn.events) {
+        return;
+    }
+
+    epoll_event event{};
+    event.events = wanted;
+    event.data.fd = conn.fd;
+    if (::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn.fd, &event) == 0) {
+        conn.events = wanted;
+    }
+}
+
+void Server::closeConnection(int fd) {
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections[fd].reset();
+}
+
+// ========== ServerClient ==========
+
+ServerClient::ServerClient() : fd(-1), input_pos(0) {}
+
+ServerClient::~ServerClient() { close(); }
+
+void ServerClient::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    input.clear();
+    input_pos = 0;
+}
+
+bool ServerClient::connectUnix(const string& path) {
+    close();
+    sockaddr_un address;
+    if (!fillUnixAddress(path, address)) {
+        return false;
+    }
+    fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool ServerClient::connectTcp(uint16_t port) {
+    close();
+    sockaddr_in address;
+    fillLoopbackAddress(port, address);
+    fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close();
+        return false;
+    }
+    setNoDelay(fd);
+    return true;
+}
+
+bool ServerClient::send(string_view commands) {
+    while (!commands.empty()) {
+        ssize_t sent = ::send(fd, commands.data(), commands.size(), MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        commands.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+bool ServerClient::finishSending() {
+    return fd >= 0 && ::shutdown(fd, SHUT_WR) == 0;
+}
+
+bool ServerClient::readReply(string& result) {
+    size_t length = 0;
+    bool have_length = false;
+    size_t body = 0;
+
+    while (true) {
+        if (!have_length) {
+            size_t end = input.find('\n', input_pos);
+            if (end != string::npos) {
+                const char* first = input.data() + input_pos;
+                const char* last = input.data() + end;
+                auto parsed = from_chars(first, last, length);
+                if (parsed.ec != errc() || parsed.ptr != last || first == last) {
+                    return false;
+                }
+                have_length = true;
+                body = end + 1;
+            }
+        }
+        if (have_length && input.size() - body >= length) {
+            result.assign(input, body, length);
+            input_pos = body + length;
+            compactBuffer(input, input_pos);
+            return true;
+        }
+
+        // Индексы выше отсчитываются от начала буфера, поэтому здесь его не сдвигаем
+        size_t old_size = input.size();
+        input.resize(old_size + READ_CHUNK);
+        ssize_t got = fd >= 0 ? ::recv(fd, &input[old_size], READ_CHUNK, 0) : -1;
+        input.resize(old_size + (got > 0 ? static_cast<size_t>(got) : 0));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+    }
+}
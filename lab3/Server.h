@@ -0,0 +1,108 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "DB.h"
+
+using namespace std;
+
+// Протокол сервера. Клиент шлет команды строками (разделитель '\n', '\r' перед
+// ним отбрасывается) и может не дожидаться ответов (конвейер). Ответы приходят
+// в порядке команд: длина ответа десятичным числом, '\n', затем сами байты
+// (ответ PRINT и подобных содержит переводы строк).
+constexpr size_t SERVER_MAX_LINE = 1 << 20;
+
+// Однопоточный сервер базы данных: неблокирующие сокеты и epoll. Команды
+// выполняются в потоке run() по одной, поэтому база не требует блокировок.
+class Server {
+private:
+    struct Connection {
+        int fd = -1;
+        string input;
+        size_t input_pos = 0;
+        string output;
+        size_t output_pos = 0;
+        bool reading = true;  // клиент еще присылает команды
+        uint32_t events = 0;  // на какие события подписаны в epoll
+    };
+
+    Database& db;
+    int epoll_fd;
+    int wake_fd;
+    vector<int> listen_fds;
+    string unix_path;
+    uint16_t tcp_port;
+    atomic<bool> stopping;
+
+    // Соединения, индексированные дескриптором
+    vector<unique_ptr<Connection>> connections;
+    // Переиспользуемый буфер ответа одной команды
+    string reply;
+
+    bool addListener(int fd);
+    void acceptClients(int listen_fd);
+    bool readInput(Connection& conn);
+    void processInput(Connection& conn);
+    bool writeOutput(Connection& conn);
+    static bool hasCompleteLine(const Connection& conn);
+    void handleConnection(Connection& conn, uint32_t flags);
+    void updateEvents(Connection& conn);
+    void closeConnection(int fd);
+
+public:
+    explicit Server(Database& database);
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    // Слушает Unix-сокет; существующий файл по этому пути заменяется
+    bool listenUnix(const string& path);
+    // Слушает 127.0.0.1:port; port 0 — выбрать свободный (см. port())
+    bool listenTcp(uint16_t port);
+    uint16_t port() const { return tcp_port; }
+
+    // Обрабатывает соединения, пока не будет вызван stop()
+    void run();
+    // Можно вызывать из любого потока
+    void stop();
+
+    size_t connectionCount() const;
+};
+
+// Блокирующий клиент протокола сервера (для тестов и генератора нагрузки)
+class ServerClient {
+private:
+    int fd;
+    string input;
+    size_t input_pos;
+
+public:
+    ServerClient();
+    ~ServerClient();
+
+    ServerClient(const ServerClient&) = delete;
+    ServerClient& operator=(const ServerClient&) = delete;
+
+    bool connectUnix(const string& path);
+    bool connectTcp(uint16_t port);
+    void close();
+    bool isConnected() const { return fd >= 0; }
+
+    // Отправляет одну или несколько команд; каждая должна оканчиваться '\n'
+    bool send(string_view commands);
+    // Закрывает передачу: сервер выполнит уже присланные команды, отдаст
+    // ответы и закроет соединение
+    bool finishSending();
+    // Читает следующий ответ; false при разрыве соединения или ошибке формата
+    bool readReply(string& result);
+};
+
+#endif
@@ -0,0 +1,423 @@
+#include "ShardedDatabase.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include <pthread.h>
+#include <sched.h>
+
+using namespace std;
+
+static constexpr size_t CROSS_SHARD = SIZE_MAX;
+
+// ========== Completion ==========
+
+// Счетчик уменьшается под блокировкой: ожидающий поток может уничтожить
+// Completion сразу после выхода из wait()
+void ShardedDatabase::Completion::finish() {
+    lock_guard<mutex> guard(lock);
+    if (--pending == 0) {
+        done.notify_all();
+    }
+}
+
+void ShardedDatabase::Completion::wait() {
+    unique_lock<mutex> guard(lock);
+    done.wait(guard, [this] { return pending == 0; });
+}
+
+// ========== ShardedDatabase ==========
+
+ShardedDatabase::ShardedDatabase(size_t shard_count, bool pin_threads) : stopping(false) {
+    if (shard_count == 0) {
+        shard_count = 1;
+    }
+    size_t cores = thread::hardware_concurrency();
+    shards.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards.push_back(make_unique<Shard>());
+        // Снимок каждого шарда невелик: кодирование идет в его же потоке
+        shards[i]->db.setSnapshotThreads(1);
+    }
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards[i]->worker = thread(&ShardedDatabase::workerLoop, this, i);
+        if (pin_threads && cores > 1) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(i % cores, &cpus);
+            pthread_setaffinity_np(shards[i]->worker.native_handle(), sizeof(cpus), &cpus);
+        }
+    }
+}
+
+ShardedDatabase::~ShardedDatabase() {
+    stopping.store(true);
+    for (auto& shard : shards) {
+        {
+            lock_guard<mutex> guard(shard->sleep_lock);
+            shard->wake.notify_one();
+        }
+        shard->worker.join();
+    }
+}
+
+size_t ShardedDatabase::shardOf(string_view name) const {
+    // FNV-1a с перемешиванием: индекс внутри шарда берет младшие биты своего
+    // хэша, поэтому шард выбирается независимой функцией
+    uint64_t h = 14695981039346656037ull;
+    for (char c : name) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return static_cast<size_t>(h % shards.size());
+}
+
+void ShardedDatabase::workerLoop(size_t index) {
+    Shard& shard = *shards[index];
+
+    while (true) {
+        MpscNode* node = shard.queue.pop();
+        if (node != nullptr) {
+            Task& task = *static_cast<Task*>(node);
+            if (task.job != nullptr) {
+                (*task.job)(shard.db, index);
+            } else {
+                for (size_t i = 0; i < task.count; ++i) {
+                    size_t position = task.indices[i];
+                    shard.db.executeCommand(task.commands[position], task.replies[position]);
+                }
+            }
+            task.completion->finish();
+            continue;
+        }
+
+        if (shard.queue.maybeNonEmpty()) {
+            // Производитель еще не закончил push
+            this_thread::yield();
+            continue;
+        }
+        if (stopping.load()) {
+            break;
+        }
+
+        unique_lock<mutex> guard(shard.sleep_lock);
+        shard.sleeping.store(true);
+        if (!shard.queue.maybeNonEmpty() && !stopping.load()) {
+            shard.wake.wait(guard);
+        }
+        shard.sleeping.store(false);
+    }
+}
+
+void ShardedDatabase::submit(size_t index, Task& task) {
+    Shard& shard = *shards[index];
+    shard.queue.push(&task);
+    // Поток шарда выставляет sleeping до последней проверки очереди, поэтому
+    // либо он увидит задание, либо мы увидим, что его нужно разбудить
+    if (shard.sleeping.load()) {
+        lock_guard<mutex> guard(shard.sleep_lock);
+        shard.wake.notify_one();
+    }
+}
+
+void ShardedDatabase::runOn(size_t shard, const function<void(Database&, size_t)>& job) {
+    Completion completion;
+    completion.pending = 1;
+    Task task;
+    task.job = &job;
+    task.completion = &completion;
+    submit(shard, task);
+    completion.wait();
+}
+
+void ShardedDatabase::runOnAll(const function<void(Database&, size_t)>& job) {
+    Completion completion;
+    completion.pending = shards.size();
+    vector<Task> tasks(shards.size());
+    for (size_t i = 0; i < shards.size(); ++i) {
+        tasks[i].job = &job;
+        tasks[i].completion = &completion;
+        submit(i, tasks[i]);
+    }
+    completion.wait();
+}
+
+size_t ShardedDatabase::route(const CommandTokens& tokens) const {
+    const CommandSpec* spec = tokens.empty() ? nullptr : findCommand(tokens[0]);
+    if (spec == nullptr) {
+        return 0;  // ошибку вернет любой шард
+    }
+    if (spec->family != CommandFamily::GENERAL) {
+        return tokens.size() < 2 ? 0 : shardOf(tokens[1]);
+    }
+
+    switch (spec->opcode) {
+        case Opcode::PRINT:
+        case Opcode::TYPE:
+        case Opcode::EXISTS:
+        case Opcode::DEL:
+            return tokens.size() < 2 ? 0 : shardOf(tokens[1]);
+        case Opcode::MEMORY:
+            // MEMORY USAGE <имя> — к шарду контейнера, MEMORY STATS — ко всем
+            if (tokens.size() >= 2 && isKeyword(tokens[1], "STATS")) {
+                return CROSS_SHARD;
+            }
+            return tokens.size() < 3 ? 0 : shardOf(tokens[2]);
+        case Opcode::RENAME:
+            if (tokens.size() < 3 || shardOf(tokens[1]) == shardOf(tokens[2])) {
+                return tokens.size() < 2 ? 0 : shardOf(tokens[1]);
+            }
+            return CROSS_SHARD;
+        case Opcode::SAVE:
+        case Opcode::BGSAVE:
+        case Opcode::LOAD:
+            return tokens.size() < 2 ? 0 : CROSS_SHARD;
+        case Opcode::STATS:
+            // Неизвестный формат: ошибку вернет любой шард
+            if (tokens.size() >= 2 && !isKeyword(tokens[1], "JSON") && !isKeyword(tokens[1], "PROMETHEUS") &&
+                !isKeyword(tokens[1], "RESET")) {
+                return 0;
+            }
+            return CROSS_SHARD;
+        case Opcode::SLOWLOG:
+            // Текущий порог и ошибки разбора одинаковы на всех шардах
+            if (tokens.size() < 2 || (isKeyword(tokens[1], "THRESHOLD") && tokens.size() < 3)) {
+                return 0;
+            }
+            if (isKeyword(tokens[1], "GET") || isKeyword(tokens[1], "LEN") || isKeyword(tokens[1], "RESET") ||
+                isKeyword(tokens[1], "THRESHOLD")) {
+                return CROSS_SHARD;
+            }
+            return 0;
+        case Opcode::LIST:
+        case Opcode::CLEAR:
+        case Opcode::INFO:
+            return CROSS_SHARD;
+        default:
+            return 0;
+    }
+}
+
+void ShardedDatabase::executeCrossShard(const CommandTokens& tokens, string& reply) {
+    Opcode opcode = findCommand(tokens[0])->opcode;
+
+    if (opcode == Opcode::RENAME) {
+        executeRename(tokens, reply);
+    } else if (opcode == Opcode::LIST) {
+        vector<vector<pair<string, ContainerType>>> parts(shards.size());
+        runOnAll([&parts](Database& db, size_t index) { db.collectContainers(parts[index]); });
+
+        vector<pair<string, ContainerType>> items;
+        for (auto& part : parts) {
+            move(part.begin(), part.end(), back_inserter(items));
+        }
+        Database::formatContainerList(items, reply);
+    } else if (opcode == Opcode::MEMORY) {
+        vector<MemorySummary> parts(shards.size());
+        runOnAll([&parts](Database& db, size_t index) { db.collectMemory(parts[index]); });
+
+        MemorySummary total;
+        for (const auto& part : parts) {
+            total += part;
+        }
+        Database::formatMemoryStats(total, reply);
+    } else if (opcode == Opcode::STATS || opcode == Opcode::INFO) {
+        executeStats(tokens, reply);
+    } else if (opcode == Opcode::SLOWLOG) {
+        executeSlowLog(tokens, reply);
+    } else if (opcode == Opcode::CLEAR) {
+        runOnAll([](Database& db, size_t) { db.clear(); });
+        reply += "SUCCESS: Database cleared";
+    } else {
+        executeFileCommand(tokens, reply);
+    }
+}
+
+void ShardedDatabase::executeStats(const CommandTokens& tokens, string& reply) {
+    if (tokens.size() >= 2 && isKeyword(tokens[1], "RESET")) {
+        runOnAll([](Database& db, size_t) { db.resetStats(); });
+        reply += "SUCCESS: Statistics reset";
+        return;
+    }
+
+    // Гистограммы, вызовы и ошибки по каждому коду складываются, списки
+    // контейнеров объединяются
+    vector<StatsSummary> parts(shards.size());
+    runOnAll([&parts](Database& db, size_t index) { db.collectStats(parts[index]); });
+    StatsSummary total;
+    for (const auto& part : parts) {
+        total += part;
+    }
+
+    if (findCommand(tokens[0])->opcode == Opcode::INFO) {
+        Database::formatInfo(total, reply);
+    } else if (tokens.size() < 2) {
+        Database::formatStats(total, StatsFormat::TEXT, reply);
+    } else {
+        Database::formatStats(total, isKeyword(tokens[1], "JSON") ? StatsFormat::JSON : StatsFormat::PROMETHEUS, reply);
+    }
+}
+
+void ShardedDatabase::executeSlowLog(const CommandTokens& tokens, string& reply) {
+    if (isKeyword(tokens[1], "RESET")) {
+        runOnAll([](Database& db, size_t) { db.resetSlowLog(); });
+        reply += "SUCCESS: Slow log reset";
+        return;
+    }
+    if (isKeyword(tokens[1], "THRESHOLD")) {
+        // Значение проверяет шард 0, остальные получают уже разобранный порог
+        string command = "SLOWLOG THRESHOLD " + string(tokens[2]);
+        uint64_t micros = 0;
+        runOn(0, [&](Database& db, size_t) {
+            db.executeCommand(command, reply);
+            micros = db.slowLog()->threshold();
+        });
+        if (reply.compare(0, 5, "ERROR") != 0) {
+            runOnAll([micros](Database& db, size_t) { db.setSlowLogThreshold(micros); });
+        }
+        return;
+    }
+    if (isKeyword(tokens[1], "LEN")) {
+        vector<size_t> sizes(shards.size());
+        runOnAll([&sizes](Database& db, size_t index) { sizes[index] = db.slowLog()->size(); });
+        size_t total = 0;
+        for (size_t size : sizes) {
+            total += size;
+        }
+        reply.append("LEN: ").append(to_string(total));
+        return;
+    }
+
+    int count = 10;
+    if (tokens.size() >= 3 && (!parseInt(tokens[2], count) || count < 0)) {
+        reply += "ERROR: Invalid count format";
+        return;
+    }
+    // Каждый шард отдает count своих последних записей; среди них точно
+    // есть count последних записей всей базы
+    vector<vector<SlowLogEntry>> parts(shards.size());
+    runOnAll([&parts, count](Database& db, size_t index) {
+        parts[index] = db.slowLog()->entries(static_cast<size_t>(count));
+    });
+    vector<SlowLogEntry> entries;
+    for (auto& part : parts) {
+        move(part.begin(), part.end(), back_inserter(entries));
+    }
+    stable_sort(entries.begin(), entries.end(),
+                [](const SlowLogEntry& a, const SlowLogEntry& b) { return a.timestamp_us > b.timestamp_us; });
+    if (entries.size() > static_cast<size_t>(count)) {
+        entries.resize(static_cast<size_t>(count));
+    }
+    Database::formatSlowLog(entries, reply);
+}
+
+void ShardedDatabase::executeRename(const CommandTokens& tokens, string& reply) {
+    string from(tokens[1]);
+    string to(tokens[2]);
+    ContainerHandle handle;
+
+    runOn(shardOf(from), [&](Database& db, size_t) { handle = db.takeContainer(from); });
+    if (handle.empty()) {
+        reply.append("ERROR: Container not found: ").append(from);
+        return;
+    }
+
+    bool adopted = false;
+    runOn(shardOf(to), [&](Database& db, size_t) { adopted = db.adoptContainer(to, handle); });
+    if (adopted) {
+        reply.append("SUCCESS: Container renamed: ").append(from).append(" -> ").append(to);
+        return;
+    }
+
+    // Имя занято: возвращаем контейнер на место
+    runOn(shardOf(from), [&](Database& db, size_t) { db.adoptContainer(from, handle); });
+    reply.append("ERROR: Name already in use: ").append(to);
+}
+
+void ShardedDatabase::executeFileCommand(const CommandTokens& tokens, string& reply) {
+    // Каждый шард работает со своим файлом: SAVE db.bin -> db.bin.shard0, ...
+    string prefix = string(tokens[0]) + " " + string(tokens[1]) + ".shard";
+    vector<string> replies(shards.size());
+    runOnAll([&prefix, &replies](Database& db, size_t index) {
+        db.executeCommand(prefix + to_string(index), replies[index]);
+    });
+
+    for (const auto& shard_reply : replies) {
+        if (shard_reply.compare(0, 5, "ERROR") == 0) {
+            reply += shard_reply;
+            return;
+        }
+    }
+    // Ответ первого шарда без суффикса файла
+    string suffix = ".shard0";
+    string& first = replies[0];
+    if (first.size() >= suffix.size() && first.compare(first.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        first.resize(first.size() - suffix.size());
+    }
+    reply += first;
+}
+
+string ShardedDatabase::executeCommand(string_view command) {
+    vector<string> replies;
+    executeBatch(&command, 1, replies);
+    return move(replies[0]);
+}
+
+void ShardedDatabase::executeBatch(const string_view* commands, size_t count, vector<string>& replies) {
+    replies.resize(count);
+    for (auto& reply : replies) {
+        reply.clear();
+    }
+
+    CommandTokens tokens;
+    vector<vector<size_t>> assigned(shards.size());
+    vector<Task> tasks(shards.size());
+
+    size_t start = 0;
+    while (start < count) {
+        for (auto& indices : assigned) {
+            indices.clear();
+        }
+
+        // Набираем команды до первой, затрагивающей несколько шардов
+        size_t end = start;
+        bool cross_shard = false;
+        for (; end < count; ++end) {
+            tokens.tokenize(commands[end]);
+            size_t shard = route(tokens);
+            if (shard == CROSS_SHARD) {
+                cross_shard = true;
+                break;
+            }
+            assigned[shard].push_back(end);
+        }
+
+        Completion completion;
+        for (const auto& indices : assigned) {
+            completion.pending += indices.empty() ? 0 : 1;
+        }
+        for (size_t i = 0; i < shards.size(); ++i) {
+            if (assigned[i].empty()) {
+                continue;
+            }
+            tasks[i].commands = commands;
+            tasks[i].indices = assigned[i].data();
+            tasks[i].count = assigned[i].size();
+            tasks[i].replies = replies.data();
+            tasks[i].job = nullptr;
+            tasks[i].completion = &completion;
+            submit(i, tasks[i]);
+        }
+        completion.wait();
+
+        // tokens все еще ссылаются на команду commands[end]
+        if (cross_shard) {
+            executeCrossShard(tokens, replies[end]);
+            ++end;
+        }
+        start = end;
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef SHARDEDDATABASE_H
+#define SHARDEDDATABASE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "DB.h"
+#include "MpscQueue.h"
+
+using namespace std;
+
+// База, разделенная на шарды без общего состояния. Имя контейнера хэшируется
+// в номер шарда; каждым шардом (своим Database) владеет отдельный поток,
+// который получает работу через очередь без блокировок. Команды к одному
+// контейнеру выполняются в порядке отправки.
+//
+// Команды без имени расходятся по всем шардам и собираются обратно:
+// LIST объединяет списки, MEMORY STATS, STATS, INFO и SLOWLOG LEN складывают
+// данные шардов, SLOWLOG GET сливает их записи по времени; CLEAR, STATS
+// RESET, SLOWLOG RESET и SLOWLOG THRESHOLD применяются ко всем шардам.
+// SAVE/BGSAVE/LOAD <файл> работают с файлами <файл>.shard<N> (загружать
+// нужно при том же числе шардов). RENAME между шардами переносит контейнер
+// и не атомарен относительно других клиентов.
+class ShardedDatabase {
+private:
+    // Дожидается выполнения всех заданий, отправленных вызывающим потоком
+    struct Completion {
+        mutex lock;
+        condition_variable done;
+        size_t pending = 0;
+
+        void finish();
+        void wait();
+    };
+
+    // Работа для одного шарда: часть пакета команд или произвольная функция
+    struct Task : MpscNode {
+        const string_view* commands = nullptr;
+        const size_t* indices = nullptr;  // номера команд этого шарда в пакете
+        size_t count = 0;
+        string* replies = nullptr;
+        const function<void(Database&, size_t)>* job = nullptr;
+        Completion* completion = nullptr;
+    };
+
+    struct Shard {
+        Database db;
+        MpscQueue queue;
+        thread worker;
+
+        // Поток шарда засыпает, только если очередь пуста
+        mutex sleep_lock;
+        condition_variable wake;
+        atomic<bool> sleeping{false};
+    };
+
+    vector<unique_ptr<Shard>> shards;
+    atomic<bool> stopping;
+
+    void workerLoop(size_t index);
+    void submit(size_t shard, Task& task);
+    // Выполняет job на каждом шарде параллельно и дожидается всех
+    void runOnAll(const function<void(Database&, size_t)>& job);
+    void runOn(size_t shard, const function<void(Database&, size_t)>& job);
+
+    // Номер шарда для команды или SIZE_MAX, если она затрагивает несколько шардов
+    size_t route(const CommandTokens& tokens) const;
+    void executeCrossShard(const CommandTokens& tokens, string& reply);
+    void executeStats(const CommandTokens& tokens, string& reply);
+    void executeSlowLog(const CommandTokens& tokens, string& reply);
+    void executeRename(const CommandTokens& tokens, string& reply);
+    void executeFileCommand(const CommandTokens& tokens, string& reply);
+
+public:
+    // pin_threads — привязать поток каждого шарда к своему ядру
+    explicit ShardedDatabase(size_t shard_count, bool pin_threads = true);
+    ~ShardedDatabase();
+
+    ShardedDatabase(const ShardedDatabase&) = delete;
+    ShardedDatabase& operator=(const ShardedDatabase&) = delete;
+
+    size_t shardCount() const { return shards.size(); }
+    size_t shardOf(string_view name) const;
+
+    // Потокобезопасно: команды можно отправлять из нескольких потоков сразу
+    string executeCommand(string_view command);
+
+    // Пакет команд: шарды выполняют свои части параллельно, replies[i] —
+    // ответ на commands[i]. Команды нескольких шардов разделяют пакет на части,
+    // выполняемые по очереди.
+    void executeBatch(const string_view* commands, size_t count, vector<string>& replies);
+};
+
+#endif
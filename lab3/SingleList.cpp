@@ -19,106 +19,122 @@ SingleList::SingleList(const SingleList& other) {
     head = nullptr;
     tail = nullptr;
     size = 0;
+    set_value_index(other.has_value_index());
 
-    SNode* current = other.head;
-    while (current != nullptr) {
-        push_back(current->data);
-        current = current->next;
+    for (const string& value : other) {
+        push_back(value);
     }
 }
 
 SingleList& SingleList::operator=(const SingleList& other) {
     if (this != &other) {
         clear();
-        SNode* current = other.head;
-        while (current != nullptr) {
-            push_back(current->data);
-            current = current->next;
+        set_value_index(other.has_value_index());
+        for (const string& value : other) {
+            push_back(value);
         }
     }
     return *this;
 }
 
 void SingleList::clear() {
+    // Узлы разрушаются на месте, а память пула освобождается целыми блоками
     SNode* current = head;
     while (current != nullptr) {
         SNode* temp = current;
         current = current->next;
-        delete temp;
+        temp->~SNode();
     }
+    pool.release();
+    index.clear();
     head = nullptr;
     tail = nullptr;
     size = 0;
 }
 
-void SingleList::push_front(const string& value) {
-    SNode* new_node = new SNode(value);
-    new_node->next = head;
-    head = new_node;
+SNode* SingleList::locate(const string& value, SNode*& prev, SNode** before_prev) const {
+    if (index.enabled()) {
+        SNode* node = index.first(value);
+        prev = node != nullptr ? index.previous(node) : nullptr;
+        if (before_prev != nullptr) {
+            *before_prev = prev != nullptr ? index.previous(prev) : nullptr;
+        }
+        return node;
+    }
 
-    if (tail == nullptr) {
-        tail = new_node;
+    SNode* previous = nullptr;
+    prev = nullptr;
+    for (SNode* current = head; current != nullptr; current = current->next) {
+        if (current->data == value) {
+            if (before_prev != nullptr) {
+                *before_prev = previous;
+            }
+            return current;
+        }
+        previous = prev;
+        prev = current;
     }
-    size++;
+    prev = nullptr;
+    return nullptr;
 }
 
-void SingleList::push_back(const string& value) {
-    SNode* new_node = new SNode(value);
-
-    if (tail == nullptr) {
-        head = new_node;
-        tail = new_node;
+void SingleList::link_after(SNode* prev, SNode* node) {
+    if (prev == nullptr) {
+        node->next = head;
+        head = node;
     } else {
-        tail->next = new_node;
-        tail = new_node;
+        node->next = prev->next;
+        prev->next = node;
+    }
+    if (node->next == nullptr) {
+        tail = node;
+    }
+    if (index.enabled()) {
+        index.inserted(node, prev);
     }
     size++;
 }
 
-bool SingleList::insert_before(const string& target, const string& value) {
-    if (head == nullptr)
-        return false;
-
-    if (head->data == target) {
-        push_front(value);
-        return true;
+void SingleList::unlink(SNode* prev, SNode* node) {
+    if (index.enabled()) {
+        index.removed(node);
     }
-
-    SNode* current = head;
-    while (current->next != nullptr && current->next->data != target) {
-        current = current->next;
+    if (prev == nullptr) {
+        head = node->next;
+    } else {
+        prev->next = node->next;
     }
+    if (node == tail) {
+        tail = prev;
+    }
+    pool.destroy(node);
+    size--;
+}
 
-    if (current->next == nullptr)
-        return false;
+void SingleList::push_front(const string& value) {
+    link_after(nullptr, pool.create(value));
+}
 
-    SNode* new_node = new SNode(value);
-    new_node->next = current->next;
-    current->next = new_node;
-    size++;
-    return true;
+void SingleList::push_back(const string& value) {
+    link_after(tail, pool.create(value));
 }
 
-bool SingleList::insert_after(const string& target, const string& value) {
-    if (head == nullptr)
+bool SingleList::insert_before(const string& target, const string& value) {
+    SNode* prev;
+    if (locate(target, prev) == nullptr)
         return false;
 
-    SNode* current = head;
-    while (current != nullptr && current->data != target) {
-        current = current->next;
-    }
+    link_after(prev, pool.create(value));
+    return true;
+}
 
+bool SingleList::insert_after(const string& target, const string& value) {
+    SNode* prev;
+    SNode* current = locate(target, prev);
     if (current == nullptr)
         return false;
 
-    SNode* new_node = new SNode(value);
-    new_node->next = current->next;
-    current->next = new_node;
-
-    if (current == tail) {
-        tail = new_node;
-    }
-    size++;
+    link_after(current, pool.create(value));
     return true;
 }
 
@@ -126,15 +142,7 @@ bool SingleList::pop_front() {
     if (head == nullptr)
         return false;
 
-    SNode* temp = head;
-    head = head->next;
-
-    if (head == nullptr) {
-        tail = nullptr;
-    }
-
-    delete temp;
-    size--;
+    unlink(nullptr, head);
     return true;
 }
 
@@ -142,187 +150,161 @@ bool SingleList::pop_back() {
     if (head == nullptr)
         return false;
 
-    if (head == tail) {
-        delete head;
-        head = nullptr;
-        tail = nullptr;
-        size--;
-        return true;
-    }
-
-    SNode* current = head;
-    while (current->next != tail) {
-        current = current->next;
+    // С индексом предыдущий узел известен, без него — проход от головы
+    SNode* prev = nullptr;
+    if (index.enabled()) {
+        prev = index.previous(tail);
+    } else if (head != tail) {
+        prev = head;
+        while (prev->next != tail) {
+            prev = prev->next;
+        }
     }
-
-    delete tail;
-    current->next = nullptr;
-    tail = current;
-    size--;
+    unlink(prev, tail);
     return true;
 }
 
 bool SingleList::remove_before(const string& target) {
-    if (head == nullptr || head->data == target)
+    SNode* prev;
+    SNode* before_prev;
+    if (locate(target, prev, &before_prev) == nullptr || prev == nullptr)
         return false;
 
-    if (head->next != nullptr && head->next->data == target) {
-        return pop_front();
-    }
-
-    SNode* current = head;
-    while (current->next != nullptr && current->next->next != nullptr) {
-        if (current->next->next->data == target) {
-            SNode* temp = current->next;
-            current->next = temp->next;
-            delete temp;
-            size--;
-            return true;
-        }
-        current = current->next;
-    }
-    return false;
+    unlink(before_prev, prev);
+    return true;
 }
 
 bool SingleList::remove_after(const string& target) {
-    SNode* current = head;
-    while (current != nullptr && current->data != target) {
-        current = current->next;
-    }
-
+    SNode* prev;
+    SNode* current = locate(target, prev);
     if (current == nullptr || current->next == nullptr)
         return false;
 
-    SNode* temp = current->next;
-    current->next = temp->next;
-
-    if (temp == tail) {
-        tail = current;
-    }
-
-    delete temp;
-    size--;
+    unlink(current, current->next);
     return true;
 }
 
 bool SingleList::remove_value(const string& value) {
-    if (head == nullptr)
-        return false;
-
-    if (head->data == value) {
-        return pop_front();
-    }
-
-    SNode* current = head;
-    while (current->next != nullptr && current->next->data != value) {
-        current = current->next;
-    }
-
-    if (current->next == nullptr)
+    SNode* prev;
+    SNode* current = locate(value, prev);
+    if (current == nullptr)
         return false;
 
-    SNode* temp = current->next;
-    current->next = temp->next;
-
-    if (temp == tail) {
-        tail = current;
-    }
-
-    delete temp;
-    size--;
+    unlink(prev, current);
     return true;
 }
 
 SNode* SingleList::find(const string& value) {
-    SNode* current = head;
-    while (current != nullptr) {
-        if (current->data == value) {
-            return current;
-        }
-        current = current->next;
+    SNode* prev;
+    return locate(value, prev);
+}
+
+void SingleList::set_value_index(bool enabled) {
+    if (enabled) {
+        index.enable(head);
+    } else if (index.enabled()) {
+        index.disable(head);
     }
-    return nullptr;
 }
 
 void SingleList::print_forward() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    print_forward(out);
+}
+
+void SingleList::print_forward(TextWriter& out) const {
     if (head == nullptr) {
-        cout << "Односвязный список пуст" << endl;
+        out << "Односвязный список пуст\n";
         return;
     }
 
-    cout << "Односвязный список [" << size << "]: ";
-    SNode* current = head;
-    while (current != nullptr) {
-        cout << current->data;
-        if (current->next != nullptr) {
-            cout << " -> ";
+    out << "Односвязный список [" << size << "]: ";
+    for (iterator it = begin(); it != end();) {
+        out << *it;
+        if (++it != end()) {
+            out << " -> ";
         }
-        current = current->next;
     }
-    cout << endl;
+    out << '\n';
 }
 
-void SingleList::print_backward_helper(SNode* node) const {
-    if (node == nullptr)
-        return;
-    print_backward_helper(node->next);
-    cout << node->data;
-    if (node != head) {
-        cout << " <- ";
-    }
+void SingleList::print_backward() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    print_backward(out);
 }
 
-void SingleList::print_backward() const {
+void SingleList::print_backward(TextWriter& out) const {
     if (head == nullptr) {
-        cout << "Односвязный список пуст" << endl;
+        out << "Односвязный список пуст\n";
         return;
     }
 
-    cout << "Односвязный список в обратном порядке [" << size << "]: ";
-    print_backward_helper(head);
-    cout << endl;
+    out << "Односвязный список в обратном порядке [" << size << "]: ";
+    int remaining = size;
+    for_each_backward([&](const string& value) {
+        out << value;
+        if (--remaining > 0) {
+            out << " <- ";
+        }
+    });
+    out << '\n';
 }
 
 int SingleList::get_size() const {
     return size;
 }
 
-bool SingleList::serialize_binary(const string& filename) const {
-    ofstream file(filename, ios::binary);
-    if (!file.is_open()) {
-        return false;
+MemoryUsage SingleList::memory_usage() const {
+    MemoryUsage usage;
+    usage.bytes = sizeof(SingleList);
+    pool.addTo(usage);
+    for (SNode* node = head; node != nullptr; node = node->next) {
+        usage.addString(node->data);
     }
+    usage += index.memory_usage();
+    return usage;
+}
 
-    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+MemoryUsage SingleList::index_memory_usage() const {
+    return index.memory_usage();
+}
 
-    SNode* current = head;
-    while (current != nullptr) {
-        size_t str_size = current->data.size();
-        file.write(reinterpret_cast<const char*>(&str_size), sizeof(str_size));
-        file.write(current->data.c_str(), str_size);
-        current = current->next;
+bool SingleList::serialize_binary(const string& filename) const {
+    return writeBinaryFile(filename, *this);
+}
+
+bool SingleList::deserialize_binary(const string& filename) {
+    return readBinaryFile(filename, *this);
+}
+
+void SingleList::serialize_binary(ByteWriter& out) const {
+    uint64_t bytes = 0;
+    for (const string& value : *this) {
+        bytes += value.size();
     }
 
-    return true;
+    out.writeBulkHeader(static_cast<uint32_t>(size), bytes);
+    for (const string& value : *this) {
+        out.writeString(value);
+    }
 }
 
-bool SingleList::deserialize_binary(const string& filename) {
-    ifstream file(filename, ios::binary);
-    if (!file.is_open()) {
+bool SingleList::deserialize_binary(ByteReader& in) {
+    uint32_t new_size;
+    uint64_t bytes;
+    if (!in.readBulkHeader(new_size, bytes, 4)) {
         return false;
     }
 
-    int new_size;
-    file.read(reinterpret_cast<char*>(&new_size), sizeof(new_size));
-
     clear();
 
-    for (int i = 0; i < new_size; ++i) {
-        size_t str_size;
-        file.read(reinterpret_cast<char*>(&str_size), sizeof(str_size));
-
-        string value(str_size, '\0');
-        file.read(&value[0], str_size);
+    string value;
+    for (uint32_t i = 0; i < new_size; ++i) {
+        if (!in.readString(value)) {
+            return false;
+        }
         push_back(value);
     }
 
@@ -337,10 +319,8 @@ bool SingleList::serialize_text(const string& filename) const {
 
     file << size << endl;
 
-    SNode* current = head;
-    while (current != nullptr) {
-        file << current->data << endl;
-        current = current->next;
+    for (const string& value : *this) {
+        file << value << endl;
     }
 
     return true;
@@ -1,8 +1,18 @@
 #ifndef SINGLELIST_H
 #define SINGLELIST_H
 
+#include <cmath>
 #include <fstream>
+#include <iterator>
 #include <string>
+#include <vector>
+
+#include "ByteStream.h"
+#include "ListIterator.h"
+#include "MemoryUsage.h"
+#include "NodePool.h"
+#include "TextWriter.h"
+#include "ValueIndex.h"
 
 using namespace std;
 
@@ -10,8 +20,9 @@ class SNode {
 public:
     string data;
     SNode* next;
+    ValueLink<SNode>* link;  // запись индекса значений; nullptr без индекса
 
-    SNode(const string& value = "") : data(value), next(nullptr) {}
+    SNode(const string& value = "") : data(value), next(nullptr), link(nullptr) {}
 };
 
 class SingleList {
@@ -19,11 +30,23 @@ private:
     SNode* head;
     SNode* tail;
     int size;
+    // Узлы списка; при очистке и разрушении память отдается блоками
+    NodePool<SNode> pool;
+    // Необязательный индекс значение -> узлы (set_value_index)
+    ValueIndex<SNode> index;
 
-    void print_backward_helper(SNode* node) const;
     void clear();
+    // Первый узел со значением value и предыдущий перед ним (before_prev —
+    // узел перед prev)
+    SNode* locate(const string& value, SNode*& prev, SNode** before_prev = nullptr) const;
+    void link_after(SNode* prev, SNode* node);  // prev == nullptr — в начало
+    void unlink(SNode* prev, SNode* node);
 
 public:
+    // Прямые итераторы по значениям (только чтение)
+    using iterator = ListIterator<SNode, forward_iterator_tag>;
+    using const_iterator = iterator;
+
     SingleList();
     ~SingleList();
     SingleList(const SingleList& other);
@@ -41,14 +64,73 @@ public:
     SNode* find(const string& value);
     SNode* find_first() const { return head; }
     SNode* find_next(SNode* current) const { return current ? current->next : nullptr; }
+    iterator begin() const { return iterator(head); }
+    iterator end() const { return iterator(); }
+    // Обход от хвоста к голове без рекурсии и без изменения списка.
+    // С индексом значений — по ссылкам на предыдущий узел. Без него список
+    // делится на участки по sqrt(n) узлов: запоминаются начала участков, и
+    // каждый участок, начиная с последнего, собирается в буфер и проходится
+    // с конца. O(n) времени и O(sqrt(n)) памяти при любой длине.
+    template <typename Visitor>
+    void for_each_backward(Visitor visit) const;
     void print_forward() const;
+    void print_forward(TextWriter& out) const;
     void print_backward() const;
+    void print_backward(TextWriter& out) const;
     int get_size() const;
+    // Индекс значений: find, insert_before/after, remove_before/after/value и
+    // pop_back работают за O(1) вместо прохода от головы. Каждый узел
+    // дополнительно занимает запись индекса, а каждое различное значение —
+    // элемент хэш-таблицы.
+    void set_value_index(bool enabled);
+    bool has_value_index() const { return index.enabled(); }
+    // Занятая память: объект, блоки в куче и емкость строк (вместе с индексом)
+    MemoryUsage memory_usage() const;
+    // Только индекс значений
+    MemoryUsage index_memory_usage() const;
 
     bool serialize_binary(const string& filename) const;
     bool deserialize_binary(const string& filename);
     bool serialize_text(const string& filename) const;
     bool deserialize_text(const string& filename);
+
+    // Сериализация в память (снимки базы данных)
+    void serialize_binary(ByteWriter& out) const;
+    bool deserialize_binary(ByteReader& in);
 };
 
+template <typename Visitor>
+void SingleList::for_each_backward(Visitor visit) const {
+    if (index.enabled()) {
+        for (const SNode* node = tail; node != nullptr; node = index.previous(node)) {
+            visit(node->data);
+        }
+        return;
+    }
+
+    size_t step = static_cast<size_t>(sqrt(static_cast<double>(size)));
+    step = step > 0 ? step : 1;
+    vector<const SNode*> starts;
+    starts.reserve(static_cast<size_t>(size) / step + 1);
+    size_t position = 0;
+    for (const SNode* node = head; node != nullptr; node = node->next, ++position) {
+        if (position % step == 0) {
+            starts.push_back(node);
+        }
+    }
+
+    vector<const SNode*> segment;
+    segment.reserve(step);
+    for (size_t i = starts.size(); i-- > 0;) {
+        const SNode* stop = i + 1 < starts.size() ? starts[i + 1] : nullptr;
+        segment.clear();
+        for (const SNode* node = starts[i]; node != stop; node = node->next) {
+            segment.push_back(node);
+        }
+        for (size_t j = segment.size(); j-- > 0;) {
+            visit(segment[j]->data);
+        }
+    }
+}
+
 #endif
\ No newline at end of file
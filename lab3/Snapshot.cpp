@@ -0,0 +1,533 @@
+#include "Snapshot.h"
+
+#include "ByteStream.h"
+#include "Checksum.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static constexpr char SNAPSHOT_MAGIC[8] = {'L', '3', 'S', 'N', 'A', 'P', '\r', '\n'};
+
+// CRC-32 заголовка — последнее поле, он покрывает все байты до себя
+static constexpr size_t HEADER_CRC_OFFSET = 36;
+
+struct SnapshotHeader {
+    uint32_t section_count;
+    uint64_t table_offset;
+    uint64_t table_length;
+    uint32_t table_crc;
+};
+
+// Проверяет сигнатуру, версию и контрольную сумму заголовка
+static bool parseHeader(const char* data, SnapshotHeader& header) {
+    if (memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        return false;
+    }
+    ByteReader in(data, SNAPSHOT_HEADER_SIZE);
+    uint32_t version;
+    uint32_t header_crc;
+    in.skip(sizeof(SNAPSHOT_MAGIC));
+    in.readU32(version);
+    in.readU32(header.section_count);
+    in.readU64(header.table_offset);
+    in.readU64(header.table_length);
+    in.readU32(header.table_crc);
+    in.readU32(header_crc);
+    return header_crc == crc32(data, HEADER_CRC_OFFSET) && version == SNAPSHOT_VERSION;
+}
+
+// ========== Запись ==========
+
+template <typename T>
+static void encodeContainer(const ContainerHandle& handle, ByteWriter& out) {
+    handle.get<T>()->serialize_binary(out);
+}
+
+static void encodeSection(const ContainerHandle& handle, ByteWriter& out) {
+    switch (handle.type()) {
+        case ContainerType::ARRAY:
+            encodeContainer<Array>(handle, out);
+            break;
+        case ContainerType::SINGLY_LIST:
+            encodeContainer<SingleList>(handle, out);
+            break;
+        case ContainerType::DOUBLY_LIST:
+            encodeContainer<DoubleList>(handle, out);
+            break;
+        case ContainerType::STACK:
+            encodeContainer<Stack>(handle, out);
+            break;
+        case ContainerType::QUEUE:
+            encodeContainer<Queue>(handle, out);
+            break;
+        case ContainerType::TREE:
+            encodeContainer<FullBinaryTree>(handle, out);
+            break;
+        case ContainerType::HASH_TABLE:
+            encodeContainer<DoubleHashTable>(handle, out);
+            break;
+        case ContainerType::NONE:
+            break;
+    }
+}
+
+// Небольшие базы быстрее обработать в одном потоке, чем запускать пул
+static constexpr size_t PARALLEL_MIN_SECTIONS = 64;
+
+static void forEachSection(size_t count, size_t threads, const function<void(size_t)>& body) {
+    if (threads <= 1 || count < PARALLEL_MIN_SECTIONS) {
+        for (size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+    ThreadPool pool(min(threads, count));
+    pool.parallelFor(count, body);
+}
+
+// Порядок секций не зависит от устройства индекса и числа потоков:
+// одна и та же база всегда дает побайтно одинаковый файл
+template <typename EntryType>
+static void sortByName(vector<EntryType*>& entries) {
+    sort(entries.begin(), entries.end(), [](EntryType* a, EntryType* b) { return a->name < b->name; });
+}
+
+// Кодирует секции независимо друг от друга; смещения назначает вызывающий
+template <typename EntryType>
+static void encodeSections(const vector<EntryType*>& entries, size_t threads, vector<string>& sections,
+                           vector<SectionLocation>& locations) {
+    sections.assign(entries.size(), string());
+    locations.assign(entries.size(), SectionLocation());
+    forEachSection(entries.size(), threads, [&](size_t i) {
+        BufferSink sink(sections[i]);
+        {
+            ByteWriter out(sink);
+            encodeSection(entries[i]->handle, out);
+        }
+        locations[i].length = sections[i].size();
+        locations[i].checksum = crc32(sections[i].data(), sections[i].size());
+    });
+}
+
+template <typename EntryType>
+static void encodeTable(const vector<EntryType*>& entries, const vector<SectionLocation>& locations,
+                        string& table) {
+    table.clear();
+    BufferSink sink(table);
+    ByteWriter out(sink);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        out.writeU8(static_cast<uint8_t>(entries[i]->handle.type()));
+        out.writeString(entries[i]->name);
+        out.writeU64(locations[i].offset);
+        out.writeU64(locations[i].length);
+        out.writeU32(locations[i].checksum);
+    }
+}
+
+static void encodeHeader(size_t section_count, uint64_t table_offset, uint64_t table_length, uint32_t table_crc,
+                         string& header) {
+    header.clear();
+    BufferSink sink(header);
+    ByteWriter out(sink);
+    out.writeBytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    out.writeU32(SNAPSHOT_VERSION);
+    out.writeU32(static_cast<uint32_t>(section_count));
+    out.writeU64(table_offset);
+    out.writeU64(table_length);
+    out.writeU32(table_crc);
+    out.flush();
+    out.writeU32(crc32(header.data(), HEADER_CRC_OFFSET));
+    out.flush();
+}
+
+// Снимок по частям: секции кодируются независимо, а записываются по порядку
+struct EncodedSnapshot {
+    string header;
+    vector<string> sections;
+    vector<SectionLocation> locations;
+    string table;
+    uint64_t table_offset = 0;
+    uint32_t table_crc = 0;
+};
+
+template <typename EntryType>
+static void encodeParts(const vector<EntryType*>& entries, size_t threads, EncodedSnapshot& image) {
+    encodeSections(entries, threads, image.sections, image.locations);
+
+    uint64_t offset = SNAPSHOT_HEADER_SIZE;
+    for (SectionLocation& location : image.locations) {
+        location.offset = offset;
+        offset += location.length;
+    }
+    encodeTable(entries, image.locations, image.table);
+    image.table_offset = offset;
+    image.table_crc = crc32(image.table.data(), image.table.size());
+    encodeHeader(entries.size(), offset, image.table.size(), image.table_crc, image.header);
+}
+
+// Единственный писатель: мелкие части склеиваются в блоки, крупные
+// уходят в файл напрямую
+static bool writeParts(int fd, const string& first, const vector<string>& sections, const string& last) {
+    FdSink sink(fd);
+    ByteWriter out(sink);
+    out.writeBytes(first.data(), first.size());
+    for (const string& section : sections) {
+        out.writeBytes(section.data(), section.size());
+    }
+    out.writeBytes(last.data(), last.size());
+    return out.flush();
+}
+
+// rename и создание файла становятся надежными только после fsync каталога
+static bool syncParentDirectory(const string& filename) {
+    size_t slash = filename.rfind('/');
+    string directory = slash == string::npos ? "." : filename.substr(0, slash == 0 ? 1 : slash);
+    int fd = ::open(directory.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+static bool writeWholeFile(const string& filename, const EncodedSnapshot& image) {
+    // Старый снимок заменяется только целиком записанным новым. Во временном
+    // имени есть pid: фоновое сохранение в дочернем процессе не мешает обычному.
+    string temp_filename = filename + ".tmp." + to_string(::getpid());
+    int fd = ::open(temp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    // Без fsync до rename после сбоя на месте прежнего снимка может
+    // оказаться пустой или обрезанный файл
+    bool ok = writeParts(fd, image.header, image.sections, image.table) && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+
+    if (!ok || ::rename(temp_filename.c_str(), filename.c_str()) != 0) {
+        ::unlink(temp_filename.c_str());
+        return false;
+    }
+    return syncParentDirectory(filename);
+}
+
+static vector<const ContainerIndex::Entry*> sortedEntries(const ContainerIndex& containers) {
+    vector<const ContainerIndex::Entry*> entries;
+    entries.reserve(containers.size());
+    for (const auto& entry : containers) {
+        entries.push_back(&entry);
+    }
+    sortByName(entries);
+    return entries;
+}
+
+static vector<ContainerIndex::Entry*> sortedEntries(ContainerIndex& containers) {
+    vector<ContainerIndex::Entry*> entries;
+    entries.reserve(containers.size());
+    for (auto& entry : containers) {
+        entries.push_back(&entry);
+    }
+    sortByName(entries);
+    return entries;
+}
+
+void encodeSnapshot(const ContainerIndex& containers, string& buffer, size_t threads) {
+    EncodedSnapshot image;
+    encodeParts(sortedEntries(containers), threads, image);
+
+    size_t total = image.header.size() + image.table.size();
+    for (const string& section : image.sections) {
+        total += section.size();
+    }
+
+    buffer.clear();
+    buffer.reserve(total);
+    buffer += image.header;
+    for (const string& section : image.sections) {
+        buffer += section;
+    }
+    buffer += image.table;
+}
+
+bool writeSnapshotFile(const string& filename, const ContainerIndex& containers, size_t threads) {
+    EncodedSnapshot image;
+    encodeParts(sortedEntries(containers), threads, image);
+    return writeWholeFile(filename, image);
+}
+
+// ========== Инкрементальная запись ==========
+
+// Файл можно дописывать, только если это ровно тот снимок, который база
+// записала или прочитала последней
+static bool matchesState(int fd, const SnapshotFileState& state) {
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) != state.file_size) {
+        return false;
+    }
+
+    char data[SNAPSHOT_HEADER_SIZE];
+    SnapshotHeader header;
+    return ::pread(fd, data, sizeof(data), 0) == static_cast<ssize_t>(sizeof(data)) && parseHeader(data, header) &&
+           header.table_offset == state.table_offset && header.table_crc == state.table_crc;
+}
+
+static void markSaved(const vector<ContainerIndex::Entry*>& entries, const vector<SectionLocation>& locations) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        entries[i]->saved = locations[i];
+        entries[i]->dirty = false;
+    }
+}
+
+static bool rewriteSnapshotFile(const string& filename, const vector<ContainerIndex::Entry*>& entries,
+                                SnapshotFileState& state, size_t threads) {
+    EncodedSnapshot image;
+    encodeParts(entries, threads, image);
+    if (!writeWholeFile(filename, image)) {
+        return false;
+    }
+
+    markSaved(entries, image.locations);
+    state.path = filename;
+    state.file_size = image.table_offset + image.table.size();
+    state.table_offset = image.table_offset;
+    state.table_crc = image.table_crc;
+    return true;
+}
+
+bool updateSnapshotFile(const string& filename, ContainerIndex& containers, SnapshotFileState& state,
+                        size_t threads) {
+    vector<ContainerIndex::Entry*> entries = sortedEntries(containers);
+    if (state.path != filename) {
+        return rewriteSnapshotFile(filename, entries, state, threads);
+    }
+
+    int fd = ::open(filename.c_str(), O_RDWR);
+    if (fd < 0) {
+        return rewriteSnapshotFile(filename, entries, state, threads);
+    }
+    if (!matchesState(fd, state)) {
+        ::close(fd);
+        return rewriteSnapshotFile(filename, entries, state, threads);
+    }
+
+    vector<ContainerIndex::Entry*> changed;
+    for (ContainerIndex::Entry* entry : entries) {
+        if (entry->dirty) {
+            changed.push_back(entry);
+        }
+    }
+
+    vector<string> sections;
+    vector<SectionLocation> changed_locations;
+    encodeSections(changed, threads, sections, changed_locations);
+
+    // Новые секции идут за концом файла, остальные остаются на месте
+    vector<SectionLocation> locations(entries.size());
+    uint64_t offset = state.file_size;
+    uint64_t live_bytes = SNAPSHOT_HEADER_SIZE;
+    for (size_t i = 0, j = 0; i < entries.size(); ++i) {
+        if (entries[i]->dirty) {
+            locations[i] = changed_locations[j++];
+            locations[i].offset = offset;
+            offset += locations[i].length;
+        } else {
+            locations[i] = entries[i]->saved;
+        }
+        live_bytes += locations[i].length;
+    }
+    uint64_t table_offset = offset;
+
+    string table;
+    encodeTable(entries, locations, table);
+    uint64_t file_size = table_offset + table.size();
+    live_bytes += table.size();
+
+    // Когда устаревшие секции занимают больше половины файла, он
+    // переписывается целиком
+    if (file_size > 2 * live_bytes) {
+        ::close(fd);
+        return rewriteSnapshotFile(filename, entries, state, threads);
+    }
+
+    uint32_t table_crc = crc32(table.data(), table.size());
+    string header;
+    encodeHeader(entries.size(), table_offset, table.size(), table_crc, header);
+
+    // Сначала дописанные данные попадают на диск, и только потом заголовок
+    // переключается на новую таблицу: при сбое остается прежний снимок.
+    // SUCCESS отдается только после того, как на диске и сам заголовок.
+    bool ok = ::lseek(fd, static_cast<off_t>(state.file_size), SEEK_SET) >= 0 &&
+              writeParts(fd, string(), sections, table) && ::fdatasync(fd) == 0 &&
+              ::pwrite(fd, header.data(), header.size(), 0) == static_cast<ssize_t>(header.size()) &&
+              ::fdatasync(fd) == 0;
+    // После ошибки размер файла уже не совпадает с state, и следующее
+    // сохранение перепишет его целиком
+    ok = ::close(fd) == 0 && ok;
+    if (!ok) {
+        return false;
+    }
+
+    markSaved(entries, locations);
+    state.file_size = file_size;
+    state.table_offset = table_offset;
+    state.table_crc = table_crc;
+    return true;
+}
+
+// ========== Чтение ==========
+
+template <typename T>
+static ContainerHandle decodeContainer(ByteReader& in) {
+    auto container = make_unique<T>();
+    if (!container->deserialize_binary(in)) {
+        return ContainerHandle();
+    }
+    return ContainerHandle(move(container));
+}
+
+static ContainerHandle decodeSection(ContainerType type, ByteReader& in) {
+    switch (type) {
+        case ContainerType::ARRAY:
+            return decodeContainer<Array>(in);
+        case ContainerType::SINGLY_LIST:
+            return decodeContainer<SingleList>(in);
+        case ContainerType::DOUBLY_LIST:
+            return decodeContainer<DoubleList>(in);
+        case ContainerType::STACK:
+            return decodeContainer<Stack>(in);
+        case ContainerType::QUEUE:
+            return decodeContainer<Queue>(in);
+        case ContainerType::TREE:
+            return decodeContainer<FullBinaryTree>(in);
+        case ContainerType::HASH_TABLE:
+            return decodeContainer<DoubleHashTable>(in);
+        case ContainerType::NONE:
+            break;
+    }
+    return ContainerHandle();
+}
+
+bool decodeSnapshot(const char* data, size_t size, ContainerIndex& result, size_t threads) {
+    result.clear();
+    SnapshotHeader header;
+    if (size < SNAPSHOT_HEADER_SIZE || !parseHeader(data, header)) {
+        return false;
+    }
+    if (header.table_offset < SNAPSHOT_HEADER_SIZE || header.table_offset > size ||
+        header.table_length > size - header.table_offset ||
+        crc32(data + header.table_offset, header.table_length) != header.table_crc) {
+        return false;
+    }
+
+    struct SectionRef {
+        ContainerType type;
+        string_view name;
+        uint64_t offset;
+        uint64_t length;
+        uint32_t checksum;
+    };
+    vector<SectionRef> refs;
+    refs.reserve(min<size_t>(header.section_count, header.table_length / 25));
+
+    ByteReader table(data + header.table_offset, header.table_length);
+    for (uint32_t i = 0; i < header.section_count; ++i) {
+        uint8_t type;
+        SectionRef ref;
+        if (!table.readU8(type) || !table.readStringView(ref.name) || !table.readU64(ref.offset) ||
+            !table.readU64(ref.length) || !table.readU32(ref.checksum)) {
+            return false;
+        }
+        ref.type = static_cast<ContainerType>(type);
+
+        // Секции лежат между заголовком и таблицей
+        if (ref.offset < SNAPSHOT_HEADER_SIZE || ref.offset > header.table_offset ||
+            ref.length > header.table_offset - ref.offset) {
+            return false;
+        }
+        refs.push_back(ref);
+    }
+
+    // Проверка сумм и разбор секций независимы и идут параллельно
+    vector<ContainerHandle> handles(refs.size());
+    atomic<bool> failed(false);
+    forEachSection(refs.size(), threads, [&](size_t i) {
+        if (failed.load(memory_order_relaxed)) {
+            return;
+        }
+        const SectionRef& ref = refs[i];
+        const char* section_data = data + ref.offset;
+        if (crc32(section_data, ref.length) != ref.checksum) {
+            failed = true;
+            return;
+        }
+        ByteReader section(section_data, ref.length);
+        handles[i] = decodeSection(ref.type, section);
+        if (handles[i].empty() || section.remaining() != 0) {
+            failed = true;
+        }
+    });
+    if (failed) {
+        return false;
+    }
+
+    // Загруженные контейнеры совпадают со своими секциями в файле
+    ContainerIndex loaded;
+    for (size_t i = 0; i < refs.size(); ++i) {
+        if (!loaded.insert(refs[i].name, move(handles[i]))) {
+            return false;
+        }
+        ContainerIndex::Entry* entry = loaded.findEntry(refs[i].name);
+        entry->saved = {refs[i].offset, refs[i].length, refs[i].checksum};
+        entry->dirty = false;
+    }
+
+    result = move(loaded);
+    return true;
+}
+
+bool readSnapshotFile(const string& filename, ContainerIndex& result, size_t threads, SnapshotFileState* state) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(SNAPSHOT_HEADER_SIZE)) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+
+    // Файл читается последовательно от начала до конца
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+    const char* data = static_cast<const char*>(mapped);
+    bool ok = decodeSnapshot(data, size, result, threads);
+    SnapshotHeader header;
+    if (ok && state != nullptr && parseHeader(data, header)) {
+        state->path = filename;
+        state->file_size = size;
+        state->table_offset = header.table_offset;
+        state->table_crc = header.table_crc;
+    }
+    ::munmap(mapped, size);
+    return ok;
+}
@@ -0,0 +1,65 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ContainerIndex.h"
+
+using namespace std;
+
+// Двоичный снимок базы данных в одном файле:
+//
+//   заголовок (40 байт): "L3SNAP" + версия формата, число секций, смещение и
+//                        длина таблицы секций, CRC-32 таблицы, CRC-32 заголовка
+//   секции:              данные контейнеров подряд (serialize_binary)
+//   таблица секций:      для каждой секции тип, имя, смещение, длина и CRC-32
+//
+// Числа хранятся в little-endian, строки — с префиксом длины, поэтому значения
+// могут содержать пробелы и переводы строк.
+
+constexpr uint32_t SNAPSHOT_VERSION = 2;
+constexpr size_t SNAPSHOT_HEADER_SIZE = 40;
+
+// Файл снимка, который база записала или прочитала последним. По этим полям
+// инкрементальное сохранение убеждается, что файл не перезаписан извне.
+struct SnapshotFileState {
+    string path;
+    uint64_t file_size = 0;
+    uint64_t table_offset = 0;
+    uint32_t table_crc = 0;
+};
+
+// Таблица может лежать не в конце секций: инкрементальное сохранение дописывает
+// в конец файла измененные секции и новую таблицу, а старые остаются мусором
+// до следующей полной перезаписи.
+
+// Секции упорядочены по имени контейнера, поэтому файл не зависит ни от
+// истории вставок, ни от числа потоков. threads > 1 распределяет кодирование и
+// разбор секций по пулу потоков; запись в файл и сборка индекса идут в одном потоке.
+
+// Сериализует все контейнеры в буфер
+void encodeSnapshot(const ContainerIndex& containers, string& buffer, size_t threads = 1);
+
+// Проверяет контрольные суммы и восстанавливает контейнеры. При любой ошибке
+// возвращает false, а result остается пустым.
+bool decodeSnapshot(const char* data, size_t size, ContainerIndex& result, size_t threads = 1);
+
+// Запись атомарна: файл пишется рядом и заменяется через rename
+bool writeSnapshotFile(const string& filename, const ContainerIndex& containers, size_t threads = 1);
+// Файл отображается в память (mmap) и разбирается без промежуточных копий.
+// Если передан state, в него записываются сведения о прочитанном файле.
+bool readSnapshotFile(const string& filename, ContainerIndex& result, size_t threads = 1,
+                      SnapshotFileState* state = nullptr);
+
+// Инкрементальное сохранение. Если filename — тот же неизмененный файл, что
+// описан в state, в его конец дописываются только секции контейнеров с флагом
+// dirty и новая таблица, после чего заголовок переключается на нее. Иначе, а
+// также когда устаревшие секции занимают больше половины файла, снимок
+// переписывается целиком. После успеха все контейнеры чистые, а state
+// описывает новый файл.
+bool updateSnapshotFile(const string& filename, ContainerIndex& containers, SnapshotFileState& state,
+                        size_t threads = 1);
+
+#endif
@@ -89,61 +89,83 @@ int Stack::get_size() const {
     return top + 1;
 }
 
+MemoryUsage Stack::memory_usage() const {
+    MemoryUsage usage;
+    usage.bytes = sizeof(Stack);
+    usage.addArray<string>(static_cast<size_t>(capacity));
+    // Снятые со стека значения остаются в своих ячейках до перезаписи
+    for (int i = 0; i < capacity; ++i) {
+        usage.addStringBuffer(data[i]);
+    }
+    for (int i = 0; i <= top; ++i) {
+        usage.payload += data[i].size();
+    }
+    return usage;
+}
+
 void Stack::print() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    print(out);
+}
+
+void Stack::print(TextWriter& out) const {
     if (top < 0) {
-        cout << "стек пустой" << endl;
+        out << "стек пустой\n";
         return;
     }
 
-    cout << "Стопка (сверху вниз) [" << (top + 1) << "]: ";
+    out << "Стопка (сверху вниз) [" << (top + 1) << "]: ";
     for (int i = top; i >= 0; i--) {
-        cout << data[i];
+        out << data[i];
         if (i > 0) {
-            cout << " | ";
+            out << " | ";
         }
     }
-    cout << endl;
+    out << '\n';
 }
 
 bool Stack::serialize_binary(const string& filename) const {
-    ofstream file(filename, ios::binary);
-    if (!file.is_open()) {
-        return false;
-    }
+    return writeBinaryFile(filename, *this);
+}
 
-    int stack_size = get_size();
-    file.write(reinterpret_cast<const char*>(&stack_size), sizeof(stack_size));
+bool Stack::deserialize_binary(const string& filename) {
+    return readBinaryFile(filename, *this);
+}
 
+void Stack::serialize_binary(ByteWriter& out) const {
+    uint64_t bytes = 0;
     for (int i = 0; i <= top; ++i) {
-        size_t str_size = data[i].size();
-        file.write(reinterpret_cast<const char*>(&str_size), sizeof(str_size));
-        file.write(data[i].c_str(), str_size);
+        bytes += data[i].size();
     }
 
-    return true;
+    // Элементы записываются от дна к вершине
+    out.writeBulkHeader(static_cast<uint32_t>(top + 1), bytes);
+    for (int i = 0; i <= top; ++i) {
+        out.writeString(data[i]);
+    }
 }
 
-bool Stack::deserialize_binary(const string& filename) {
-    ifstream file(filename, ios::binary);
-    if (!file.is_open()) {
+bool Stack::deserialize_binary(ByteReader& in) {
+    uint32_t stack_size;
+    uint64_t bytes;
+    if (!in.readBulkHeader(stack_size, bytes, 4)) {
         return false;
     }
 
-    int stack_size;
-    file.read(reinterpret_cast<char*>(&stack_size), sizeof(stack_size));
-
     clear();
-    data = new string[stack_size];
-    capacity = stack_size;
+    capacity = stack_size > 0 ? bulkReserve(stack_size) : 10;
+    data = new string[capacity];
     top = -1;
 
-    for (int i = 0; i < stack_size; ++i) {
-        size_t str_size;
-        file.read(reinterpret_cast<char*>(&str_size), sizeof(str_size));
-
-        string value(str_size, '\0');
-        file.read(&value[0], str_size);
-        push(value);
+    for (uint32_t i = 0; i < stack_size; ++i) {
+        if (top == capacity - 1) {
+            resize(capacity * 2);
+        }
+        if (!in.readString(data[top + 1])) {
+            return false;
+        }
+        top++;
     }
 
     return true;
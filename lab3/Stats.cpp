@@ -0,0 +1,233 @@
+#include "Stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define STATS_USE_TSC 1
+#endif
+
+using namespace std;
+
+// ========== LatencyHistogram ==========
+
+size_t LatencyHistogram::bucketOf(uint64_t value) {
+    // Первая группа — точные значения 0..SUB_BUCKETS-1
+    if (value < SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    size_t top_bit = 63 - static_cast<size_t>(__builtin_clzll(value));
+    size_t group = top_bit - SUB_BUCKET_BITS + 1;
+    if (group >= GROUPS) {
+        return BUCKETS - 1;
+    }
+    size_t sub = static_cast<size_t>(value >> (top_bit - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return group * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    size_t group = bucket / SUB_BUCKETS;
+    size_t sub = bucket % SUB_BUCKETS;
+    if (bucket == BUCKETS - 1) {
+        return UINT64_MAX;
+    }
+    uint64_t width = uint64_t(1) << (group - 1);
+    return ((SUB_BUCKETS + sub) << (group - 1)) + width - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    buckets[bucketOf(value)].fetch_add(1, memory_order_relaxed);
+    total_sum.fetch_add(value, memory_order_relaxed);
+
+    uint64_t current = max_value.load(memory_order_relaxed);
+    while (value > current && !max_value.compare_exchange_weak(current, value, memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, memory_order_relaxed);
+    }
+    total_sum.store(0, memory_order_relaxed);
+    max_value.store(0, memory_order_relaxed);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+        buckets[bucket].fetch_add(other.bucketCount(bucket), memory_order_relaxed);
+    }
+    total_sum.fetch_add(other.sum(), memory_order_relaxed);
+
+    uint64_t value = other.max();
+    uint64_t current = max_value.load(memory_order_relaxed);
+    while (value > current && !max_value.compare_exchange_weak(current, value, memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t recorded = 0;
+    for (const auto& bucket : buckets) {
+        recorded += bucket.load(memory_order_relaxed);
+    }
+    return recorded;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    uint64_t recorded = count();
+    if (recorded == 0) {
+        return 0;
+    }
+    // Ранг искомого значения, считая с 1
+    uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(recorded) + 0.5);
+    rank = rank == 0 ? 1 : (rank > recorded ? recorded : rank);
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+        seen += bucketCount(bucket);
+        if (seen >= rank) {
+            uint64_t bound = bucketUpperBound(bucket);
+            return bound < max() ? bound : max();
+        }
+    }
+    return max();
+}
+
+// ========== CommandStats ==========
+
+uint64_t CommandStats::now() {
+#ifdef STATS_USE_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(
+        chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+static double measureNanosPerTick() {
+#ifdef STATS_USE_TSC
+    auto start_time = chrono::steady_clock::now();
+    uint64_t start_ticks = __rdtsc();
+    auto elapsed = chrono::steady_clock::now() - start_time;
+    while (elapsed < chrono::milliseconds(2)) {
+        elapsed = chrono::steady_clock::now() - start_time;
+    }
+    uint64_t ticks = __rdtsc() - start_ticks;
+    double nanos = static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+    return ticks > 0 ? nanos / static_cast<double>(ticks) : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+double CommandStats::nanosPerTick() {
+    static const double ratio = measureNanosPerTick();
+    return ratio;
+}
+
+void CommandStats::record(Opcode opcode, uint64_t ticks, bool error) {
+    OpcodeStats& stats = opcodes[static_cast<size_t>(opcode)];
+    if (error) {
+        stats.errors.fetch_add(1, memory_order_relaxed);
+    }
+    stats.latency.record(ticks);
+}
+
+void CommandStats::reset() {
+    for (auto& stats : opcodes) {
+        stats.errors.store(0, memory_order_relaxed);
+        stats.latency.reset();
+    }
+}
+
+void CommandStats::merge(const CommandStats& other) {
+    for (size_t i = 0; i < OPCODE_COUNT; ++i) {
+        opcodes[i].errors.fetch_add(other.opcodes[i].errors.load(memory_order_relaxed), memory_order_relaxed);
+        opcodes[i].latency.merge(other.opcodes[i].latency);
+    }
+}
+
+// ========== SlowLog ==========
+
+SlowLog::SlowLog(size_t capacity) : slot_count(capacity == 0 ? 1 : capacity) {
+    slots = make_unique<Slot[]>(slot_count);
+    setThreshold(DEFAULT_THRESHOLD_US);
+}
+
+void SlowLog::setThreshold(uint64_t micros) {
+    uint64_t ticks = DISABLED;
+    if (micros != DISABLED) {
+        double scaled = static_cast<double>(micros) * 1000.0 / CommandStats::nanosPerTick();
+        ticks = scaled < static_cast<double>(DISABLED) ? static_cast<uint64_t>(scaled) : DISABLED - 1;
+    }
+    threshold_us.store(micros, memory_order_relaxed);
+    threshold_ticks.store(ticks, memory_order_relaxed);
+}
+
+// Ячейку держат доли микросекунды; на одном ядре уступаем владельцу
+static void lockSlot(atomic<bool>& busy) {
+    while (busy.exchange(true, memory_order_acquire)) {
+        while (busy.load(memory_order_relaxed)) {
+            this_thread::yield();
+        }
+    }
+}
+
+void SlowLog::record(string_view command, uint64_t ticks, size_t container_size) {
+    uint64_t id = next_id.fetch_add(1, memory_order_relaxed);
+    uint64_t timestamp_us = static_cast<uint64_t>(
+        chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count());
+    size_t text_length = min(command.size(), TEXT_LIMIT);
+
+    Slot& slot = slots[id % slot_count];
+    lockSlot(slot.busy);
+    // Поток, обогнавший нас на круг, уже записал более новую команду
+    if (slot.id < id) {
+        slot.id = id;
+        slot.timestamp_us = timestamp_us;
+        slot.ticks = ticks;
+        slot.container_size = container_size;
+        slot.command_length = command.size();
+        slot.text_length = text_length;
+        memcpy(slot.text, command.data(), text_length);
+    }
+    slot.busy.store(false, memory_order_release);
+}
+
+vector<SlowLogEntry> SlowLog::entries(size_t count) const {
+    vector<SlowLogEntry> result;
+    uint64_t next = next_id.load(memory_order_relaxed);
+    uint64_t first = max(first_id.load(memory_order_relaxed), next > slot_count ? next - slot_count : 1);
+
+    for (uint64_t id = next; id > first && result.size() < count;) {
+        --id;
+        Slot& slot = slots[id % slot_count];
+        lockSlot(slot.busy);
+        if (slot.id == id) {
+            SlowLogEntry entry;
+            entry.id = id;
+            entry.timestamp_us = slot.timestamp_us;
+            entry.duration_ns = CommandStats::toNanos(slot.ticks);
+            entry.container_size = slot.container_size;
+            entry.command_length = slot.command_length;
+            entry.command.assign(slot.text, slot.text_length);
+            result.push_back(move(entry));
+        }
+        slot.busy.store(false, memory_order_release);
+    }
+    return result;
+}
+
+size_t SlowLog::size() const {
+    uint64_t recorded = next_id.load(memory_order_relaxed) - first_id.load(memory_order_relaxed);
+    return static_cast<size_t>(min<uint64_t>(recorded, slot_count));
+}
+
+void SlowLog::reset() {
+    first_id.store(next_id.load(memory_order_relaxed), memory_order_relaxed);
+}
@@ -0,0 +1,152 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Command.h"
+
+using namespace std;
+
+// Гистограмма задержек с логарифмическими корзинами, как в HdrHistogram:
+// значение попадает в группу по старшему биту и в одну из SUB_BUCKETS равных
+// подкорзин внутри нее, поэтому относительная погрешность не больше 1/8.
+// Запись — два атомарных инкремента без блокировок; число значений
+// считается по корзинам только при чтении.
+class LatencyHistogram {
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 3;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    // Последняя группа покрывает значения от 2^37 (десятки секунд в тактах)
+    static constexpr size_t GROUPS = 36;
+    static constexpr size_t BUCKETS = GROUPS * SUB_BUCKETS;
+
+    void record(uint64_t value);
+    void reset();
+    // Добавляет значения другой гистограммы (сводка по шардам)
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const;
+    uint64_t sum() const { return total_sum.load(memory_order_relaxed); }
+    uint64_t max() const { return max_value.load(memory_order_relaxed); }
+    uint64_t bucketCount(size_t bucket) const { return buckets[bucket].load(memory_order_relaxed); }
+
+    // Верхняя граница корзины, в которую попадает доля fraction значений
+    uint64_t percentile(double fraction) const;
+
+    static size_t bucketOf(uint64_t value);
+    // Наибольшее значение, попадающее в корзину
+    static uint64_t bucketUpperBound(size_t bucket);
+
+private:
+    array<atomic<uint64_t>, BUCKETS> buckets{};
+    atomic<uint64_t> total_sum{0};
+    atomic<uint64_t> max_value{0};
+};
+
+// Формат отчета команды STATS
+enum class StatsFormat : uint8_t {
+    TEXT,
+    JSON,
+    PROMETHEUS
+};
+
+// Счетчики одной команды; задержки в тактах CommandStats::now()
+struct OpcodeStats {
+    atomic<uint64_t> errors{0};
+    LatencyHistogram latency;
+
+    uint64_t calls() const { return latency.count(); }
+};
+
+// Статистика выполнения команд по кодам. Нераспознанные команды учитываются
+// под Opcode::UNKNOWN.
+class CommandStats {
+private:
+    array<OpcodeStats, OPCODE_COUNT> opcodes;
+
+public:
+    // Отметка времени для замера: на x86 — счетчик тактов процессора (rdtsc
+    // вдвое дешевле steady_clock), иначе — наносекунды steady_clock
+    static uint64_t now();
+    // Перевод тактов в наносекунды; калибруется один раз (около 2 мс)
+    static double nanosPerTick();
+    static uint64_t toNanos(uint64_t ticks) {
+        return static_cast<uint64_t>(static_cast<double>(ticks) * nanosPerTick());
+    }
+
+    void record(Opcode opcode, uint64_t ticks, bool error);
+    void reset();
+    // Добавляет вызовы, ошибки и задержки other по каждому коду
+    void merge(const CommandStats& other);
+
+    const OpcodeStats& operator[](Opcode opcode) const { return opcodes[static_cast<size_t>(opcode)]; }
+};
+
+// Запись журнала медленных команд
+struct SlowLogEntry {
+    uint64_t id = 0;
+    uint64_t timestamp_us = 0;   // время завершения, микросекунды с начала эпохи Unix
+    uint64_t duration_ns = 0;
+    size_t container_size = 0;   // элементов в контейнере команды после ее выполнения
+    size_t command_length = 0;   // полная длина команды
+    string command;              // не больше SlowLog::TEXT_LIMIT байт
+};
+
+// Журнал медленных команд: кольцевой буфер из заранее выделенных ячеек.
+// Запись не выделяет памяти: номер берется атомарным инкрементом, ячейка
+// занимается только на время копирования (не больше TEXT_LIMIT байт команды).
+// Быстрые команды стоят одного сравнения с порогом.
+class SlowLog {
+public:
+    static constexpr size_t TEXT_LIMIT = 128;
+    static constexpr size_t DEFAULT_CAPACITY = 128;
+    static constexpr uint64_t DEFAULT_THRESHOLD_US = 10000;
+    static constexpr uint64_t DISABLED = UINT64_MAX;
+
+    explicit SlowLog(size_t capacity = DEFAULT_CAPACITY);
+
+    SlowLog(const SlowLog&) = delete;
+    SlowLog& operator=(const SlowLog&) = delete;
+
+    // Порог в микросекундах: 0 — записывать все команды, DISABLED — ничего
+    void setThreshold(uint64_t micros);
+    uint64_t threshold() const { return threshold_us.load(memory_order_relaxed); }
+    bool enabled() const { return threshold_ticks.load(memory_order_relaxed) != DISABLED; }
+    // ticks — длительность в тактах CommandStats::now()
+    bool isSlow(uint64_t ticks) const { return ticks >= threshold_ticks.load(memory_order_relaxed); }
+
+    void record(string_view command, uint64_t ticks, size_t container_size);
+    // Не больше count последних записей, новые первыми
+    vector<SlowLogEntry> entries(size_t count) const;
+    size_t size() const;
+    size_t capacity() const { return slot_count; }
+    void reset();
+
+private:
+    struct Slot {
+        atomic<bool> busy{false};
+        uint64_t id = 0;  // 0 — ячейка пуста
+        uint64_t timestamp_us = 0;
+        uint64_t ticks = 0;
+        size_t container_size = 0;
+        size_t command_length = 0;
+        size_t text_length = 0;
+        char text[TEXT_LIMIT];
+    };
+
+    unique_ptr<Slot[]> slots;
+    size_t slot_count;
+    atomic<uint64_t> next_id{1};
+    atomic<uint64_t> first_id{1};  // записи до RESET не выдаются
+    atomic<uint64_t> threshold_us{DISABLED};
+    atomic<uint64_t> threshold_ticks{DISABLED};
+};
+
+#endif
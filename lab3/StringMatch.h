@@ -0,0 +1,92 @@
+#ifndef STRINGMATCH_H
+#define STRINGMATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// Как значение сравнивается с образцом в MFIND/MCOUNT/MFILTER
+enum class MatchMode : uint8_t {
+    EXACT,
+    PREFIX,
+    SUBSTRING
+};
+
+constexpr size_t MATCH_NOT_FOUND = static_cast<size_t>(-1);
+
+// Позиция первого вхождения pattern в text[0, length) или MATCH_NOT_FOUND.
+// С SSE2 первый и последний байты образца сравниваются сразу в 16 позициях,
+// а memcmp проверяет только позиции, где совпали оба.
+inline size_t findSubstring(const char* text, size_t length, string_view pattern) {
+    size_t n = pattern.size();
+    if (n == 0) {
+        return 0;
+    }
+    if (n > length) {
+        return MATCH_NOT_FOUND;
+    }
+    if (n == 1) {
+        const void* hit = memchr(text, pattern[0], length);
+        return hit != nullptr ? static_cast<size_t>(static_cast<const char*>(hit) - text) : MATCH_NOT_FOUND;
+    }
+
+    const char first = pattern[0];
+    const char last = pattern[n - 1];
+    const size_t final_position = length - n;
+    size_t position = 0;
+#ifdef __SSE2__
+    const __m128i first_bytes = _mm_set1_epi8(first);
+    const __m128i last_bytes = _mm_set1_epi8(last);
+    for (; position + 16 <= final_position + 1; position += 16) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + position));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + position + n - 1));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first_bytes), _mm_cmpeq_epi8(tail, last_bytes))));
+        while (mask != 0) {
+            size_t candidate = position + static_cast<size_t>(__builtin_ctz(mask));
+            if (memcmp(text + candidate + 1, pattern.data() + 1, n - 2) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; position <= final_position; ++position) {
+        if (text[position] == first && text[position + n - 1] == last &&
+            memcmp(text + position + 1, pattern.data() + 1, n - 2) == 0) {
+            return position;
+        }
+    }
+    return MATCH_NOT_FOUND;
+}
+
+// value начинается с pattern; value не короче pattern. Первый и последний
+// байты образца отсекают почти все несовпадения до memcmp: у значений с
+// общим началом ("user_1", "user_2") различается конец.
+inline bool hasPrefix(string_view value, string_view pattern) {
+    size_t n = pattern.size();
+    return n == 0 || (value[0] == pattern[0] && value[n - 1] == pattern[n - 1] &&
+                      memcmp(value.data(), pattern.data(), n) == 0);
+}
+
+// Длина отсекает несовпадения, не читая самих байтов значения
+inline bool matchesPattern(string_view value, string_view pattern, MatchMode mode) {
+    switch (mode) {
+        case MatchMode::EXACT:
+            return value.size() == pattern.size() && hasPrefix(value, pattern);
+        case MatchMode::PREFIX:
+            return value.size() >= pattern.size() && hasPrefix(value, pattern);
+        case MatchMode::SUBSTRING:
+            return findSubstring(value.data(), value.size(), pattern) != MATCH_NOT_FOUND;
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,256 @@
+#include "StringSort.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+#include "ThreadPool.h"
+
+using namespace std;
+
+// Участки меньше этого досортировываются вставками
+static constexpr size_t INSERTION_THRESHOLD = 32;
+// Меньший вход быстрее отсортировать в одном потоке, чем запускать пул
+static constexpr size_t PARALLEL_MIN_KEYS = 1 << 16;
+
+// Байт значения на глубине depth; 0 — значение закончилось
+static inline unsigned byteAt(const SortKey& key, size_t depth) {
+    return depth < key.length ? static_cast<unsigned char>(key.data[depth]) + 1u : 0u;
+}
+
+// Сравнение значений, у которых первые depth байт совпадают
+static inline int compareFrom(const SortKey& a, const SortKey& b, size_t depth) {
+    size_t common = min(a.length, b.length);
+    if (common > depth) {
+        int result = memcmp(a.data + depth, b.data + depth, common - depth);
+        if (result != 0) {
+            return result;
+        }
+    }
+    return a.length < b.length ? -1 : (a.length > b.length ? 1 : 0);
+}
+
+static inline bool keyLess(const SortKey& a, const SortKey& b) {
+    return compareFrom(a, b, 0) < 0;
+}
+
+// Устойчива: элемент сдвигается только за строго больший
+static void insertionSort(SortKey* keys, size_t count, size_t depth) {
+    for (size_t i = 1; i < count; ++i) {
+        SortKey key = keys[i];
+        size_t j = i;
+        for (; j > 0 && compareFrom(keys[j - 1], key, depth) > 0; --j) {
+            keys[j] = keys[j - 1];
+        }
+        keys[j] = key;
+    }
+}
+
+// ========== Поразрядная MSD-сортировка ==========
+//
+// На каждой глубине байт каждого значения читается один раз и запоминается в
+// digits: повторное чтение по указателю — промах кэша на каждый ключ.
+
+// Считает корзины для байта depth; false — все значения равны
+static bool countDigits(const SortKey* keys, uint16_t* digits, size_t count, size_t& depth,
+                        array<size_t, 257>& bucket_size) {
+    while (true) {
+        bucket_size.fill(0);
+        for (size_t i = 0; i < count; ++i) {
+            digits[i] = static_cast<uint16_t>(byteAt(keys[i], depth));
+            ++bucket_size[digits[i]];
+        }
+        // Общий префикс ("user_...") проходится без перестановок
+        if (bucket_size[digits[0]] != count) {
+            return true;
+        }
+        if (digits[0] == 0) {
+            return false;
+        }
+        ++depth;
+    }
+}
+
+static array<size_t, 257> bucketStarts(const array<size_t, 257>& bucket_size) {
+    array<size_t, 257> bucket_start;
+    size_t position = 0;
+    for (size_t c = 0; c < 257; ++c) {
+        bucket_start[c] = position;
+        position += bucket_size[c];
+    }
+    return bucket_start;
+}
+
+// Участок, который осталось досортировать начиная с байта depth.
+// Корзины кладутся в явный стек, а не обрабатываются рекурсией: у значений с
+// длинным общим началом ("a", "aa", "aaa", ...) глубина равна длине значения,
+// и рекурсия по байту на кадр переполняла стек потока.
+struct RadixTask {
+    size_t begin;
+    size_t count;
+    size_t depth;
+};
+
+static void pushBuckets(vector<RadixTask>& pending, size_t begin, size_t depth,
+                        const array<size_t, 257>& bucket_start, const array<size_t, 257>& bucket_size) {
+    // Корзина 0 — значения, закончившиеся на depth: они равны
+    for (size_t c = 1; c < 257; ++c) {
+        if (bucket_size[c] > 1) {
+            pending.push_back({begin + bucket_start[c], bucket_size[c], depth + 1});
+        }
+    }
+}
+
+// Устойчивая: раскладка по корзинам через aux сохраняет порядок внутри корзины
+static void radixSort(SortKey* keys, SortKey* aux, uint16_t* digits, size_t count, size_t depth) {
+    vector<RadixTask> pending{{0, count, depth}};
+    array<size_t, 257> bucket_size;
+    while (!pending.empty()) {
+        RadixTask task = pending.back();
+        pending.pop_back();
+        SortKey* part = keys + task.begin;
+        if (task.count <= INSERTION_THRESHOLD) {
+            insertionSort(part, task.count, task.depth);
+            continue;
+        }
+        if (!countDigits(part, digits + task.begin, task.count, task.depth, bucket_size)) {
+            continue;
+        }
+        array<size_t, 257> bucket_start = bucketStarts(bucket_size);
+        array<size_t, 257> next = bucket_start;
+        for (size_t i = 0; i < task.count; ++i) {
+            aux[task.begin + next[digits[task.begin + i]]++] = part[i];
+        }
+        copy(aux + task.begin, aux + task.begin + task.count, part);
+        pushBuckets(pending, task.begin, task.depth, bucket_start, bucket_size);
+    }
+}
+
+// Неустойчивая, на месте (American flag sort): ключ переставляется прямо в
+// свободную позицию своей корзины, вытесняя оттуда чужой
+static void flagSort(SortKey* keys, uint16_t* digits, size_t count, size_t depth) {
+    vector<RadixTask> pending{{0, count, depth}};
+    array<size_t, 257> bucket_size;
+    while (!pending.empty()) {
+        RadixTask task = pending.back();
+        pending.pop_back();
+        SortKey* part = keys + task.begin;
+        uint16_t* part_digits = digits + task.begin;
+        if (task.count <= INSERTION_THRESHOLD) {
+            insertionSort(part, task.count, task.depth);
+            continue;
+        }
+        if (!countDigits(part, part_digits, task.count, task.depth, bucket_size)) {
+            continue;
+        }
+        array<size_t, 257> bucket_start = bucketStarts(bucket_size);
+        array<size_t, 257> next = bucket_start;
+        for (size_t c = 0; c < 257; ++c) {
+            size_t bucket_end = bucket_start[c] + bucket_size[c];
+            while (next[c] < bucket_end) {
+                size_t i = next[c];
+                uint16_t digit = part_digits[i];
+                if (digit == c) {
+                    ++next[c];
+                    continue;
+                }
+                size_t target = next[digit]++;
+                swap(part[i], part[target]);
+                swap(part_digits[i], part_digits[target]);
+            }
+        }
+        pushBuckets(pending, task.begin, task.depth, bucket_start, bucket_size);
+    }
+}
+
+// ========== Параллельные части и слияние ==========
+
+static void sortRun(SortKey* keys, SortKey* aux, uint16_t* digits, size_t count, bool stable) {
+    if (stable) {
+        radixSort(keys, aux, digits, count, 0);
+    } else {
+        flagSort(keys, digits, count, 0);
+    }
+}
+
+// Участок слияния двух соседних серий
+struct MergePiece {
+    size_t left_begin, left_end;
+    size_t right_begin, right_end;
+    size_t output;
+};
+
+// Делит слияние [left, middle) и [middle, right) на pieces независимых
+// участков: граница левой серии ищется в правой двоичным поиском. При равных
+// значениях левая серия идет первой, поэтому слияние устойчиво.
+static void splitMerge(const SortKey* keys, size_t left, size_t middle, size_t right, size_t pieces,
+                       vector<MergePiece>& result) {
+    size_t previous_left = left;
+    size_t previous_right = middle;
+    for (size_t piece = 1; piece <= pieces; ++piece) {
+        size_t split_left = piece == pieces ? middle : left + (middle - left) * piece / pieces;
+        size_t split_right = right;
+        if (piece < pieces) {
+            split_right = static_cast<size_t>(
+                lower_bound(keys + previous_right, keys + right, keys[split_left], keyLess) - keys);
+        }
+        result.push_back({previous_left, split_left, previous_right, split_right,
+                          left + (previous_left - left) + (previous_right - middle)});
+        previous_left = split_left;
+        previous_right = split_right;
+    }
+}
+
+void sortStrings(vector<SortKey>& keys, bool stable, size_t threads) {
+    size_t count = keys.size();
+    if (threads <= 1 || count < PARALLEL_MIN_KEYS) {
+        vector<SortKey> aux(stable ? count : 0);
+        vector<uint16_t> digits(count);
+        sortRun(keys.data(), aux.data(), digits.data(), count, stable);
+        return;
+    }
+
+    ThreadPool pool(threads);
+    vector<SortKey> aux(count);
+    vector<uint16_t> digits(count);
+
+    // Серии одинаковой длины сортируются независимо
+    vector<size_t> bounds(threads + 1);
+    for (size_t run = 0; run <= threads; ++run) {
+        bounds[run] = count * run / threads;
+    }
+    pool.parallelFor(threads, [&](size_t run) {
+        sortRun(keys.data() + bounds[run], aux.data() + bounds[run], digits.data() + bounds[run],
+                bounds[run + 1] - bounds[run], stable);
+    });
+
+    // Попарное слияние серий; в каждом раунде работают все потоки
+    while (bounds.size() > 2) {
+        vector<MergePiece> pieces;
+        vector<size_t> merged_bounds;
+        size_t pairs = (bounds.size() - 1) / 2;
+        size_t pieces_per_pair = max<size_t>(1, threads / pairs);
+        for (size_t run = 0; run + 1 < bounds.size(); run += 2) {
+            merged_bounds.push_back(bounds[run]);
+            if (run + 2 < bounds.size()) {
+                splitMerge(keys.data(), bounds[run], bounds[run + 1], bounds[run + 2], pieces_per_pair, pieces);
+            } else {
+                // Серия без пары переносится как есть
+                pieces.push_back({bounds[run], bounds[run + 1], bounds[run + 1], bounds[run + 1], bounds[run]});
+            }
+        }
+        merged_bounds.push_back(count);
+
+        pool.parallelFor(pieces.size(), [&](size_t i) {
+            const MergePiece& piece = pieces[i];
+            merge(keys.begin() + static_cast<ptrdiff_t>(piece.left_begin),
+                  keys.begin() + static_cast<ptrdiff_t>(piece.left_end),
+                  keys.begin() + static_cast<ptrdiff_t>(piece.right_begin),
+                  keys.begin() + static_cast<ptrdiff_t>(piece.right_end),
+                  aux.begin() + static_cast<ptrdiff_t>(piece.output), keyLess);
+        });
+        keys.swap(aux);
+        bounds = move(merged_bounds);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef STRINGSORT_H
+#define STRINGSORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Ключ сортировки: байты значения и его исходный номер
+struct SortKey {
+    const char* data;
+    uint32_t length;
+    uint32_t index;
+};
+
+// Сортирует ключи по байтам значений (как string::compare).
+// Поразрядная MSD-сортировка. stable — равные значения сохраняют
+// исходный порядок: ключи раскладываются по корзинам через вспомогательный
+// буфер. Без него ключи переставляются на месте (American flag sort) и
+// лишней памяти на n ключей не нужно.
+// threads > 1 делит большой вход на части, сортирует их параллельно и сливает
+// попарно; каждое слияние тоже делится между потоками.
+void sortStrings(vector<SortKey>& keys, bool stable, size_t threads = 1);
+
+#endif
@@ -0,0 +1,13 @@
+#include "TextWriter.h"
+
+using namespace std;
+
+bool OstreamSink::write(const char* data, size_t size) {
+    stream.write(data, static_cast<streamsize>(size));
+    return static_cast<bool>(stream);
+}
+
+bool OstreamSink::flush() {
+    stream.flush();
+    return static_cast<bool>(stream);
+}
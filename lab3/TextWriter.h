@@ -0,0 +1,58 @@
+#ifndef TEXTWRITER_H
+#define TEXTWRITER_H
+
+#include <charconv>
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+#include "ByteStream.h"
+
+using namespace std;
+
+// Пишет в поток C++ (cout, stringstream); поток сбрасывается только в flush
+class OstreamSink : public ByteSink {
+private:
+    ostream& stream;
+
+public:
+    explicit OstreamSink(ostream& target) : stream(target) {}
+    bool write(const char* data, size_t size) override;
+    bool flush() override;
+};
+
+// Текстовый вывод в любой приемник: строку (BufferSink), файл (FileSink),
+// сокет (FdSink) или поток (OstreamSink). Вывод копится в буфере ByteWriter
+// и уходит в приемник крупными блоками, без сброса после каждой строки.
+class TextWriter {
+private:
+    ByteWriter out;
+
+public:
+    explicit TextWriter(ByteSink& target) : out(target) {}
+
+    TextWriter& operator<<(string_view text) {
+        out.writeBytes(text.data(), text.size());
+        return *this;
+    }
+    TextWriter& operator<<(const char* text) { return *this << string_view(text); }
+    TextWriter& operator<<(char c) {
+        out.writeU8(static_cast<uint8_t>(c));
+        return *this;
+    }
+
+    template <typename T, typename = enable_if_t<is_integral_v<T> && !is_same_v<T, char> && !is_same_v<T, bool>>>
+    TextWriter& operator<<(T value) {
+        char digits[24];
+        to_chars_result result = to_chars(digits, digits + sizeof(digits), value);
+        out.writeBytes(digits, static_cast<size_t>(result.ptr - digits));
+        return *this;
+    }
+
+    bool flush() { return out.flush(); }
+    bool ok() const { return out.ok(); }
+    uint64_t size() const { return out.size(); }
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "ThreadPool.h"
+
+using namespace std;
+
+ThreadPool::ThreadPool(size_t threads)
+    : job(nullptr), job_count(0), next_index(0), active(0), generation(0), stopping(false) {
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// Элементы раздаются по одному через общий счетчик: крупные и мелкие
+// контейнеры распределяются между потоками сами собой
+void ThreadPool::runJob() {
+    while (true) {
+        size_t index = next_index.fetch_add(1, memory_order_relaxed);
+        if (index >= job_count) {
+            break;
+        }
+        (*job)(index);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        runJob();
+
+        {
+            lock_guard<mutex> guard(lock);
+            active--;
+        }
+        finished.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const function<void(size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    lock_guard<mutex> run_guard(run_lock);
+    {
+        lock_guard<mutex> guard(lock);
+        job = &body;
+        job_count = count;
+        next_index.store(0, memory_order_relaxed);
+        active = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    runJob();
+
+    unique_lock<mutex> guard(lock);
+    finished.wait(guard, [this] { return active == 0; });
+    job = nullptr;
+}
@@ -0,0 +1,50 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Пул потоков для параллельной обработки независимых элементов.
+// Вызывающий поток тоже участвует в работе, поэтому пул размера N создает
+// N - 1 рабочих потоков, а пул размера 1 выполняет все последовательно.
+class ThreadPool {
+private:
+    vector<thread> workers;
+
+    mutex run_lock;  // одновременно выполняется одна parallelFor
+    mutex lock;
+    condition_variable wake;
+    condition_variable finished;
+
+    const function<void(size_t)>* job;
+    size_t job_count;
+    atomic<size_t> next_index;
+    size_t active;
+    uint64_t generation;
+    bool stopping;
+
+    void workerLoop();
+    void runJob();
+
+public:
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size() + 1; }
+
+    // Вызывает body(i) для всех i из [0, count) и дожидается завершения
+    void parallelFor(size_t count, const function<void(size_t)>& body);
+};
+
+#endif
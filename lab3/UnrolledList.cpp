@@ -0,0 +1,398 @@
+#include "UnrolledList.h"
+
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+
+UnrolledList::UnrolledList() {
+    head = nullptr;
+    tail = nullptr;
+    size = 0;
+}
+
+UnrolledList::~UnrolledList() {
+    clear();
+}
+
+UnrolledList::UnrolledList(const UnrolledList& other) {
+    head = nullptr;
+    tail = nullptr;
+    size = 0;
+
+    for (UBlock* block = other.head; block != nullptr; block = block->next) {
+        for (int i = 0; i < block->count; ++i) {
+            push_back(block->items[i].data);
+        }
+    }
+}
+
+UnrolledList& UnrolledList::operator=(const UnrolledList& other) {
+    if (this != &other) {
+        clear();
+        for (UBlock* block = other.head; block != nullptr; block = block->next) {
+            for (int i = 0; i < block->count; ++i) {
+                push_back(block->items[i].data);
+            }
+        }
+    }
+    return *this;
+}
+
+void UnrolledList::clear() {
+    UBlock* current = head;
+    while (current != nullptr) {
+        UBlock* temp = current;
+        current = current->next;
+        temp->~UBlock();
+    }
+    pool.release();
+    head = nullptr;
+    tail = nullptr;
+    size = 0;
+}
+
+UBlock* UnrolledList::add_block_after(UBlock* prev) {
+    UBlock* block = pool.create();
+    block->prev = prev;
+    block->next = prev != nullptr ? prev->next : head;
+
+    if (block->prev != nullptr) {
+        block->prev->next = block;
+    } else {
+        head = block;
+    }
+    if (block->next != nullptr) {
+        block->next->prev = block;
+    } else {
+        tail = block;
+    }
+    return block;
+}
+
+void UnrolledList::remove_block(UBlock* block) {
+    if (block->prev != nullptr) {
+        block->prev->next = block->next;
+    } else {
+        head = block->next;
+    }
+    if (block->next != nullptr) {
+        block->next->prev = block->prev;
+    } else {
+        tail = block->prev;
+    }
+    pool.destroy(block);
+}
+
+void UnrolledList::merge_next(UBlock* block) {
+    UBlock* next = block->next;
+    for (int i = 0; i < next->count; ++i) {
+        block->items[block->count + i].data = move(next->items[i].data);
+    }
+    block->count += next->count;
+    remove_block(next);
+}
+
+// Сдвиг перемещает строки, а не копирует: буфер длинной строки переходит в
+// соседнюю ячейку вместе с ней
+void UnrolledList::insert_at(UBlock* block, int slot, const string& value) {
+    if (block->count == UBlock::CAPACITY) {
+        // Верхняя половина уходит в новый блок, значение — в свою половину
+        UBlock* upper = add_block_after(block);
+        const int half = UBlock::CAPACITY / 2;
+        for (int i = half; i < UBlock::CAPACITY; ++i) {
+            upper->items[i - half].data = move(block->items[i].data);
+        }
+        upper->count = UBlock::CAPACITY - half;
+        block->count = half;
+        if (slot > half) {
+            block = upper;
+            slot -= half;
+        }
+    }
+
+    for (int i = block->count; i > slot; --i) {
+        block->items[i].data = move(block->items[i - 1].data);
+    }
+    block->items[slot].data = value;
+    block->count++;
+    size++;
+}
+
+void UnrolledList::remove_at(UBlock* block, int slot) {
+    for (int i = slot; i + 1 < block->count; ++i) {
+        block->items[i].data = move(block->items[i + 1].data);
+    }
+    block->count--;
+    size--;
+    // Освободившаяся ячейка не держит буфер удаленной строки
+    string().swap(block->items[block->count].data);
+
+    if (block->count == 0) {
+        remove_block(block);
+    } else if (block->next != nullptr && block->count + block->next->count <= UBlock::CAPACITY / 2) {
+        merge_next(block);
+    } else if (block->prev != nullptr && block->prev->count + block->count <= UBlock::CAPACITY / 2) {
+        merge_next(block->prev);
+    }
+}
+
+UPosition UnrolledList::locate(const string& value) const {
+    for (UBlock* block = head; block != nullptr; block = block->next) {
+        for (int i = 0; i < block->count; ++i) {
+            if (block->items[i].data == value) {
+                return UPosition(block, i);
+            }
+        }
+    }
+    return UPosition();
+}
+
+void UnrolledList::push_front(const string& value) {
+    UBlock* block = head != nullptr && head->count < UBlock::CAPACITY ? head : add_block_after(nullptr);
+    insert_at(block, 0, value);
+}
+
+void UnrolledList::push_back(const string& value) {
+    // Полный последний блок не делится: подряд добавленные значения
+    // заполняют блоки целиком
+    UBlock* block = tail != nullptr && tail->count < UBlock::CAPACITY ? tail : add_block_after(tail);
+    insert_at(block, block->count, value);
+}
+
+bool UnrolledList::insert_before(const string& target, const string& value) {
+    UPosition position = locate(target);
+    if (!position)
+        return false;
+
+    insert_at(position.block, position.slot, value);
+    return true;
+}
+
+bool UnrolledList::insert_after(const string& target, const string& value) {
+    UPosition position = locate(target);
+    if (!position)
+        return false;
+
+    insert_at(position.block, position.slot + 1, value);
+    return true;
+}
+
+bool UnrolledList::pop_front() {
+    if (head == nullptr)
+        return false;
+
+    remove_at(head, 0);
+    return true;
+}
+
+bool UnrolledList::pop_back() {
+    if (tail == nullptr)
+        return false;
+
+    remove_at(tail, tail->count - 1);
+    return true;
+}
+
+bool UnrolledList::remove_before(const string& target) {
+    UPosition position = locate(target);
+    if (!position)
+        return false;
+
+    if (position.slot > 0) {
+        remove_at(position.block, position.slot - 1);
+    } else if (position.block->prev != nullptr) {
+        remove_at(position.block->prev, position.block->prev->count - 1);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool UnrolledList::remove_after(const string& target) {
+    UPosition position = locate(target);
+    if (!position)
+        return false;
+
+    if (position.slot + 1 < position.block->count) {
+        remove_at(position.block, position.slot + 1);
+    } else if (position.block->next != nullptr) {
+        remove_at(position.block->next, 0);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool UnrolledList::remove_value(const string& value) {
+    UPosition position = locate(value);
+    if (!position)
+        return false;
+
+    remove_at(position.block, position.slot);
+    return true;
+}
+
+UPosition UnrolledList::find(const string& value) {
+    return locate(value);
+}
+
+UPosition UnrolledList::find_next(UPosition current) const {
+    if (!current) {
+        return UPosition();
+    }
+    if (current.slot + 1 < current.block->count) {
+        return UPosition(current.block, current.slot + 1);
+    }
+    return current.block->next != nullptr ? UPosition(current.block->next, 0) : UPosition();
+}
+
+void UnrolledList::print_forward() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    print_forward(out);
+}
+
+void UnrolledList::print_forward(TextWriter& out) const {
+    if (head == nullptr) {
+        out << "Двусвязный список пуст\n";
+        return;
+    }
+
+    out << "Двусвязный список [" << size << "]: ";
+    for (UBlock* block = head; block != nullptr; block = block->next) {
+        for (int i = 0; i < block->count; ++i) {
+            if (block != head || i > 0) {
+                out << " <-> ";
+            }
+            out << block->items[i].data;
+        }
+    }
+    out << '\n';
+}
+
+void UnrolledList::print_backward() const {
+    OstreamSink sink(cout);
+    TextWriter out(sink);
+    print_backward(out);
+}
+
+void UnrolledList::print_backward(TextWriter& out) const {
+    if (tail == nullptr) {
+        out << "Двусвязный список пуст\n";
+        return;
+    }
+
+    out << "Двусвязный список в обратном порядке [" << size << "]: ";
+    for (UBlock* block = tail; block != nullptr; block = block->prev) {
+        for (int i = block->count - 1; i >= 0; --i) {
+            if (block != tail || i < block->count - 1) {
+                out << " <-> ";
+            }
+            out << block->items[i].data;
+        }
+    }
+    out << '\n';
+}
+
+int UnrolledList::get_size() const {
+    return size;
+}
+
+MemoryUsage UnrolledList::memory_usage() const {
+    MemoryUsage usage;
+    usage.bytes = sizeof(UnrolledList);
+    pool.addTo(usage);
+    for (UBlock* block = head; block != nullptr; block = block->next) {
+        for (int i = 0; i < block->count; ++i) {
+            usage.addString(block->items[i].data);
+        }
+    }
+    return usage;
+}
+
+bool UnrolledList::serialize_binary(const string& filename) const {
+    return writeBinaryFile(filename, *this);
+}
+
+bool UnrolledList::deserialize_binary(const string& filename) {
+    return readBinaryFile(filename, *this);
+}
+
+void UnrolledList::serialize_binary(ByteWriter& out) const {
+    uint64_t bytes = 0;
+    for (UBlock* block = head; block != nullptr; block = block->next) {
+        for (int i = 0; i < block->count; ++i) {
+            bytes += block->items[i].data.size();
+        }
+    }
+
+    out.writeBulkHeader(static_cast<uint32_t>(size), bytes);
+    for (UBlock* block = head; block != nullptr; block = block->next) {
+        for (int i = 0; i < block->count; ++i) {
+            out.writeString(block->items[i].data);
+        }
+    }
+}
+
+bool UnrolledList::deserialize_binary(ByteReader& in) {
+    uint32_t new_size;
+    uint64_t bytes;
+    if (!in.readBulkHeader(new_size, bytes, 4)) {
+        return false;
+    }
+
+    clear();
+
+    string value;
+    for (uint32_t i = 0; i < new_size; ++i) {
+        if (!in.readString(value)) {
+            return false;
+        }
+        push_back(value);
+    }
+
+    return true;
+}
+
+bool UnrolledList::serialize_text(const string& filename) const {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << size << endl;
+
+    for (UBlock* block = head; block != nullptr; block = block->next) {
+        for (int i = 0; i < block->count; ++i) {
+            file << block->items[i].data << endl;
+        }
+    }
+
+    return true;
+}
+
+bool UnrolledList::deserialize_text(const string& filename) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    int new_size;
+    file >> new_size;
+    file.ignore();
+
+    clear();
+
+    for (int i = 0; i < new_size; ++i) {
+        string value;
+        getline(file, value);
+        if (!file.good() && !file.eof()) {
+            return false;
+        }
+        push_back(value);
+    }
+
+    return true;
+}
@@ -0,0 +1,113 @@
+#ifndef UNROLLEDLIST_H
+#define UNROLLEDLIST_H
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+#include "ByteStream.h"
+#include "MemoryUsage.h"
+#include "NodePool.h"
+#include "TextWriter.h"
+
+using namespace std;
+
+// Элемент списка; поле data — как у DNode
+struct UItem {
+    string data;
+};
+
+// Блок развернутого списка: до CAPACITY значений подряд в памяти
+class UBlock {
+public:
+    static constexpr int CAPACITY = 32;
+
+    UItem items[CAPACITY];
+    UBlock* prev;
+    UBlock* next;
+    int count;
+
+    UBlock() : prev(nullptr), next(nullptr), count(0) {}
+};
+
+// Позиция элемента: блок и номер в нем. Заменяет DNode* из DoubleList:
+// position->data — значение, пустая позиция равна nullptr. Вставка и
+// удаление сдвигают элементы блока, поэтому позиции после них недействительны.
+class UPosition {
+private:
+    UBlock* block;
+    int slot;
+
+    friend class UnrolledList;
+
+public:
+    UPosition(nullptr_t = nullptr) : block(nullptr), slot(0) {}
+    UPosition(UBlock* block, int slot) : block(block), slot(slot) {}
+
+    UItem* operator->() const { return &block->items[slot]; }
+    UItem& operator*() const { return block->items[slot]; }
+    explicit operator bool() const { return block != nullptr; }
+
+    bool operator==(const UPosition& other) const { return block == other.block && slot == other.slot; }
+    bool operator!=(const UPosition& other) const { return !(*this == other); }
+};
+
+// Развернутый двусвязный список: интерфейс DoubleList, но в каждом узле
+// лежит до UBlock::CAPACITY значений. Обход, поиск и сериализация читают
+// значения подряд, а переход по указателю нужен раз на блок, а не на каждый
+// элемент. Полный блок при вставке делится пополам; блок, который после
+// удаления вместе с соседом умещается в половину емкости, сливается с ним.
+class UnrolledList {
+private:
+    UBlock* head;
+    UBlock* tail;
+    int size;
+    // Блоки списка; при очистке и разрушении память отдается целиком
+    NodePool<UBlock> pool;
+
+    void clear();
+    UPosition locate(const string& value) const;
+    // Вставка перед элементом slot блока block (slot == count — в конец блока)
+    void insert_at(UBlock* block, int slot, const string& value);
+    void remove_at(UBlock* block, int slot);
+    UBlock* add_block_after(UBlock* prev);  // prev == nullptr — в начало
+    void remove_block(UBlock* block);
+    void merge_next(UBlock* block);         // переносит block->next в block
+
+public:
+    UnrolledList();
+    ~UnrolledList();
+    UnrolledList(const UnrolledList& other);
+    UnrolledList& operator=(const UnrolledList& other);
+
+    void push_front(const string& value);
+    void push_back(const string& value);
+    bool insert_before(const string& target, const string& value);
+    bool insert_after(const string& target, const string& value);
+    bool pop_front();
+    bool pop_back();
+    bool remove_before(const string& target);
+    bool remove_after(const string& target);
+    bool remove_value(const string& value);
+    UPosition find(const string& value);
+    UPosition find_first() const { return head != nullptr ? UPosition(head, 0) : UPosition(); }
+    UPosition find_next(UPosition current) const;
+    void print_forward() const;
+    void print_forward(TextWriter& out) const;
+    void print_backward() const;
+    void print_backward(TextWriter& out) const;
+    int get_size() const;
+    // Занятая память: объект, блоки в куче и емкость строк
+    MemoryUsage memory_usage() const;
+
+    bool serialize_binary(const string& filename) const;
+    bool deserialize_binary(const string& filename);
+    bool serialize_text(const string& filename) const;
+    bool deserialize_text(const string& filename);
+
+    // Сериализация в память; формат тот же, что у DoubleList
+    void serialize_binary(ByteWriter& out) const;
+    bool deserialize_binary(ByteReader& in);
+};
+
+#endif
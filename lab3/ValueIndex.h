@@ -0,0 +1,264 @@
+#ifndef VALUEINDEX_H
+#define VALUEINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "MemoryUsage.h"
+#include "NodePool.h"
+
+using namespace std;
+
+// Запись индекса для одного узла списка
+template <typename Node>
+struct ValueLink {
+    Node* node;
+    Node* prev;            // предыдущий узел списка (односвязному списку его не найти)
+    uint64_t order;        // метки возрастают от головы к хвосту
+    ValueLink* prev_same;  // узлы с тем же значением в порядке списка
+    ValueLink* next_same;
+};
+
+// Индекс значений списка: значение -> его узлы в порядке списка. Первое
+// вхождение и предыдущий узел находятся за O(1), поэтому find, remove_value,
+// insert_before/after и remove_before/after не проходят список.
+//
+// Чтобы вставка узла с уже встречавшимся значением знала свое место среди
+// одинаковых, у каждого узла есть метка порядка. Новый узел получает середину
+// промежутка между соседями; если промежуток исчерпан, метки окна вокруг
+// узла, растущего вдвое, пока в нем не станет достаточно места, раздаются
+// заново.
+//
+// Узел списка хранит указатель link на свою запись (nullptr без индекса),
+// ключи таблицы ссылаются на строки самих узлов.
+template <typename Node>
+class ValueIndex {
+private:
+    using Link = ValueLink<Node>;
+
+    struct Chain {
+        Link* first;
+        Link* last;
+    };
+
+    static constexpr uint64_t SPACING = uint64_t(1) << 32;
+    static constexpr uint64_t MIN_SPACING = uint64_t(1) << 16;
+
+    unordered_map<string_view, Chain> chains;
+    NodePool<Link> links;
+    bool active = false;
+
+    void assignOrder(Link* link) {
+        Node* prev = link->prev;
+        Node* next = link->node->next;
+        uint64_t lo = prev != nullptr ? prev->link->order : 0;
+        if (next == nullptr) {
+            if (prev == nullptr) {
+                link->order = uint64_t(1) << 63;
+                return;
+            }
+            if (UINT64_MAX - lo > SPACING) {
+                link->order = lo + SPACING;
+                return;
+            }
+        } else if (prev == nullptr && next->link->order > SPACING) {
+            link->order = next->link->order - SPACING;
+            return;
+        }
+        uint64_t hi = next != nullptr ? next->link->order : UINT64_MAX;
+        if (hi - lo >= 2) {
+            link->order = lo + (hi - lo) / 2;
+            return;
+        }
+        relabel(link->node);
+    }
+
+    void relabel(Node* node) {
+        Node* start = node;
+        Node* end = node;
+        size_t count = 1;
+        while (true) {
+            Node* before = start->link->prev;
+            Node* after = end->next;
+            uint64_t lo = before != nullptr ? before->link->order : 0;
+            uint64_t hi = after != nullptr ? after->link->order : UINT64_MAX;
+            uint64_t step = (hi - lo) / (count + 1);
+            if (step >= MIN_SPACING || (before == nullptr && after == nullptr)) {
+                step = step > 0 ? step : 1;
+                uint64_t order = lo;
+                for (Node* current = start;; current = current->next) {
+                    order += step;
+                    current->link->order = order;
+                    if (current == end) {
+                        break;
+                    }
+                }
+                return;
+            }
+            for (size_t grow = count; grow > 0; --grow) {
+                bool moved = false;
+                if (start->link->prev != nullptr) {
+                    start = start->link->prev;
+                    ++count;
+                    moved = true;
+                }
+                if (end->next != nullptr) {
+                    end = end->next;
+                    ++count;
+                    moved = true;
+                }
+                if (!moved) {
+                    break;
+                }
+            }
+        }
+    }
+
+    Link* attach(Node* node, Node* prev) {
+        Link* link = links.create();
+        link->node = node;
+        link->prev = prev;
+        node->link = link;
+        return link;
+    }
+
+    void addToChain(Link* link) {
+        link->prev_same = nullptr;
+        link->next_same = nullptr;
+        auto [entry, created] = chains.try_emplace(string_view(link->node->data), Chain{link, link});
+        if (created) {
+            return;
+        }
+        Chain& chain = entry->second;
+        if (link->order > chain.last->order) {
+            link->prev_same = chain.last;
+            chain.last->next_same = link;
+            chain.last = link;
+        } else if (link->order < chain.first->order) {
+            link->next_same = chain.first;
+            chain.first->prev_same = link;
+            chain.first = link;
+        } else {
+            // Вставка между одинаковыми значениями: проход только по ним
+            Link* current = chain.first;
+            while (current->next_same->order < link->order) {
+                current = current->next_same;
+            }
+            link->prev_same = current;
+            link->next_same = current->next_same;
+            current->next_same->prev_same = link;
+            current->next_same = link;
+        }
+    }
+
+public:
+    ValueIndex() = default;
+    ValueIndex(const ValueIndex&) = delete;
+    ValueIndex& operator=(const ValueIndex&) = delete;
+
+    bool enabled() const { return active; }
+
+    // Строит индекс по списку, начиная с head
+    void enable(Node* head) {
+        if (active) {
+            return;
+        }
+        active = true;
+        // Метки раздаются с шагом SPACING, каждый узел встает в конец цепочки
+        Node* prev = nullptr;
+        uint64_t order = 0;
+        for (Node* node = head; node != nullptr; node = node->next) {
+            Link* link = attach(node, prev);
+            order += SPACING;
+            link->order = order;
+            addToChain(link);
+            prev = node;
+        }
+    }
+
+    void disable(Node* head) {
+        for (Node* node = head; node != nullptr; node = node->next) {
+            node->link = nullptr;
+        }
+        clear();
+        active = false;
+    }
+
+    // Первый в порядке списка узел со значением value
+    Node* first(string_view value) const {
+        auto entry = chains.find(value);
+        return entry != chains.end() ? entry->second.first->node : nullptr;
+    }
+
+    Node* previous(const Node* node) const { return node->link->prev; }
+
+    // Узел уже связан со списком: prev перед ним, node->next после него
+    void inserted(Node* node, Node* prev) {
+        Link* link = attach(node, prev);
+        if (node->next != nullptr) {
+            node->next->link->prev = node;
+        }
+        assignOrder(link);
+        addToChain(link);
+    }
+
+    // Вызывается до того, как узел будет исключен из списка
+    void removed(Node* node) {
+        Link* link = node->link;
+        if (node->next != nullptr) {
+            node->next->link->prev = link->prev;
+        }
+
+        auto entry = chains.find(string_view(node->data));
+        Chain& chain = entry->second;
+        if (link->prev_same != nullptr) {
+            link->prev_same->next_same = link->next_same;
+        } else {
+            chain.first = link->next_same;
+        }
+        if (link->next_same != nullptr) {
+            link->next_same->prev_same = link->prev_same;
+        } else {
+            chain.last = link->prev_same;
+        }
+
+        if (chain.first == nullptr) {
+            chains.erase(entry);
+        } else if (entry->first.data() == node->data.data()) {
+            // Ключ ссылался на строку удаляемого узла
+            Node* owner = chain.first->node;
+            auto handle = chains.extract(entry);
+            handle.key() = string_view(owner->data);
+            chains.insert(move(handle));
+        }
+        links.destroy(link);
+        node->link = nullptr;
+    }
+
+    // Все узлы списка уже разрушены
+    void clear() {
+        unordered_map<string_view, Chain>().swap(chains);
+        links.release();
+    }
+
+    size_t distinct_values() const { return chains.size(); }
+
+    // Записи узлов, массив корзин и узлы таблицы (ключ, цепочка, ссылка на
+    // следующий и сохраненный хэш)
+    MemoryUsage memory_usage() const {
+        MemoryUsage usage;
+        links.addTo(usage);
+        if (chains.bucket_count() > 1) {
+            usage.addBlock(chains.bucket_count() * sizeof(void*));
+        }
+        for (size_t i = 0; i < chains.size(); ++i) {
+            usage.addBlock(sizeof(void*) + sizeof(pair<const string_view, Chain>) + sizeof(size_t));
+        }
+        return usage;
+    }
+};
+
+#endif
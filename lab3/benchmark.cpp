@@ -1,15 +1,47 @@
 #include <benchmark/benchmark.h>
 #include <random>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include "Array.h"
 #include "SingleList.h"
 #include "DoubleList.h"
+#include "UnrolledList.h"
 #include "Stack.h"
 #include "Queue.h"
 #include "FullBinaryTree.h"
 #include "HashTable.h"
+#include "Command.h"
+#include "DB.h"
+#include "ShardedDatabase.h"
 
 using namespace std;
 
+// Счетчик выделений памяти: глобальный operator new заменен на весь бинарник
+// бенчмарков, чтобы показывать число выделений на операцию
+static atomic<uint64_t> allocation_count{0};
+
+void* operator new(size_t bytes) {
+    allocation_count.fetch_add(1, memory_order_relaxed);
+    void* block = malloc(bytes == 0 ? 1 : bytes);
+    if (block == nullptr) {
+        throw bad_alloc();
+    }
+    return block;
+}
+
+void operator delete(void* block) noexcept {
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    free(block);
+}
+
 // Бенчмарк для Array
 static void BM_ArrayPushBack(benchmark::State& state) {
     Array arr;
@@ -36,6 +68,345 @@ static void BM_ArrayInsert(benchmark::State& state) {
 }
 BENCHMARK(BM_ArrayInsert)->Range(8, 1024);
 
+// То же в режиме CHUNKED: вставка сдвигает строки только внутри блока
+static void BM_ArrayInsertChunked(benchmark::State& state) {
+    Array arr;
+    arr.set_storage(ArrayStorage::CHUNKED);
+    for (int i = 0; i < state.range(0); i++) {
+        arr.push_back("element_" + to_string(i));
+    }
+
+    random_device rd;
+    mt19937 gen(rd());
+    uniform_int_distribution<> dist(0, arr.length() - 1);
+
+    for (auto _ : state) {
+        arr.insert(dist(gen), "inserted_element");
+    }
+}
+BENCHMARK(BM_ArrayInsertChunked)->Range(8, 1024);
+
+static const char* storageLabel(ArrayStorage mode) {
+    switch (mode) {
+        case ArrayStorage::STRINGS: return "strings";
+        case ArrayStorage::ARENA: return "arena";
+        case ArrayStorage::CHUNKED: return "chunked";
+    }
+    return "";
+}
+
+// Вставка и удаление в большом массиве: range(0) — элементов, range(1) —
+// режим, range(2) — 0 в начало, 1 в случайное место. Размер не меняется.
+static void BM_ArrayInsertLarge(benchmark::State& state) {
+    ArrayStorage mode = static_cast<ArrayStorage>(state.range(1));
+    Array arr;
+    arr.set_storage(mode);
+    for (int i = 0; i < state.range(0); i++) {
+        arr.push_back("element_" + to_string(i));
+    }
+
+    mt19937 gen(11);
+    uniform_int_distribution<> dist(0, arr.length() - 1);
+    for (auto _ : state) {
+        int index = state.range(2) == 0 ? 0 : dist(gen);
+        arr.insert(index, "inserted_element");
+        arr.remove(index);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(string(storageLabel(mode)) + (state.range(2) == 0 ? " front" : " random"));
+}
+BENCHMARK(BM_ArrayInsertLarge)
+    ->ArgsProduct({{100000, 1000000}, {0, 2}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+// Выделения памяти на операцию Array: значения длиннее SSO (32 байта),
+// поэтому каждая копия строки — отдельное выделение
+static constexpr int ALLOC_BATCH = 1024;
+
+static void BM_ArrayAllocations(benchmark::State& state) {
+    string value(32, 'v');
+    vector<string> values(ALLOC_BATCH, value);
+    uint64_t allocations = 0;
+    uint64_t operations = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        Array arr;
+        for (auto& item : values) {
+            item = value;
+        }
+        if (state.range(0) >= 2) {
+            for (int i = 0; i < 256; ++i) {
+                arr.push_back(value);
+            }
+        }
+        state.ResumeTiming();
+
+        uint64_t before = allocation_count.load(memory_order_relaxed);
+        switch (state.range(0)) {
+            case 0:  // push_back копии
+                for (int i = 0; i < ALLOC_BATCH; ++i) {
+                    arr.push_back(value);
+                }
+                break;
+            case 1:  // push_back временной строки
+                for (int i = 0; i < ALLOC_BATCH; ++i) {
+                    arr.push_back(move(values[i]));
+                }
+                break;
+            case 2:  // вставка в начало
+                for (int i = 0; i < ALLOC_BATCH; ++i) {
+                    arr.insert(0, move(values[i]));
+                }
+                break;
+            case 3:  // чтение копией
+                for (int i = 0; i < ALLOC_BATCH; ++i) {
+                    benchmark::DoNotOptimize(arr.get(i % 256).size());
+                }
+                break;
+            default:  // чтение без копии
+                for (int i = 0; i < ALLOC_BATCH; ++i) {
+                    benchmark::DoNotOptimize(arr.view(i % 256).size());
+                }
+                break;
+        }
+        allocations += allocation_count.load(memory_order_relaxed) - before;
+        operations += ALLOC_BATCH;
+    }
+    state.counters["allocs_per_op"] = static_cast<double>(allocations) / static_cast<double>(operations);
+    const char* labels[] = {"push_back copy", "push_back rvalue", "insert front", "get", "view"};
+    state.SetLabel(labels[state.range(0)]);
+}
+BENCHMARK(BM_ArrayAllocations)->DenseRange(0, 4);
+
+// Массив из миллиона значений длиной 24..40 в каждом режиме хранения. Значения
+// заменяются в случайном порядке, поэтому в режиме STRINGS их буферы разбросаны
+// по куче, как у массива, который долго обновлялся.
+static constexpr int LARGE_ARRAY_SIZE = 1 << 20;
+
+static Array& largeArray(ArrayStorage mode) {
+    static Array arrays[3];
+    Array& arr = arrays[static_cast<int>(mode)];
+    if (arr.length() == 0) {
+        mt19937 gen(7);
+        uniform_int_distribution<> length(24, 40);
+        if (mode != ArrayStorage::STRINGS) {
+            arr = largeArray(ArrayStorage::STRINGS);
+            arr.set_storage(mode);
+            return arr;
+        }
+        vector<int> order(LARGE_ARRAY_SIZE);
+        for (int i = 0; i < LARGE_ARRAY_SIZE; ++i) {
+            arr.push_back("");
+            order[i] = i;
+        }
+        shuffle(order.begin(), order.end(), gen);
+        for (int index : order) {
+            arr.replace(index, string(static_cast<size_t>(length(gen)), static_cast<char>('a' + index % 26)));
+        }
+    }
+    return arr;
+}
+
+// Полный проход: сумма длин и первых байтов всех значений
+static void BM_ArrayScan(benchmark::State& state) {
+    const Array& arr = largeArray(static_cast<ArrayStorage>(state.range(0)));
+    for (auto _ : state) {
+        uint64_t checksum = 0;
+        for (int i = 0; i < arr.length(); ++i) {
+            string_view value = arr.view(i);
+            checksum += value.size() + static_cast<uint8_t>(value[0]);
+        }
+        benchmark::DoNotOptimize(checksum);
+    }
+    state.SetItemsProcessed(state.iterations() * arr.length());
+    state.SetLabel(storageLabel(static_cast<ArrayStorage>(state.range(0))));
+}
+BENCHMARK(BM_ArrayScan)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+// Чтение по случайным индексам
+static void BM_ArrayRandomGet(benchmark::State& state) {
+    const Array& arr = largeArray(static_cast<ArrayStorage>(state.range(0)));
+    mt19937 gen(5);
+    uniform_int_distribution<> dist(0, arr.length() - 1);
+    uint64_t checksum = 0;
+    for (auto _ : state) {
+        checksum += arr.view(dist(gen)).size();
+    }
+    benchmark::DoNotOptimize(checksum);
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(storageLabel(static_cast<ArrayStorage>(state.range(0))));
+}
+BENCHMARK(BM_ArrayRandomGet)->DenseRange(0, 2);
+
+static void BM_ArraySerialize(benchmark::State& state) {
+    const Array& arr = largeArray(static_cast<ArrayStorage>(state.range(0)));
+    string buffer;
+    for (auto _ : state) {
+        buffer.clear();
+        BufferSink sink(buffer);
+        ByteWriter out(sink);
+        arr.serialize_binary(out);
+        out.flush();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(buffer.size()));
+    state.SetLabel(storageLabel(static_cast<ArrayStorage>(state.range(0))));
+}
+BENCHMARK(BM_ArraySerialize)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+static void BM_ArrayDeserialize(benchmark::State& state) {
+    string buffer;
+    {
+        BufferSink sink(buffer);
+        ByteWriter out(sink);
+        largeArray(ArrayStorage::STRINGS).serialize_binary(out);
+    }
+    for (auto _ : state) {
+        Array arr;
+        arr.set_storage(static_cast<ArrayStorage>(state.range(0)));
+        ByteReader in(buffer);
+        benchmark::DoNotOptimize(arr.deserialize_binary(in));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(buffer.size()));
+    state.SetLabel(storageLabel(static_cast<ArrayStorage>(state.range(0))));
+}
+BENCHMARK(BM_ArrayDeserialize)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+// 10M коротких значений ("item_<номер>", 6..12 байт) для MFIND/MCOUNT/MFILTER
+static constexpr int SEARCH_ARRAY_SIZE = 10000000;
+
+static const Array& searchArray(ArrayStorage mode) {
+    static Array arrays[3];
+    Array& arr = arrays[static_cast<int>(mode)];
+    if (arr.length() == 0) {
+        arr.set_storage(mode);
+        arr.reserve(SEARCH_ARRAY_SIZE);
+        for (int i = 0; i < SEARCH_ARRAY_SIZE; ++i) {
+            arr.push_back("item_" + to_string(i));
+        }
+    }
+    return arr;
+}
+
+// Образцы с числом совпадений около 100: точное, префикс, подстрока
+static constexpr const char* SEARCH_PATTERNS[] = {"item_4999999", "item_99999", "77777"};
+
+// range(0) — режим хранения, range(1) — MatchMode, range(2) — потоков
+static void BM_ArraySearch(benchmark::State& state) {
+    ArrayStorage storage = static_cast<ArrayStorage>(state.range(0));
+    MatchMode mode = static_cast<MatchMode>(state.range(1));
+    const Array& arr = searchArray(storage);
+    int matches = 0;
+    for (auto _ : state) {
+        matches = arr.count_matches(SEARCH_PATTERNS[state.range(1)], mode, static_cast<size_t>(state.range(2)));
+        benchmark::DoNotOptimize(matches);
+    }
+    state.SetItemsProcessed(state.iterations() * arr.length());
+    state.counters["matches"] = matches;
+    state.SetLabel(storageLabel(storage));
+}
+BENCHMARK(BM_ArraySearch)
+    ->ArgsProduct({{0, 1}, {0, 1, 2}, {1, 4}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Тот же подсчет через string::compare и string::find без предфильтра
+static void BM_ArraySearchNaive(benchmark::State& state) {
+    const Array& arr = searchArray(ArrayStorage::STRINGS);
+    string pattern = SEARCH_PATTERNS[state.range(0)];
+    int matches = 0;
+    for (auto _ : state) {
+        matches = 0;
+        for (int i = 0; i < arr.length(); ++i) {
+            string_view value = arr.view(i);
+            switch (static_cast<MatchMode>(state.range(0))) {
+                case MatchMode::EXACT:
+                    matches += value == pattern;
+                    break;
+                case MatchMode::PREFIX:
+                    matches += value.compare(0, pattern.size(), pattern) == 0;
+                    break;
+                case MatchMode::SUBSTRING:
+                    matches += value.find(pattern) != string_view::npos;
+                    break;
+            }
+        }
+        benchmark::DoNotOptimize(matches);
+    }
+    state.SetItemsProcessed(state.iterations() * arr.length());
+    state.counters["matches"] = matches;
+}
+BENCHMARK(BM_ArraySearchNaive)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+// 10M значений из searchArray в случайном порядке
+static const Array& shuffledArray() {
+    static Array arr;
+    if (arr.length() == 0) {
+        const Array& source = searchArray(ArrayStorage::STRINGS);
+        vector<int> order(static_cast<size_t>(source.length()));
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = static_cast<int>(i);
+        }
+        shuffle(order.begin(), order.end(), mt19937(13));
+        arr.reserve(source.length());
+        for (int index : order) {
+            arr.push_back(source.view(index));
+        }
+    }
+    return arr;
+}
+
+// MSORTED на 10M значений: range(0) — потоков, range(1) — устойчивая сортировка
+static void BM_ArraySortedOrder(benchmark::State& state) {
+    const Array& arr = shuffledArray();
+    for (auto _ : state) {
+        vector<int> order = arr.sorted_order(state.range(1) != 0, static_cast<size_t>(state.range(0)));
+        benchmark::DoNotOptimize(order.data());
+    }
+    state.SetItemsProcessed(state.iterations() * arr.length());
+    state.SetLabel(state.range(1) != 0 ? "stable" : "in place");
+}
+BENCHMARK(BM_ArraySortedOrder)
+    ->ArgsProduct({{1, 2, 4, 8}, {0, 1}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Для сравнения: std::sort номеров по string_view
+static void BM_ArraySortedOrderStd(benchmark::State& state) {
+    const Array& arr = shuffledArray();
+    for (auto _ : state) {
+        vector<int> order(static_cast<size_t>(arr.length()));
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = static_cast<int>(i);
+        }
+        sort(order.begin(), order.end(), [&arr](int a, int b) { return arr.view(a) < arr.view(b); });
+        benchmark::DoNotOptimize(order.data());
+    }
+    state.SetItemsProcessed(state.iterations() * arr.length());
+}
+BENCHMARK(BM_ArraySortedOrderStd)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// MGET через базу: ответ дописывается в буфер без промежуточной строки
+static void BM_ArrayGetCommand(benchmark::State& state) {
+    Database db;
+    db.setStatsEnabled(false);
+    db.executeCommand("MCREATE arr");
+    for (int i = 0; i < 256; ++i) {
+        db.executeCommand("MPUSH arr " + string(32, 'v'));
+    }
+    string reply;
+    reply.reserve(256);
+    uint64_t before = allocation_count.load(memory_order_relaxed);
+    for (auto _ : state) {
+        reply.clear();
+        db.executeCommand("MGET arr 17", reply);
+        benchmark::DoNotOptimize(reply.data());
+    }
+    state.counters["allocs_per_op"] = static_cast<double>(allocation_count.load(memory_order_relaxed) - before) /
+                                      static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_ArrayGetCommand);
+
 // Бенчмарк для SingleList
 static void BM_SingleListPushBack(benchmark::State& state) {
     SingleList list;
@@ -62,6 +433,211 @@ static void BM_DoubleListPushBack(benchmark::State& state) {
 }
 BENCHMARK(BM_DoubleListPushBack);
 
+// Прежнее устройство списка для сравнения с пулом узлов: new на каждый узел
+template <typename Node>
+struct HeapNodeList {
+    Node* head = nullptr;
+    Node* tail = nullptr;
+
+    ~HeapNodeList() {
+        while (head != nullptr) {
+            pop_front();
+        }
+    }
+    void push_back(const string& value) {
+        Node* node = new Node(value);
+        if (tail != nullptr) {
+            tail->next = node;
+        } else {
+            head = node;
+        }
+        tail = node;
+    }
+    void pop_front() {
+        Node* node = head;
+        head = head->next;
+        if (head == nullptr) {
+            tail = nullptr;
+        }
+        delete node;
+    }
+};
+
+// range(0): 0 — SingleList, 1 — DoubleList, 2 и 3 — те же узлы через new/delete
+static constexpr const char* LIST_LABELS[] = {"single pool", "double pool", "single heap", "double heap"};
+
+template <typename List>
+static void listChurn(benchmark::State& state, List& list) {
+    for (int i = 0; i < 1024; ++i) {
+        list.push_back("value");
+    }
+    for (auto _ : state) {
+        list.push_back("value");
+        list.pop_front();
+    }
+}
+
+// Очередь из 1024 элементов: добавление в конец и удаление из начала
+static void BM_ListChurn(benchmark::State& state) {
+    if (state.range(0) == 0) {
+        SingleList list;
+        listChurn(state, list);
+    } else if (state.range(0) == 1) {
+        DoubleList list;
+        listChurn(state, list);
+    } else if (state.range(0) == 2) {
+        HeapNodeList<SNode> list;
+        listChurn(state, list);
+    } else {
+        HeapNodeList<DNode> list;
+        listChurn(state, list);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(LIST_LABELS[state.range(0)]);
+}
+BENCHMARK(BM_ListChurn)->DenseRange(0, 3);
+
+// Заполнение двух списков вперемешку, проход по первому и разрушение обоих.
+// У узлов через new соседи по списку разнесены по куче.
+template <typename List>
+static void listBuildWalkDestroy(benchmark::State& state, uint64_t& walked) {
+    auto first = make_unique<List>();
+    auto second = make_unique<List>();
+    for (int i = 0; i < state.range(1); ++i) {
+        first->push_back("value");
+        second->push_back("value");
+    }
+    for (auto* node = first->head; node != nullptr; node = node->next) {
+        walked += node->data.size();
+    }
+    first.reset();
+    second.reset();
+}
+
+// Доступ к head у SingleList/DoubleList только через find_first
+template <typename List, typename Node>
+struct PooledListView {
+    List list;
+    Node* head = nullptr;
+    void push_back(const string& value) {
+        list.push_back(value);
+        head = list.find_first();
+    }
+};
+
+static void BM_ListBuildWalkDestroy(benchmark::State& state) {
+    uint64_t walked = 0;
+    for (auto _ : state) {
+        switch (state.range(0)) {
+            case 0: listBuildWalkDestroy<PooledListView<SingleList, SNode>>(state, walked); break;
+            case 1: listBuildWalkDestroy<PooledListView<DoubleList, DNode>>(state, walked); break;
+            case 2: listBuildWalkDestroy<HeapNodeList<SNode>>(state, walked); break;
+            default: listBuildWalkDestroy<HeapNodeList<DNode>>(state, walked); break;
+        }
+    }
+    benchmark::DoNotOptimize(walked);
+    state.SetItemsProcessed(state.iterations() * state.range(1) * 2);
+    state.SetLabel(LIST_LABELS[state.range(0)]);
+}
+BENCHMARK(BM_ListBuildWalkDestroy)
+    ->ArgsProduct({{0, 1, 2, 3}, {1 << 16}})
+    ->Unit(benchmark::kMillisecond);
+
+// Вставка после случайного значения и удаление вставленного в списке из
+// 100000 элементов. range(1): 1 — с индексом значений, 0 — поиск проходом.
+template <typename List>
+static void listIndexedInsertRemove(benchmark::State& state) {
+    const int count = 100000;
+    List list;
+    list.set_value_index(state.range(1) != 0);
+    for (int i = 0; i < count; ++i) {
+        list.push_back("value_" + to_string(i));
+    }
+    mt19937 rng(42);
+    vector<string> targets(1024);
+    for (auto& target : targets) {
+        target = "value_" + to_string(rng() % count);
+    }
+    size_t next = 0;
+    for (auto _ : state) {
+        const string& target = targets[next++ % targets.size()];
+        list.insert_after(target, "inserted");
+        list.remove_after(target);
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+    state.counters["index_bytes"] = static_cast<double>(list.index_memory_usage().bytes);
+    state.counters["list_bytes"] = static_cast<double>(list.memory_usage().bytes);
+}
+
+static void BM_ListIndexedInsertRemove(benchmark::State& state) {
+    if (state.range(0) == 0) {
+        listIndexedInsertRemove<SingleList>(state);
+    } else {
+        listIndexedInsertRemove<DoubleList>(state);
+    }
+    state.SetLabel(string(state.range(0) == 0 ? "single" : "double") + (state.range(1) != 0 ? " indexed" : " scan"));
+}
+BENCHMARK(BM_ListIndexedInsertRemove)->ArgsProduct({{0, 1}, {0, 1}});
+
+// Развернутый список против DoubleList на 1000000 элементов.
+// range(0): 0 — DoubleList, 1 — UnrolledList.
+static constexpr int UNROLLED_BENCH_SIZE = 1000000;
+
+template <typename List>
+static void fillBenchList(List& list) {
+    for (int i = 0; i < UNROLLED_BENCH_SIZE; ++i) {
+        list.push_back("value_" + to_string(i));
+    }
+}
+
+template <typename List>
+static void listTraverse(benchmark::State& state) {
+    List list;
+    fillBenchList(list);
+    for (auto _ : state) {
+        size_t bytes = 0;
+        for (auto node = list.find_first(); node != nullptr; node = list.find_next(node)) {
+            bytes += node->data.size();
+        }
+        benchmark::DoNotOptimize(bytes);
+    }
+    state.SetItemsProcessed(state.iterations() * UNROLLED_BENCH_SIZE);
+}
+
+static void BM_UnrolledTraverse(benchmark::State& state) {
+    if (state.range(0) == 0) {
+        listTraverse<DoubleList>(state);
+    } else {
+        listTraverse<UnrolledList>(state);
+    }
+    state.SetLabel(state.range(0) == 0 ? "DoubleList" : "UnrolledList");
+}
+BENCHMARK(BM_UnrolledTraverse)->DenseRange(0, 1)->Unit(benchmark::kMillisecond);
+
+// Вставка после элемента из середины и удаление вставленного; поиск
+// середины — проход по половине списка
+template <typename List>
+static void listMiddleInsert(benchmark::State& state) {
+    List list;
+    fillBenchList(list);
+    const string target = "value_" + to_string(UNROLLED_BENCH_SIZE / 2);
+    for (auto _ : state) {
+        list.insert_after(target, "inserted");
+        list.remove_after(target);
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+static void BM_UnrolledMiddleInsert(benchmark::State& state) {
+    if (state.range(0) == 0) {
+        listMiddleInsert<DoubleList>(state);
+    } else {
+        listMiddleInsert<UnrolledList>(state);
+    }
+    state.SetLabel(state.range(0) == 0 ? "DoubleList" : "UnrolledList");
+}
+BENCHMARK(BM_UnrolledMiddleInsert)->DenseRange(0, 1)->Unit(benchmark::kMillisecond);
+
 // Бенчмарк для Stack
 static void BM_StackPushPop(benchmark::State& state) {
     Stack stack;
@@ -132,4 +708,567 @@ static void BM_ArraySerialization(benchmark::State& state) {
 }
 BENCHMARK(BM_ArraySerialization);
 
+// Та же работа без файловой системы: буфер в памяти и чтение без копирования
+static void BM_ArraySerializationInMemory(benchmark::State& state) {
+    Array arr;
+    for (int i = 0; i < 1000; i++) {
+        arr.push_back("element_" + to_string(i));
+    }
+
+    string buffer;
+    for (auto _ : state) {
+        buffer.clear();
+        {
+            BufferSink sink(buffer);
+            ByteWriter out(sink);
+            arr.serialize_binary(out);
+        }
+        Array arr2;
+        ByteReader in(buffer);
+        arr2.deserialize_binary(in);
+        benchmark::DoNotOptimize(arr2.length());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_ArraySerializationInMemory);
+
+// Бенчмарк разбора и диспетчеризации команд
+static void BM_CommandTokenize(benchmark::State& state) {
+    CommandTokens tokens;
+    const string command = "FPUSH list1 BEFORE target value";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tokens.tokenize(command));
+    }
+}
+BENCHMARK(BM_CommandTokenize);
+
+// Поиск кода команды не должен зависеть от ее семейства
+static void BM_CommandLookup(benchmark::State& state) {
+    static const string_view names[] = {"MSIZE", "FSIZE", "LSIZE", "SSIZE", "QSIZE", "TSIZE", "HSIZE", "HELP"};
+    string_view name = names[state.range(0)];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(findCommand(name));
+    }
+    state.SetLabel(string(name));
+}
+BENCHMARK(BM_CommandLookup)->DenseRange(0, 7);
+
+static void BM_DatabaseParseDispatch(benchmark::State& state) {
+    static const char* commands[] = {"MSIZE c", "FSIZE c", "LSIZE c", "SSIZE c", "QSIZE c", "TSIZE c", "HSIZE c"};
+    static const char* creates[] = {"MCREATE c", "FCREATE c", "LCREATE c", "SCREATE c", "QCREATE c", "TCREATE c", "HCREATE c"};
+    Database db;
+    db.executeCommand(creates[state.range(0)]);
+    const string command = commands[state.range(0)];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db.executeCommand(command));
+    }
+    state.SetLabel(command);
+}
+BENCHMARK(BM_DatabaseParseDispatch)->DenseRange(0, 6);
+
+// Поштучное и пакетное выполнение одной и той же нагрузки
+static string makeWorkload(const char* create, const char* command, int count, bool with_key) {
+    string workload = string(create) + "\n";
+    for (int i = 0; i < count; i++) {
+        workload += command;
+        if (with_key) {
+            workload += " key_" + to_string(i);
+        }
+        workload += " value_" + to_string(i) + "\n";
+    }
+    return workload;
+}
+
+static const char* workload_creates[] = {"MCREATE c", "HCREATE c", "QCREATE c"};
+static const char* workload_commands[] = {"MPUSH c", "HINSERT c", "QPUSH c"};
+
+static void BM_PerCommandWorkload(benchmark::State& state) {
+    const int count = 10000;
+    const string workload = makeWorkload(workload_creates[state.range(0)], workload_commands[state.range(0)],
+                                         count, state.range(0) == 1);
+    vector<string> commands;
+    size_t pos = 0;
+    while (pos < workload.size()) {
+        size_t end = workload.find('\n', pos);
+        commands.push_back(workload.substr(pos, end - pos));
+        pos = end + 1;
+    }
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        Database db;
+        state.ResumeTiming();
+        for (const auto& command : commands) {
+            benchmark::DoNotOptimize(db.executeCommand(command));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetLabel(workload_commands[state.range(0)]);
+}
+BENCHMARK(BM_PerCommandWorkload)->DenseRange(0, 2);
+
+static void BM_BatchWorkload(benchmark::State& state) {
+    const int count = 10000;
+    const string workload = makeWorkload(workload_creates[state.range(0)], workload_commands[state.range(0)],
+                                         count, state.range(0) == 1);
+    string output;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        Database db;
+        output.clear();
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(db.executeBatch(workload, output));
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetLabel(workload_commands[state.range(0)]);
+}
+BENCHMARK(BM_BatchWorkload)->DenseRange(0, 2);
+
+// Стоимость долговечной записи: журнал с разными политиками fsync против
+// полного сохранения базы после изменения
+static const char* journal_policy_names[] = {"always", "interval", "never", "no journal"};
+
+static void removeJournalFiles(const string& base) {
+    filesystem::remove(Journal::manifestPath(base));
+    for (uint64_t number = 1; filesystem::exists(Journal::segmentPath(base, number)); number++) {
+        filesystem::remove(Journal::segmentPath(base, number));
+    }
+}
+
+static void BM_JournaledWrites(benchmark::State& state) {
+    const int count = 200;
+    string base = (filesystem::temp_directory_path() / "lab3_bench_journal").string();
+    removeJournalFiles(base);
+    Database db;
+    if (state.range(0) < 3) {
+        db.openJournal(base, static_cast<FsyncPolicy>(state.range(0)), 10);
+    }
+    db.executeCommand("MCREATE c");
+
+    for (auto _ : state) {
+        for (int i = 0; i < count; i++) {
+            benchmark::DoNotOptimize(db.executeCommand("MPUSH c value"));
+        }
+        state.PauseTiming();
+        db.executeCommand("DEL c");
+        db.executeCommand("MCREATE c");
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetLabel(journal_policy_names[state.range(0)]);
+
+    db.closeJournal();
+    removeJournalFiles(base);
+}
+BENCHMARK(BM_JournaledWrites)->DenseRange(0, 3)->Unit(benchmark::kMicrosecond);
+
+static void BM_FullSave(benchmark::State& state) {
+    string path = (filesystem::temp_directory_path() / "lab3_bench_save.txt").string();
+    Database db;
+    db.executeCommand("MCREATE c");
+    for (int i = 0; i < state.range(0); i++) {
+        db.executeCommand("MPUSH c value");
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db.saveToFile(path));
+    }
+    filesystem::remove(path);
+}
+BENCHMARK(BM_FullSave)->Range(8, 8 << 10)->Unit(benchmark::kMicrosecond);
+
+static void BM_SnapshotLoad(benchmark::State& state) {
+    string path = (filesystem::temp_directory_path() / "lab3_bench_snapshot.bin").string();
+    {
+        Database db;
+        db.executeCommand("MCREATE arr");
+        db.executeCommand("QCREATE q");
+        db.executeCommand("HCREATE ht");
+        for (int i = 0; i < state.range(0); i++) {
+            db.executeCommand("MPUSH arr value_" + to_string(i));
+            db.executeCommand("QPUSH q value_" + to_string(i));
+            db.executeCommand("HINSERT ht key_" + to_string(i) + " value_" + to_string(i));
+        }
+        db.saveToFile(path);
+    }
+
+    Database db;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db.loadFromFile(path));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 3);
+    filesystem::remove(path);
+}
+BENCHMARK(BM_SnapshotLoad)->Range(8, 8 << 10)->Unit(benchmark::kMicrosecond);
+
+// Запуск с большой базой: загрузка снимка из многих контейнеров при разном
+// числе потоков. Файл одинаков при любом числе потоков.
+static void fillStartupDatabase(Database& db) {
+    const int containers = 20000;
+    for (int i = 0; i < containers; i++) {
+        string name = to_string(i);
+        if (i % 2 == 0) {
+            db.executeCommand("MCREATE arr" + name);
+            for (int j = 0; j < 16; j++) {
+                db.executeCommand("MPUSH arr" + name + " value_" + to_string(j));
+            }
+        } else {
+            db.executeCommand("HCREATE ht" + name);
+            // Без реструктуризации таблицы, которая печатает отчет
+            for (int j = 0; j < 8; j++) {
+                db.executeCommand("HINSERT ht" + name + " key_" + to_string(j) + " value_" + to_string(j));
+            }
+        }
+    }
+}
+
+static void BM_SnapshotStartup(benchmark::State& state) {
+    string path = (filesystem::temp_directory_path() / "lab3_bench_startup.bin").string();
+    {
+        Database db;
+        fillStartupDatabase(db);
+        db.saveToFile(path);
+    }
+
+    for (auto _ : state) {
+        Database db;
+        db.setSnapshotThreads(state.range(0));
+        benchmark::DoNotOptimize(db.loadFromFile(path));
+    }
+    state.SetBytesProcessed(state.iterations() * filesystem::file_size(path));
+    filesystem::remove(path);
+}
+BENCHMARK(BM_SnapshotStartup)->Arg(1)->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_SnapshotParallelSave(benchmark::State& state) {
+    string path = (filesystem::temp_directory_path() / "lab3_bench_parallel_save.bin").string();
+    Database db;
+    fillStartupDatabase(db);
+    db.setSnapshotThreads(state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db.saveToFile(path));
+    }
+    state.SetBytesProcessed(state.iterations() * filesystem::file_size(path));
+    filesystem::remove(path);
+}
+BENCHMARK(BM_SnapshotParallelSave)->Arg(1)->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Тысячи статичных массивов и несколько горячих очередей: полное сохранение
+// против инкрементального, которое пишет только измененные контейнеры
+static void BM_SaveWithChurn(benchmark::State& state) {
+    string path = (filesystem::temp_directory_path() / "lab3_bench_churn.bin").string();
+    Database db;
+    for (int i = 0; i < 5000; i++) {
+        string name = "arr" + to_string(i);
+        db.executeCommand("MCREATE " + name);
+        for (int j = 0; j < 16; j++) {
+            db.executeCommand("MPUSH " + name + " value_" + to_string(j));
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        db.executeCommand("QCREATE hot" + to_string(i));
+    }
+    bool incremental = state.range(0) == 1;
+    db.saveIncremental(path);
+
+    int tick = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int i = 0; i < 4; i++) {
+            db.executeCommand("QPUSH hot" + to_string(i) + " job_" + to_string(tick));
+        }
+        tick++;
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(incremental ? db.saveIncremental(path) : db.saveToFile(path));
+    }
+    state.SetLabel(incremental ? "incremental" : "full");
+    filesystem::remove(path);
+}
+BENCHMARK(BM_SaveWithChurn)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Задержка команд вокруг сохранения: SAVE останавливает обработку на все время
+// записи, а BGSAVE — только на fork(). Задержка самой команды сохранения
+// входит в выборку: клиент, пришедший в этот момент, ждал бы столько же.
+static void BM_CommandLatencyDuringSave(benchmark::State& state) {
+    string path = (filesystem::temp_directory_path() / "lab3_bench_bgsave.bin").string();
+    Database db;
+    fillStartupDatabase(db);
+    db.executeCommand("QCREATE hot");
+    const bool background = state.range(0) == 1;
+    const string save = string(background ? "BGSAVE " : "SAVE ") + path;
+    const int commands = 2000;
+
+    vector<double> latencies;
+    for (auto _ : state) {
+        auto started = chrono::steady_clock::now();
+        benchmark::DoNotOptimize(db.executeCommand(save));
+        auto finished = chrono::steady_clock::now();
+        latencies.push_back(chrono::duration<double, micro>(finished - started).count());
+
+        for (int i = 0; i < commands; i++) {
+            started = chrono::steady_clock::now();
+            benchmark::DoNotOptimize(db.executeCommand(i % 2 == 0 ? "QPUSH hot job" : "MGET arr0 3"));
+            finished = chrono::steady_clock::now();
+            latencies.push_back(chrono::duration<double, micro>(finished - started).count());
+        }
+
+        state.PauseTiming();
+        db.waitForBackgroundSave();
+        db.executeCommand("DEL hot");
+        db.executeCommand("QCREATE hot");
+        state.ResumeTiming();
+    }
+
+    sort(latencies.begin(), latencies.end());
+    state.counters["p50_us"] = latencies[latencies.size() / 2];
+    state.counters["p99_us"] = latencies[latencies.size() * 99 / 100];
+    state.counters["p999_us"] = latencies[latencies.size() * 999 / 1000];
+    state.counters["max_us"] = latencies.back();
+    state.SetLabel(background ? "BGSAVE" : "SAVE");
+    filesystem::remove(path);
+}
+BENCHMARK(BM_CommandLatencyDuringSave)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->Iterations(20);
+
+// Вывод большого контейнера: построчный сброс cout против буферизованного
+// TextWriter, который пишет прямо в строку ответа
+static void BM_ArrayPrint(benchmark::State& state) {
+    Array arr;
+    for (int i = 0; i < 100000; i++) {
+        arr.push_back("element_" + to_string(i));
+    }
+
+    string buffer;
+    for (auto _ : state) {
+        buffer.clear();
+        BufferSink sink(buffer);
+        TextWriter out(sink);
+        arr.print(out);
+        out.flush();
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_ArrayPrint)->Unit(benchmark::kMicrosecond);
+
+static void BM_HashTablePrintCommand(benchmark::State& state) {
+    Database db;
+    db.executeCommand("HCREATE ht");
+    for (int i = 0; i < 8; i++) {
+        db.executeCommand("HINSERT ht key_" + to_string(i) + " value_" + to_string(i));
+    }
+    size_t bytes = 0;
+    for (auto _ : state) {
+        string reply = db.executeCommand("HPRINT ht");
+        bytes += reply.size();
+        benchmark::DoNotOptimize(reply.data());
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_HashTablePrintCommand);
+
+// Пропускная способность шардированной базы: 4 клиентских потока шлют пакеты
+// команд к 1024 очередям; аргумент — число шардов
+static void BM_ShardedThroughput(benchmark::State& state) {
+    const size_t clients = 4;
+    const size_t batch = 256;
+    const size_t queues = 1024;
+    ShardedDatabase sharded(static_cast<size_t>(state.range(0)));
+
+    // У каждого клиента свои очереди и заранее подготовленные пакеты
+    vector<vector<string>> owned(clients);
+    for (size_t c = 0; c < clients; ++c) {
+        for (size_t i = 0; i < batch; ++i) {
+            string queue = "queue_" + to_string((c * batch + i) % queues);
+            owned[c].push_back((i % 2 == 0 ? "QPUSH " + queue + " value" : "QPOP " + queue));
+        }
+    }
+    for (size_t q = 0; q < queues; ++q) {
+        sharded.executeCommand("QCREATE queue_" + to_string(q));
+    }
+
+    const size_t rounds = 64;
+    for (auto _ : state) {
+        vector<thread> threads;
+        for (size_t c = 0; c < clients; ++c) {
+            threads.emplace_back([&sharded, &owned, c, rounds] {
+                vector<string_view> commands(owned[c].begin(), owned[c].end());
+                vector<string> replies;
+                for (size_t r = 0; r < rounds; ++r) {
+                    sharded.executeBatch(commands.data(), commands.size(), replies);
+                }
+            });
+        }
+        for (auto& worker : threads) {
+            worker.join();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * clients * rounds * batch);
+}
+BENCHMARK(BM_ShardedThroughput)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Цена статистики команд: одна и та же короткая команда без замеров, только
+// с журналом медленных команд (порог не достигается) и со всей статистикой
+static void BM_StatsOverhead(benchmark::State& state) {
+    Database db;
+    db.setStatsEnabled(state.range(0) == 2);
+    if (state.range(0) == 0) {
+        db.setSlowLogThreshold(SlowLog::DISABLED);
+    }
+    db.executeCommand("SCREATE s");
+    string reply;
+    for (auto _ : state) {
+        reply.clear();
+        db.executeCommand("SSIZE s", reply);
+        benchmark::DoNotOptimize(reply.data());
+    }
+    const char* labels[] = {"stats off", "slowlog only", "stats and slowlog"};
+    state.SetLabel(labels[state.range(0)]);
+}
+BENCHMARK(BM_StatsOverhead)->Arg(0)->Arg(1)->Arg(2);
+
+// Стресс конкурентного режима: потоки выполняют MGET/MREPLACE над 64 массивами,
+// аргумент — доля чтений в процентах. Для сравнения та же нагрузка на обычной
+// базе под одним глобальным мьютексом.
+static constexpr int STRESS_ARRAYS = 64;
+static constexpr int STRESS_ELEMENTS = 256;
+
+static void fillStressDatabase(Database& db) {
+    for (int a = 0; a < STRESS_ARRAYS; ++a) {
+        string name = "arr" + to_string(a);
+        db.executeCommand("MCREATE " + name);
+        for (int i = 0; i < STRESS_ELEMENTS; ++i) {
+            db.executeCommand("MPUSH " + name + " value_" + to_string(i));
+        }
+    }
+}
+
+// Команды потока заранее: замер не включает форматирование строк
+static vector<string> makeStressCommands(int thread_index, int read_percent) {
+    mt19937 gen(static_cast<unsigned>(thread_index + 1));
+    uniform_int_distribution<> array_dist(0, STRESS_ARRAYS - 1);
+    uniform_int_distribution<> index_dist(0, STRESS_ELEMENTS - 1);
+    uniform_int_distribution<> percent(0, 99);
+    vector<string> commands;
+    for (int i = 0; i < 4096; ++i) {
+        string target = "arr" + to_string(array_dist(gen)) + " " + to_string(index_dist(gen));
+        commands.push_back(percent(gen) < read_percent ? "MGET " + target : "MREPLACE " + target + " new");
+    }
+    return commands;
+}
+
+static Database* stress_db = nullptr;
+static mutex stress_global_lock;
+
+template <bool Concurrent>
+static void runStress(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        stress_db = new Database();
+        stress_db->setConcurrent(Concurrent);
+        fillStressDatabase(*stress_db);
+    }
+    vector<string> commands = makeStressCommands(state.thread_index(), static_cast<int>(state.range(0)));
+    size_t next = 0;
+    string reply;
+
+    for (auto _ : state) {
+        reply.clear();
+        if (Concurrent) {
+            stress_db->executeCommand(commands[next], reply);
+        } else {
+            lock_guard<mutex> guard(stress_global_lock);
+            stress_db->executeCommand(commands[next], reply);
+        }
+        next = (next + 1) % commands.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        delete stress_db;
+        stress_db = nullptr;
+    }
+}
+
+static void BM_ConcurrentReadWrite(benchmark::State& state) { runStress<true>(state); }
+BENCHMARK(BM_ConcurrentReadWrite)->Arg(50)->Arg(90)->Arg(100)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_GlobalMutexReadWrite(benchmark::State& state) { runStress<false>(state); }
+BENCHMARK(BM_GlobalMutexReadWrite)->Arg(50)->Arg(90)->Arg(100)->ThreadRange(1, 8)->UseRealTime();
+
+// Байт на элемент для каждого типа контейнера: 10000 значений длиной 8
+// (строка внутри объекта) и 32 (отдельный буфер). Время — заполнение и подсчет.
+static constexpr int MEMORY_ELEMENTS = 10000;
+
+static MemoryUsage fillAndMeasure(int type, size_t value_length) {
+    string value(value_length, 'v');
+    switch (type) {
+        case 0: {
+            Array arr;
+            for (int i = 0; i < MEMORY_ELEMENTS; ++i) {
+                arr.push_back(value);
+            }
+            return arr.memory_usage();
+        }
+        case 1: {
+            SingleList list;
+            for (int i = 0; i < MEMORY_ELEMENTS; ++i) {
+                list.push_back(value);
+            }
+            return list.memory_usage();
+        }
+        case 2: {
+            DoubleList list;
+            for (int i = 0; i < MEMORY_ELEMENTS; ++i) {
+                list.push_back(value);
+            }
+            return list.memory_usage();
+        }
+        case 3: {
+            Stack stack;
+            for (int i = 0; i < MEMORY_ELEMENTS; ++i) {
+                stack.push(value);
+            }
+            return stack.memory_usage();
+        }
+        case 4: {
+            Queue queue;
+            for (int i = 0; i < MEMORY_ELEMENTS; ++i) {
+                queue.push(value);
+            }
+            return queue.memory_usage();
+        }
+        case 5: {
+            FullBinaryTree tree;
+            for (int i = 0; i < MEMORY_ELEMENTS; ++i) {
+                tree.insert(i, value);
+            }
+            return tree.memory_usage();
+        }
+        default: {
+            DoubleHashTable table;
+            for (int i = 0; i < MEMORY_ELEMENTS; ++i) {
+                string key = to_string(i);
+                key.resize(value_length, 'k');
+                table.insert(key, value);
+            }
+            return table.memory_usage();
+        }
+    }
+}
+
+static void BM_BytesPerElement(benchmark::State& state) {
+    int type = static_cast<int>(state.range(0));
+    size_t value_length = static_cast<size_t>(state.range(1));
+    MemoryUsage usage;
+    for (auto _ : state) {
+        usage = fillAndMeasure(type, value_length);
+    }
+    state.counters["bytes_per_element"] = static_cast<double>(usage.bytes) / MEMORY_ELEMENTS;
+    state.counters["overhead_per_element"] = static_cast<double>(usage.bytes - usage.payload) / MEMORY_ELEMENTS;
+    const char* names[] = {"array", "singly_list", "doubly_list", "stack", "queue", "tree", "hash_table"};
+    state.SetLabel(names[type]);
+}
+BENCHMARK(BM_BytesPerElement)->ArgsProduct({{0, 1, 2, 3, 4, 5, 6}, {8, 32}})->Unit(benchmark::kMillisecond);
+
 BENCHMARK_MAIN();
\ No newline at end of file
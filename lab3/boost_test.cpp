@@ -2067,12 +2067,9 @@ BOOST_AUTO_TEST_CASE(DatabaseArrayCommands) {
                      "SUCCESS: Element removed at index 1");
     
     // Печать
-    boost::test_tools::output_test_stream output;
-    auto old_cout = cout.rdbuf(output.rdbuf());
-    db.executeCommand("PRINT arr1");
-    cout.rdbuf(old_cout);
-    BOOST_CHECK(output.str().find("SUCCESS") != string::npos || 
-                output.str().find("массив") != string::npos);
+    string output = db.executeCommand("PRINT arr1");
+    BOOST_CHECK(output.find("SUCCESS") != string::npos || 
+                output.find("массив") != string::npos);
     
     // Ошибки
     BOOST_CHECK(db.executeCommand("MCREATE arr1").find("ERROR") != string::npos);
@@ -2114,11 +2111,8 @@ BOOST_AUTO_TEST_CASE(DatabaseSingleListCommands) {
                      "SUCCESS: Value removed");
     
     // Print backward
-    boost::test_tools::output_test_stream output;
-    auto old_cout = cout.rdbuf(output.rdbuf());
-    db.executeCommand("FPRINT_BACKWARD list1");
-    cout.rdbuf(old_cout);
-    BOOST_CHECK(output.str().find("SUCCESS") != string::npos);
+    string output = db.executeCommand("FPRINT_BACKWARD list1");
+    BOOST_CHECK(output.find("SUCCESS") != string::npos);
 }
 
 BOOST_AUTO_TEST_CASE(DatabaseDoubleListCommands) {
@@ -2137,11 +2131,8 @@ BOOST_AUTO_TEST_CASE(DatabaseDoubleListCommands) {
     
     BOOST_CHECK_EQUAL(db.executeCommand("LSIZE dlist1"), "SIZE: 3");
     
-    boost::test_tools::output_test_stream output;
-    auto old_cout = cout.rdbuf(output.rdbuf());
-    db.executeCommand("LPRINT_BACKWARD dlist1");
-    cout.rdbuf(old_cout);
-    BOOST_CHECK(output.str().find("SUCCESS") != string::npos);
+    string output = db.executeCommand("LPRINT_BACKWARD dlist1");
+    BOOST_CHECK(output.find("SUCCESS") != string::npos);
 }
 
 BOOST_AUTO_TEST_CASE(DatabaseStackCommands) {
@@ -2160,11 +2151,8 @@ BOOST_AUTO_TEST_CASE(DatabaseStackCommands) {
     BOOST_CHECK_EQUAL(db.executeCommand("SPOP stack1"), "POPPED: second");
     BOOST_CHECK_EQUAL(db.executeCommand("SSIZE stack1"), "SIZE: 1");
     
-    boost::test_tools::output_test_stream output;
-    auto old_cout = cout.rdbuf(output.rdbuf());
-    db.executeCommand("PRINT stack1");
-    cout.rdbuf(old_cout);
-    BOOST_CHECK(output.str().find("SUCCESS") != string::npos);
+    string output = db.executeCommand("PRINT stack1");
+    BOOST_CHECK(output.find("SUCCESS") != string::npos);
 }
 
 BOOST_AUTO_TEST_CASE(DatabaseQueueCommands) {
@@ -2205,11 +2193,8 @@ BOOST_AUTO_TEST_CASE(DatabaseTreeCommands) {
     BOOST_CHECK_EQUAL(db.executeCommand("THEIGHT tree1"), "HEIGHT: 2");
     BOOST_CHECK_EQUAL(db.executeCommand("TISFULL tree1"), "IS_FULL: YES");
     
-    boost::test_tools::output_test_stream output;
-    auto old_cout = cout.rdbuf(output.rdbuf());
-    db.executeCommand("TTRAVERSE tree1 INORDER");
-    cout.rdbuf(old_cout);
-    BOOST_CHECK(output.str().find("SUCCESS") != string::npos);
+    string output = db.executeCommand("TTRAVERSE tree1 INORDER");
+    BOOST_CHECK(output.find("SUCCESS") != string::npos);
 }
 
 BOOST_AUTO_TEST_CASE(DatabaseHashTableCommands) {
@@ -1,5 +1,9 @@
 #define CATCH_CONFIG_MAIN
+#if __has_include(<catch2/catch_all.hpp>)
 #include <catch2/catch_all.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
 #include <sstream>
 #include "Array.h"
 #include "SingleList.h"
@@ -658,12 +662,8 @@ TEST_CASE("Database - Basic operations", "[database]") {
         db.executeCommand("MCREATE testarray");
         db.executeCommand("MPUSH testarray hello");
         
-        std::stringstream ss;
-        auto old_buf = std::cout.rdbuf(ss.rdbuf());
-        db.executeCommand("PRINT testarray");
-        std::cout.rdbuf(old_buf);
-        
-        REQUIRE(ss.str().find("hello") != string::npos);
+        string output = db.executeCommand("PRINT testarray");
+        REQUIRE(output.find("hello") != string::npos);
     }
     
     SECTION("List command") {
@@ -770,17 +770,8 @@ TEST_CASE("Integration - All data structures work together", "[integration]") {
         REQUIRE(db.hasHashTable("hash"));
         
         // Test PRINT command for each
-        std::stringstream ss;
-        auto old_buf = std::cout.rdbuf(ss.rdbuf());
-        
-        db.executeCommand("PRINT arr");
-        REQUIRE(ss.str().find("element") != string::npos);
-        ss.str("");
-        
-        db.executeCommand("PRINT hash");
-        REQUIRE(ss.str().find("value") != string::npos);
-        
-        std::cout.rdbuf(old_buf);
+        REQUIRE(db.executeCommand("PRINT arr").find("element") != string::npos);
+        REQUIRE(db.executeCommand("PRINT hash").find("value") != string::npos);
     }
     
     SECTION("Complex scenario") {
@@ -3,14 +3,24 @@
 #include <thread>
 #include <random>
 #include <filesystem>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
 #include "Array.h"
 #include "SingleList.h"
 #include "DoubleList.h"
+#include "UnrolledList.h"
 #include "Stack.h"
 #include "Queue.h"
 #include "FullBinaryTree.h"
 #include "HashTable.h"
 #include "DB.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
+#include "Server.h"
+#include "ShardedDatabase.h"
+#include "Stats.h"
 
 using namespace std;
 namespace fs = filesystem;
@@ -183,6 +193,317 @@ TEST(ArrayTest, ToVector) {
     EXPECT_TRUE(emptyVec.empty());
 }
 
+TEST(ArrayTest, MovesInsteadOfCopying) {
+    Array arr(1);
+    string long_value(64, 'x');
+    const char* buffer = long_value.data();
+    arr.push_back(move(long_value));
+    EXPECT_EQ(arr.view(0).data(), buffer);
+
+    // Рост и вставка перемещают строки: буфер элемента не меняется
+    for (int i = 0; i < 100; ++i) {
+        arr.push_back("item" + to_string(i));
+    }
+    EXPECT_TRUE(arr.insert(0, "front"));
+    EXPECT_EQ(arr.view(1).data(), buffer);
+    EXPECT_EQ(arr.length(), 102);
+
+    EXPECT_TRUE(arr.remove(0));
+    EXPECT_EQ(arr.view(0).data(), buffer);
+    EXPECT_EQ(arr.view(1000), "");
+
+    Array moved(move(arr));
+    EXPECT_EQ(moved.view(0).data(), buffer);
+    EXPECT_EQ(arr.length(), 0);
+}
+
+TEST(ArrayTest, EmplaceAndReserve) {
+    Array arr(0);
+    arr.reserve(4);
+    string_view text = "abcdef";
+    arr.emplace_back(3, 'z');
+    arr.push_back(text.substr(0, 3));
+    arr.emplace_back("assigned");
+    EXPECT_EQ(arr.get(0), "zzz");
+    EXPECT_EQ(arr.get(1), "abc");
+    EXPECT_EQ(arr.get(2), "assigned");
+
+    // Значение из самого массива при росте не теряется
+    arr.push_back(arr.view(0));
+    arr.push_back(arr.view(1));
+    EXPECT_EQ(arr.get(4), "abc");
+    EXPECT_TRUE(arr.replace(0, arr.view(2)));
+    EXPECT_EQ(arr.get(0), "assigned");
+
+    // Исключение конструктора не оставляет в массиве неинициализированную ячейку
+    EXPECT_THROW(arr.emplace_back(string::npos, 'x'), length_error);
+    EXPECT_EQ(arr.length(), 5);
+    EXPECT_EQ(arr.to_vector().back(), "abc");
+}
+
+TEST(ArrayTest, ArenaStorageBehavesLikeStrings) {
+    Array strings;
+    Array packed;
+    packed.set_storage(ArrayStorage::ARENA);
+    Array chunked;
+    chunked.set_storage(ArrayStorage::CHUNKED);
+    for (Array* arr : {&strings, &packed, &chunked}) {
+        for (int i = 0; i < 20; ++i) {
+            arr->push_back("value_" + to_string(i));
+        }
+        arr->insert(0, "first");
+        arr->insert(10, string(40, 'm'));
+        arr->remove(5);
+        arr->replace(3, "replaced with a longer value");
+        arr->replace(4, "");
+        arr->push_back(arr->view(0));
+    }
+    EXPECT_EQ(packed.get_storage(), ArrayStorage::ARENA);
+    EXPECT_EQ(packed.to_vector(), strings.to_vector());
+    EXPECT_EQ(packed.view(21), "first");
+    EXPECT_EQ(packed.view(100), "");
+    EXPECT_EQ(chunked.get_storage(), ArrayStorage::CHUNKED);
+    EXPECT_EQ(chunked.to_vector(), strings.to_vector());
+
+    // Формат сериализации общий для обоих режимов
+    string bytes;
+    {
+        BufferSink sink(bytes);
+        ByteWriter out(sink);
+        packed.serialize_binary(out);
+    }
+    Array loaded;
+    ByteReader in(bytes);
+    ASSERT_TRUE(loaded.deserialize_binary(in));
+    EXPECT_EQ(loaded.to_vector(), strings.to_vector());
+
+    loaded.set_storage(ArrayStorage::ARENA);
+    Array copy(loaded);
+    copy.set_storage(ArrayStorage::STRINGS);
+    EXPECT_EQ(copy.to_vector(), strings.to_vector());
+    EXPECT_EQ(loaded.memory_usage().payload, strings.memory_usage().payload);
+
+    loaded.set_storage(ArrayStorage::CHUNKED);
+    EXPECT_EQ(loaded.to_vector(), strings.to_vector());
+    EXPECT_EQ(loaded.memory_usage().payload, strings.memory_usage().payload);
+}
+
+TEST(ArrayTest, ChunkedStorageMatchesVector) {
+    Array arr;
+    arr.set_storage(ArrayStorage::CHUNKED);
+    vector<string> expected;
+
+    // Вставки в начало, середину и конец делят блоки, удаления сливают их
+    unsigned seed = 12345;
+    auto next = [&seed](size_t bound) {
+        seed = seed * 1103515245 + 12345;
+        return static_cast<size_t>((seed >> 8) % bound);
+    };
+    for (int step = 0; step < 6000; ++step) {
+        size_t action = next(10);
+        if (action < 6 || expected.empty()) {
+            size_t index = action < 2 ? 0 : next(expected.size() + 1);
+            string value = "v" + to_string(step);
+            ASSERT_TRUE(arr.insert(static_cast<int>(index), value));
+            expected.insert(expected.begin() + index, value);
+        } else if (action < 9) {
+            size_t index = next(expected.size());
+            ASSERT_TRUE(arr.remove(static_cast<int>(index)));
+            expected.erase(expected.begin() + index);
+        } else {
+            size_t index = next(expected.size());
+            ASSERT_TRUE(arr.replace(static_cast<int>(index), "r" + to_string(step)));
+            expected[index] = "r" + to_string(step);
+        }
+        ASSERT_EQ(arr.length(), static_cast<int>(expected.size()));
+        if (!expected.empty()) {
+            size_t probe = next(expected.size());
+            ASSERT_EQ(arr.view(static_cast<int>(probe)), expected[probe]);
+        }
+    }
+    EXPECT_EQ(arr.to_vector(), expected);
+
+    // Обход с конца и копия видят те же значения
+    for (int i = arr.length() - 1; i >= 0; --i) {
+        ASSERT_EQ(arr.view(i), expected[i]);
+    }
+    Array copy(arr);
+    Array moved(move(arr));
+    EXPECT_EQ(copy.to_vector(), expected);
+    EXPECT_EQ(moved.to_vector(), expected);
+    EXPECT_EQ(arr.length(), 0);
+
+    while (moved.length() > 0) {
+        ASSERT_TRUE(moved.remove(0));
+    }
+    EXPECT_FALSE(moved.remove(0));
+    moved.push_back("again");
+    EXPECT_EQ(moved.get(0), "again");
+}
+
+TEST(ArrayTest, ChunkedLocateAcrossManyBlocks) {
+    // Сотни блоков разной заполненности: поиск по дереву размеров блоков
+    // должен совпадать с vector после делений и слияний
+    Array arr;
+    arr.set_storage(ArrayStorage::CHUNKED);
+    vector<string> expected;
+    for (int i = 0; i < 100000; ++i) {
+        arr.push_back("p" + to_string(i));
+        expected.push_back("p" + to_string(i));
+    }
+    mt19937 gen(11);
+    for (int step = 0; step < 20000; ++step) {
+        size_t index = gen() % expected.size();
+        if (step % 3 == 2) {
+            ASSERT_TRUE(arr.remove(static_cast<int>(index)));
+            expected.erase(expected.begin() + index);
+        } else {
+            ASSERT_TRUE(arr.insert(static_cast<int>(index), "i" + to_string(step)));
+            expected.insert(expected.begin() + index, "i" + to_string(step));
+        }
+    }
+    // Удаление подряд опустошает и сливает блоки в начале массива
+    for (int i = 0; i < 30000; ++i) {
+        ASSERT_TRUE(arr.remove(1000));
+    }
+    expected.erase(expected.begin() + 1000, expected.begin() + 31000);
+
+    ASSERT_EQ(arr.length(), static_cast<int>(expected.size()));
+    for (size_t i = 0; i < expected.size(); i += 7) {
+        ASSERT_EQ(arr.view(static_cast<int>(i)), expected[i]) << i;
+    }
+    EXPECT_EQ(arr.view(arr.length() - 1), expected.back());
+    EXPECT_EQ(arr.to_vector(), expected);
+}
+
+TEST(ArrayTest, FindCountFilterInEveryStorage) {
+    vector<string> values = {"apple", "pineapple", "app", "", "application", "banana", "apple", "grape"};
+    for (ArrayStorage mode : {ArrayStorage::STRINGS, ArrayStorage::ARENA, ArrayStorage::CHUNKED}) {
+        Array arr;
+        arr.set_storage(mode);
+        for (const auto& value : values) {
+            arr.push_back(value);
+        }
+        EXPECT_EQ(arr.find("apple", MatchMode::EXACT), 0);
+        EXPECT_EQ(arr.find("apple", MatchMode::EXACT, 1), 6);
+        EXPECT_EQ(arr.find("apple", MatchMode::EXACT, 7), -1);
+        EXPECT_EQ(arr.find("", MatchMode::EXACT), 3);
+        EXPECT_EQ(arr.find("pine", MatchMode::PREFIX), 1);
+        EXPECT_EQ(arr.count_matches("app", MatchMode::PREFIX), 4);
+        EXPECT_EQ(arr.count_matches("app", MatchMode::EXACT), 1);
+        EXPECT_EQ(arr.count_matches("", MatchMode::SUBSTRING), 8);
+        // Вхождение через границу соседних значений не считается
+        EXPECT_EQ(arr.count_matches("ppleapp", MatchMode::SUBSTRING), 0);
+        EXPECT_EQ(arr.count_matches("ana", MatchMode::SUBSTRING), 1);
+        EXPECT_EQ(arr.filter("apple", MatchMode::SUBSTRING), (vector<int>{0, 1, 6}));
+        EXPECT_EQ(arr.filter("apple", MatchMode::SUBSTRING, 2), (vector<int>{0, 1}));
+        EXPECT_TRUE(arr.filter("kiwi", MatchMode::SUBSTRING).empty());
+    }
+}
+
+TEST(ArrayTest, ParallelFilterKeepsOrder) {
+    Array arr;
+    for (int i = 0; i < 100000; ++i) {
+        arr.push_back("key_" + to_string(i) + (i % 7 == 0 ? "_hit_long_enough_for_simd" : "_miss"));
+    }
+    vector<int> expected;
+    for (int i = 0; i < 100000; i += 7) {
+        expected.push_back(i);
+    }
+    for (ArrayStorage mode : {ArrayStorage::STRINGS, ArrayStorage::ARENA, ArrayStorage::CHUNKED}) {
+        arr.set_storage(mode);
+        EXPECT_EQ(arr.count_matches("_hit_", MatchMode::SUBSTRING, 4), static_cast<int>(expected.size()));
+        EXPECT_EQ(arr.filter("_hit_", MatchMode::SUBSTRING, SIZE_MAX, 4), expected);
+        EXPECT_EQ(arr.filter("_hit_", MatchMode::SUBSTRING, 3, 4), (vector<int>{0, 7, 14}));
+        EXPECT_EQ(arr.count_matches("key_9", MatchMode::PREFIX, 3), 11111);
+    }
+}
+
+TEST(ArrayTest, ChunkedConcurrentReads) {
+    // Константные методы CHUNKED вызываются из разных потоков, как под
+    // общей блокировкой контейнера, и должны видеть одни и те же значения
+    Array arr;
+    arr.set_storage(ArrayStorage::CHUNKED);
+    for (int i = 0; i < 20000; ++i) {
+        arr.push_back("v" + to_string(i));
+    }
+    for (int i = 0; i < 3000; ++i) {
+        arr.insert((i * 7919) % arr.length(), "m" + to_string(i));
+    }
+    vector<string> expected = arr.to_vector();
+
+    const Array& shared = arr;
+    atomic<int> mismatches{0};
+    vector<thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&shared, &expected, &mismatches, t] {
+            mt19937 gen(t);
+            for (int step = 0; step < 20000; ++step) {
+                // Соседние и случайные обращения вперемешку
+                int index = step % 2 == 0 ? static_cast<int>(gen() % expected.size())
+                                          : (t * 5000 + step) % static_cast<int>(expected.size());
+                if (shared.view(index) != expected[index] || shared.get(index) != expected[index]) {
+                    mismatches++;
+                }
+            }
+            if (shared.find("m2999", MatchMode::EXACT) < 0) {
+                mismatches++;
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+TEST(ArrayTest, SortMatchesStdSort) {
+    // Повторы, общие префиксы, пустые строки и байты старше 0x7F
+    mt19937 gen(3);
+    vector<string> values;
+    for (int i = 0; i < 70000; ++i) {
+        string value = i % 3 == 0 ? "user_" : "";
+        size_t length = gen() % 6;
+        for (size_t j = 0; j < length; ++j) {
+            value += static_cast<char>(j == 0 && i % 5 == 0 ? 0xE0 + gen() % 4 : 'a' + gen() % 3);
+        }
+        values.push_back(value);
+    }
+    vector<int> expected_order(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        expected_order[i] = static_cast<int>(i);
+    }
+    stable_sort(expected_order.begin(), expected_order.end(),
+                [&values](int a, int b) { return values[a] < values[b]; });
+    vector<string> expected = values;
+    sort(expected.begin(), expected.end());
+
+    for (ArrayStorage mode : {ArrayStorage::STRINGS, ArrayStorage::ARENA, ArrayStorage::CHUNKED}) {
+        for (size_t threads : {size_t(1), size_t(3)}) {
+            Array arr;
+            arr.set_storage(mode);
+            for (const auto& value : values) {
+                arr.push_back(value);
+            }
+            EXPECT_EQ(arr.sorted_order(true, threads), expected_order);
+            vector<int> order = arr.sorted_order(false, threads);
+            for (size_t i = 0; i < order.size(); ++i) {
+                ASSERT_EQ(arr.view(order[i]), expected[i]);
+            }
+            arr.sort(threads);
+            EXPECT_EQ(arr.to_vector(), expected);
+        }
+    }
+
+    Array small;
+    small.sort();
+    EXPECT_TRUE(small.sorted_order(true).empty());
+    small.push_back("b");
+    small.push_back("a");
+    small.push_back("b");
+    EXPECT_EQ(small.sorted_order(true), (vector<int>{1, 0, 2}));
+}
+
 TEST(ArrayTest, SerializationBinary) {
     Array arr;
     arr.push_back("Hello");
@@ -594,6 +915,375 @@ TEST(DoubleListTest, Serialization) {
     fs::remove("test_dlist.txt");
 }
 
+TEST(DoubleListTest, NodePoolReusesAndPacksNodes) {
+    // Узлы, добавленные подряд, лежат подряд в блоке пула
+    DoubleList list;
+    for (int i = 0; i < 4; ++i) {
+        list.push_back("v" + to_string(i));
+    }
+    DNode* first = list.find_first();
+    DNode* second = list.find_next(first);
+    EXPECT_EQ(reinterpret_cast<char*>(second) - reinterpret_cast<char*>(first), static_cast<ptrdiff_t>(sizeof(DNode)));
+
+    // Освобожденный узел выдается снова, память при чередовании не растет
+    size_t before = list.memory_usage().bytes;
+    for (int i = 0; i < 1000; ++i) {
+        list.push_back("churn");
+        list.pop_front();
+    }
+    EXPECT_EQ(list.memory_usage().bytes, before);
+    EXPECT_EQ(list.get_size(), 4);
+
+    SingleList copy_source;
+    for (int i = 0; i < 100; ++i) {
+        copy_source.push_front(to_string(i));
+    }
+    SingleList copy(copy_source);
+    EXPECT_EQ(copy.get_size(), 100);
+    EXPECT_EQ(copy.find_first()->data, "99");
+    copy = SingleList();
+    EXPECT_EQ(copy.get_size(), 0);
+    EXPECT_EQ(copy.memory_usage().bytes, sizeof(SingleList));
+}
+
+template <typename List>
+static vector<string> listValues(const List& list) {
+    vector<string> values;
+    for (auto node = list.find_first(); node != nullptr; node = list.find_next(node)) {
+        values.push_back(node->data);
+    }
+    return values;
+}
+
+// Номер узла от головы; -1 — узла нет
+template <typename List, typename Node>
+static int nodePosition(const List& list, Node target) {
+    int position = 0;
+    for (auto node = list.find_first(); node != nullptr; node = list.find_next(node), ++position) {
+        if (node == target) {
+            return position;
+        }
+    }
+    return -1;
+}
+
+// Список с индексом значений дает те же ответы, что и без него, и находит то
+// же (первое) из повторяющихся значений
+template <typename List>
+static void checkValueIndexMatchesScan() {
+    List plain;
+    List indexed;
+    indexed.set_value_index(true);
+    EXPECT_TRUE(indexed.has_value_index());
+
+    mt19937 rng(23);
+    for (int step = 0; step < 4000; ++step) {
+        if (step == 2000) {
+            // Индекс, построенный по готовому списку
+            indexed.set_value_index(false);
+            indexed.set_value_index(true);
+        }
+        string target = "v" + to_string(rng() % 12);
+        string value = "v" + to_string(rng() % 12);
+        bool expected = true;
+        bool actual = true;
+        switch (rng() % 9) {
+            case 0: plain.push_front(value); indexed.push_front(value); break;
+            case 1: plain.push_back(value); indexed.push_back(value); break;
+            case 2:
+                expected = plain.insert_before(target, value);
+                actual = indexed.insert_before(target, value);
+                break;
+            case 3:
+            case 4:
+                // Вставки подряд после одного узла исчерпывают промежуток меток
+                expected = plain.insert_after(target, value);
+                actual = indexed.insert_after(target, value);
+                break;
+            case 5:
+                expected = plain.remove_before(target);
+                actual = indexed.remove_before(target);
+                break;
+            case 6:
+                expected = plain.remove_after(target);
+                actual = indexed.remove_after(target);
+                break;
+            case 7:
+                expected = plain.remove_value(target);
+                actual = indexed.remove_value(target);
+                break;
+            default:
+                if (rng() % 2) {
+                    expected = plain.pop_back();
+                    actual = indexed.pop_back();
+                } else {
+                    expected = plain.pop_front();
+                    actual = indexed.pop_front();
+                }
+                break;
+        }
+        ASSERT_EQ(actual, expected) << "step " << step;
+        ASSERT_EQ(listValues(indexed), listValues(plain)) << "step " << step;
+        ASSERT_EQ(nodePosition(indexed, indexed.find(target)), nodePosition(plain, plain.find(target)))
+            << "step " << step;
+    }
+
+    // Сотни вставок в одно место: метки между соседями раздаются заново
+    plain.push_front("anchor");
+    indexed.push_front("anchor");
+    for (int i = 0; i < 300; ++i) {
+        string value = "v" + to_string(i % 7);
+        EXPECT_TRUE(plain.insert_after("anchor", value));
+        EXPECT_TRUE(indexed.insert_after("anchor", value));
+        EXPECT_TRUE(plain.insert_before("v3", value));
+        EXPECT_TRUE(indexed.insert_before("v3", value));
+    }
+    EXPECT_EQ(listValues(indexed), listValues(plain));
+    for (int i = 0; i < 7; ++i) {
+        string value = "v" + to_string(i);
+        EXPECT_EQ(nodePosition(indexed, indexed.find(value)), nodePosition(plain, plain.find(value)));
+        EXPECT_EQ(indexed.remove_value(value), plain.remove_value(value));
+        EXPECT_EQ(nodePosition(indexed, indexed.find(value)), nodePosition(plain, plain.find(value)));
+    }
+}
+
+TEST(DoubleListTest, ValueIndexMatchesLinearScan) {
+    checkValueIndexMatchesScan<SingleList>();
+    checkValueIndexMatchesScan<DoubleList>();
+}
+
+TEST(DoubleListTest, ValueIndexMemoryAndToggle) {
+    SingleList list;
+    for (int i = 0; i < 1000; ++i) {
+        list.push_back("value_" + to_string(i % 100));
+    }
+    MemoryUsage plain = list.memory_usage();
+    EXPECT_EQ(list.index_memory_usage().bytes, 0u);
+
+    // Накладные расходы индекса видны в memory_usage и отдельно
+    list.set_value_index(true);
+    MemoryUsage index = list.index_memory_usage();
+    EXPECT_GE(index.bytes, 1000 * sizeof(ValueLink<SNode>));
+    EXPECT_EQ(list.memory_usage().bytes, plain.bytes + index.bytes);
+    EXPECT_EQ(list.memory_usage().payload, plain.payload);
+
+    // Копия сохраняет индекс; удаление первого вхождения переходит ко второму
+    SingleList copy(list);
+    EXPECT_TRUE(copy.has_value_index());
+    EXPECT_TRUE(copy.remove_value("value_5"));
+    EXPECT_EQ(nodePosition(copy, copy.find("value_5")), 104);
+    EXPECT_FALSE(copy.remove_before("value_0"));
+    EXPECT_TRUE(copy.remove_before("value_1"));
+    EXPECT_EQ(nodePosition(copy, copy.find("value_0")), 98);
+    EXPECT_EQ(nodePosition(copy, copy.find("value_99")), 97);
+
+    list.set_value_index(false);
+    EXPECT_FALSE(list.has_value_index());
+    EXPECT_EQ(list.memory_usage().bytes, plain.bytes);
+    EXPECT_EQ(nodePosition(list, list.find("value_42")), 42);
+
+    DoubleList doubles;
+    doubles.set_value_index(true);
+    doubles.push_back("a");
+    doubles.push_back("b");
+    doubles.push_back("a");
+    EXPECT_TRUE(doubles.remove_value("a"));
+    EXPECT_EQ(nodePosition(doubles, doubles.find("a")), 1);
+    EXPECT_TRUE(doubles.remove_before("a"));
+    EXPECT_EQ(listValues(doubles), vector<string>{"a"});
+}
+
+TEST(SingleListTest, BackwardTraversalWithoutRecursion) {
+    // Прежний рекурсивный print_backward переполнял стек на таком списке
+    SingleList list;
+    const int count = 300000;
+    for (int i = 0; i < count; ++i) {
+        list.push_back(to_string(i));
+    }
+    for (bool indexed : {false, true}) {
+        list.set_value_index(indexed);
+        int expected = count;
+        bool ordered = true;
+        list.for_each_backward([&](const string& value) { ordered = ordered && value == to_string(--expected); });
+        EXPECT_TRUE(ordered);
+        EXPECT_EQ(expected, 0);
+    }
+
+    string text;
+    {
+        BufferSink sink(text);
+        TextWriter out(sink);
+        list.print_backward(out);
+        out.flush();
+    }
+    const string prefix = "Односвязный список в обратном порядке [300000]: 299999 <- 299998 <- ";
+    EXPECT_EQ(text.compare(0, prefix.size(), prefix), 0);
+    EXPECT_EQ(text.substr(text.size() - 7), "1 <- 0\n");
+
+    SingleList small;
+    small.push_back("a");
+    small.push_back("b");
+    small.push_back("c");
+    text.clear();
+    {
+        BufferSink sink(text);
+        TextWriter out(sink);
+        small.print_backward(out);
+        out.flush();
+    }
+    EXPECT_EQ(text, "Односвязный список в обратном порядке [3]: c <- b <- a\n");
+
+    // Прямые итераторы: range-for и алгоритмы STL
+    vector<string> values(small.begin(), small.end());
+    EXPECT_EQ(values, (vector<string>{"a", "b", "c"}));
+    EXPECT_EQ(*find(small.begin(), small.end(), "b"), "b");
+    EXPECT_EQ(distance(SingleList().begin(), SingleList().end()), 0);
+}
+
+TEST(DoubleListTest, BidirectionalIterators) {
+    DoubleList list;
+    for (string value : {"a", "b", "c", "d"}) {
+        list.push_back(value);
+    }
+    EXPECT_EQ(distance(list.begin(), list.end()), 4);
+    EXPECT_EQ(vector<string>(list.rbegin(), list.rend()), (vector<string>{"d", "c", "b", "a"}));
+
+    auto it = list.end();
+    EXPECT_EQ(*--it, "d");
+    EXPECT_EQ(*--it, "c");
+    EXPECT_EQ(*it++, "c");
+    EXPECT_EQ(it->size(), 1u);
+    EXPECT_EQ(*it, "d");
+    EXPECT_EQ(++it, list.end());
+
+    size_t total = 0;
+    for (const string& value : list) {
+        total += value.size();
+    }
+    EXPECT_EQ(total, 4u);
+
+    DoubleList empty;
+    EXPECT_EQ(empty.begin(), empty.end());
+    EXPECT_EQ(empty.rbegin(), empty.rend());
+}
+
+// ==================== UnrolledList Tests ====================
+
+TEST(UnrolledListTest, MatchesDoubleList) {
+    DoubleList reference;
+    UnrolledList list;
+
+    // Вставки в середину делят блоки, удаления сливают их обратно
+    mt19937 rng(24);
+    for (int step = 0; step < 6000; ++step) {
+        string target = "v" + to_string(rng() % 50);
+        string value = "v" + to_string(rng() % 50);
+        bool expected = true;
+        bool actual = true;
+        switch (rng() % 10) {
+            case 0: reference.push_front(value); list.push_front(value); break;
+            case 1:
+            case 2: reference.push_back(value); list.push_back(value); break;
+            case 3:
+                expected = reference.insert_before(target, value);
+                actual = list.insert_before(target, value);
+                break;
+            case 4:
+            case 5:
+                expected = reference.insert_after(target, value);
+                actual = list.insert_after(target, value);
+                break;
+            case 6:
+                expected = reference.remove_before(target);
+                actual = list.remove_before(target);
+                break;
+            case 7:
+                expected = reference.remove_after(target);
+                actual = list.remove_after(target);
+                break;
+            case 8:
+                expected = reference.remove_value(target);
+                actual = list.remove_value(target);
+                break;
+            default:
+                if (rng() % 2) {
+                    expected = reference.pop_back();
+                    actual = list.pop_back();
+                } else {
+                    expected = reference.pop_front();
+                    actual = list.pop_front();
+                }
+                break;
+        }
+        ASSERT_EQ(actual, expected) << "step " << step;
+        ASSERT_EQ(list.get_size(), reference.get_size()) << "step " << step;
+        ASSERT_EQ(nodePosition(list, list.find(target)), nodePosition(reference, reference.find(target)))
+            << "step " << step;
+        if (step % 50 == 0) {
+            ASSERT_EQ(listValues(list), listValues(reference)) << "step " << step;
+        }
+    }
+    EXPECT_EQ(listValues(list), listValues(reference));
+
+    string expected_text;
+    string actual_text;
+    {
+        BufferSink expected_sink(expected_text);
+        TextWriter expected_out(expected_sink);
+        reference.print_forward(expected_out);
+        reference.print_backward(expected_out);
+        expected_out.flush();
+        BufferSink actual_sink(actual_text);
+        TextWriter actual_out(actual_sink);
+        list.print_forward(actual_out);
+        list.print_backward(actual_out);
+        actual_out.flush();
+    }
+    EXPECT_EQ(actual_text, expected_text);
+
+    while (list.pop_front()) {
+        ASSERT_TRUE(reference.pop_front());
+    }
+    EXPECT_EQ(reference.get_size(), 0);
+    EXPECT_FALSE(list.find_first());
+}
+
+TEST(UnrolledListTest, SerializationAndMemory) {
+    UnrolledList list;
+    DoubleList reference;
+    for (int i = 0; i < 10000; ++i) {
+        list.push_back("item" + to_string(i));
+        reference.push_back("item" + to_string(i));
+    }
+    list.push_back(string(100, 'x'));
+
+    // Формат совпадает с DoubleList
+    EXPECT_TRUE(list.serialize_binary("test_ulist.bin"));
+    DoubleList restored;
+    EXPECT_TRUE(restored.deserialize_binary("test_ulist.bin"));
+    EXPECT_EQ(listValues(restored), listValues(list));
+
+    EXPECT_TRUE(list.serialize_text("test_ulist.txt"));
+    UnrolledList restored_text;
+    EXPECT_TRUE(restored_text.deserialize_text("test_ulist.txt"));
+    EXPECT_EQ(listValues(restored_text), listValues(list));
+
+    UnrolledList copy(list);
+    copy = restored_text;
+    EXPECT_EQ(copy.get_size(), 10001);
+    EXPECT_EQ(copy.find("item500")->data, "item500");
+    EXPECT_EQ(copy.find_next(copy.find("item9999"))->data, string(100, 'x'));
+
+    // Одна строка на ячейку блока вместо узла с двумя указателями на каждую
+    MemoryUsage usage = list.memory_usage();
+    EXPECT_EQ(usage.payload, 78890u + 100u);
+    reference.push_back(string(100, 'x'));
+    EXPECT_LT(usage.bytes, reference.memory_usage().bytes);
+
+    fs::remove("test_ulist.bin");
+    fs::remove("test_ulist.txt");
+}
+
 // ==================== Stack Tests ====================
 TEST(StackTest, BasicOperations) {
     Stack s;
@@ -1040,15 +1730,61 @@ TEST(DatabaseTest, ArrayCommands) {
     EXPECT_EQ(db.executeCommand("MDEL arr1 1"), "SUCCESS: Element removed at index 1");
     
     // Печать
-    testing::internal::CaptureStdout();
-    db.executeCommand("PRINT arr1");
-    string output = testing::internal::GetCapturedStdout();
+    string output = db.executeCommand("PRINT arr1");
     EXPECT_NE(output.find("массив"), string::npos);
+    EXPECT_EQ(output.substr(output.size() - 7), "SUCCESS");
     
     // Ошибки
     EXPECT_NE(db.executeCommand("MCREATE arr1").find("ERROR"), string::npos);
     EXPECT_NE(db.executeCommand("MPUSH arr2 value").find("ERROR"), string::npos);
     EXPECT_NE(db.executeCommand("MGET arr1 100").find("ERROR"), string::npos);
+
+    db.executeCommand("MCREATE fruits");
+    for (const char* value : {"apple", "pineapple", "grape", "apple"}) {
+        db.executeCommand(string("MPUSH fruits ") + value);
+    }
+    EXPECT_EQ(db.executeCommand("MFIND fruits apple"), "INDEX: 0");
+    EXPECT_EQ(db.executeCommand("MFIND fruits pine PREFIX"), "INDEX: 1");
+    EXPECT_EQ(db.executeCommand("MFIND fruits kiwi"), "NOT_FOUND");
+    EXPECT_EQ(db.executeCommand("MCOUNT fruits apple"), "COUNT: 2");
+    EXPECT_EQ(db.executeCommand("MCOUNT fruits ap substr"), "COUNT: 4");
+    EXPECT_EQ(db.executeCommand("MFILTER fruits apple SUBSTR"),
+              "[0] apple\n[1] pineapple\n[3] apple\nMATCHES: 3");
+    EXPECT_EQ(db.executeCommand("MFILTER fruits apple LIMIT 1"), "[0] apple\nMATCHES: 1");
+    EXPECT_NE(db.executeCommand("MCOUNT fruits apple FUZZY").find("ERROR"), string::npos);
+    EXPECT_NE(db.executeCommand("MFILTER fruits apple LIMIT").find("ERROR"), string::npos);
+
+    EXPECT_EQ(db.executeCommand("MSORTED fruits STABLE"), "ORDER: 0 3 2 1");
+    EXPECT_NE(db.executeCommand("MSORTED fruits FAST").find("ERROR"), string::npos);
+    EXPECT_EQ(db.executeCommand("MSORT fruits"), "SUCCESS: Array sorted");
+    EXPECT_EQ(db.executeCommand("MGET fruits 2"), "VALUE: grape");
+    EXPECT_EQ(db.executeCommand("MGET fruits 3"), "VALUE: pineapple");
+}
+
+TEST(DatabaseTest, SortLongSharedPrefixes) {
+    // "a", "aa", "aaa", ...: на каждом байте от корзины отделяется одно
+    // значение, глубина сортировки равна длине самого длинного
+    Database db;
+    db.executeCommand("MCREATE nested");
+    const int count = 3000;
+    for (int i = 0; i < count; ++i) {
+        db.executeCommand("MPUSH nested " + string(count - i, 'a'));
+    }
+    db.executeCommand("MPUSH nested aaa");
+
+    string expected = "ORDER:";
+    for (int i = count - 1; i >= 0; --i) {
+        expected += " " + to_string(i);
+        if (i == count - 3) {
+            expected += " " + to_string(count);
+        }
+    }
+    EXPECT_EQ(db.executeCommand("MSORTED nested STABLE"), expected);
+
+    EXPECT_EQ(db.executeCommand("MSORT nested"), "SUCCESS: Array sorted");
+    EXPECT_EQ(db.executeCommand("MGET nested 0"), "VALUE: a");
+    EXPECT_EQ(db.executeCommand("MGET nested 3"), "VALUE: aaa");
+    EXPECT_EQ(db.executeCommand("MGET nested " + to_string(count)), "VALUE: " + string(count, 'a'));
 }
 
 TEST(DatabaseTest, SingleListCommands) {
@@ -1082,11 +1818,9 @@ TEST(DatabaseTest, SingleListCommands) {
     EXPECT_EQ(db.executeCommand("FDEL list1 AFTER afterfront"), "ERROR: Cannot remove after target");
     
     // Печать назад
-    testing::internal::CaptureStdout();
-    db.executeCommand("FPRINT_BACKWARD list1");
-    string output = testing::internal::GetCapturedStdout();
-    EXPECT_TRUE(output.find("SUCCESS") != string::npos || 
-                output.find("список") != string::npos);
+    string output = db.executeCommand("FPRINT_BACKWARD list1");
+    EXPECT_NE(output.find("SUCCESS"), string::npos);
+    EXPECT_NE(output.find("список"), string::npos);
 }
 
 TEST(DatabaseTest, DoubleListCommands) {
@@ -1101,10 +1835,19 @@ TEST(DatabaseTest, DoubleListCommands) {
     
     EXPECT_EQ(db.executeCommand("LSIZE dlist1"), "SIZE: 3");
     
-    testing::internal::CaptureStdout();
-    db.executeCommand("PRINT dlist1");
-    string output = testing::internal::GetCapturedStdout();
+    string output = db.executeCommand("PRINT dlist1");
     EXPECT_NE(output.find("Двусвязный список"), string::npos);
+
+    // Индекс значений не меняет ответов команд
+    EXPECT_EQ(db.executeCommand("LINDEX dlist1 ON"), "SUCCESS: Value index enabled");
+    EXPECT_EQ(db.executeCommand("LPUSH dlist1 AFTER A A2"), "SUCCESS: Value inserted after target");
+    EXPECT_EQ(db.executeCommand("LDEL dlist1 BEFORE B"), "SUCCESS: Element before target removed");
+    EXPECT_EQ(db.executeCommand("LGET dlist1"), "LIST: A <-> B <-> C");
+    EXPECT_EQ(db.executeCommand("LINDEX dlist1 OFF"), "SUCCESS: Value index disabled");
+    EXPECT_NE(db.executeCommand("LINDEX dlist1").find("ERROR"), string::npos);
+    EXPECT_EQ(db.executeCommand("FCREATE flist"), "SUCCESS: Singly list created: flist");
+    EXPECT_EQ(db.executeCommand("FINDEX flist ON"), "SUCCESS: Value index enabled");
+    EXPECT_EQ(db.executeCommand("FINDEX missing ON"), "ERROR: Singly list not found: missing");
 }
 
 TEST(DatabaseTest, StackCommands) {
@@ -1120,9 +1863,7 @@ TEST(DatabaseTest, StackCommands) {
     EXPECT_EQ(db.executeCommand("SPOP stack1"), "POPPED: second");
     EXPECT_EQ(db.executeCommand("SSIZE stack1"), "SIZE: 1");
     
-    testing::internal::CaptureStdout();
-    db.executeCommand("PRINT stack1");
-    string output = testing::internal::GetCapturedStdout();
+    string output = db.executeCommand("PRINT stack1");
     EXPECT_NE(output.find("Стопка"), string::npos);
 }
 
@@ -1157,11 +1898,9 @@ TEST(DatabaseTest, TreeCommands) {
     EXPECT_EQ(db.executeCommand("THEIGHT tree1"), "HEIGHT: 2");
     EXPECT_EQ(db.executeCommand("TISFULL tree1"), "IS_FULL: YES");
     
-    testing::internal::CaptureStdout();
-    db.executeCommand("TTRAVERSE tree1 INORDER");
-    string output = testing::internal::GetCapturedStdout();
-    EXPECT_TRUE(output.find("SUCCESS") != string::npos || 
-                output.find("Inorder") != string::npos);
+    string output = db.executeCommand("TTRAVERSE tree1 INORDER");
+    EXPECT_NE(output.find("SUCCESS"), string::npos);
+    EXPECT_NE(output.find("Inorder"), string::npos);
 }
 
 TEST(DatabaseTest, HashTableCommands) {
@@ -1281,6 +2020,1609 @@ TEST(DatabaseTest, BoundaryConditions) {
     }
 }
 
+// ==================== Command Parsing Tests ====================
+TEST(CommandTest, TokenizerSplitsOnWhitespace) {
+    CommandTokens tokens;
+    string command = "  FPUSH\tlist1   BEFORE target  value \n";
+
+    EXPECT_EQ(tokens.tokenize(command), 5u);
+    EXPECT_EQ(tokens[0], "FPUSH");
+    EXPECT_EQ(tokens[1], "list1");
+    EXPECT_EQ(tokens[4], "value");
+    EXPECT_EQ(tokens[5], "");
+
+    EXPECT_EQ(tokens.tokenize("   "), 0u);
+    EXPECT_TRUE(tokens.empty());
+}
+
+TEST(CommandTest, TokenizerCountsTokensBeyondBuffer) {
+    CommandTokens tokens;
+    EXPECT_EQ(tokens.tokenize("a b c d e f g h i j"), 10u);
+    EXPECT_EQ(tokens[7], "h");
+    EXPECT_EQ(tokens[8], "");
+}
+
+TEST(CommandTest, OpcodeLookup) {
+    for (const CommandSpec& spec : COMMAND_SPECS) {
+        const CommandSpec* found = findCommand(spec.name);
+        ASSERT_NE(found, nullptr) << spec.name;
+        EXPECT_EQ(found->opcode, spec.opcode);
+    }
+
+    EXPECT_EQ(findCommand("mpush")->opcode, Opcode::MPUSH);
+    EXPECT_EQ(findCommand("McReAtE")->opcode, Opcode::MCREATE);
+    EXPECT_EQ(findCommand("MPUSHX"), nullptr);
+    EXPECT_EQ(findCommand("MPRINT"), nullptr);
+    EXPECT_EQ(findCommand(""), nullptr);
+}
+
+TEST(CommandTest, ParseInt) {
+    int value = 0;
+    EXPECT_TRUE(parseInt("42", value));
+    EXPECT_EQ(value, 42);
+    EXPECT_TRUE(parseInt("-7", value));
+    EXPECT_EQ(value, -7);
+    EXPECT_TRUE(parseInt("+5", value));
+    EXPECT_EQ(value, 5);
+    EXPECT_FALSE(parseInt("abc", value));
+    EXPECT_FALSE(parseInt("99999999999", value));
+}
+
+TEST(CommandTest, GeneralCommandsAreNotTakenByFamilies) {
+    Database db;
+    db.executeCommand("SCREATE s1");
+
+    // SAVE/LOAD/LIST раньше перехватывались ветками стеков и двусвязных списков
+    EXPECT_EQ(db.executeCommand("SAVE dispatch_test.txt"), "SUCCESS: Database saved to dispatch_test.txt");
+    EXPECT_EQ(db.executeCommand("LOAD dispatch_test.txt"), "SUCCESS: Database loaded from dispatch_test.txt");
+    EXPECT_NE(db.executeCommand("LIST").find("Stacks"), string::npos);
+    EXPECT_EQ(db.executeCommand("MFOO x"), "ERROR: Unknown command: MFOO");
+    EXPECT_EQ(db.executeCommand("MPUSH"), "ERROR: Array command requires container name");
+
+    fs::remove("dispatch_test.txt");
+}
+
+TEST(CommandTest, BatchExecution) {
+    Database db;
+    string output;
+
+    size_t executed = db.executeBatch("MCREATE arr\nMPUSH arr a\n\n  \nMPUSH arr b\nMSIZE arr\nMGET missing 0", output);
+    EXPECT_EQ(executed, 5u);
+    EXPECT_EQ(output,
+              "SUCCESS: Array created: arr\n"
+              "SUCCESS: Value pushed to array\n"
+              "SUCCESS: Value pushed to array\n"
+              "SIZE: 2\n"
+              "ERROR: Array not found: missing\n");
+
+    // Результаты дописываются в конец буфера, кэш контейнера сбрасывается после CLEAR
+    string_view commands[] = {"MSIZE arr", "CLEAR", "MSIZE arr"};
+    output = "prefix\n";
+    EXPECT_EQ(db.executeBatch(commands, 3, output), 3u);
+    EXPECT_EQ(output, "prefix\nSIZE: 2\nSUCCESS: Database cleared\nERROR: Array not found: arr\n");
+}
+
+// ==================== Container Index Tests ====================
+TEST(ContainerIndexTest, InsertFindErase) {
+    ContainerIndex index;
+    EXPECT_TRUE(index.insert("arr", ContainerHandle(make_unique<Array>())));
+    EXPECT_TRUE(index.insert("list", ContainerHandle(make_unique<SingleList>())));
+    EXPECT_FALSE(index.insert("arr", ContainerHandle(make_unique<Stack>())));
+    EXPECT_EQ(index.size(), 2u);
+
+    ASSERT_NE(index.find("arr"), nullptr);
+    EXPECT_EQ(index.find("arr")->type(), ContainerType::ARRAY);
+    EXPECT_NE(index.find("arr")->get<Array>(), nullptr);
+    EXPECT_EQ(index.find("arr")->get<SingleList>(), nullptr);
+
+    EXPECT_TRUE(index.rename("arr", "renamed"));
+    EXPECT_EQ(index.find("arr"), nullptr);
+    EXPECT_FALSE(index.rename("renamed", "list"));
+
+    EXPECT_TRUE(index.erase("renamed"));
+    EXPECT_FALSE(index.erase("renamed"));
+    EXPECT_EQ(index.size(), 1u);
+}
+
+TEST(ContainerIndexTest, RandomOperationsMatchStdMap) {
+    ContainerIndex index;
+    map<string, int> reference;
+    mt19937 rng(12345);
+
+    for (int step = 0; step < 20000; ++step) {
+        string name = "c" + to_string(rng() % 500);
+        switch (rng() % 3) {
+            case 0: {
+                bool inserted = index.insert(name, ContainerHandle(make_unique<Queue>()));
+                EXPECT_EQ(inserted, reference.emplace(name, 0).second);
+                break;
+            }
+            case 1:
+                EXPECT_EQ(index.erase(name), reference.erase(name) == 1);
+                break;
+            default:
+                EXPECT_EQ(index.find(name) != nullptr, reference.count(name) == 1);
+                break;
+        }
+    }
+
+    EXPECT_EQ(index.size(), reference.size());
+    size_t visited = 0;
+    for (const auto& entry : index) {
+        EXPECT_EQ(reference.count(entry.name), 1u);
+        visited++;
+    }
+    EXPECT_EQ(visited, reference.size());
+}
+
+TEST(DatabaseTest, UnifiedNamespaceCommands) {
+    Database db;
+    db.executeCommand("MCREATE shared");
+
+    // Имя занято контейнером другого типа
+    EXPECT_EQ(db.executeCommand("FCREATE shared"), "ERROR: Name already used by array: shared");
+    EXPECT_FALSE(db.hasSinglyList("shared"));
+
+    EXPECT_EQ(db.executeCommand("TYPE shared"), "TYPE: array");
+    EXPECT_EQ(db.executeCommand("EXISTS shared"), "EXISTS: YES");
+    EXPECT_EQ(db.executeCommand("EXISTS missing"), "EXISTS: NO");
+
+    db.executeCommand("MPUSH shared value");
+    EXPECT_EQ(db.executeCommand("RENAME shared moved"), "SUCCESS: Container renamed: shared -> moved");
+    EXPECT_EQ(db.executeCommand("MSIZE shared"), "ERROR: Array not found: shared");
+    EXPECT_EQ(db.executeCommand("MGET moved 0"), "VALUE: value");
+
+    db.executeCommand("SCREATE other");
+    EXPECT_EQ(db.executeCommand("RENAME moved other"), "ERROR: Name already in use: other");
+
+    EXPECT_EQ(db.executeCommand("DEL moved"), "SUCCESS: Container deleted: moved");
+    EXPECT_EQ(db.executeCommand("DEL moved"), "ERROR: Container not found: moved");
+    EXPECT_EQ(db.executeCommand("TYPE moved"), "ERROR: Container not found: moved");
+    EXPECT_TRUE(db.hasStack("other"));
+}
+
+// ==================== Byte Stream Tests ====================
+// Источник, отдающий по одному байту: каждое значение пересекает границу блоков
+class TrickleSource : public ByteSource {
+private:
+    string_view data;
+
+public:
+    explicit TrickleSource(string_view bytes) : data(bytes) {}
+    string_view next() override {
+        if (data.empty()) {
+            return data;
+        }
+        string_view block = data.substr(0, 1);
+        data.remove_prefix(1);
+        return block;
+    }
+};
+
+static void fillSample(Array& arr, FullBinaryTree& tree, DoubleHashTable& table) {
+    for (int i = 0; i < 100; ++i) {
+        arr.push_back("item " + to_string(i));
+    }
+    arr.push_back(string(10000, 'x'));
+    for (int i = 1; i <= 15; ++i) {
+        tree.insert(i, "node " + to_string(i));
+    }
+    table.insert("alpha", "1");
+    table.insert("beta", "2");
+    table.remove("alpha");
+}
+
+static void expectSample(const Array& arr, const FullBinaryTree& tree, const DoubleHashTable& table) {
+    ASSERT_EQ(arr.length(), 101);
+    EXPECT_EQ(arr.get(42), "item 42");
+    EXPECT_EQ(arr.get(100), string(10000, 'x'));
+    EXPECT_EQ(tree.get_size(), 15);
+    EXPECT_EQ(tree.search(15), "node 15");
+    EXPECT_TRUE(tree.is_full());
+    EXPECT_EQ(table.search("beta"), "2");
+    EXPECT_EQ(table.search("alpha"), "");
+    EXPECT_EQ(table.get_size(), 1);
+}
+
+TEST(ByteStreamTest, BufferAndSpanRoundTrip) {
+    Array arr;
+    FullBinaryTree tree;
+    DoubleHashTable table;
+    fillSample(arr, tree, table);
+
+    string buffer;
+    BufferSink sink(buffer);
+    ByteWriter out(sink);
+    arr.serialize_binary(out);
+    tree.serialize_binary(out);
+    table.serialize_binary(out);
+    ASSERT_TRUE(out.flush());
+    EXPECT_EQ(out.size(), buffer.size());
+
+    Array arr2;
+    FullBinaryTree tree2;
+    DoubleHashTable table2;
+    SpanSource source(buffer);
+    ByteReader in(source);
+    ASSERT_TRUE(arr2.deserialize_binary(in));
+    ASSERT_TRUE(tree2.deserialize_binary(in));
+    ASSERT_TRUE(table2.deserialize_binary(in));
+    EXPECT_EQ(in.remaining(), 0u);
+    expectSample(arr2, tree2, table2);
+
+    // Тот же поток, прочитанный по одному байту
+    Array arr3;
+    FullBinaryTree tree3;
+    DoubleHashTable table3;
+    TrickleSource trickle(buffer);
+    ByteReader slow(trickle);
+    ASSERT_TRUE(arr3.deserialize_binary(slow));
+    ASSERT_TRUE(tree3.deserialize_binary(slow));
+    ASSERT_TRUE(table3.deserialize_binary(slow));
+    expectSample(arr3, tree3, table3);
+}
+
+TEST(ByteStreamTest, FileAndDescriptorRoundTrip) {
+    Stack stack;
+    Queue queue;
+    SingleList slist;
+    DoubleList dlist;
+    for (int i = 0; i < 50; ++i) {
+        stack.push("s" + to_string(i));
+        queue.push("q" + to_string(i));
+        slist.push_back("f" + to_string(i));
+        dlist.push_back("l" + to_string(i));
+    }
+
+    FILE* file = tmpfile();
+    ASSERT_NE(file, nullptr);
+    {
+        FileSink sink(file);
+        ByteWriter out(sink);
+        stack.serialize_binary(out);
+        queue.serialize_binary(out);
+        ASSERT_TRUE(out.flush());
+    }
+    {
+        // Дескриптор того же файла: пишем дальше мимо буфера stdio
+        FdSink sink(fileno(file));
+        ByteWriter out(sink);
+        slist.serialize_binary(out);
+        dlist.serialize_binary(out);
+        ASSERT_TRUE(out.flush());
+    }
+
+    rewind(file);
+    Stack stack2;
+    Queue queue2;
+    {
+        FileSource source(file);
+        ByteReader in(source);
+        ASSERT_TRUE(stack2.deserialize_binary(in));
+        ASSERT_TRUE(queue2.deserialize_binary(in));
+        lseek(fileno(file), static_cast<off_t>(in.offset()), SEEK_SET);
+    }
+
+    SingleList slist2;
+    DoubleList dlist2;
+    {
+        FdSource source(fileno(file));
+        ByteReader in(source);
+        ASSERT_TRUE(slist2.deserialize_binary(in));
+        ASSERT_TRUE(dlist2.deserialize_binary(in));
+        EXPECT_EQ(in.remaining(), 0u);
+    }
+    fclose(file);
+
+    EXPECT_EQ(stack2.peek(), "s49");
+    EXPECT_EQ(stack2.get_size(), 50);
+    EXPECT_EQ(queue2.peek(), "q0");
+    EXPECT_EQ(slist2.get_size(), 50);
+    EXPECT_NE(slist2.find("f49"), nullptr);
+    EXPECT_EQ(dlist2.find_first()->data, "l0");
+}
+
+TEST(ByteStreamTest, BulkHeaderRejectsImpossibleCounts) {
+    // Заголовок обещает миллиард строк, а данных всего несколько байт
+    string buffer;
+    {
+        BufferSink sink(buffer);
+        ByteWriter out(sink);
+        out.writeBulkHeader(1000000000u, 0);
+        out.writeString("tail");
+    }
+
+    Array arr;
+    ByteReader in(buffer);
+    EXPECT_FALSE(arr.deserialize_binary(in));
+    EXPECT_FALSE(in.ok());
+
+    Stack stack;
+    ByteReader stack_in(buffer);
+    EXPECT_FALSE(stack.deserialize_binary(stack_in));
+}
+
+// ==================== Text Writer Tests ====================
+// Приемник, который считает обращения к себе
+class CountingSink : public ByteSink {
+public:
+    string data;
+    int writes = 0;
+    int flushes = 0;
+
+    bool write(const char* bytes, size_t size) override {
+        data.append(bytes, size);
+        writes++;
+        return true;
+    }
+    bool flush() override {
+        flushes++;
+        return true;
+    }
+};
+
+TEST(TextWriterTest, FormatsTextAndNumbers) {
+    string buffer;
+    BufferSink sink(buffer);
+    {
+        TextWriter out(sink);
+        out << "size: " << 42 << ", " << -7 << ' ' << size_t(18446744073709551615ULL) << '\n' << string("done");
+    }
+    EXPECT_EQ(buffer, "size: 42, -7 18446744073709551615\ndone");
+}
+
+TEST(TextWriterTest, PrintDoesNotFlushPerLine) {
+    DoubleHashTable table(5);
+    table.insert("a", "1");
+    table.insert("b", "2");
+    Array arr;
+    for (int i = 0; i < 5000; ++i) {
+        arr.push_back("value_" + to_string(i));
+    }
+
+    CountingSink sink;
+    {
+        TextWriter out(sink);
+        table.print(out);
+        arr.print(out);
+    }
+    // Десятки тысяч строк уходят в приемник крупными блоками и один раз сбрасываются
+    EXPECT_EQ(sink.flushes, 1);
+    EXPECT_LT(sink.writes, 40);
+    EXPECT_NE(sink.data.find("[0]: "), string::npos);
+    EXPECT_NE(sink.data.find("value_4999\n"), string::npos);
+
+    // Без аргументов вывод по-прежнему идет в cout
+    stringstream captured;
+    auto old_buf = cout.rdbuf(captured.rdbuf());
+    table.print();
+    cout.rdbuf(old_buf);
+    EXPECT_EQ(captured.str(), sink.data.substr(0, captured.str().size()));
+}
+
+TEST(TextWriterTest, PrintCommandsReturnOutputToCaller) {
+    Database db;
+    db.executeCommand("FCREATE fl");
+    db.executeCommand("FPUSH fl BACK a");
+    db.executeCommand("FPUSH fl BACK b");
+    db.executeCommand("TCREATE tr");
+    db.executeCommand("TINSERT tr 2 two");
+    db.executeCommand("TINSERT tr 1 one");
+    db.executeCommand("HCREATE ht");
+    db.executeCommand("HINSERT ht key value");
+
+    EXPECT_EQ(db.executeCommand("PRINT fl"), "Односвязный список [2]: a -> b\nSUCCESS");
+    EXPECT_EQ(db.executeCommand("FPRINT_BACKWARD fl"), "Односвязный список в обратном порядке [2]: b <- a\nSUCCESS");
+    EXPECT_EQ(db.executeCommand("TTRAVERSE tr INORDER"), "Inorder: 1:one 2:two \nSUCCESS");
+    EXPECT_EQ(db.executeCommand("TTRAVERSE tr SIDEWAYS"),
+              "ERROR: Invalid traverse type. Use INORDER/PREORDER/POSTORDER/LEVEL");
+    EXPECT_NE(db.executeCommand("HPRINT ht").find("key -> value"), string::npos);
+}
+
+// ==================== Snapshot Tests ====================
+TEST(SnapshotTest, RoundTripAllContainerTypes) {
+    Database db;
+    db.executeCommand("MCREATE arr");
+    db.executeCommand("MPUSH arr a0");
+    db.executeCommand("MPUSH arr a1");
+    db.executeCommand("FCREATE fl");
+    db.executeCommand("FPUSH fl BACK f0");
+    db.executeCommand("FPUSH fl BACK f1");
+    db.executeCommand("LCREATE dl");
+    db.executeCommand("LPUSH dl BACK d0");
+    db.executeCommand("SCREATE st");
+    db.executeCommand("SPUSH st bottom");
+    db.executeCommand("SPUSH st top");
+    db.executeCommand("QCREATE q");
+    db.executeCommand("QPUSH q first");
+    db.executeCommand("QPUSH q second");
+    db.executeCommand("QPOP q");
+    db.executeCommand("QPUSH q third");
+    db.executeCommand("TCREATE tr");
+    db.executeCommand("TINSERT tr 10 root");
+    db.executeCommand("TINSERT tr 5 left");
+    db.executeCommand("TINSERT tr 15 right");
+    db.executeCommand("HCREATE ht");
+    db.executeCommand("HINSERT ht k1 v1");
+    db.executeCommand("HINSERT ht k2 v2");
+    db.executeCommand("HDELETE ht k1");
+    ASSERT_TRUE(db.saveToFile("snapshot_roundtrip.bin"));
+
+    Database loaded;
+    ASSERT_TRUE(loaded.loadFromFile("snapshot_roundtrip.bin"));
+    EXPECT_EQ(loaded.executeCommand("MGET arr 1"), "VALUE: a1");
+    EXPECT_EQ(loaded.executeCommand("FGET fl f1"), "FOUND: f1");
+    EXPECT_EQ(loaded.executeCommand("LSIZE dl"), "SIZE: 1");
+    EXPECT_EQ(loaded.executeCommand("SPOP st"), "POPPED: top");
+    EXPECT_EQ(loaded.executeCommand("SPOP st"), "POPPED: bottom");
+    EXPECT_EQ(loaded.executeCommand("QPOP q"), "POPPED: second");
+    EXPECT_EQ(loaded.executeCommand("QPOP q"), "POPPED: third");
+    EXPECT_EQ(loaded.executeCommand("TSEARCH tr 15"), "FOUND: right");
+    EXPECT_EQ(loaded.getTree("tr")->get_size(), 3);
+    EXPECT_EQ(loaded.executeCommand("HSEARCH ht k2"), "FOUND: v2");
+    EXPECT_EQ(loaded.executeCommand("HSEARCH ht k1"), "NOT_FOUND");
+
+    filesystem::remove("snapshot_roundtrip.bin");
+}
+
+TEST(SnapshotTest, ValuesWithSpacesSurvive) {
+    auto arr = make_unique<Array>();
+    arr->push_back("hello world");
+    arr->push_back("");
+    arr->push_back("line\nbreak");
+    auto table = make_unique<DoubleHashTable>();
+    table->insert("key with space", "value with space");
+
+    ContainerIndex index;
+    index.insert("arr", ContainerHandle(move(arr)));
+    index.insert("ht", ContainerHandle(move(table)));
+    ASSERT_TRUE(writeSnapshotFile("snapshot_spaces.bin", index));
+
+    Database db;
+    ASSERT_TRUE(db.loadFromFile("snapshot_spaces.bin"));
+    ASSERT_TRUE(db.hasArray("arr"));
+    EXPECT_EQ(db.getArray("arr")->length(), 3);
+    EXPECT_EQ(db.getArray("arr")->get(0), "hello world");
+    EXPECT_EQ(db.getArray("arr")->get(1), "");
+    EXPECT_EQ(db.getArray("arr")->get(2), "line\nbreak");
+    EXPECT_EQ(db.getHashTable("ht")->search("key with space"), "value with space");
+
+    filesystem::remove("snapshot_spaces.bin");
+}
+
+TEST(SnapshotTest, CorruptedSnapshotIsRejected) {
+    Database db;
+    db.executeCommand("MCREATE arr");
+    db.executeCommand("MPUSH arr payload");
+    ASSERT_TRUE(db.saveToFile("snapshot_corrupt.bin"));
+
+    string bytes;
+    {
+        ifstream file("snapshot_corrupt.bin", ios::binary);
+        bytes.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
+    ASSERT_GT(bytes.size(), SNAPSHOT_HEADER_SIZE);
+
+    Database target;
+    target.executeCommand("SCREATE keep");
+
+    // Испорченный байт в данных секции ловится контрольной суммой
+    string damaged = bytes;
+    damaged[SNAPSHOT_HEADER_SIZE + 6] ^= 0x20;
+    {
+        ofstream file("snapshot_corrupt.bin", ios::binary | ios::trunc);
+        file.write(damaged.data(), damaged.size());
+    }
+    EXPECT_FALSE(target.loadFromFile("snapshot_corrupt.bin"));
+
+    // Обрезанный файл
+    {
+        ofstream file("snapshot_corrupt.bin", ios::binary | ios::trunc);
+        file.write(bytes.data(), bytes.size() - 3);
+    }
+    EXPECT_FALSE(target.loadFromFile("snapshot_corrupt.bin"));
+
+    // Неудачная загрузка не трогает текущие данные
+    EXPECT_TRUE(target.hasStack("keep"));
+    EXPECT_FALSE(target.hasArray("arr"));
+
+    filesystem::remove("snapshot_corrupt.bin");
+}
+
+TEST(SnapshotTest, ThreadPoolVisitsEveryIndexOnce) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+
+    vector<atomic<int>> visits(1000);
+    pool.parallelFor(visits.size(), [&](size_t i) { visits[i]++; });
+    for (size_t i = 0; i < visits.size(); ++i) {
+        EXPECT_EQ(visits[i].load(), 1) << i;
+    }
+
+    // Пул переиспользуется между вызовами
+    atomic<size_t> total(0);
+    pool.parallelFor(10, [&](size_t i) { total += i; });
+    EXPECT_EQ(total.load(), 45u);
+}
+
+// Много контейнеров, чтобы секции действительно разошлись по потокам
+static void fillNumberedContainer(Database& db, int i) {
+    string n = to_string(i);
+    switch (i % 4) {
+        case 0:
+            db.executeCommand("MCREATE arr" + n);
+            db.executeCommand("MPUSH arr" + n + " value" + n);
+            break;
+        case 1:
+            db.executeCommand("QCREATE q" + n);
+            db.executeCommand("QPUSH q" + n + " value" + n);
+            break;
+        case 2:
+            db.executeCommand("HCREATE ht" + n);
+            db.executeCommand("HINSERT ht" + n + " key value" + n);
+            break;
+        case 3:
+            db.executeCommand("TCREATE tr" + n);
+            db.executeCommand("TINSERT tr" + n + " " + n + " value" + n);
+            break;
+    }
+}
+
+static void fillManyContainers(Database& db, int count) {
+    for (int i = 0; i < count; ++i) {
+        fillNumberedContainer(db, i);
+    }
+}
+
+static string readWholeFile(const string& path) {
+    ifstream file(path, ios::binary);
+    return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+TEST(SnapshotTest, ParallelSaveIsDeterministic) {
+    Database db;
+    fillManyContainers(db, 300);
+    db.setSnapshotThreads(1);
+    ASSERT_TRUE(db.saveToFile("snapshot_parallel_1.bin"));
+    db.setSnapshotThreads(4);
+    ASSERT_TRUE(db.saveToFile("snapshot_parallel_4.bin"));
+
+    string serial = readWholeFile("snapshot_parallel_1.bin");
+    EXPECT_FALSE(serial.empty());
+    EXPECT_EQ(serial, readWholeFile("snapshot_parallel_4.bin"));
+
+    // Порядок создания контейнеров на файл не влияет
+    Database reversed;
+    for (int i = 299; i >= 0; --i) {
+        fillNumberedContainer(reversed, i);
+    }
+    reversed.setSnapshotThreads(4);
+    ASSERT_TRUE(reversed.saveToFile("snapshot_parallel_r.bin"));
+    EXPECT_EQ(serial, readWholeFile("snapshot_parallel_r.bin"));
+
+    Database loaded;
+    loaded.setSnapshotThreads(4);
+    ASSERT_TRUE(loaded.loadFromFile("snapshot_parallel_4.bin"));
+    EXPECT_EQ(loaded.executeCommand("MGET arr296 0"), "VALUE: value296");
+    EXPECT_EQ(loaded.executeCommand("QPEEK q1"), "PEEK: value1");
+    EXPECT_EQ(loaded.executeCommand("HSEARCH ht298 key"), "FOUND: value298");
+    EXPECT_EQ(loaded.executeCommand("TSEARCH tr299 299"), "FOUND: value299");
+
+    filesystem::remove("snapshot_parallel_1.bin");
+    filesystem::remove("snapshot_parallel_4.bin");
+    filesystem::remove("snapshot_parallel_r.bin");
+}
+
+TEST(SnapshotTest, ParallelLoadRejectsCorruptedSection) {
+    Database db;
+    fillManyContainers(db, 200);
+    db.setSnapshotThreads(4);
+    ASSERT_TRUE(db.saveToFile("snapshot_parallel_corrupt.bin"));
+
+    string bytes = readWholeFile("snapshot_parallel_corrupt.bin");
+    ContainerIndex index;
+    EXPECT_TRUE(decodeSnapshot(bytes.data(), bytes.size(), index, 4));
+    EXPECT_EQ(index.size(), 200u);
+
+    bytes[bytes.size() / 2] ^= 0x01;
+    EXPECT_FALSE(decodeSnapshot(bytes.data(), bytes.size(), index, 4));
+    EXPECT_TRUE(index.empty());
+
+    filesystem::remove("snapshot_parallel_corrupt.bin");
+}
+
+TEST(SnapshotTest, IncrementalSaveAppendsOnlyChangedSections) {
+    Database db;
+    for (int i = 0; i < 100; ++i) {
+        db.executeCommand("MCREATE arr" + to_string(i));
+        db.executeCommand("MPUSH arr" + to_string(i) + " static_value_" + to_string(i));
+    }
+    db.executeCommand("QCREATE hot");
+    ASSERT_TRUE(db.saveIncremental("snapshot_incremental.bin"));
+    uintmax_t full_size = filesystem::file_size("snapshot_incremental.bin");
+
+    db.executeCommand("QPUSH hot job1");
+    ASSERT_TRUE(db.saveIncremental("snapshot_incremental.bin"));
+    uintmax_t grown = filesystem::file_size("snapshot_incremental.bin") - full_size;
+    // Дописаны одна секция и таблица, а не все сто массивов
+    EXPECT_GT(grown, 0u);
+    EXPECT_LT(grown, full_size);
+
+    // Чтение, ошибка и переименование не требуют перезаписи секций
+    uintmax_t before = filesystem::file_size("snapshot_incremental.bin");
+    db.executeCommand("MGET arr1 0");
+    db.executeCommand("MPUSH missing value");
+    db.executeCommand("RENAME arr2 renamed");
+    ASSERT_TRUE(db.executeCommand("SAVE snapshot_incremental.bin").rfind("SUCCESS", 0) == 0);
+    uintmax_t table_only = filesystem::file_size("snapshot_incremental.bin") - before;
+    EXPECT_LE(table_only, grown);
+
+    Database loaded;
+    ASSERT_TRUE(loaded.loadFromFile("snapshot_incremental.bin"));
+    EXPECT_EQ(loaded.executeCommand("QPEEK hot"), "PEEK: job1");
+    EXPECT_EQ(loaded.executeCommand("MGET renamed 0"), "VALUE: static_value_2");
+    EXPECT_FALSE(loaded.hasArray("arr2"));
+    EXPECT_EQ(loaded.executeCommand("MGET arr99 0"), "VALUE: static_value_99");
+
+    filesystem::remove("snapshot_incremental.bin");
+}
+
+TEST(SnapshotTest, IncrementalSaveAfterLoadAndExternalRewrite) {
+    {
+        Database db;
+        fillManyContainers(db, 50);
+        ASSERT_TRUE(db.saveToFile("snapshot_incremental_load.bin"));
+    }
+
+    // После загрузки дописываются только изменения
+    Database db;
+    ASSERT_TRUE(db.loadFromFile("snapshot_incremental_load.bin"));
+    uintmax_t loaded_size = filesystem::file_size("snapshot_incremental_load.bin");
+    db.executeCommand("QPUSH q1 more");
+    db.executeCommand("DEL arr0");
+    ASSERT_TRUE(db.saveIncremental("snapshot_incremental_load.bin"));
+    EXPECT_GT(filesystem::file_size("snapshot_incremental_load.bin"), loaded_size);
+    EXPECT_LT(filesystem::file_size("snapshot_incremental_load.bin"), 2 * loaded_size);
+
+    // Файл перезаписан другой базой: дописывать нельзя, снимок пишется заново
+    {
+        Database other;
+        other.executeCommand("SCREATE foreign");
+        ASSERT_TRUE(other.saveToFile("snapshot_incremental_load.bin"));
+    }
+    db.executeCommand("QPUSH q5 extra");
+    ASSERT_TRUE(db.saveIncremental("snapshot_incremental_load.bin"));
+
+    Database check;
+    ASSERT_TRUE(check.loadFromFile("snapshot_incremental_load.bin"));
+    EXPECT_FALSE(check.hasStack("foreign"));
+    EXPECT_FALSE(check.hasArray("arr0"));
+    EXPECT_EQ(check.executeCommand("QSIZE q1"), "SIZE: 2");
+    EXPECT_EQ(check.executeCommand("QSIZE q5"), "SIZE: 2");
+    EXPECT_EQ(check.executeCommand("MGET arr4 0"), "VALUE: value4");
+
+    filesystem::remove("snapshot_incremental_load.bin");
+}
+
+TEST(SnapshotTest, IncrementalSaveReclaimsStaleSections) {
+    Database db;
+    db.executeCommand("MCREATE big");
+    for (int i = 0; i < 200; ++i) {
+        db.executeCommand("MPUSH big payload_" + to_string(i));
+    }
+    ASSERT_TRUE(db.saveIncremental("snapshot_incremental_churn.bin"));
+    uintmax_t initial = filesystem::file_size("snapshot_incremental_churn.bin");
+
+    // Постоянно меняющийся контейнер не раздувает файл без предела
+    for (int round = 0; round < 20; ++round) {
+        db.executeCommand("MREPLACE big 0 round_" + to_string(round));
+        ASSERT_TRUE(db.saveIncremental("snapshot_incremental_churn.bin"));
+        EXPECT_LE(filesystem::file_size("snapshot_incremental_churn.bin"), 2 * initial + 64);
+    }
+
+    Database loaded;
+    ASSERT_TRUE(loaded.loadFromFile("snapshot_incremental_churn.bin"));
+    EXPECT_EQ(loaded.executeCommand("MGET big 0"), "VALUE: round_19");
+    EXPECT_EQ(loaded.executeCommand("MSIZE big"), "SIZE: 200");
+
+    filesystem::remove("snapshot_incremental_churn.bin");
+}
+
+TEST(SnapshotTest, BackgroundSaveCapturesPointInTime) {
+    Database db;
+    fillManyContainers(db, 100);
+    db.executeCommand("QCREATE live");
+    db.executeCommand("QPUSH live before");
+
+    EXPECT_EQ(db.executeCommand("BGSAVE snapshot_background.bin"),
+              "SUCCESS: Background save started to snapshot_background.bin");
+    // Команды выполняются, пока идет сохранение, и в снимок не попадают
+    db.executeCommand("QPUSH live after");
+    db.executeCommand("DEL arr0");
+    EXPECT_EQ(db.executeCommand("QSIZE live"), "SIZE: 2");
+    ASSERT_TRUE(db.waitForBackgroundSave());
+    EXPECT_FALSE(db.backgroundSaveInProgress());
+
+    Database loaded;
+    ASSERT_TRUE(loaded.loadFromFile("snapshot_background.bin"));
+    EXPECT_EQ(loaded.executeCommand("QSIZE live"), "SIZE: 1");
+    EXPECT_TRUE(loaded.hasArray("arr0"));
+    EXPECT_EQ(loaded.executeCommand("HSEARCH ht98 key"), "FOUND: value98");
+
+    filesystem::remove("snapshot_background.bin");
+}
+
+TEST(SnapshotTest, BackgroundSaveReportsFailure) {
+    Database db;
+    db.executeCommand("MCREATE arr");
+    ASSERT_TRUE(db.saveInBackground("no_such_directory/snapshot.bin"));
+    EXPECT_FALSE(db.waitForBackgroundSave());
+    EXPECT_EQ(db.executeCommand("BGSAVE"), "ERROR: BGSAVE requires filename");
+}
+
+// ==================== Stats Tests ====================
+TEST(StatsTest, HistogramBucketsBoundRelativeError) {
+    for (uint64_t value : {0ull, 1ull, 7ull, 8ull, 15ull, 16ull, 1000ull, 123456789ull, 1ull << 40}) {
+        size_t bucket = LatencyHistogram::bucketOf(value);
+        uint64_t upper = LatencyHistogram::bucketUpperBound(bucket);
+        EXPECT_GE(upper, value);
+        if (value >= 8 && value < (1ull << 37)) {
+            // Ширина корзины не больше 1/8 ее нижней границы
+            EXPECT_LE(upper - value, value / 8) << value;
+        }
+        if (bucket > 0) {
+            EXPECT_LT(LatencyHistogram::bucketUpperBound(bucket - 1), value) << value;
+        }
+    }
+
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        histogram.record(value * 1000);
+    }
+    EXPECT_EQ(histogram.count(), 1000u);
+    EXPECT_EQ(histogram.max(), 1000000u);
+    EXPECT_NEAR(static_cast<double>(histogram.percentile(0.5)), 500000.0, 500000.0 / 8);
+    EXPECT_NEAR(static_cast<double>(histogram.percentile(0.99)), 990000.0, 990000.0 / 8);
+    EXPECT_EQ(histogram.percentile(1.0), 1000000u);
+}
+
+TEST(StatsTest, CountsCallsAndErrorsPerCommand) {
+    Database db;
+    db.executeCommand("MCREATE arr");
+    db.executeCommand("MPUSH arr a");
+    db.executeCommand("MPUSH arr b");
+    db.executeCommand("MPUSH missing c");
+    db.executeCommand("MPUSH");
+    db.executeCommand("BOGUS");
+
+    const CommandStats& stats = *db.commandStats();
+    EXPECT_EQ(stats[Opcode::MPUSH].calls(), 4u);
+    EXPECT_EQ(stats[Opcode::MPUSH].errors.load(), 2u);
+    EXPECT_EQ(stats[Opcode::MPUSH].latency.count(), 4u);
+    EXPECT_EQ(stats[Opcode::MCREATE].calls(), 1u);
+    EXPECT_EQ(stats[Opcode::UNKNOWN].errors.load(), 1u);
+
+    string text = db.executeCommand("STATS");
+    EXPECT_NE(text.find("MPUSH calls=4 errors=2"), string::npos);
+    EXPECT_NE(text.find("arr (array): 2 elements"), string::npos);
+
+    string json = db.executeCommand("stats json");
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+    EXPECT_NE(json.find("\"MPUSH\":{\"calls\":4,\"errors\":2"), string::npos);
+    EXPECT_NE(json.find("{\"name\":\"arr\",\"type\":\"array\",\"elements\":2"), string::npos);
+
+    string prometheus = db.executeCommand("STATS PROMETHEUS");
+    EXPECT_NE(prometheus.find("lab3_commands_total{command=\"MPUSH\"} 4\n"), string::npos);
+    EXPECT_NE(prometheus.find("lab3_command_errors_total{command=\"MPUSH\"} 2\n"), string::npos);
+    EXPECT_NE(prometheus.find("lab3_container_elements{name=\"arr\",type=\"array\"} 2\n"), string::npos);
+
+    EXPECT_NE(db.executeCommand("INFO").find("containers: 1\nelements: 2\n"), string::npos);
+    EXPECT_EQ(db.executeCommand("STATS RESET"), "SUCCESS: Statistics reset");
+    EXPECT_EQ(stats[Opcode::MPUSH].calls(), 0u);
+    EXPECT_EQ(db.executeCommand("STATS XML"), "ERROR: Unknown STATS option: XML");
+}
+
+TEST(StatsTest, DisabledStatsRecordNothing) {
+    Database db;
+    db.setStatsEnabled(false);
+    db.executeCommand("SCREATE s");
+    EXPECT_EQ((*db.commandStats())[Opcode::SCREATE].calls(), 0u);
+    EXPECT_TRUE(db.hasStack("s"));
+}
+
+TEST(SlowLogTest, RecordsCommandsAboveThreshold) {
+    Database db;
+    db.executeCommand("MCREATE arr");
+    EXPECT_EQ(db.executeCommand("SLOWLOG LEN"), "LEN: 0");
+
+    db.setSlowLogThreshold(0);
+    db.executeCommand("MPUSH arr a");
+    db.executeCommand("MPUSH arr b");
+    vector<SlowLogEntry> entries = db.slowLog()->entries(10);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].command, "MPUSH arr b");
+    EXPECT_EQ(entries[0].container_size, 2u);
+    EXPECT_EQ(entries[1].command, "MPUSH arr a");
+    EXPECT_GT(entries[0].id, entries[1].id);
+    EXPECT_GT(entries[0].timestamp_us, 0u);
+
+    string reply = db.executeCommand("SLOWLOG GET 1");
+    EXPECT_EQ(reply.rfind("SLOWLOG: 1 entries\n  id=", 0), 0u);
+    EXPECT_NE(reply.find("size=2 command=MPUSH arr b"), string::npos);
+
+    EXPECT_EQ(db.executeCommand("SLOWLOG THRESHOLD OFF"), "SUCCESS: Slow log disabled");
+    EXPECT_EQ(db.executeCommand("SLOWLOG RESET"), "SUCCESS: Slow log reset");
+    db.executeCommand("MPUSH arr c");
+    EXPECT_EQ(db.executeCommand("SLOWLOG LEN"), "LEN: 0");
+    EXPECT_EQ(db.executeCommand("SLOWLOG THRESHOLD"), "THRESHOLD: off");
+    EXPECT_EQ(db.executeCommand("SLOWLOG THRESHOLD 500"), "SUCCESS: Slow log threshold set to 500us");
+    EXPECT_EQ(db.slowLog()->threshold(), 500u);
+    EXPECT_EQ(db.executeCommand("SLOWLOG THRESHOLD -5"), "ERROR: Invalid threshold format");
+    EXPECT_EQ(db.executeCommand("SLOWLOG"), "ERROR: SLOWLOG requires GET, LEN, RESET or THRESHOLD");
+}
+
+TEST(SlowLogTest, RingKeepsNewestAndTruncatesText) {
+    SlowLog log(4);
+    log.setThreshold(0);
+    for (int i = 0; i < 10; ++i) {
+        log.record("CMD " + to_string(i), 1, static_cast<size_t>(i));
+    }
+    string long_command(SlowLog::TEXT_LIMIT + 50, 'x');
+    log.record(long_command, 1, 0);
+
+    vector<SlowLogEntry> entries = log.entries(100);
+    ASSERT_EQ(entries.size(), 4u);
+    EXPECT_EQ(log.size(), 4u);
+    EXPECT_EQ(entries[0].command, long_command.substr(0, SlowLog::TEXT_LIMIT));
+    EXPECT_EQ(entries[0].command_length, long_command.size());
+    EXPECT_EQ(entries[1].command, "CMD 9");
+    EXPECT_EQ(entries[1].container_size, 9u);
+    EXPECT_EQ(entries[3].command, "CMD 7");
+
+    log.reset();
+    EXPECT_EQ(log.size(), 0u);
+    EXPECT_TRUE(log.entries(100).empty());
+}
+
+TEST(SlowLogTest, ConcurrentRecordingKeepsEntriesIntact) {
+    SlowLog log(16);
+    log.setThreshold(0);
+    vector<thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&log, t] {
+            string command = "THREAD " + to_string(t);
+            for (int i = 0; i < 2000; ++i) {
+                log.record(command, 1, static_cast<size_t>(t));
+            }
+        });
+    }
+    for (auto& worker : threads) {
+        worker.join();
+    }
+
+    vector<SlowLogEntry> entries = log.entries(100);
+    EXPECT_EQ(entries.size(), 16u);
+    for (const auto& entry : entries) {
+        EXPECT_EQ(entry.command, "THREAD " + to_string(entry.container_size));
+    }
+}
+
+TEST(MemoryUsageTest, CountsHeapBlocksAndStringBuffers) {
+    DoubleHashTable table;
+    MemoryUsage empty = table.memory_usage();
+    // Все ячейки — один блок new[], даже пустые
+    EXPECT_EQ(empty.heap_blocks, 1u);
+    EXPECT_EQ(empty.bytes, sizeof(DoubleHashTable) + heapBlockSize(10 * sizeof(HashEntry) + sizeof(size_t)));
+    table.insert("k", "v");
+    EXPECT_EQ(table.memory_usage().bytes, empty.bytes);
+    EXPECT_EQ(table.memory_usage().payload, 2u);
+
+    SingleList list;
+    list.push_back("a");
+    list.push_back("b");
+    list.push_back("c");
+    // Три узла в первом блоке пула на 8 узлов плюс массив из одного блока
+    MemoryUsage nodes = list.memory_usage();
+    EXPECT_EQ(nodes.heap_blocks, 2u);
+    EXPECT_EQ(nodes.bytes, sizeof(SingleList) + heapBlockSize(8 * sizeof(SNode)) +
+                               heapBlockSize(sizeof(void*) + sizeof(size_t)));
+
+    // Длинная строка в отдельном буфере; после извлечения буфер остается в ячейке
+    Queue queue;
+    string long_value(100, 'x');
+    queue.push(long_value);
+    MemoryUsage before = queue.memory_usage();
+    EXPECT_EQ(before.heap_blocks, 2u);
+    EXPECT_EQ(before.payload, 100u);
+    EXPECT_GE(before.bytes, sizeof(Queue) + heapBlockSize(101));
+    queue.pop();
+    MemoryUsage after = queue.memory_usage();
+    EXPECT_EQ(after.payload, 0u);
+    EXPECT_EQ(after.bytes, before.bytes);
+}
+
+TEST(MemoryUsageTest, MemoryCommandReportsContainerAndSummary) {
+    Database db;
+    db.executeCommand("MCREATE arr");
+    db.executeCommand("MPUSH arr first");
+    db.executeCommand("MPUSH arr second");
+    db.executeCommand("HCREATE h");
+
+    string expected = "MEMORY: " + to_string(db.getArray("arr")->memory_usage().bytes) + " bytes (payload 11,";
+    string reply = db.executeCommand("MEMORY USAGE arr");
+    EXPECT_EQ(reply.rfind(expected, 0), 0u) << reply;
+    EXPECT_NE(reply.find("elements 2)"), string::npos);
+    EXPECT_EQ(db.executeCommand("MEMORY USAGE missing"), "ERROR: Container not found: missing");
+
+    string summary = db.executeCommand("MEMORY STATS");
+    EXPECT_NE(summary.find("\n  array: 1 containers, 2 elements, "), string::npos) << summary;
+    EXPECT_NE(summary.find("\n  double hash table: 1 containers, 0 elements, "), string::npos) << summary;
+    EXPECT_NE(summary.find("\n  total: "), string::npos);
+    EXPECT_EQ(db.executeCommand("MEMORY"), "ERROR: MEMORY requires USAGE <name> or STATS");
+}
+
+// ==================== Journal Tests ====================
+static string makeJournalBase(const string& name) {
+    filesystem::path dir = filesystem::temp_directory_path() / ("lab3_journal_" + name);
+    filesystem::remove_all(dir);
+    filesystem::create_directories(dir);
+    return (dir / "db").string();
+}
+
+TEST(JournalTest, ReplayRestoresState) {
+    string base = makeJournalBase("replay");
+    {
+        Database db;
+        ASSERT_TRUE(db.openJournal(base, FsyncPolicy::ALWAYS));
+        db.executeCommand("MCREATE arr");
+        db.executeCommand("MPUSH arr first");
+        db.executeCommand("MPUSH arr second");
+        db.executeCommand("MREPLACE arr 0 replaced");
+        db.executeCommand("QCREATE q");
+        db.executeCommand("QPUSH q a");
+        db.executeCommand("QPUSH q b");
+        db.executeCommand("QPOP q");
+        db.executeCommand("MPUSH missing value");  // ошибка не попадает в журнал
+        db.executeCommand("MGET arr 0");           // чтение не попадает в журнал
+    }
+
+    size_t records = Journal::replaySegment(Journal::segmentPath(base, 1), [](string_view) {});
+    EXPECT_EQ(records, 8u);
+
+    Database restored;
+    ASSERT_TRUE(restored.openJournal(base, FsyncPolicy::ALWAYS));
+    EXPECT_EQ(restored.executeCommand("MGET arr 0"), "VALUE: replaced");
+    EXPECT_EQ(restored.executeCommand("MGET arr 1"), "VALUE: second");
+    EXPECT_EQ(restored.executeCommand("QPEEK q"), "PEEK: b");
+    EXPECT_FALSE(restored.hasArray("missing"));
+}
+
+TEST(JournalTest, TornTailIsIgnored) {
+    string base = makeJournalBase("torn");
+    {
+        Database db;
+        ASSERT_TRUE(db.openJournal(base, FsyncPolicy::NEVER));
+        db.executeCommand("SCREATE st");
+        db.executeCommand("SPUSH st 1");
+    }
+
+    // Сбой посреди записи: заголовок обещает больше данных, чем есть в файле
+    {
+        ofstream segment(Journal::segmentPath(base, 1), ios::binary | ios::app);
+        const char torn[] = {0x40, 0, 0, 0, 1, 2, 3, 4, 'S', 'P'};
+        segment.write(torn, sizeof(torn));
+    }
+
+    Database restored;
+    ASSERT_TRUE(restored.openJournal(base, FsyncPolicy::NEVER));
+    EXPECT_EQ(restored.executeCommand("SSIZE st"), "SIZE: 1");
+
+    // Новые записи идут в следующий сегмент и переживают перезапуск
+    restored.executeCommand("SPUSH st 2");
+    restored.closeJournal();
+
+    Database again;
+    ASSERT_TRUE(again.openJournal(base, FsyncPolicy::NEVER));
+    EXPECT_EQ(again.executeCommand("SPEEK st"), "PEEK: 2");
+}
+
+TEST(JournalTest, IntervalPolicyGroupsCommits) {
+    string base = makeJournalBase("interval");
+    Database db;
+    ASSERT_TRUE(db.openJournal(base, FsyncPolicy::INTERVAL, 5));
+    db.executeCommand("MCREATE arr");
+    for (int i = 0; i < 100; ++i) {
+        db.executeCommand("MPUSH arr v" + to_string(i));
+    }
+    ASSERT_TRUE(db.syncJournal());
+
+    size_t records = Journal::replaySegment(Journal::segmentPath(base, 1), [](string_view) {});
+    EXPECT_EQ(records, 101u);
+}
+
+TEST(JournalTest, CompactionFoldsSegmentsIntoSnapshot) {
+    string base = makeJournalBase("compact");
+    {
+        Database db;
+        ASSERT_TRUE(db.openJournal(base, FsyncPolicy::INTERVAL, 5));
+        db.executeCommand("MCREATE arr");
+        for (int i = 0; i < 50; ++i) {
+            db.executeCommand("MPUSH arr v" + to_string(i));
+        }
+        ASSERT_TRUE(db.compactJournal());
+
+        // Команды продолжают выполняться, пока снимок строится в фоне
+        db.executeCommand("QCREATE q");
+        db.executeCommand("QPUSH q tail");
+        db.executeCommand("MDEL arr 0");
+        db.waitForCompaction();
+
+        JournalManifest manifest;
+        ASSERT_TRUE(Journal::readManifest(base, manifest));
+        EXPECT_EQ(manifest.snapshot, Journal::snapshotPath(base, 1));
+        EXPECT_EQ(manifest.first_segment, 2u);
+        EXPECT_FALSE(filesystem::exists(Journal::segmentPath(base, 1)));
+        EXPECT_TRUE(filesystem::exists(manifest.snapshot));
+    }
+
+    Database restored;
+    ASSERT_TRUE(restored.openJournal(base, FsyncPolicy::NEVER));
+    EXPECT_EQ(restored.executeCommand("MSIZE arr"), "SIZE: 49");
+    EXPECT_EQ(restored.executeCommand("MGET arr 0"), "VALUE: v1");
+    EXPECT_EQ(restored.executeCommand("QPEEK q"), "PEEK: tail");
+}
+
+TEST(JournalTest, MoveAssignWaitsForCompaction) {
+    string base = makeJournalBase("move_assign");
+    {
+        Database db;
+        ASSERT_TRUE(db.openJournal(base, FsyncPolicy::NEVER));
+        db.executeCommand("MCREATE arr");
+        for (int i = 0; i < 20000; ++i) {
+            db.executeCommand("MPUSH arr v" + to_string(i));
+        }
+        ASSERT_TRUE(db.compactJournal());
+
+        // Старый журнал удаляется присваиванием только после того, как
+        // фоновое сжатие зафиксировало в нем снимок
+        Database replacement;
+        replacement.executeCommand("SCREATE st");
+        db = move(replacement);
+        EXPECT_TRUE(db.hasStack("st"));
+        EXPECT_FALSE(db.hasArray("arr"));
+        EXPECT_FALSE(db.hasJournal());
+    }
+
+    JournalManifest manifest;
+    ASSERT_TRUE(Journal::readManifest(base, manifest));
+    EXPECT_EQ(manifest.snapshot, Journal::snapshotPath(base, 1));
+    Database restored;
+    ASSERT_TRUE(restored.openJournal(base, FsyncPolicy::NEVER));
+    EXPECT_EQ(restored.executeCommand("MSIZE arr"), "SIZE: 20000");
+}
+
+TEST(JournalTest, WriteFailureIsReported) {
+    string base = makeJournalBase("failure");
+    Database db;
+    ASSERT_TRUE(db.openJournal(base, FsyncPolicy::ALWAYS));
+    EXPECT_EQ(db.executeCommand("MCREATE arr"), "SUCCESS: Array created: arr");
+
+    // Следующий сегмент не открыть: на его месте каталог
+    filesystem::create_directory(Journal::segmentPath(base, 2));
+    ASSERT_TRUE(db.compactJournal());
+    db.waitForCompaction();
+
+    // Изменения отклоняются и не применяются, чтение работает
+    EXPECT_EQ(db.executeCommand("MPUSH arr lost"), "ERROR: journal write failed");
+    EXPECT_EQ(db.executeCommand("MSIZE arr"), "SIZE: 0");
+    EXPECT_EQ(db.executeCommand("SCREATE st"), "ERROR: journal write failed");
+    EXPECT_FALSE(db.hasStack("st"));
+}
+
+TEST(JournalTest, FailedAppendKeepsAppliedReply) {
+    if (!filesystem::exists("/dev/full")) {
+        GTEST_SKIP() << "/dev/full is not available";
+    }
+    string base = makeJournalBase("append_failure");
+    Database db;
+    ASSERT_TRUE(db.openJournal(base, FsyncPolicy::ALWAYS));
+    EXPECT_EQ(db.executeCommand("MCREATE arr"), "SUCCESS: Array created: arr");
+
+    // Следующий сегмент открывается, но любая запись в него не удается
+    filesystem::create_symlink("/dev/full", Journal::segmentPath(base, 2));
+    ASSERT_TRUE(db.compactJournal());
+    db.waitForCompaction();
+
+    // Изменение уже применено: клиент видит успех и отдельное предупреждение,
+    // а не ошибку, после которой повтор применил бы команду дважды
+    string reply = db.executeCommand("MPUSH arr kept");
+    EXPECT_EQ(reply.compare(0, 7, "SUCCESS"), 0) << reply;
+    EXPECT_NE(reply.find("\nWARNING: journal write failed"), string::npos) << reply;
+    EXPECT_EQ(db.executeCommand("MSIZE arr"), "SIZE: 1");
+
+    // Дальше изменения отклоняются до повторного открытия журнала
+    EXPECT_EQ(db.executeCommand("MPUSH arr lost"), "ERROR: journal write failed");
+    EXPECT_EQ(db.executeCommand("MSIZE arr"), "SIZE: 1");
+}
+
+TEST(JournalTest, CorruptManifestIsRejected) {
+    string base = makeJournalBase("manifest");
+    for (const char* content : {"snapshot -\nfirst_segment 12x\n", "snapshot -\nfirst_segment\n",
+                                "snapshot -\n", "snapshot -\nfirst_segment 99999999999999999999999\n"}) {
+        {
+            ofstream manifest(Journal::manifestPath(base));
+            manifest << content;
+        }
+        JournalManifest parsed;
+        EXPECT_FALSE(Journal::readManifest(base, parsed)) << content;
+        Database db;
+        EXPECT_FALSE(db.openJournal(base, FsyncPolicy::NEVER)) << content;
+        EXPECT_FALSE(db.hasJournal());
+    }
+
+    {
+        ofstream manifest(Journal::manifestPath(base));
+        manifest << "snapshot -\nfirst_segment 3\n";
+    }
+    JournalManifest parsed;
+    ASSERT_TRUE(Journal::readManifest(base, parsed));
+    EXPECT_EQ(parsed.first_segment, 3u);
+    EXPECT_TRUE(parsed.snapshot.empty());
+}
+
+TEST(JournalTest, LoadIsRefusedWithJournal) {
+    string base = makeJournalBase("load");
+    string saved = base + ".saved";
+    {
+        Database source;
+        source.executeCommand("SCREATE st");
+        ASSERT_EQ(source.executeCommand("SAVE " + saved).compare(0, 7, "SUCCESS"), 0);
+    }
+
+    // LOAD записал бы в журнал только имя файла, а не его содержимое
+    Database db;
+    ASSERT_TRUE(db.openJournal(base, FsyncPolicy::NEVER));
+    EXPECT_EQ(db.executeCommand("LOAD " + saved), "ERROR: LOAD is not allowed while the journal is open");
+    EXPECT_FALSE(db.hasStack("st"));
+    db.closeJournal();
+    EXPECT_EQ(db.executeCommand("LOAD " + saved).compare(0, 7, "SUCCESS"), 0);
+    EXPECT_TRUE(db.hasStack("st"));
+}
+
+// ==================== Server Tests ====================
+// Сервер работает в отдельном потоке, пока тест не вызовет stop()
+struct RunningServer {
+    Database db;
+    Server server{db};
+    thread loop;
+
+    void start() { loop = thread([this] { server.run(); }); }
+    ~RunningServer() {
+        server.stop();
+        if (loop.joinable()) {
+            loop.join();
+        }
+    }
+};
+
+TEST(ServerTest, PipelinedCommandsOverUnixSocket) {
+    string path = (filesystem::temp_directory_path() / "lab3_server_test.sock").string();
+    RunningServer running;
+    ASSERT_TRUE(running.server.listenUnix(path));
+    running.start();
+
+    const vector<string> commands = {"MCREATE arr", "MPUSH arr a", "MPUSH arr b", "MGET arr 1",
+                                     "PRINT arr",   "",            "NOPE",        "MSIZE arr"};
+    string batch;
+    for (const auto& command : commands) {
+        batch += command + "\r\n";
+    }
+
+    ServerClient client;
+    ASSERT_TRUE(client.connectUnix(path));
+    ASSERT_TRUE(client.send(batch));
+
+    // Ответы приходят по порядку и совпадают с прямым вызовом executeCommand
+    Database reference;
+    string reply;
+    for (const auto& command : commands) {
+        ASSERT_TRUE(client.readReply(reply));
+        EXPECT_EQ(reply, reference.executeCommand(command)) << command;
+    }
+    EXPECT_NE(reference.executeCommand("PRINT arr").find('\n'), string::npos);
+}
+
+TEST(ServerTest, TcpClientsShareDatabaseAndSplitLines) {
+    RunningServer running;
+    ASSERT_TRUE(running.server.listenTcp(0));
+    ASSERT_NE(running.server.port(), 0);
+    running.start();
+
+    ServerClient writer;
+    ServerClient reader;
+    ASSERT_TRUE(writer.connectTcp(running.server.port()));
+    ASSERT_TRUE(reader.connectTcp(running.server.port()));
+
+    // Команда, пришедшая по частям, выполняется только после перевода строки
+    string reply;
+    ASSERT_TRUE(writer.send("QCREATE q\nQPU"));
+    ASSERT_TRUE(writer.readReply(reply));
+    EXPECT_EQ(reply.compare(0, 7, "SUCCESS"), 0);
+    ASSERT_TRUE(writer.send("SH q hello\n"));
+    ASSERT_TRUE(writer.readReply(reply));
+    EXPECT_EQ(reply.compare(0, 7, "SUCCESS"), 0);
+
+    ASSERT_TRUE(reader.send("QPEEK q\n"));
+    ASSERT_TRUE(reader.readReply(reply));
+    EXPECT_EQ(reply, "PEEK: hello");
+}
+
+TEST(ServerTest, LargePipelineIsAnsweredCompletely) {
+    string path = (filesystem::temp_directory_path() / "lab3_server_pipeline.sock").string();
+    RunningServer running;
+    ASSERT_TRUE(running.server.listenUnix(path));
+    running.start();
+
+    ServerClient client;
+    ASSERT_TRUE(client.connectUnix(path));
+    ASSERT_TRUE(client.send("SCREATE s\n"));
+    string reply;
+    ASSERT_TRUE(client.readReply(reply));
+
+    // Клиент сначала отправляет все команды и только потом читает ответы:
+    // сервер не должен блокироваться на переполненном сокете
+    const size_t count = 50000;
+    string batch;
+    for (size_t i = 0; i < count; ++i) {
+        batch += "SPUSH s " + to_string(i) + "\n";
+    }
+    batch += "SSIZE s\n";
+    thread sender([&client, &batch] { client.send(batch); });
+
+    size_t successes = 0;
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_TRUE(client.readReply(reply));
+        successes += reply.compare(0, 7, "SUCCESS") == 0 ? 1 : 0;
+    }
+    ASSERT_TRUE(client.readReply(reply));
+    sender.join();
+    EXPECT_EQ(successes, count);
+    EXPECT_NE(reply.find(to_string(count)), string::npos);
+}
+
+TEST(ServerTest, HalfClosedClientGetsEveryReply) {
+    RunningServer running;
+    ASSERT_TRUE(running.server.listenTcp(0));
+    running.start();
+
+    // Ответы на весь пакет намного больше предела выходного буфера, а клиент
+    // закрывает передачу сразу после отправки: сервер должен выполнить
+    // отложенные команды и только потом закрыть соединение. Буферы TCP на
+    // loopback растут до мегабайтов, поэтому выходной буфер уходит целиком.
+    ServerClient client;
+    ASSERT_TRUE(client.connectTcp(running.server.port()));
+    const string value(256 * 1024, 'x');
+    const size_t count = 64;
+    string batch = "MCREATE arr\nMPUSH arr " + value + "\n";
+    for (size_t i = 0; i < count; ++i) {
+        batch += "MGET arr 0\n";
+    }
+    batch += "MSIZE arr\n";
+    thread sender([&client, &batch] {
+        client.send(batch);
+        client.finishSending();
+    });
+
+    // Читаем до закрытия соединения сервером
+    vector<string> replies;
+    string reply;
+    while (client.readReply(reply)) {
+        replies.push_back(reply);
+    }
+    sender.join();
+    ASSERT_EQ(replies.size(), count + 3);
+    size_t full = 0;
+    for (size_t i = 2; i < count + 2; ++i) {
+        full += replies[i].find(value) != string::npos ? 1 : 0;
+    }
+    EXPECT_EQ(full, count);
+    EXPECT_NE(replies.back().find('1'), string::npos);
+}
+
+// ==================== Sharded Database Tests ====================
+// Два имени, попадающие в разные шарды
+static pair<string, string> namesOnDifferentShards(const ShardedDatabase& db) {
+    for (int i = 1; i < 100; ++i) {
+        string name = "name" + to_string(i);
+        if (db.shardOf(name) != db.shardOf("name0")) {
+            return {"name0", name};
+        }
+    }
+    return {"name0", "name0"};
+}
+
+TEST(ShardedDatabaseTest, BatchRepliesMatchSingleDatabase) {
+    ShardedDatabase sharded(4, false);
+    Database reference;
+
+    vector<string> owned;
+    for (int i = 0; i < 32; ++i) {
+        string queue = "q" + to_string(i);
+        owned.push_back("QCREATE " + queue);
+        owned.push_back("QPUSH " + queue + " a" + to_string(i));
+        owned.push_back("QPUSH " + queue + " b" + to_string(i));
+        owned.push_back("QPOP " + queue);
+        owned.push_back("QPEEK " + queue);
+    }
+    owned.push_back("QPEEK missing");
+    owned.push_back("NOPE");
+    owned.push_back("");
+
+    vector<string_view> commands(owned.begin(), owned.end());
+    vector<string> replies;
+    sharded.executeBatch(commands.data(), commands.size(), replies);
+
+    ASSERT_EQ(replies.size(), commands.size());
+    for (size_t i = 0; i < commands.size(); ++i) {
+        EXPECT_EQ(replies[i], reference.executeCommand(commands[i])) << commands[i];
+    }
+}
+
+TEST(ShardedDatabaseTest, CrossShardCommandsFanOut) {
+    ShardedDatabase sharded(4, false);
+    auto [from, to] = namesOnDifferentShards(sharded);
+    ASSERT_NE(sharded.shardOf(from), sharded.shardOf(to));
+
+    sharded.executeCommand("MCREATE " + from);
+    sharded.executeCommand("MPUSH " + from + " value");
+    sharded.executeCommand("SCREATE other");
+
+    string list = sharded.executeCommand("LIST");
+    EXPECT_NE(list.find(from), string::npos);
+    EXPECT_NE(list.find("Stacks: other"), string::npos);
+
+    // Переименование переносит контейнер в другой шард
+    EXPECT_EQ(sharded.executeCommand("RENAME " + from + " " + to),
+              "SUCCESS: Container renamed: " + from + " -> " + to);
+    EXPECT_EQ(sharded.executeCommand("MGET " + to + " 0"), "VALUE: value");
+    EXPECT_EQ(sharded.executeCommand("EXISTS " + from), "EXISTS: NO");
+    EXPECT_EQ(sharded.executeCommand("RENAME " + to + " other"), "ERROR: Name already in use: other");
+    EXPECT_EQ(sharded.executeCommand("MGET " + to + " 0"), "VALUE: value");
+
+    // Снимок: по файлу на шард
+    string path = (filesystem::temp_directory_path() / "lab3_sharded.bin").string();
+    EXPECT_EQ(sharded.executeCommand("SAVE " + path), "SUCCESS: Database saved to " + path);
+    EXPECT_TRUE(filesystem::exists(path + ".shard0"));
+    EXPECT_EQ(sharded.executeCommand("CLEAR"), "SUCCESS: Database cleared");
+    EXPECT_EQ(sharded.executeCommand("LIST"), "CONTAINERS:\nNo containers found.");
+    EXPECT_EQ(sharded.executeCommand("LOAD " + path), "SUCCESS: Database loaded from " + path);
+    EXPECT_EQ(sharded.executeCommand("MGET " + to + " 0"), "VALUE: value");
+    EXPECT_EQ(sharded.executeCommand("EXISTS other"), "EXISTS: YES");
+    for (size_t i = 0; i < sharded.shardCount(); ++i) {
+        filesystem::remove(path + ".shard" + to_string(i));
+    }
+}
+
+// Число перед suffix в строке отчета, начинающейся с label
+static size_t reportNumber(const string& report, const string& label, const string& suffix) {
+    size_t start = report.find(label);
+    if (start == string::npos) {
+        return SIZE_MAX;
+    }
+    start += label.size();
+    return stoull(report.substr(start, report.find(suffix, start) - start));
+}
+
+TEST(ShardedDatabaseTest, MemoryStatsCoversAllShards) {
+    ShardedDatabase sharded(4, false);
+    const int count = 40;
+    size_t container_bytes = 0;
+    for (int i = 0; i < count; ++i) {
+        string name = "arr" + to_string(i);
+        sharded.executeCommand("MCREATE " + name);
+        sharded.executeCommand("MPUSH " + name + " value" + to_string(i));
+    }
+    for (int i = 0; i < count; ++i) {
+        string usage = sharded.executeCommand("MEMORY USAGE arr" + to_string(i));
+        container_bytes += reportNumber(usage, "MEMORY: ", " bytes");
+    }
+
+    // Итог — по контейнерам всех шардов плюс их индексы, а не только шард 0
+    string summary = sharded.executeCommand("MEMORY STATS");
+    EXPECT_EQ(reportNumber(summary, "\n  array: ", " containers"), static_cast<size_t>(count)) << summary;
+    EXPECT_EQ(reportNumber(summary, " containers, ", " elements"), static_cast<size_t>(count)) << summary;
+    size_t index_bytes = reportNumber(summary, "\n  index: ", " bytes");
+    EXPECT_EQ(reportNumber(summary, "\n  total: ", " bytes"), container_bytes + index_bytes) << summary;
+}
+
+TEST(ShardedDatabaseTest, StatsCoverAllShards) {
+    ShardedDatabase sharded(4, false);
+    const int count = 20;
+    for (int i = 0; i < count; ++i) {
+        string name = "arr" + to_string(i);
+        sharded.executeCommand("MCREATE " + name);
+        sharded.executeCommand("MPUSH " + name + " a");
+        sharded.executeCommand("MPUSH " + name + " b");
+    }
+    sharded.executeCommand("MPUSH missing c");
+
+    // Вызовы, ошибки и гистограммы складываются по всем шардам
+    string text = sharded.executeCommand("STATS");
+    EXPECT_NE(text.find("MPUSH calls=41 errors=1"), string::npos) << text;
+    EXPECT_NE(text.find("MCREATE calls=20 errors=0"), string::npos) << text;
+    for (int i = 0; i < count; ++i) {
+        EXPECT_NE(text.find("arr" + to_string(i) + " (array): 2 elements"), string::npos) << i;
+    }
+    string json = sharded.executeCommand("STATS JSON");
+    EXPECT_NE(json.find("\"MPUSH\":{\"calls\":41,\"errors\":1"), string::npos) << json;
+    // Сумма корзин гистограммы MPUSH: элементы вида [граница,число]
+    size_t pos = json.find("\"histogram\":[", json.find("\"MPUSH\"")) + 13;
+    size_t histogram_end = json.find("]}", pos);
+    size_t histogram_total = 0;
+    while ((pos = json.find(',', json.find('[', pos))) < histogram_end) {
+        histogram_total += stoull(json.substr(pos + 1));
+        pos = json.find(']', pos);
+    }
+    EXPECT_EQ(histogram_total, 41u);
+    string prometheus = sharded.executeCommand("STATS PROMETHEUS");
+    EXPECT_NE(prometheus.find("lab3_commands_total{command=\"MPUSH\"} 41\n"), string::npos);
+
+    string info = sharded.executeCommand("INFO");
+    EXPECT_NE(info.find("containers: 20\nelements: 40\n"), string::npos) << info;
+    EXPECT_NE(info.find("commands: 61\nerrors: 1\n"), string::npos) << info;
+
+    // RESET очищает счетчики каждого шарда
+    EXPECT_EQ(sharded.executeCommand("STATS RESET"), "SUCCESS: Statistics reset");
+    EXPECT_EQ(sharded.executeCommand("STATS").find("MPUSH"), string::npos);
+    EXPECT_NE(sharded.executeCommand("INFO").find("commands: 0\n"), string::npos);
+    EXPECT_EQ(sharded.executeCommand("STATS XML"), "ERROR: Unknown STATS option: XML");
+}
+
+TEST(ShardedDatabaseTest, SlowLogCoversAllShards) {
+    ShardedDatabase sharded(4, false);
+    auto [first, second] = namesOnDifferentShards(sharded);
+    ASSERT_NE(sharded.shardOf(first), sharded.shardOf(second));
+
+    // Порог и сброс доходят до каждого шарда
+    EXPECT_EQ(sharded.executeCommand("SLOWLOG THRESHOLD 0"), "SUCCESS: Slow log threshold set to 0us");
+    EXPECT_EQ(sharded.executeCommand("SLOWLOG RESET"), "SUCCESS: Slow log reset");
+    vector<string> commands = {"MCREATE " + first, "SCREATE " + second, "MPUSH " + first + " a",
+                               "SPUSH " + second + " b", "MPUSH " + first + " c"};
+    for (const auto& command : commands) {
+        sharded.executeCommand(command);
+        this_thread::sleep_for(chrono::milliseconds(2));
+    }
+    EXPECT_EQ(sharded.executeCommand("SLOWLOG LEN"), "LEN: 5");
+
+    // Записи шардов сливаются по времени, новые первыми
+    string reply = sharded.executeCommand("SLOWLOG GET 3");
+    EXPECT_EQ(reply.rfind("SLOWLOG: 3 entries", 0), 0u) << reply;
+    size_t newest = reply.find("command=" + commands[4]);
+    size_t middle = reply.find("command=" + commands[3]);
+    size_t oldest = reply.find("command=" + commands[2]);
+    ASSERT_NE(oldest, string::npos) << reply;
+    EXPECT_LT(newest, middle);
+    EXPECT_LT(middle, oldest);
+    EXPECT_EQ(reply.find("command=" + commands[1]), string::npos);
+    EXPECT_EQ(sharded.executeCommand("SLOWLOG GET x"), "ERROR: Invalid count format");
+
+    EXPECT_EQ(sharded.executeCommand("SLOWLOG THRESHOLD -1"), "ERROR: Invalid threshold format");
+    EXPECT_EQ(sharded.executeCommand("SLOWLOG THRESHOLD OFF"), "SUCCESS: Slow log disabled");
+    EXPECT_EQ(sharded.executeCommand("SLOWLOG RESET"), "SUCCESS: Slow log reset");
+    sharded.executeCommand("MPUSH " + first + " d");
+    sharded.executeCommand("SPUSH " + second + " e");
+    EXPECT_EQ(sharded.executeCommand("SLOWLOG LEN"), "LEN: 0");
+    EXPECT_EQ(sharded.executeCommand("SLOWLOG THRESHOLD"), "THRESHOLD: off");
+}
+
+TEST(ShardedDatabaseTest, ConcurrentClients) {
+    ShardedDatabase sharded(3, false);
+    const int clients = 4;
+    const int pushes = 2000;
+
+    vector<thread> threads;
+    for (int c = 0; c < clients; ++c) {
+        threads.emplace_back([&sharded, c] {
+            string stack = "stack" + to_string(c);
+            sharded.executeCommand("SCREATE " + stack);
+            vector<string> owned;
+            for (int i = 0; i < pushes; ++i) {
+                owned.push_back("SPUSH " + stack + " " + to_string(i));
+            }
+            vector<string_view> commands(owned.begin(), owned.end());
+            vector<string> replies;
+            for (size_t start = 0; start < commands.size(); start += 100) {
+                sharded.executeBatch(commands.data() + start, 100, replies);
+            }
+        });
+    }
+    for (auto& worker : threads) {
+        worker.join();
+    }
+
+    for (int c = 0; c < clients; ++c) {
+        string stack = "stack" + to_string(c);
+        EXPECT_EQ(sharded.executeCommand("SPEEK " + stack), "PEEK: " + to_string(pushes - 1));
+        EXPECT_NE(sharded.executeCommand("SSIZE " + stack).find(to_string(pushes)), string::npos);
+    }
+}
+
+// ==================== Concurrent Database Tests ====================
+TEST(ConcurrentDatabaseTest, ReadersWritersAndNamespaceChanges) {
+    Database db;
+    db.setConcurrent(true);
+    const int arrays = 4;
+    const int pushes = 2000;
+    for (int a = 0; a < arrays; ++a) {
+        db.executeCommand("MCREATE arr" + to_string(a));
+        db.executeCommand("MPUSH arr" + to_string(a) + " first");
+    }
+
+    atomic<bool> done{false};
+    atomic<int> bad_reads{0};
+    vector<thread> threads;
+    // Писатели: каждый в свой массив
+    for (int a = 0; a < arrays; ++a) {
+        threads.emplace_back([&db, a] {
+            string name = "arr" + to_string(a);
+            for (int i = 0; i < pushes; ++i) {
+                db.executeCommand("MPUSH " + name + " v" + to_string(i));
+            }
+        });
+    }
+    // Читатели: все массивы, включая те, в которые сейчас пишут
+    for (int r = 0; r < 3; ++r) {
+        threads.emplace_back([&db, &done, &bad_reads, r] {
+            int i = 0;
+            while (!done.load()) {
+                string reply = db.executeCommand("MGET arr" + to_string(i++ % arrays) + " 0");
+                if (reply != "VALUE: first") {
+                    bad_reads++;
+                }
+                db.executeCommand("EXISTS tmp" + to_string(r));
+            }
+        });
+    }
+    // Изменения пространства имен идут параллельно с остальными командами
+    threads.emplace_back([&db] {
+        for (int i = 0; i < 200; ++i) {
+            db.executeCommand("SCREATE tmp" + to_string(i % 3));
+            db.executeCommand("SPUSH tmp" + to_string(i % 3) + " x");
+            db.executeCommand("DEL tmp" + to_string(i % 3));
+        }
+    });
+
+    for (int t = 0; t < arrays; ++t) {
+        threads[t].join();
+    }
+    threads.back().join();
+    done.store(true);
+    for (size_t t = arrays; t + 1 < threads.size(); ++t) {
+        threads[t].join();
+    }
+
+    EXPECT_EQ(bad_reads.load(), 0);
+    for (int a = 0; a < arrays; ++a) {
+        EXPECT_EQ(db.getArray("arr" + to_string(a))->length(), pushes + 1);
+        EXPECT_EQ(db.executeCommand("MGET arr" + to_string(a) + " " + to_string(pushes)),
+                  "VALUE: v" + to_string(pushes - 1));
+    }
+    EXPECT_EQ(db.executeCommand("EXISTS tmp0"), "EXISTS: NO");
+}
+
+TEST(ConcurrentDatabaseTest, RepliesMatchSequentialMode) {
+    Database concurrent;
+    concurrent.setConcurrent(true);
+    Database sequential;
+    const vector<string> commands = {"MCREATE a", "MPUSH a x", "MGET a 0", "MGET missing 0", "MPUSH",
+                                     "PRINT a",   "TYPE a",    "RENAME a b", "LIST",         "DEL b",
+                                     "NOPE",      ""};
+    for (const auto& command : commands) {
+        EXPECT_EQ(concurrent.executeCommand(command), sequential.executeCommand(command)) << command;
+    }
+}
+
 // ==================== Integration Tests ====================
 TEST(IntegrationTest, ComplexScenario) {
     Database db;
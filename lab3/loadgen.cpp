@@ -0,0 +1,169 @@
+// Генератор нагрузки для сервера базы данных (main --unix / main --port).
+// Каждый клиент в своем потоке шлет команды пачками по --pipeline штук и
+// дожидается ответов на всю пачку. Задержка команды — время от отправки ее
+// пачки до получения ее ответа.
+#include "Server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct LoadOptions {
+    string unix_path;
+    int port = -1;
+    size_t clients = 4;
+    size_t requests = 100000;  // на каждого клиента
+    size_t pipeline = 16;
+    string command;  // пусто — по очереди QPUSH/QPOP в собственную очередь клиента
+};
+
+struct ClientResult {
+    vector<uint64_t> latencies;  // наносекунды
+    size_t errors = 0;
+    bool failed = false;
+};
+
+static bool connectClient(ServerClient& client, const LoadOptions& options) {
+    return options.unix_path.empty() ? client.connectTcp(static_cast<uint16_t>(options.port))
+                                     : client.connectUnix(options.unix_path);
+}
+
+static void runClient(const LoadOptions& options, size_t id, ClientResult& result) {
+    ServerClient client;
+    string reply;
+    if (!connectClient(client, options)) {
+        result.failed = true;
+        return;
+    }
+
+    string queue = "loadgen_" + to_string(id);
+    if (options.command.empty()) {
+        client.send("DEL " + queue + "\nQCREATE " + queue + "\n");
+        result.failed = !client.readReply(reply) || !client.readReply(reply);
+    }
+    string push = "QPUSH " + queue + " value\n";
+    string pop = "QPOP " + queue + "\n";
+    string fixed = options.command + "\n";
+
+    result.latencies.reserve(options.requests);
+    string batch;
+    size_t sent = 0;
+    while (sent < options.requests && !result.failed) {
+        size_t count = min(options.pipeline, options.requests - sent);
+        batch.clear();
+        for (size_t i = 0; i < count; ++i) {
+            if (!options.command.empty()) {
+                batch += fixed;
+            } else {
+                batch += (sent + i) % 2 == 0 ? push : pop;
+            }
+        }
+
+        auto start = chrono::steady_clock::now();
+        if (!client.send(batch)) {
+            result.failed = true;
+            break;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (!client.readReply(reply)) {
+                result.failed = true;
+                break;
+            }
+            auto elapsed = chrono::steady_clock::now() - start;
+            result.latencies.push_back(
+                static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(elapsed).count()));
+            if (reply.compare(0, 5, "ERROR") == 0) {
+                ++result.errors;
+            }
+        }
+        sent += count;
+    }
+
+    if (options.command.empty() && !result.failed) {
+        client.send("DEL " + queue + "\n");
+        client.readReply(reply);
+    }
+}
+
+static double percentileMicros(const vector<uint64_t>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1));
+    return static_cast<double>(sorted[index]) / 1000.0;
+}
+
+static bool parseOptions(int argc, char* argv[], LoadOptions& options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char* name = argv[i];
+        const char* value = argv[i + 1];
+        if (strcmp(name, "--unix") == 0) {
+            options.unix_path = value;
+        } else if (strcmp(name, "--port") == 0) {
+            options.port = atoi(value);
+        } else if (strcmp(name, "--clients") == 0) {
+            options.clients = strtoull(value, nullptr, 10);
+        } else if (strcmp(name, "--requests") == 0) {
+            options.requests = strtoull(value, nullptr, 10);
+        } else if (strcmp(name, "--pipeline") == 0) {
+            options.pipeline = strtoull(value, nullptr, 10);
+        } else if (strcmp(name, "--command") == 0) {
+            options.command = value;
+        } else {
+            return false;
+        }
+    }
+    return argc % 2 == 1 && (!options.unix_path.empty() || (options.port > 0 && options.port <= 65535)) &&
+           options.clients > 0 && options.pipeline > 0;
+}
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        cerr << "Использование: " << argv[0]
+             << " (--unix <путь> | --port <порт>) [--clients N] [--requests N]"
+                " [--pipeline N] [--command <команда>]"
+             << endl;
+        return 1;
+    }
+
+    vector<ClientResult> results(options.clients);
+    vector<thread> threads;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < options.clients; ++i) {
+        threads.emplace_back(runClient, cref(options), i, ref(results[i]));
+    }
+    for (auto& worker : threads) {
+        worker.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<uint64_t> latencies;
+    size_t errors = 0;
+    for (const auto& result : results) {
+        if (result.failed) {
+            cerr << "Соединение с сервером прервано" << endl;
+            return 1;
+        }
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        errors += result.errors;
+    }
+    sort(latencies.begin(), latencies.end());
+
+    cout << fixed << setprecision(1);
+    cout << "Клиентов: " << options.clients << ", конвейер: " << options.pipeline
+         << ", команд: " << latencies.size() << " (с ошибкой: " << errors << ")" << endl;
+    cout << "Пропускная способность: " << static_cast<double>(latencies.size()) / seconds << " ops/s" << endl;
+    cout << "Задержка p50: " << percentileMicros(latencies, 0.50) << " мкс, p99: "
+         << percentileMicros(latencies, 0.99) << " мкс, max: " << percentileMicros(latencies, 1.0)
+         << " мкс" << endl;
+    return 0;
+}
@@ -1,15 +1,74 @@
 #include "DB.h"
+#include "Server.h"
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
 
 using namespace std;
 
+static Server* running_server = nullptr;
+
+static void stopServer(int) {
+    if (running_server != nullptr) {
+        running_server->stop();
+    }
+}
+
+// Режим сервера: main --unix <путь> и/или main --port <порт>
+static int runServer(Database& db, const string& unix_path, int port) {
+    Server server(db);
+    if (!unix_path.empty() && !server.listenUnix(unix_path)) {
+        cerr << "Не удалось открыть сокет " << unix_path << endl;
+        return 1;
+    }
+    if (port >= 0 && !server.listenTcp(static_cast<uint16_t>(port))) {
+        cerr << "Не удалось открыть порт " << port << endl;
+        return 1;
+    }
+
+    if (!unix_path.empty()) {
+        cout << "Сервер слушает " << unix_path << endl;
+    }
+    if (port >= 0) {
+        cout << "Сервер слушает 127.0.0.1:" << server.port() << endl;
+    }
+
+    running_server = &server;
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+    server.run();
+    running_server = nullptr;
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
-    (void)argc; 
-    (void)argv;
-    
     Database db;
     string command;
+
+    string unix_path;
+    int port = -1;
+    bool valid = true;
+    for (int i = 1; i < argc && valid; i += 2) {
+        if (i + 1 >= argc) {
+            valid = false;
+        } else if (strcmp(argv[i], "--unix") == 0) {
+            unix_path = argv[i + 1];
+        } else if (strcmp(argv[i], "--port") == 0) {
+            port = atoi(argv[i + 1]);
+            valid = port >= 0 && port <= 65535;
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid) {
+        cerr << "Использование: " << argv[0] << " [--unix <путь>] [--port <порт>]" << endl;
+        return 1;
+    }
+    if (!unix_path.empty() || port >= 0) {
+        return runServer(db, unix_path, port);
+    }
     
     cout << "=== Система управления базами данных контейнеров ===" << endl;
     cout << "Введите HELP для списка команд" << endl;